@@ -0,0 +1,201 @@
+// Контроль производительности ядер относительно сохранённых замеров:
+//   bench --record файл             снять замеры на этой машине
+//   bench [--strict] файл [порог]   сравнить с замерами; код возврата 1,
+//                                   если ядро стало медленнее замера больше
+//                                   чем в порог раз
+// Замеры привязаны к модели процессора (S21Tuner::HostId()): файл хранит
+// по разделу на машину, каждый начинается строкой host, и --record
+// заменяет только раздел текущей машины. Без раздела для этой машины
+// проверка пропускается, а с --strict (режим CI, make bench) завершается
+// ошибкой.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_matrix_tune.h"
+
+namespace {
+
+const double kDefaultThreshold = 1.25;
+const int kRepeats = 5;
+
+struct Kernel {
+  std::string name;
+  std::function<void()> run;
+};
+
+S21Matrix Filled(int rows, int cols) {
+  S21Matrix m(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      m(i, j) = static_cast<double>((i * 7 + j * 13) % 17) / 17.0 +
+                (i == j ? cols : 0);
+    }
+  }
+  return m;
+}
+
+std::vector<Kernel> Kernels() {
+  auto mul_a = std::make_shared<const S21Matrix>(Filled(256, 256));
+  auto mul_b = std::make_shared<const S21Matrix>(Filled(256, 256));
+  auto big = std::make_shared<const S21Matrix>(Filled(1024, 1024));
+  auto system = std::make_shared<const S21Matrix>(Filled(256, 256));
+  auto rhs = std::make_shared<const S21Matrix>(Filled(256, 4));
+  auto small = std::make_shared<const S21Matrix>(Filled(8, 8));
+  auto power = std::make_shared<const S21Matrix>(Filled(128, 128) * 0.01);
+  return {
+      {"MulMatrix/256", [=] { (void)(*mul_a * *mul_b); }},
+      {"Transpose/1024", [=] { (void)big->Transpose(); }},
+      {"Sum/1024", [=] { (void)big->Sum(); }},
+      {"Solve/256", [=] { (void)system->Solve(*rhs); }},
+      {"SolveRefined/256", [=] { (void)system->SolveRefined(*rhs); }},
+      {"Determinant/8", [=] { (void)small->Determinant(); }},
+      {"InverseMatrix/8", [=] { (void)small->InverseMatrix(); }},
+      {"Pow/128", [=] { (void)power->Pow(8); }},
+  };
+}
+
+// Лучшее из kRepeats время в наносекундах после прогревочного запуска
+std::uint64_t Measure(const Kernel& kernel) {
+  kernel.run();
+  std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+  for (int r = 0; r < kRepeats; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    kernel.run();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    best = std::min(best, static_cast<std::uint64_t>(ns));
+  }
+  return best;
+}
+
+// Разделы файла замеров по машинам: host -> строки раздела без строки host
+std::map<std::string, std::vector<std::string>> ReadSections(
+    const std::string& path) {
+  std::map<std::string, std::vector<std::string>> sections;
+  std::ifstream in(path);
+  std::string host, line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (line.compare(0, 7, "host = ") == 0) {
+      host = line.substr(7);
+      sections[host];
+    } else if (!host.empty()) {
+      sections[host].push_back(line);
+    }
+  }
+  return sections;
+}
+
+int Record(const std::string& path) {
+  std::map<std::string, std::vector<std::string>> sections =
+      ReadSections(path);
+  std::vector<std::string>& current = sections[S21Tuner::HostId()];
+  current.clear();
+  for (const Kernel& kernel : Kernels()) {
+    std::uint64_t ns = Measure(kernel);
+    current.push_back(kernel.name + " = " + std::to_string(ns));
+    std::cout << kernel.name << ": " << ns << " нс\n";
+  }
+
+  std::ostringstream text;
+  text << "# Замеры s21_matrix, нс (лучшее из " << kRepeats << ")\n";
+  for (const auto& section : sections) {
+    text << "host = " << section.first << "\n";
+    for (const std::string& line : section.second) text << line << "\n";
+  }
+  // Через временный файл, чтобы прерванная запись не испортила разделы
+  // других машин
+  const std::string temporary = path + ".tmp";
+  std::ofstream out(temporary, std::ios::trunc);
+  out << text.str();
+  out.close();
+  if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::cerr << "Не удалось записать файл " << path << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+int Compare(const std::string& path, double threshold, bool strict) {
+  std::map<std::string, std::vector<std::string>> sections =
+      ReadSections(path);
+  auto section = sections.find(S21Tuner::HostId());
+  if (section == sections.end()) {
+    std::cout << "В " << path << " нет замеров для этой машины ("
+              << S21Tuner::HostId() << "), "
+              << (strict ? "проверка не пройдена" : "проверка пропущена")
+              << "; снимите их: make bench_baseline\n";
+    return strict ? 1 : 0;
+  }
+  std::map<std::string, std::uint64_t> baseline;
+  for (const std::string& line : section->second) {
+    std::size_t equals = line.find(" = ");
+    if (equals == std::string::npos) continue;
+    baseline[line.substr(0, equals)] =
+        std::strtoull(line.c_str() + equals + 3, nullptr, 10);
+  }
+
+  int slower = 0;
+  for (const Kernel& kernel : Kernels()) {
+    auto found = baseline.find(kernel.name);
+    if (found == baseline.end() || found->second == 0) {
+      std::cout << std::left << std::setw(18) << kernel.name
+                << " нет замера\n";
+      slower += strict ? 1 : 0;
+      continue;
+    }
+    std::uint64_t ns = Measure(kernel);
+    double ratio = static_cast<double>(ns) / found->second;
+    if (ratio > threshold) {
+      // Повторный замер отсеивает разовые помехи
+      ns = std::min(ns, Measure(kernel));
+      ratio = static_cast<double>(ns) / found->second;
+    }
+    bool failed = ratio > threshold;
+    slower += failed ? 1 : 0;
+    std::cout << std::left << std::setw(18) << kernel.name << std::right
+              << std::setw(12) << ns << " нс  x" << std::fixed
+              << std::setprecision(2) << ratio
+              << (failed ? "  МЕДЛЕННЕЕ ПОРОГА" : "") << "\n";
+  }
+  if (slower != 0) {
+    std::cout << "Ядер без замера или медленнее замера больше чем в "
+              << threshold << " раз: " << slower << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && std::string(argv[1]) == "--record") {
+    return Record(argv[2]);
+  }
+  const bool strict = argc >= 2 && std::string(argv[1]) == "--strict";
+  const int first = strict ? 2 : 1;
+  if (argc <= first) {
+    std::cerr << "Использование: bench --record файл | "
+                 "bench [--strict] файл [порог]\n";
+    return 2;
+  }
+  double threshold =
+      argc > first + 1 ? std::atof(argv[first + 1]) : kDefaultThreshold;
+  if (!(threshold > 0)) threshold = kDefaultThreshold;
+  return Compare(argv[first], threshold, strict);
+}
@@ -0,0 +1,267 @@
+#include "s21_matrix_cache.h"
+
+#include <pthread.h>
+
+#include "s21_matrix_memory.h"
+#include "s21_matrix_profile.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+// Константы xxHash64
+const std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+const std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+const std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t Rotl(std::uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t Round(std::uint64_t acc, std::uint64_t input) {
+  acc += input * kPrime2;
+  acc = Rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+inline std::uint64_t MergeRound(std::uint64_t acc, std::uint64_t val) {
+  acc ^= Round(0, val);
+  return acc * kPrime1 + kPrime4;
+}
+
+inline std::uint64_t Bits(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+S21MatrixCache::S21MatrixCache() {
+  // Под замком кэша копируются матрицы, а это захватывает замки
+  // распределителя, профилировщика и пула. Обработчики fork() вызываются в
+  // порядке, обратном регистрации, поэтому их замки регистрируются раньше
+  S21MatrixMemory::Instance();
+  S21Profiler::Instance();
+  S21ThreadPool::Instance();
+  ::pthread_atfork([] { Instance().mutex_.lock(); },
+                   [] { Instance().mutex_.unlock(); },
+                   [] { Instance().mutex_.unlock(); });
+}
+
+S21MatrixCache& S21MatrixCache::Instance() {
+  static S21MatrixCache instance;
+  return instance;
+}
+
+void S21MatrixCache::Enable(std::size_t budget_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_.store(true, std::memory_order_release);
+  budget_ = budget_bytes;
+  EvictLocked();
+}
+
+void S21MatrixCache::Disable() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_.store(false, std::memory_order_release);
+  index_.clear();
+  lru_.clear();
+  stats_.entries = 0;
+  stats_.bytes = 0;
+}
+
+bool S21MatrixCache::IsEnabled() const {
+  return enabled_.load(std::memory_order_acquire);
+}
+
+void S21MatrixCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  lru_.clear();
+  stats_.entries = 0;
+  stats_.bytes = 0;
+}
+
+void S21MatrixCache::ResetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.evictions = 0;
+}
+
+S21CacheStats S21MatrixCache::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+bool S21MatrixCache::FindDeterminant(const S21Matrix& m, double* det) {
+  if (!IsEnabled()) return false;
+  Key key = MakeKey(m);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_.load(std::memory_order_relaxed)) return false;
+  Entry* entry = Lookup(m, key);
+  if (entry == nullptr || !entry->has_det) {
+    ++stats_.misses;
+    return false;
+  }
+  ++stats_.hits;
+  *det = entry->det;
+  return true;
+}
+
+void S21MatrixCache::StoreDeterminant(const S21Matrix& m, double det) {
+  if (!IsEnabled()) return;
+  Key key = MakeKey(m);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_.load(std::memory_order_relaxed)) return;
+  Entry* entry = Insert(m, key);
+  if (entry == nullptr) return;
+  entry->has_det = true;
+  entry->det = det;
+}
+
+bool S21MatrixCache::FindInverse(const S21Matrix& m, S21Matrix* inverse) {
+  if (!IsEnabled()) return false;
+  Key key = MakeKey(m);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_.load(std::memory_order_relaxed)) return false;
+  Entry* entry = Lookup(m, key);
+  if (entry == nullptr || !entry->inverse) {
+    ++stats_.misses;
+    return false;
+  }
+  ++stats_.hits;
+  *inverse = S21Matrix(*entry->inverse);
+  return true;
+}
+
+void S21MatrixCache::StoreInverse(const S21Matrix& m,
+                                  const S21Matrix& inverse) {
+  if (!IsEnabled()) return;
+  Key key = MakeKey(m);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_.load(std::memory_order_relaxed)) return;
+  Entry* entry = Insert(m, key);
+  if (entry == nullptr || entry->inverse) return;
+  entry->inverse.reset(new S21Matrix(inverse));
+  Account(entry, MatrixBytes(inverse));
+}
+
+std::uint64_t S21MatrixCache::Hash(const S21Matrix& m) {
+  const int rows = m.GetRows();
+  const int cols = m.GetCols();
+  const double* const* data = m.GetConstMatrixPointer();
+
+  std::uint64_t acc[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+  std::uint64_t total = 0;
+  // Элементы подаются сквозным потоком, поэтому разбиение на строки не
+  // влияет на результат
+  int lane = 0;
+  for (int i = 0; i < rows; ++i) {
+    const double* row = data[i];
+    int j = 0;
+    // Выравниваем позицию на начало полосы из четырёх элементов
+    for (; j < cols && lane != 0; ++j, lane = (lane + 1) & 3) {
+      acc[lane] = Round(acc[lane], Bits(row[j]));
+    }
+    for (; j + 4 <= cols; j += 4) {
+      acc[0] = Round(acc[0], Bits(row[j]));
+      acc[1] = Round(acc[1], Bits(row[j + 1]));
+      acc[2] = Round(acc[2], Bits(row[j + 2]));
+      acc[3] = Round(acc[3], Bits(row[j + 3]));
+    }
+    for (; j < cols; ++j, lane = (lane + 1) & 3) {
+      acc[lane] = Round(acc[lane], Bits(row[j]));
+    }
+    total += static_cast<std::uint64_t>(cols);
+  }
+
+  std::uint64_t h = Rotl(acc[0], 1) + Rotl(acc[1], 7) + Rotl(acc[2], 12) +
+                    Rotl(acc[3], 18);
+  for (int k = 0; k < 4; ++k) h = MergeRound(h, acc[k]);
+  h += total * sizeof(double) + kPrime5;
+
+  // Финальное перемешивание
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+S21MatrixCache::Entry* S21MatrixCache::Lookup(const S21Matrix& m,
+                                              const Key& key) {
+  auto found = index_.find(key);
+  if (found == index_.end()) return nullptr;
+  EntryList::iterator it = found->second;
+  if (!SameBits(it->source, m)) return nullptr;  // Коллизия хэша
+  lru_.splice(lru_.begin(), lru_, it);
+  return &*it;
+}
+
+S21MatrixCache::Entry* S21MatrixCache::Insert(const S21Matrix& m,
+                                              const Key& key) {
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    EntryList::iterator it = found->second;
+    if (SameBits(it->source, m)) {
+      lru_.splice(lru_.begin(), lru_, it);
+      return &*it;
+    }
+    // Коллизия хэша: заменяем старую запись новой
+    stats_.bytes -= it->bytes;
+    --stats_.entries;
+    lru_.erase(it);
+    index_.erase(found);
+  }
+
+  std::size_t bytes = MatrixBytes(m);
+  if (bytes > budget_) return nullptr;
+  lru_.emplace_front(key, m);
+  index_[key] = lru_.begin();
+  ++stats_.entries;
+  Entry* entry = &lru_.front();
+  Account(entry, bytes);
+  // Запись могла быть вытеснена, если бюджет был исчерпан ею самой
+  return index_.count(key) != 0 ? entry : nullptr;
+}
+
+void S21MatrixCache::Account(Entry* entry, std::size_t extra) {
+  entry->bytes += extra;
+  stats_.bytes += extra;
+  EvictLocked();
+}
+
+void S21MatrixCache::EvictLocked() {
+  while (stats_.bytes > budget_ && !lru_.empty()) {
+    Entry& victim = lru_.back();
+    stats_.bytes -= victim.bytes;
+    --stats_.entries;
+    ++stats_.evictions;
+    index_.erase(victim.key);
+    lru_.pop_back();
+  }
+}
+
+S21MatrixCache::Key S21MatrixCache::MakeKey(const S21Matrix& m) {
+  return Key{Hash(m), m.GetRows(), m.GetCols()};
+}
+
+bool S21MatrixCache::SameBits(const S21Matrix& a, const S21Matrix& b) {
+  const double* const* pa = a.GetConstMatrixPointer();
+  const double* const* pb = b.GetConstMatrixPointer();
+  const std::size_t row_bytes =
+      static_cast<std::size_t>(a.GetCols()) * sizeof(double);
+  for (int i = 0; i < a.GetRows(); ++i) {
+    if (std::memcmp(pa[i], pb[i], row_bytes) != 0) return false;
+  }
+  return true;
+}
+
+std::size_t S21MatrixCache::MatrixBytes(const S21Matrix& m) {
+  return static_cast<std::size_t>(m.GetRows()) *
+         (static_cast<std::size_t>(m.GetCols()) * sizeof(double) +
+          sizeof(double*));
+}
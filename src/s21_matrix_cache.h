@@ -0,0 +1,119 @@
+#ifndef S21_MATRIX_CACHE
+#define S21_MATRIX_CACHE
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "s21_matrix_oop.h"
+
+// Счётчики кэша результатов
+struct S21CacheStats {
+  std::size_t hits = 0;       // Попадания
+  std::size_t misses = 0;     // Промахи
+  std::size_t evictions = 0;  // Вытеснения по бюджету памяти
+  std::size_t entries = 0;    // Текущее число записей
+  std::size_t bytes = 0;      // Текущий объём занятой памяти
+};
+
+/**
+ * @brief Кэш результатов Determinant / InverseMatrix для повторяющихся
+ * матриц.
+ *
+ * Кэш выключен по умолчанию и включается вызовом Enable() с бюджетом памяти в
+ * байтах. Ключом служит хэш содержимого матрицы вместе с её размерами, а при
+ * попадании содержимое дополнительно сверяется побитово, как и хэшируется,
+ * поэтому коллизии хэша не приводят к неверным результатам, а матрицы с NaN
+ * находятся так же, как и остальные.
+ *
+ * Счётчики hits и misses учитывают только операцию, вызванную
+ * пользователем: определитель, который InverseMatrix вычисляет внутри, в них
+ * не попадает.
+ *
+ * Так как ключ вычисляется из содержимого, любая мутация матрицы (SumMatrix,
+ * MulNumber, запись через operator() и т.д.) автоматически делает старую
+ * запись недостижимой — явная инвалидация не требуется. Неиспользуемые записи
+ * вытесняются по принципу LRU при превышении бюджета.
+ *
+ * @note Все методы потокобезопасны.
+ */
+class S21MatrixCache {
+ public:
+  static S21MatrixCache& Instance();  // Глобальный экземпляр кэша
+
+  void Enable(std::size_t budget_bytes);  // Включает кэш с бюджетом памяти
+  void Disable();  // Выключает кэш и очищает записи
+  bool IsEnabled() const;  // Без блокировки: одно атомарное чтение
+  void Clear();       // Очищает записи, сохраняя счётчики
+  void ResetStats();  // Обнуляет счётчики попаданий и промахов
+  S21CacheStats Stats() const;
+
+  // Поиск и сохранение результатов, используются внутри S21Matrix
+  bool FindDeterminant(const S21Matrix& m, double* det);
+  void StoreDeterminant(const S21Matrix& m, double det);
+  bool FindInverse(const S21Matrix& m, S21Matrix* inverse);
+  void StoreInverse(const S21Matrix& m, const S21Matrix& inverse);
+
+  /**
+   * @brief Хэш содержимого матрицы (вариант xxHash64 по битам элементов).
+   *
+   * Строки обрабатываются четырьмя независимыми аккумуляторами, что позволяет
+   * компилятору векторизовать основной цикл.
+   */
+  static std::uint64_t Hash(const S21Matrix& m);
+
+ private:
+  S21MatrixCache();
+
+  struct Key {
+    std::uint64_t hash;
+    int rows, cols;
+    bool operator==(const Key& other) const {
+      return hash == other.hash && rows == other.rows && cols == other.cols;
+    }
+  };
+
+  struct KeyHasher {
+    std::size_t operator()(const Key& key) const {
+      return static_cast<std::size_t>(key.hash);
+    }
+  };
+
+  struct Entry {
+    Key key;
+    S21Matrix source;  // Копия исходной матрицы для сверки при попадании
+    bool has_det = false;
+    double det = 0.0;
+    std::unique_ptr<S21Matrix> inverse;
+    std::size_t bytes = 0;
+
+    Entry(const Key& k, const S21Matrix& m) : key(k), source(m) {}
+  };
+
+  using EntryList = std::list<Entry>;
+
+  Entry* Lookup(const S21Matrix& m, const Key& key);  // Ищет и обновляет LRU
+  Entry* Insert(const S21Matrix& m, const Key& key);  // Ищет или создаёт
+  void Account(Entry* entry, std::size_t extra);  // Учитывает память
+  void EvictLocked();  // Вытесняет записи до соблюдения бюджета
+  static Key MakeKey(const S21Matrix& m);
+  // Побитовое совпадение элементов матриц одного размера
+  static bool SameBits(const S21Matrix& a, const S21Matrix& b);
+  static std::size_t MatrixBytes(const S21Matrix& m);
+
+  mutable std::mutex mutex_;
+  // Пишется под mutex_, читается без него: выключенный кэш не должен
+  // сериализовать Determinant и InverseMatrix на общей блокировке
+  std::atomic<bool> enabled_{false};
+  std::size_t budget_ = 0;
+  S21CacheStats stats_;
+  EntryList lru_;  // Голова — самые свежие записи
+  std::unordered_map<Key, EntryList::iterator, KeyHasher> index_;
+};
+
+#endif  // S21_MATRIX_CACHE
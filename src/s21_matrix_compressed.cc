@@ -0,0 +1,344 @@
+#include "s21_matrix_compressed.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "s21_thread_pool.h"
+
+namespace {
+
+const double kInt8Levels = 127.0;
+
+// Округляет double к ближайшему 16-битному числу с exponent_bits битами
+// порядка и mantissa_bits битами мантиссы (к чётному при равенстве).
+// Переполнение даёт бесконечность, потеря значимости — денормализованное
+// число или ноль, NaN остаётся NaN
+template <int exponent_bits, int mantissa_bits>
+std::uint16_t Narrow(double value) {
+  const int bias = (1 << (exponent_bits - 1)) - 1;
+  const std::uint32_t max_exponent = (1u << exponent_bits) - 1;
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const std::uint32_t sign = static_cast<std::uint32_t>(bits >> 63) << 15;
+  const int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+  const std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+  if (exponent == 0x7ff) {
+    return static_cast<std::uint16_t>(
+        sign | (max_exponent << mantissa_bits) |
+        (mantissa != 0 ? 1u << (mantissa_bits - 1) : 0u));
+  }
+  // Денормализованные double намного меньше наименьшего 16-битного числа
+  if (exponent == 0) return static_cast<std::uint16_t>(sign);
+  const int biased = exponent - 1023 + bias;
+  if (biased >= static_cast<int>(max_exponent)) {
+    return static_cast<std::uint16_t>(sign | (max_exponent << mantissa_bits));
+  }
+  const int shift = 52 - mantissa_bits + (biased <= 0 ? 1 - biased : 0);
+  if (shift > 53) return static_cast<std::uint16_t>(sign);
+  const std::uint64_t full = mantissa | (std::uint64_t(1) << 52);
+  const std::uint64_t kept = full >> shift;
+  const std::uint64_t rest = full & ((std::uint64_t(1) << shift) - 1);
+  const std::uint64_t half = std::uint64_t(1) << (shift - 1);
+  // Скрытая единица в kept переносит порядок, поэтому нормализованное
+  // число собирается сложением, а перенос при округлении доходит до
+  // следующего порядка или бесконечности сам
+  std::uint32_t result = static_cast<std::uint32_t>(kept);
+  if (biased > 0) {
+    result += static_cast<std::uint32_t>(biased - 1) << mantissa_bits;
+  }
+  if (rest > half || (rest == half && (kept & 1) != 0)) ++result;
+  return static_cast<std::uint16_t>(sign | result);
+}
+
+float HalfToFloat(std::uint16_t half) {
+  const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+  const std::uint32_t exponent = (half >> 10) & 0x1f;
+  const std::uint32_t mantissa = half & 0x3ff;
+  std::uint32_t bits;
+  if (exponent == 0) {
+    // Денормализованное число mantissa * 2^-24 точно представимо во float
+    float value = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+    return sign != 0 ? -value : value;
+  } else if (exponent == 0x1f) {
+    bits = sign | 0x7f800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+float BFloat16ToFloat(std::uint16_t bfloat) {
+  const std::uint32_t bits = static_cast<std::uint32_t>(bfloat) << 16;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+S21CompressedMatrix::S21CompressedMatrix(const S21Matrix& matrix,
+                                         const S21CompressionOptions& options,
+                                         S21CompressionReport* report)
+    : rows_(matrix.GetRows()),
+      cols_(matrix.GetCols()),
+      block_size_(options.block_size),
+      block_rows_(0),
+      block_cols_(0),
+      kind_(options.kind) {
+  if (block_size_ <= 0) {
+    throw std::invalid_argument("Размер блока должен быть положительным");
+  }
+  if (!(options.zero_tolerance >= 0)) {
+    throw std::invalid_argument("Порог нулевых блоков не может быть "
+                                "отрицательным");
+  }
+  block_rows_ = (rows_ + block_size_ - 1) / block_size_;
+  block_cols_ = (cols_ + block_size_ - 1) / block_size_;
+  const double* const* source = matrix.GetConstMatrixPointer();
+  offsets_.assign(static_cast<std::size_t>(block_rows_) * block_cols_, -1);
+  const std::size_t elements = static_cast<std::size_t>(rows_) * cols_;
+  if (kind_ == S21Compression::kInt8) {
+    scales_.resize(offsets_.size());
+    int8_.reserve(elements);
+  } else if (kind_ != S21Compression::kBlockSparse) {
+    half_.reserve(elements);
+  }
+
+  std::int64_t stored = 0;
+  for (int bi = 0; bi < block_rows_; ++bi) {
+    const int r0 = bi * block_size_, r1 = std::min(rows_, r0 + block_size_);
+    for (int bj = 0; bj < block_cols_; ++bj) {
+      const int c0 = bj * block_size_, c1 = std::min(cols_, c0 + block_size_);
+      const std::size_t block = static_cast<std::size_t>(bi) * block_cols_ + bj;
+      double max_abs = 0.0;
+      for (int i = r0; i < r1; ++i) {
+        for (int j = c0; j < c1; ++j) {
+          if (kind_ == S21Compression::kInt8 && !std::isfinite(source[i][j])) {
+            throw std::invalid_argument(
+                "Сжатие в int8 требует конечных элементов");
+          }
+          // NaN не считается нулём
+          if (!(std::fabs(source[i][j]) <= max_abs)) {
+            max_abs = std::fabs(source[i][j]);
+          }
+        }
+      }
+      if (kind_ == S21Compression::kBlockSparse &&
+          max_abs <= options.zero_tolerance) {
+        continue;
+      }
+      offsets_[block] = stored;
+      stored += static_cast<std::int64_t>(r1 - r0) * (c1 - c0);
+      const double scale = max_abs / kInt8Levels;
+      if (kind_ == S21Compression::kInt8) scales_[block] = scale;
+      for (int i = r0; i < r1; ++i) {
+        for (int j = c0; j < c1; ++j) {
+          const double x = source[i][j];
+          switch (kind_) {
+            case S21Compression::kInt8:
+              int8_.push_back(static_cast<std::int8_t>(
+                  scale > 0 ? std::lround(x / scale) : 0));
+              break;
+            case S21Compression::kFloat16:
+              half_.push_back(Narrow<5, 10>(x));
+              break;
+            case S21Compression::kBFloat16:
+              half_.push_back(Narrow<8, 7>(x));
+              break;
+            case S21Compression::kBlockSparse:
+              dense_.push_back(x);
+              break;
+          }
+        }
+      }
+    }
+  }
+  if (report != nullptr) *report = Compare(matrix);
+}
+
+bool S21CompressedMatrix::UnpackBlock(int block_row, int block_col,
+                                      double* tile) const {
+  const std::size_t block =
+      static_cast<std::size_t>(block_row) * block_cols_ + block_col;
+  const std::int64_t offset = offsets_[block];
+  if (offset < 0) return false;
+  const int height = std::min(rows_ - block_row * block_size_, block_size_);
+  const int width = std::min(cols_ - block_col * block_size_, block_size_);
+  for (int i = 0; i < height; ++i) {
+    double* row = tile + static_cast<std::size_t>(i) * block_size_;
+    const std::size_t start = offset + static_cast<std::size_t>(i) * width;
+    switch (kind_) {
+      case S21Compression::kInt8: {
+        const double scale = scales_[block];
+        const std::int8_t* q = int8_.data() + start;
+        for (int j = 0; j < width; ++j) row[j] = q[j] * scale;
+        break;
+      }
+      case S21Compression::kFloat16: {
+        const std::uint16_t* h = half_.data() + start;
+        for (int j = 0; j < width; ++j) row[j] = HalfToFloat(h[j]);
+        break;
+      }
+      case S21Compression::kBFloat16: {
+        const std::uint16_t* h = half_.data() + start;
+        for (int j = 0; j < width; ++j) row[j] = BFloat16ToFloat(h[j]);
+        break;
+      }
+      case S21Compression::kBlockSparse:
+        std::copy(dense_.begin() + start, dense_.begin() + start + width, row);
+        break;
+    }
+  }
+  return true;
+}
+
+S21Matrix S21CompressedMatrix::Decompress() const {
+  S21Matrix result(rows_, cols_);
+  double** out = result.GetMatrixPointer();
+  std::vector<double> tile(static_cast<std::size_t>(block_size_) *
+                           block_size_);
+  for (int bi = 0; bi < block_rows_; ++bi) {
+    const int r0 = bi * block_size_;
+    const int height = std::min(rows_ - r0, block_size_);
+    for (int bj = 0; bj < block_cols_; ++bj) {
+      if (!UnpackBlock(bi, bj, tile.data())) continue;
+      const int c0 = bj * block_size_;
+      const int width = std::min(cols_ - c0, block_size_);
+      for (int i = 0; i < height; ++i) {
+        std::copy(tile.begin() + static_cast<std::size_t>(i) * block_size_,
+                  tile.begin() + static_cast<std::size_t>(i) * block_size_ +
+                      width,
+                  out[r0 + i] + c0);
+      }
+    }
+  }
+  return result;
+}
+
+double S21CompressedMatrix::At(int row, int col) const {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::out_of_range("Матрица вне диапазона");
+  }
+  const int bi = row / block_size_, bj = col / block_size_;
+  const std::size_t block = static_cast<std::size_t>(bi) * block_cols_ + bj;
+  if (offsets_[block] < 0) return 0.0;
+  const int width = std::min(cols_ - bj * block_size_, block_size_);
+  const std::size_t index =
+      offsets_[block] +
+      static_cast<std::size_t>(row - bi * block_size_) * width +
+      (col - bj * block_size_);
+  switch (kind_) {
+    case S21Compression::kInt8:
+      return int8_[index] * scales_[block];
+    case S21Compression::kFloat16:
+      return HalfToFloat(half_[index]);
+    case S21Compression::kBFloat16:
+      return BFloat16ToFloat(half_[index]);
+    case S21Compression::kBlockSparse:
+      break;
+  }
+  return dense_[index];
+}
+
+S21Matrix S21CompressedMatrix::Multiply(const S21Matrix& b) const {
+  if (b.GetRows() != cols_) {
+    throw std::invalid_argument(
+        "Число столбцов первой матрицы должно совпадать с числом строк "
+        "второй");
+  }
+  const int width = b.GetCols();
+  S21Matrix result(rows_, width);
+  double** c = result.GetMatrixPointer();
+  const double* const* rhs = b.GetConstMatrixPointer();
+  // Каждый поток распаковывает блоки в собственный буфер и пишет только в
+  // свои строки блоков результата
+  auto body = [this, c, rhs, width](int begin, int end) {
+    std::vector<double> tile(static_cast<std::size_t>(block_size_) *
+                             block_size_);
+    for (int bi = begin; bi < end; ++bi) {
+      const int r0 = bi * block_size_;
+      const int height = std::min(rows_ - r0, block_size_);
+      for (int bk = 0; bk < block_cols_; ++bk) {
+        if (!UnpackBlock(bi, bk, tile.data())) continue;
+        const int k0 = bk * block_size_;
+        const int depth = std::min(cols_ - k0, block_size_);
+        for (int i = 0; i < height; ++i) {
+          double* row = c[r0 + i];
+          const double* a = tile.data() + static_cast<std::size_t>(i) *
+                                              block_size_;
+          for (int k = 0; k < depth; ++k) {
+            const double factor = a[k];
+            const double* b_row = rhs[k0 + k];
+            for (int j = 0; j < width; ++j) row[j] += factor * b_row[j];
+          }
+        }
+      }
+    }
+  };
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      block_rows_,
+      2 * static_cast<std::uint64_t>(rows_) *
+          static_cast<std::uint64_t>(cols_) * width,
+      static_cast<std::size_t>(block_size_) * (cols_ + width) * sizeof(double),
+      body);
+  return result;
+}
+
+S21CompressionReport S21CompressedMatrix::Compare(
+    const S21Matrix& reference) const {
+  if (reference.GetRows() != rows_ || reference.GetCols() != cols_) {
+    throw std::invalid_argument("Размеры матриц должны совпадать");
+  }
+  S21CompressionReport report;
+  const S21Matrix restored = Decompress();
+  const double* const* x = reference.GetConstMatrixPointer();
+  const double* const* y = restored.GetConstMatrixPointer();
+  double error_squares = 0.0, norm_squares = 0.0;
+  for (int i = 0; i < rows_; ++i) {
+    for (int j = 0; j < cols_; ++j) {
+      if (std::isnan(x[i][j]) && std::isnan(y[i][j])) continue;
+      double diff = x[i][j] == y[i][j] ? 0.0 : std::fabs(x[i][j] - y[i][j]);
+      if (std::isnan(diff)) diff = std::numeric_limits<double>::infinity();
+      report.max_abs_error = std::max(report.max_abs_error, diff);
+      error_squares += diff * diff;
+      if (std::isfinite(x[i][j])) norm_squares += x[i][j] * x[i][j];
+    }
+  }
+  if (error_squares > 0) {
+    report.relative_error =
+        norm_squares > 0 ? std::sqrt(error_squares / norm_squares)
+                         : std::numeric_limits<double>::infinity();
+  }
+  report.dense_bytes = static_cast<std::size_t>(rows_) * cols_ *
+                       sizeof(double);
+  report.compressed_bytes = Bytes();
+  report.ratio = report.compressed_bytes > 0
+                     ? static_cast<double>(report.dense_bytes) /
+                           report.compressed_bytes
+                     : std::numeric_limits<double>::infinity();
+  return report;
+}
+
+int S21CompressedMatrix::GetRows() const { return rows_; }
+
+int S21CompressedMatrix::GetCols() const { return cols_; }
+
+S21Compression S21CompressedMatrix::Kind() const { return kind_; }
+
+std::size_t S21CompressedMatrix::Bytes() const {
+  return offsets_.size() * sizeof(std::int64_t) +
+         scales_.size() * sizeof(double) + int8_.size() +
+         half_.size() * sizeof(std::uint16_t) +
+         dense_.size() * sizeof(double);
+}
+
+std::size_t S21CompressedMatrix::StoredBlocks() const {
+  return static_cast<std::size_t>(
+      std::count_if(offsets_.begin(), offsets_.end(),
+                    [](std::int64_t offset) { return offset >= 0; }));
+}
@@ -0,0 +1,89 @@
+#ifndef S21_MATRIX_COMPRESSED
+#define S21_MATRIX_COMPRESSED
+
+// Небходимые зависимые директивы
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Способ хранения элементов
+enum class S21Compression {
+  kInt8,        // int8 с масштабом на блок, в ~8 раз меньше double
+  kFloat16,     // IEEE 754 half, в 4 раза меньше double
+  kBFloat16,    // bfloat16: диапазон float, 8 бит мантиссы
+  kBlockSparse  // Без потерь: нулевые блоки не хранятся
+};
+
+struct S21CompressionOptions {
+  S21Compression kind = S21Compression::kInt8;
+  int block_size = 32;  // Сторона квадратного блока: блок, распакованный в
+                        // double, занимает 8 КБ и остаётся в L1
+  double zero_tolerance = 0.0;  // kBlockSparse: блок опускается, если все
+                                // его |x| не больше этого значения
+};
+
+// Точность и размер сжатого представления относительно исходной матрицы
+struct S21CompressionReport {
+  double max_abs_error = 0.0;       // max |x - x'|
+  double relative_error = 0.0;      // ||X - X'||_F / ||X||_F
+  std::size_t dense_bytes = 0;      // rows * cols * sizeof(double)
+  std::size_t compressed_bytes = 0;  // Bytes()
+  double ratio = 0.0;               // dense_bytes / compressed_bytes
+};
+
+/**
+ * @brief Сжатое хранение матрицы с умножением без полной распаковки.
+ *
+ * Матрица делится на квадратные блоки block_size x block_size, каждый из
+ * которых хранится подряд. Для kInt8 у каждого блока свой масштаб
+ * max|x| / 127, так что выброс портит точность только своего блока; kFloat16
+ * и kBFloat16 округляют элементы к ближайшему с чётной мантиссой;
+ * kBlockSparse хранит ненулевые блоки в double без потерь.
+ *
+ * Multiply() распаковывает по одному блоку в буфер потока, лежащий в L1, и
+ * сразу умножает его на соответствующую полосу правого множителя; строки
+ * блоков распределяются по S21ThreadPool. Отсутствующие блоки kBlockSparse
+ * пропускаются без работы.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21CompressedMatrix {
+ public:
+  // std::invalid_argument для неположительного block_size, отрицательного
+  // zero_tolerance и нечисловых элементов при kInt8; report, если задан,
+  // получает ошибку сжатия
+  explicit S21CompressedMatrix(const S21Matrix& matrix,
+                               const S21CompressionOptions& options = {},
+                               S21CompressionReport* report = nullptr);
+
+  S21Matrix Decompress() const;
+  double At(int row, int col) const;  // Один элемент; std::out_of_range
+  // this * b; std::invalid_argument при несовпадении размеров
+  S21Matrix Multiply(const S21Matrix& b) const;
+  // Ошибка и степень сжатия относительно reference того же размера
+  S21CompressionReport Compare(const S21Matrix& reference) const;
+
+  int GetRows() const;
+  int GetCols() const;
+  S21Compression Kind() const;
+  std::size_t Bytes() const;  // Память под элементы, масштабы и индекс блоков
+  std::size_t StoredBlocks() const;  // Меньше числа блоков для kBlockSparse
+
+ private:
+  // Распаковывает блок (block_row, block_col) построчно в tile с шагом
+  // block_size_; false, если блок опущен
+  bool UnpackBlock(int block_row, int block_col, double* tile) const;
+
+  int rows_, cols_, block_size_, block_rows_, block_cols_;
+  S21Compression kind_;
+  // Начало блока в хранилище элементов или -1 для опущенного блока
+  std::vector<std::int64_t> offsets_;
+  std::vector<double> scales_;  // kInt8: масштаб каждого блока
+  std::vector<std::int8_t> int8_;
+  std::vector<std::uint16_t> half_;  // kFloat16 и kBFloat16
+  std::vector<double> dense_;        // kBlockSparse
+};
+
+#endif  // S21_MATRIX_COMPRESSED
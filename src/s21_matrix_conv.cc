@@ -0,0 +1,434 @@
+#include "s21_matrix_conv.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_thread_pool.h"
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// Оценка числа вещественных операций комплексного БПФ длины n
+const double kFftFlopsPerPoint = 5.0;
+
+// Наибольшая развёртка окон одной полосы Convolve2D в элементах (8 МБ)
+const std::size_t kIm2colElements = std::size_t(1) << 20;
+
+// Без проверок на NaN, которые std::complex делает при умножении
+inline Complex Mul(Complex a, Complex b) {
+  return Complex(a.real() * b.real() - a.imag() * b.imag(),
+                 a.real() * b.imag() + a.imag() * b.real());
+}
+
+int FftSize(int length) {
+  int size = 1;
+  while (size < length) size <<= 1;
+  return size;
+}
+
+double FftFlops(double points) {
+  return points > 1 ? kFftFlopsPerPoint * points * std::log2(points) : 1.0;
+}
+
+// Итеративное БПФ по основанию 2 для длины степени двойки. Таблицы
+// перестановки и поворотных множителей строятся один раз на длину
+class FftPlan {
+ public:
+  explicit FftPlan(int n) : n_(n), reversed_(n), twiddles_(n / 2) {
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    for (int i = 0; i < n; ++i) {
+      int reversed = 0;
+      for (int b = 0; b < bits; ++b) {
+        reversed |= ((i >> b) & 1) << (bits - 1 - b);
+      }
+      reversed_[i] = reversed;
+    }
+    const double angle = -2.0 * std::acos(-1.0) / n;
+    for (int k = 0; k < n / 2; ++k) {
+      twiddles_[k] = Complex(std::cos(angle * k), std::sin(angle * k));
+    }
+  }
+
+  // Прямое или обратное (без деления на n) преобразование на месте
+  void Run(Complex* data, bool inverse) const {
+    for (int i = 0; i < n_; ++i) {
+      if (i < reversed_[i]) std::swap(data[i], data[reversed_[i]]);
+    }
+    for (int length = 2; length <= n_; length <<= 1) {
+      const int half = length / 2, step = n_ / length;
+      for (int start = 0; start < n_; start += length) {
+        for (int k = 0; k < half; ++k) {
+          Complex w = twiddles_[k * step];
+          if (inverse) w = std::conj(w);
+          const Complex u = data[start + k];
+          const Complex v = Mul(data[start + k + half], w);
+          data[start + k] = u + v;
+          data[start + k + half] = u - v;
+        }
+      }
+    }
+  }
+
+ private:
+  int n_;
+  std::vector<int> reversed_;
+  std::vector<Complex> twiddles_;
+};
+
+// Двумерное БПФ массива rows x cols (обе стороны — степени двойки):
+// преобразуются строки, затем столбцы
+void Fft2D(std::vector<Complex>* data, int rows, int cols, bool inverse) {
+  Complex* grid = data->data();
+  const FftPlan row_plan(cols), column_plan(rows);
+  const double points = static_cast<double>(rows) * cols;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows, static_cast<std::uint64_t>(FftFlops(points)),
+      static_cast<std::size_t>(cols) * sizeof(Complex),
+      [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          row_plan.Run(grid + static_cast<std::size_t>(i) * cols, inverse);
+        }
+      });
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      cols, static_cast<std::uint64_t>(FftFlops(points)),
+      static_cast<std::size_t>(rows) * sizeof(Complex),
+      [&](int begin, int end) {
+        std::vector<Complex> column(rows);
+        for (int j = begin; j < end; ++j) {
+          for (int i = 0; i < rows; ++i) {
+            column[i] = grid[static_cast<std::size_t>(i) * cols + j];
+          }
+          column_plan.Run(column.data(), inverse);
+          for (int i = 0; i < rows; ++i) {
+            grid[static_cast<std::size_t>(i) * cols + j] = column[i];
+          }
+        }
+      });
+}
+
+// Ядро в порядке свёртки: для корреляции отражается по обеим осям
+double KernelAt(const S21Matrix& kernel, int a, int b, bool correlate) {
+  return correlate
+             ? kernel(kernel.GetRows() - 1 - a, kernel.GetCols() - 1 - b)
+             : kernel(a, b);
+}
+
+// full(p, q) = sum image(p - a, q - b) * k(a, b) для окон out(i, j) =
+// full(i + top, j + left)
+S21Matrix ConvolveIm2col(const S21Matrix& image, const S21Matrix& kernel,
+                         bool correlate, int out_rows, int out_cols, int top,
+                         int left) {
+  const int height = image.GetRows(), width = image.GetCols();
+  const int kernel_rows = kernel.GetRows(), kernel_cols = kernel.GetCols();
+  const int taps = kernel_rows * kernel_cols;
+  S21Matrix weights(taps, 1);
+  for (int a = 0; a < kernel_rows; ++a) {
+    for (int b = 0; b < kernel_cols; ++b) {
+      weights(a * kernel_cols + b, 0) = KernelAt(kernel, a, b, correlate);
+    }
+  }
+  S21Matrix result(out_rows, out_cols);
+  const double* const* pixels = image.GetConstMatrixPointer();
+  const std::size_t row_elements = static_cast<std::size_t>(out_cols) * taps;
+  const int band = static_cast<int>(std::max<std::size_t>(
+      1, std::min<std::size_t>(out_rows, kIm2colElements / row_elements)));
+  for (int first = 0; first < out_rows; first += band) {
+    const int rows = std::min(band, out_rows - first);
+    S21Matrix windows(rows * out_cols, taps);
+    double** window = windows.GetMatrixPointer();
+    for (int i = 0; i < rows; ++i) {
+      const int p = first + i + top;
+      for (int j = 0; j < out_cols; ++j) {
+        const int q = j + left;
+        double* row = window[i * out_cols + j];
+        for (int a = 0; a < kernel_rows; ++a) {
+          const int y = p - a;
+          for (int b = 0; b < kernel_cols; ++b) {
+            const int x = q - b;
+            row[a * kernel_cols + b] =
+                y >= 0 && y < height && x >= 0 && x < width ? pixels[y][x]
+                                                            : 0.0;
+          }
+        }
+      }
+    }
+    const S21Matrix values = windows * weights;
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < out_cols; ++j) {
+        result(first + i, j) = values(i * out_cols + j, 0);
+      }
+    }
+  }
+  return result;
+}
+
+S21Matrix ConvolveFft(const S21Matrix& image, const S21Matrix& kernel,
+                      bool correlate, int out_rows, int out_cols, int top,
+                      int left) {
+  const int height = image.GetRows(), width = image.GetCols();
+  const int kernel_rows = kernel.GetRows(), kernel_cols = kernel.GetCols();
+  const int rows = FftSize(height + kernel_rows - 1);
+  const int cols = FftSize(width + kernel_cols - 1);
+  // Ядро приводится к масштабу изображения степенью двойки, чтобы его
+  // ошибка округления в общем массиве не зависела от их соотношения
+  double image_max = 0.0, kernel_max = 0.0;
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      image_max = std::max(image_max, std::fabs(image(i, j)));
+    }
+  }
+  for (int a = 0; a < kernel_rows; ++a) {
+    for (int b = 0; b < kernel_cols; ++b) {
+      kernel_max = std::max(kernel_max, std::fabs(kernel(a, b)));
+    }
+  }
+  const int shift = std::isnormal(image_max) && std::isnormal(kernel_max)
+                        ? std::ilogb(image_max) - std::ilogb(kernel_max)
+                        : 0;
+
+  std::vector<Complex> packed(static_cast<std::size_t>(rows) * cols);
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      packed[static_cast<std::size_t>(i) * cols + j].real(image(i, j));
+    }
+  }
+  for (int a = 0; a < kernel_rows; ++a) {
+    for (int b = 0; b < kernel_cols; ++b) {
+      packed[static_cast<std::size_t>(a) * cols + b].imag(
+          std::ldexp(KernelAt(kernel, a, b, correlate), shift));
+    }
+  }
+  Fft2D(&packed, rows, cols, false);
+
+  // Z = X + iK; X(f) = (Z(f) + conj Z(-f)) / 2, K(f) = (Z(f) - conj Z(-f))
+  // / 2i, откуда X K = (Z(f)^2 - conj Z(-f)^2) / 4i
+  std::vector<Complex> product(packed.size());
+  for (int u = 0; u < rows; ++u) {
+    const int mirror_u = (rows - u) % rows;
+    for (int v = 0; v < cols; ++v) {
+      const int mirror_v = (cols - v) % cols;
+      const Complex z = packed[static_cast<std::size_t>(u) * cols + v];
+      const Complex mirror = std::conj(
+          packed[static_cast<std::size_t>(mirror_u) * cols + mirror_v]);
+      const Complex difference = Mul(z, z) - Mul(mirror, mirror);
+      product[static_cast<std::size_t>(u) * cols + v] =
+          Complex(difference.imag(), -difference.real()) * 0.25;
+    }
+  }
+  Fft2D(&product, rows, cols, true);
+
+  const double scale = std::ldexp(1.0 / (static_cast<double>(rows) * cols),
+                                  -shift);
+  S21Matrix result(out_rows, out_cols);
+  for (int i = 0; i < out_rows; ++i) {
+    for (int j = 0; j < out_cols; ++j) {
+      result(i, j) =
+          product[static_cast<std::size_t>(i + top) * cols + j + left].real() *
+          scale;
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+S21Toeplitz::S21Toeplitz(const std::vector<double>& column,
+                         const std::vector<double>& row)
+    : rows_(static_cast<int>(column.size())),
+      cols_(static_cast<int>(row.size())) {
+  if (column.empty() || row.empty()) {
+    throw std::invalid_argument("Образующие векторы не должны быть пустыми");
+  }
+  if (!(column[0] == row[0]) &&
+      !(std::isnan(column[0]) && std::isnan(row[0]))) {
+    throw std::invalid_argument(
+        "Первые элементы столбца и строки должны совпадать");
+  }
+  diagonals_.resize(rows_ + cols_ - 1);
+  for (int k = 1; k < cols_; ++k) diagonals_[cols_ - 1 - k] = row[k];
+  std::copy(column.begin(), column.end(), diagonals_.begin() + cols_ - 1);
+
+  fft_size_ = FftSize(rows_ + cols_ - 1);
+  spectrum_.assign(diagonals_.begin(), diagonals_.end());
+  spectrum_.resize(fft_size_);
+  FftPlan(fft_size_).Run(spectrum_.data(), false);
+}
+
+S21Toeplitz S21Toeplitz::Convolution(const std::vector<double>& kernel,
+                                     int signal_length) {
+  if (kernel.empty() || signal_length <= 0) {
+    throw std::invalid_argument(
+        "Ядро и длина сигнала должны быть положительными");
+  }
+  std::vector<double> column(kernel.size() + signal_length - 1, 0.0);
+  std::copy(kernel.begin(), kernel.end(), column.begin());
+  std::vector<double> row(signal_length, 0.0);
+  row[0] = kernel[0];
+  return S21Toeplitz(column, row);
+}
+
+int S21Toeplitz::GetRows() const { return rows_; }
+
+int S21Toeplitz::GetCols() const { return cols_; }
+
+double S21Toeplitz::At(int row, int col) const {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::out_of_range("Индекс за пределами матрицы");
+  }
+  return diagonals_[row - col + cols_ - 1];
+}
+
+S21Matrix S21Toeplitz::Dense() const {
+  S21Matrix dense(rows_, cols_);
+  for (int i = 0; i < rows_; ++i) {
+    for (int j = 0; j < cols_; ++j) {
+      dense(i, j) = diagonals_[i - j + cols_ - 1];
+    }
+  }
+  return dense;
+}
+
+S21Matrix S21Toeplitz::Multiply(const S21Matrix& b) const {
+  if (b.GetRows() != cols_) {
+    throw std::invalid_argument(
+        "Число строк правого множителя должно совпадать с числом столбцов");
+  }
+  const int width = b.GetCols();
+  S21Matrix result(rows_, width);
+  const double* const* rhs = b.GetConstMatrixPointer();
+  double** out = result.GetMatrixPointer();
+  const double* t = diagonals_.data() + cols_ - 1;
+
+  const double direct_flops = 2.0 * rows_ * cols_;
+  const double fft_flops = 2.0 * FftFlops(fft_size_) + 6.0 * fft_size_;
+  if (direct_flops * 2 <= fft_flops) {
+    // y(i, :) = sum_j t[i - j] b(j, :); строки b читаются подряд
+    S21ThreadPool::Instance().ParallelRowsIfWorth(
+        rows_, static_cast<std::uint64_t>(direct_flops * width),
+        static_cast<std::size_t>(cols_ + width) * sizeof(double),
+        [&](int begin, int end) {
+          for (int i = begin; i < end; ++i) {
+            for (int j = 0; j < cols_; ++j) {
+              const double factor = t[i - j];
+              for (int c = 0; c < width; ++c) {
+                out[i][c] += factor * rhs[j][c];
+              }
+            }
+          }
+        });
+    return result;
+  }
+
+  // Пара столбцов b в одном комплексном векторе: спектр образующих
+  // вещественный во времени, поэтому свёртка не смешивает части
+  const FftPlan plan(fft_size_);
+  const int pairs = (width + 1) / 2;
+  const double inverse_size = 1.0 / fft_size_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      pairs, static_cast<std::uint64_t>(fft_flops * pairs),
+      static_cast<std::size_t>(fft_size_) * sizeof(Complex),
+      [&](int begin, int end) {
+        std::vector<Complex> buffer(fft_size_);
+        for (int pair = begin; pair < end; ++pair) {
+          const int c = 2 * pair;
+          const bool twin = c + 1 < width;
+          std::fill(buffer.begin(), buffer.end(), Complex());
+          for (int j = 0; j < cols_; ++j) {
+            buffer[j] = Complex(rhs[j][c], twin ? rhs[j][c + 1] : 0);
+          }
+          plan.Run(buffer.data(), false);
+          for (int f = 0; f < fft_size_; ++f) {
+            buffer[f] = Mul(buffer[f], spectrum_[f]);
+          }
+          plan.Run(buffer.data(), true);
+          // Свёртка сдвинута на cols - 1 относительно строк T
+          for (int i = 0; i < rows_; ++i) {
+            const Complex value = buffer[i + cols_ - 1];
+            out[i][c] = value.real() * inverse_size;
+            if (twin) out[i][c + 1] = value.imag() * inverse_size;
+          }
+        }
+      });
+  return result;
+}
+
+// =================================================================================================================================================================>
+
+namespace {
+
+// Вторая образующая циркулянта: row[k] = column[(n - k) mod n]
+std::vector<double> CirculantRow(const std::vector<double>& column) {
+  if (column.empty()) {
+    throw std::invalid_argument("Образующие векторы не должны быть пустыми");
+  }
+  const std::size_t n = column.size();
+  std::vector<double> row(n);
+  for (std::size_t k = 0; k < n; ++k) row[k] = column[(n - k) % n];
+  return row;
+}
+
+}  // namespace
+
+S21Circulant::S21Circulant(const std::vector<double>& column)
+    : column_(column), toeplitz_(column, CirculantRow(column)) {}
+
+int S21Circulant::GetSize() const { return static_cast<int>(column_.size()); }
+
+double S21Circulant::At(int row, int col) const {
+  return toeplitz_.At(row, col);
+}
+
+S21Matrix S21Circulant::Dense() const { return toeplitz_.Dense(); }
+
+S21Matrix S21Circulant::Multiply(const S21Matrix& b) const {
+  return toeplitz_.Multiply(b);
+}
+
+// =================================================================================================================================================================>
+
+S21Matrix S21Convolve2D(const S21Matrix& image, const S21Matrix& kernel,
+                        const S21ConvolutionOptions& options) {
+  const int height = image.GetRows(), width = image.GetCols();
+  const int kernel_rows = kernel.GetRows(), kernel_cols = kernel.GetCols();
+  if (height == 0 || width == 0 || kernel_rows == 0 || kernel_cols == 0) {
+    throw std::invalid_argument("Изображение и ядро не должны быть пустыми");
+  }
+  int out_rows = height + kernel_rows - 1, out_cols = width + kernel_cols - 1;
+  int top = 0, left = 0;
+  if (options.mode == S21ConvolutionMode::kSame) {
+    out_rows = height;
+    out_cols = width;
+    top = (kernel_rows - 1) / 2;
+    left = (kernel_cols - 1) / 2;
+  } else if (options.mode == S21ConvolutionMode::kValid) {
+    if (kernel_rows > height || kernel_cols > width) {
+      throw std::invalid_argument(
+          "Для kValid ядро не должно быть больше изображения");
+    }
+    out_rows = height - kernel_rows + 1;
+    out_cols = width - kernel_cols + 1;
+    top = kernel_rows - 1;
+    left = kernel_cols - 1;
+  }
+
+  S21ConvolutionMethod method = options.method;
+  if (method == S21ConvolutionMethod::kAuto) {
+    const double direct = 2.0 * out_rows * out_cols * kernel_rows * kernel_cols;
+    const double points =
+        static_cast<double>(FftSize(height + kernel_rows - 1)) *
+        FftSize(width + kernel_cols - 1);
+    const double fft = 2.0 * FftFlops(points) + 12.0 * points;
+    method = fft < direct ? S21ConvolutionMethod::kFft
+                          : S21ConvolutionMethod::kIm2col;
+  }
+  return method == S21ConvolutionMethod::kFft
+             ? ConvolveFft(image, kernel, options.correlate, out_rows,
+                           out_cols, top, left)
+             : ConvolveIm2col(image, kernel, options.correlate, out_rows,
+                              out_cols, top, left);
+}
@@ -0,0 +1,113 @@
+#ifndef S21_MATRIX_CONV
+#define S21_MATRIX_CONV
+
+// Небходимые зависимые директивы
+#include <complex>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+/**
+ * @brief Тёплицева матрица rows x cols, заданная первым столбцом и первой
+ * строкой: T(i, j) = column[i - j] при i >= j и row[j - i] при j > i.
+ *
+ * Хранятся только rows + cols - 1 образующих и их спектр. Произведение
+ * T * B — линейная свёртка образующих с каждым столбцом B, поэтому
+ * Multiply() для больших размеров идёт через БПФ за O((rows + cols) log)
+ * на столбец вместо O(rows * cols). Вещественные столбцы B
+ * преобразуются парами: один столбец — действительная часть, другой —
+ * мнимая, так что на два столбца приходится одно комплексное БПФ в каждую
+ * сторону. Пары столбцов распределяются по S21ThreadPool. Для малых
+ * размеров, где БПФ не окупается, произведение считается напрямую.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21Toeplitz {
+ public:
+  // std::invalid_argument для пустых векторов и column[0] != row[0]
+  S21Toeplitz(const std::vector<double>& column,
+              const std::vector<double>& row);
+
+  // Матрица (signal_length + k - 1) x signal_length, умножение на которую
+  // даёт полную линейную свёртку сигнала с ядром длины k
+  static S21Toeplitz Convolution(const std::vector<double>& kernel,
+                                 int signal_length);
+
+  int GetRows() const;
+  int GetCols() const;
+  double At(int row, int col) const;  // std::out_of_range вне матрицы
+  S21Matrix Dense() const;
+
+  // this * b; std::invalid_argument, если число строк b не равно GetCols()
+  S21Matrix Multiply(const S21Matrix& b) const;
+
+ private:
+  int rows_, cols_;
+  // t_k для k = -(cols - 1) .. rows - 1 со сдвигом cols - 1
+  std::vector<double> diagonals_;
+  int fft_size_;  // Степень двойки не меньше rows + cols - 1
+  std::vector<std::complex<double>> spectrum_;  // БПФ diagonals_
+};
+
+/**
+ * @brief Циркулянт n x n: C(i, j) = column[(i - j) mod n].
+ *
+ * Частный случай тёплицевой матрицы, каждая строка которой — циклический
+ * сдвиг предыдущей. Хранится только первый столбец; умножение — через ту же
+ * свёртку, что и у S21Toeplitz.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21Circulant {
+ public:
+  // std::invalid_argument для пустого столбца
+  explicit S21Circulant(const std::vector<double>& column);
+
+  int GetSize() const;
+  double At(int row, int col) const;  // std::out_of_range вне матрицы
+  S21Matrix Dense() const;
+  S21Matrix Multiply(const S21Matrix& b) const;  // Как S21Toeplitz
+
+ private:
+  std::vector<double> column_;
+  S21Toeplitz toeplitz_;
+};
+
+// Размер результата Convolve2D, как в scipy.signal.convolve2d
+enum class S21ConvolutionMode {
+  kFull,   // (h + kh - 1) x (w + kw - 1)
+  kSame,   // h x w, по центру полной свёртки
+  kValid   // (h - kh + 1) x (w - kw + 1), без выхода ядра за края
+};
+
+enum class S21ConvolutionMethod {
+  kAuto,    // По оценке числа операций
+  kIm2col,  // Развёртка окон в матрицу и умножение на ядро
+  kFft      // Двумерное БПФ с дополнением нулями
+};
+
+struct S21ConvolutionOptions {
+  S21ConvolutionMode mode = S21ConvolutionMode::kFull;
+  S21ConvolutionMethod method = S21ConvolutionMethod::kAuto;
+  bool correlate = false;  // Взаимная корреляция: ядро не отражается
+};
+
+/**
+ * @brief Двумерная свёртка (или корреляция) image с kernel.
+ *
+ * kIm2col развёртывает окна полосы выходных строк в матрицу
+ * (окна x элементы ядра) и умножает её на ядро тем же блочным
+ * многопоточным умножением, что и operator*; полосы ограничены по памяти,
+ * так что развёртка не превышает нескольких мегабайт. kFft упаковывает
+ * изображение и ядро в действительную и мнимую части одного комплексного
+ * массива, поэтому на всю свёртку уходят одно прямое и одно обратное
+ * двумерное БПФ. kAuto выбирает способ с меньшей оценкой числа операций:
+ * малые ядра идут через развёртку, большие — через БПФ.
+ *
+ * @throws std::invalid_argument Для пустых матриц и для kValid, если ядро
+ * больше изображения.
+ */
+S21Matrix S21Convolve2D(const S21Matrix& image, const S21Matrix& kernel,
+                        const S21ConvolutionOptions& options = {});
+
+#endif  // S21_MATRIX_CONV
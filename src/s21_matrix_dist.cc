@@ -0,0 +1,665 @@
+#include "s21_matrix_dist.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#ifdef S21_MATRIX_MPI
+#include <mpi.h>
+#endif
+
+namespace {
+
+// Теги сообщений распределённых операций
+const int kTagScatter = 1;
+const int kTagGather = 2;
+const int kTagPanelA = 3;
+const int kTagPanelB = 4;
+const int kTagReduce = 5;
+const int kTagReduceResult = 6;
+const int kTagPivotRow = 7;
+const int kTagMultipliers = 8;
+
+void WriteAll(int fd, const void* data, std::size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(),
+                              "Ошибка отправки сообщения");
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+}
+
+bool ReadAll(int fd, void* data, std::size_t size) {
+  char* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t got = ::read(fd, bytes, size);
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) return false;
+    bytes += got;
+    size -= static_cast<std::size_t>(got);
+  }
+  return true;
+}
+
+// Число строк (столбцов) блочно-циклического распределения у процесса
+// iproc из nprocs, как NUMROC в ScaLAPACK
+int LocalCount(int n, int block, int iproc, int nprocs) {
+  int blocks = n / block;
+  int count = (blocks / nprocs) * block;
+  int extra = blocks % nprocs;
+  if (iproc < extra) {
+    count += block;
+  } else if (iproc == extra) {
+    count += n % block;
+  }
+  return count;
+}
+
+int GlobalIndex(int local, int block, int iproc, int nprocs) {
+  return ((local / block) * nprocs + iproc) * block + local % block;
+}
+
+// Рассылка данных от root остальным процессам группы
+void Broadcast(S21Transport& transport, const std::vector<int>& group,
+               int root, int tag, std::vector<double>* data) {
+  if (transport.Rank() == root) {
+    for (int rank : group) {
+      if (rank != root) transport.Send(rank, tag, *data);
+    }
+  } else {
+    *data = transport.Recv(root, tag);
+  }
+}
+
+// Поэлементная сумма векторов всех процессов, результат получают все
+std::vector<double> AllReduceSum(S21Transport& transport,
+                                 std::vector<double> data) {
+  if (transport.Rank() != 0) {
+    transport.Send(0, kTagReduce, data);
+    return transport.Recv(0, kTagReduceResult);
+  }
+  for (int rank = 1; rank < transport.Size(); ++rank) {
+    std::vector<double> part = transport.Recv(rank, kTagReduce);
+    for (std::size_t k = 0; k < data.size() && k < part.size(); ++k) {
+      data[k] += part[k];
+    }
+  }
+  for (int rank = 1; rank < transport.Size(); ++rank) {
+    transport.Send(rank, kTagReduceResult, data);
+  }
+  return data;
+}
+
+// Максимум по значению с наименьшим индексом среди равных; пара кодируется
+// как {значение, индекс}
+std::vector<double> AllReduceMaxLoc(S21Transport& transport,
+                                    std::vector<double> best) {
+  if (transport.Rank() != 0) {
+    transport.Send(0, kTagReduce, best);
+    return transport.Recv(0, kTagReduceResult);
+  }
+  for (int rank = 1; rank < transport.Size(); ++rank) {
+    std::vector<double> part = transport.Recv(rank, kTagReduce);
+    if (part[0] > best[0] || (part[0] == best[0] && part[1] < best[1])) {
+      best = part;
+    }
+  }
+  for (int rank = 1; rank < transport.Size(); ++rank) {
+    transport.Send(rank, kTagReduceResult, best);
+  }
+  return best;
+}
+
+}  // namespace
+
+// ============================== Транспорт ==================================
+
+int S21SocketTransport::Launch(
+    int size, const std::function<void(S21Transport&)>& body) {
+  if (size < 1) {
+    throw std::invalid_argument("Число процессов должно быть положительным");
+  }
+  std::vector<std::vector<int>> fds(size, std::vector<int>(size, -1));
+  auto close_foreign = [&fds, size](int keep) {
+    for (int i = 0; i < size; ++i) {
+      if (i == keep) continue;
+      for (int fd : fds[i]) {
+        if (fd != -1) ::close(fd);
+      }
+    }
+  };
+  std::vector<pid_t> children;
+  // Ошибка запуска: закрывает все сокеты и завершает уже порождённые ранги,
+  // которые иначе навсегда остались бы в Recv
+  auto abandon = [&close_foreign, &children](int error, const char* what) {
+    close_foreign(-1);
+    for (pid_t pid : children) ::kill(pid, SIGTERM);
+    for (pid_t pid : children) {
+      while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+      }
+    }
+    throw std::system_error(error, std::generic_category(), what);
+  };
+
+  for (int i = 0; i < size; ++i) {
+    for (int j = i + 1; j < size; ++j) {
+      int pair[2];
+      if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        abandon(errno, "Не удалось создать socketpair");
+      }
+      fds[i][j] = pair[0];
+      fds[j][i] = pair[1];
+    }
+  }
+
+  for (int rank = 1; rank < size; ++rank) {
+    pid_t pid = ::fork();
+    if (pid < 0) abandon(errno, "Не удалось породить процесс");
+    if (pid == 0) {
+      close_foreign(rank);
+      int code = 0;
+      try {
+        S21SocketTransport transport(rank, fds[rank]);
+        body(transport);
+      } catch (...) {
+        code = 1;
+      }
+      ::_exit(code);
+    }
+    children.push_back(pid);
+  }
+  close_foreign(0);
+
+  std::exception_ptr error;
+  try {
+    S21SocketTransport transport(0, fds[0]);
+    body(transport);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  int failed = 0;
+  for (pid_t pid : children) {
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ++failed;
+  }
+  if (error) std::rethrow_exception(error);
+  return failed;
+}
+
+S21SocketTransport::S21SocketTransport(int rank, std::vector<int> peers)
+    : rank_(rank),
+      peers_(std::move(peers)),
+      inbox_(peers_.size()),
+      closed_(peers_.size(), false) {
+  if (::pipe(wakeup_) != 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Не удалось создать канал");
+  }
+  receiver_ = std::thread(&S21SocketTransport::ReceiveLoop, this);
+}
+
+S21SocketTransport::~S21SocketTransport() {
+  char stop = 0;
+  while (::write(wakeup_[1], &stop, 1) < 0 && errno == EINTR) {
+  }
+  receiver_.join();
+  ::close(wakeup_[0]);
+  ::close(wakeup_[1]);
+  for (int fd : peers_) {
+    if (fd != -1) ::close(fd);
+  }
+}
+
+int S21SocketTransport::Rank() const { return rank_; }
+
+int S21SocketTransport::Size() const {
+  return static_cast<int>(peers_.size());
+}
+
+void S21SocketTransport::Send(int dest, int tag,
+                              const std::vector<double>& data) {
+  if (dest < 0 || dest >= Size()) {
+    throw std::out_of_range("Ранг получателя вне диапазона");
+  }
+  if (dest == rank_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inbox_[dest][tag].push_back(data);
+    arrived_.notify_all();
+    return;
+  }
+  std::int64_t header[2] = {tag, static_cast<std::int64_t>(data.size())};
+  WriteAll(peers_[dest], header, sizeof(header));
+  WriteAll(peers_[dest], data.data(), data.size() * sizeof(double));
+}
+
+std::vector<double> S21SocketTransport::Recv(int source, int tag) {
+  if (source < 0 || source >= Size()) {
+    throw std::out_of_range("Ранг отправителя вне диапазона");
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto& queues = inbox_[source];
+  arrived_.wait(lock, [&] {
+    auto found = queues.find(tag);
+    return (found != queues.end() && !found->second.empty()) ||
+           closed_[source];
+  });
+  auto found = queues.find(tag);
+  if (found == queues.end() || found->second.empty()) {
+    throw std::runtime_error("Соединение с процессом разорвано");
+  }
+  std::vector<double> data = std::move(found->second.front());
+  found->second.pop_front();
+  return data;
+}
+
+void S21SocketTransport::ReceiveLoop() {
+  for (;;) {
+    std::vector<pollfd> watched;
+    std::vector<int> ranks;
+    watched.push_back(pollfd{wakeup_[0], POLLIN, 0});
+    ranks.push_back(-1);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int rank = 0; rank < Size(); ++rank) {
+        if (peers_[rank] != -1 && !closed_[rank]) {
+          watched.push_back(pollfd{peers_[rank], POLLIN, 0});
+          ranks.push_back(rank);
+        }
+      }
+    }
+    if (::poll(watched.data(), watched.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (watched[0].revents != 0) break;
+
+    for (std::size_t k = 1; k < watched.size(); ++k) {
+      if (watched[k].revents == 0) continue;
+      int rank = ranks[k];
+      std::int64_t header[2];
+      std::vector<double> data;
+      bool ok = ReadAll(peers_[rank], header, sizeof(header)) &&
+                header[1] >= 0;
+      if (ok) {
+        data.resize(static_cast<std::size_t>(header[1]));
+        ok = ReadAll(peers_[rank], data.data(), data.size() * sizeof(double));
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (ok) {
+        inbox_[rank][static_cast<int>(header[0])].push_back(std::move(data));
+      } else {
+        closed_[rank] = true;
+      }
+      arrived_.notify_all();
+    }
+  }
+  // После остановки ожидающие Recv() не должны висеть бесконечно
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::fill(closed_.begin(), closed_.end(), true);
+  arrived_.notify_all();
+}
+
+#ifdef S21_MATRIX_MPI
+S21MpiTransport::S21MpiTransport() {
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+  MPI_Comm_size(MPI_COMM_WORLD, &size_);
+}
+
+int S21MpiTransport::Rank() const { return rank_; }
+
+int S21MpiTransport::Size() const { return size_; }
+
+void S21MpiTransport::Send(int dest, int tag,
+                           const std::vector<double>& data) {
+  MPI_Send(data.data(), static_cast<int>(data.size()), MPI_DOUBLE, dest, tag,
+           MPI_COMM_WORLD);
+}
+
+std::vector<double> S21MpiTransport::Recv(int source, int tag) {
+  MPI_Status status;
+  MPI_Probe(source, tag, MPI_COMM_WORLD, &status);
+  int count = 0;
+  MPI_Get_count(&status, MPI_DOUBLE, &count);
+  std::vector<double> data(count);
+  MPI_Recv(data.data(), count, MPI_DOUBLE, source, tag, MPI_COMM_WORLD,
+           MPI_STATUS_IGNORE);
+  return data;
+}
+#endif  // S21_MATRIX_MPI
+
+// ======================== Распределённая матрица ===========================
+
+S21DistMatrix::S21DistMatrix(S21Transport& transport, int rows, int cols,
+                             int block, int grid_rows, int grid_cols)
+    : transport_(&transport),
+      rows_(rows),
+      cols_(cols),
+      block_(block),
+      grid_rows_(grid_rows),
+      grid_cols_(grid_cols) {
+  if (rows < 0 || cols < 0 || block < 1) {
+    throw std::invalid_argument("Недопустимые размеры распределённой матрицы");
+  }
+  if (grid_rows < 1 || grid_cols < 1 ||
+      grid_rows * grid_cols != transport.Size()) {
+    throw std::invalid_argument(
+        "Размер сетки процессов не совпадает с числом процессов");
+  }
+  my_row_ = transport.Rank() / grid_cols_;
+  my_col_ = transport.Rank() % grid_cols_;
+  local_ = S21Matrix(LocalCount(rows_, block_, my_row_, grid_rows_),
+                     LocalCount(cols_, block_, my_col_, grid_cols_));
+}
+
+void S21DistMatrix::Scatter(const S21Matrix& global, int root) {
+  S21Transport& transport = *transport_;
+  if (transport.Rank() == root) {
+    if (global.GetRows() != rows_ || global.GetCols() != cols_) {
+      throw std::invalid_argument("Размеры матриц не совпадают");
+    }
+    for (int rank = 0; rank < transport.Size(); ++rank) {
+      int grid_row = rank / grid_cols_;
+      int grid_col = rank % grid_cols_;
+      int local_rows = LocalCount(rows_, block_, grid_row, grid_rows_);
+      int local_cols = LocalCount(cols_, block_, grid_col, grid_cols_);
+      std::vector<double> packed;
+      packed.reserve(static_cast<std::size_t>(local_rows) * local_cols);
+      for (int li = 0; li < local_rows; ++li) {
+        int i = GlobalIndex(li, block_, grid_row, grid_rows_);
+        for (int lj = 0; lj < local_cols; ++lj) {
+          packed.push_back(
+              global(i, GlobalIndex(lj, block_, grid_col, grid_cols_)));
+        }
+      }
+      if (rank == root) {
+        for (int li = 0; li < local_rows; ++li) {
+          for (int lj = 0; lj < local_cols; ++lj) {
+            local_(li, lj) = packed[li * local_cols + lj];
+          }
+        }
+      } else {
+        transport.Send(rank, kTagScatter, packed);
+      }
+    }
+    return;
+  }
+  std::vector<double> packed = transport.Recv(root, kTagScatter);
+  const int local_cols = local_.GetCols();
+  for (int li = 0; li < local_.GetRows(); ++li) {
+    for (int lj = 0; lj < local_cols; ++lj) {
+      local_(li, lj) = packed[li * local_cols + lj];
+    }
+  }
+}
+
+S21Matrix S21DistMatrix::Gather(int root) const {
+  S21Transport& transport = *transport_;
+  if (transport.Rank() != root) {
+    std::vector<double> packed;
+    packed.reserve(static_cast<std::size_t>(local_.GetRows()) *
+                   local_.GetCols());
+    for (int li = 0; li < local_.GetRows(); ++li) {
+      for (int lj = 0; lj < local_.GetCols(); ++lj) {
+        packed.push_back(local_(li, lj));
+      }
+    }
+    transport.Send(root, kTagGather, packed);
+    return S21Matrix();
+  }
+  S21Matrix global(rows_, cols_);
+  for (int rank = 0; rank < transport.Size(); ++rank) {
+    int grid_row = rank / grid_cols_;
+    int grid_col = rank % grid_cols_;
+    int local_rows = LocalCount(rows_, block_, grid_row, grid_rows_);
+    int local_cols = LocalCount(cols_, block_, grid_col, grid_cols_);
+    std::vector<double> packed;
+    if (rank == root) {
+      for (int li = 0; li < local_rows; ++li) {
+        for (int lj = 0; lj < local_cols; ++lj) {
+          packed.push_back(local_(li, lj));
+        }
+      }
+    } else {
+      packed = transport.Recv(rank, kTagGather);
+    }
+    for (int li = 0; li < local_rows; ++li) {
+      int i = GlobalIndex(li, block_, grid_row, grid_rows_);
+      for (int lj = 0; lj < local_cols; ++lj) {
+        global(i, GlobalIndex(lj, block_, grid_col, grid_cols_)) =
+            packed[li * local_cols + lj];
+      }
+    }
+  }
+  return global;
+}
+
+S21DistMatrix S21DistMatrix::Multiply(const S21DistMatrix& other) const {
+  if (cols_ != other.rows_) {
+    throw std::invalid_argument(
+        "Количество столбцов первой матрицы должно быть равно количеству "
+        "строк второй");
+  }
+  if (block_ != other.block_ || grid_rows_ != other.grid_rows_ ||
+      grid_cols_ != other.grid_cols_ || transport_ != other.transport_) {
+    throw std::invalid_argument("Распределения матриц несовместимы");
+  }
+  S21Transport& transport = *transport_;
+  S21DistMatrix result(transport, rows_, other.cols_, block_, grid_rows_,
+                       grid_cols_);
+  std::vector<int> row_group, col_group;
+  for (int c = 0; c < grid_cols_; ++c) row_group.push_back(RankOf(my_row_, c));
+  for (int r = 0; r < grid_rows_; ++r) col_group.push_back(RankOf(r, my_col_));
+
+  const int local_rows = local_.GetRows();
+  const int local_cols = other.local_.GetCols();
+  for (int k = 0; k < cols_; k += block_) {
+    const int width = std::min(block_, cols_ - k);
+
+    // Панель A(:, k) от владельца блочной колонки в строке сетки
+    std::vector<double> panel_a;
+    int owner_col = OwnerCol(k);
+    if (my_col_ == owner_col) {
+      int lk = LocalCol(k);
+      for (int li = 0; li < local_rows; ++li) {
+        for (int t = 0; t < width; ++t) panel_a.push_back(local_(li, lk + t));
+      }
+    }
+    Broadcast(transport, row_group, RankOf(my_row_, owner_col), kTagPanelA,
+              &panel_a);
+
+    // Панель B(k, :) от владельца блочной строки в столбце сетки
+    std::vector<double> panel_b;
+    int owner_row = other.OwnerRow(k);
+    if (my_row_ == owner_row) {
+      int lk = other.LocalRow(k);
+      for (int t = 0; t < width; ++t) {
+        for (int lj = 0; lj < local_cols; ++lj) {
+          panel_b.push_back(other.local_(lk + t, lj));
+        }
+      }
+    }
+    Broadcast(transport, col_group, RankOf(owner_row, my_col_), kTagPanelB,
+              &panel_b);
+
+    // Локальное обновление обычным умножением S21Matrix
+    S21Matrix a(local_rows, width);
+    S21Matrix b(width, local_cols);
+    for (int li = 0; li < local_rows; ++li) {
+      for (int t = 0; t < width; ++t) a(li, t) = panel_a[li * width + t];
+    }
+    for (int t = 0; t < width; ++t) {
+      for (int lj = 0; lj < local_cols; ++lj) {
+        b(t, lj) = panel_b[t * local_cols + lj];
+      }
+    }
+    a.MulMatrix(b);
+    result.local_.SumMatrix(a);
+  }
+  return result;
+}
+
+S21Matrix S21DistMatrix::Solve(const S21Matrix& b) const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  if (b.GetRows() != rows_) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  S21Transport& transport = *transport_;
+  const int n = rows_;
+  const int local_rows = local_.GetRows();
+  const int local_cols = local_.GetCols();
+  std::vector<int> row_group, col_group;
+  for (int c = 0; c < grid_cols_; ++c) row_group.push_back(RankOf(my_row_, c));
+  for (int r = 0; r < grid_rows_; ++r) col_group.push_back(RankOf(r, my_col_));
+
+  // Разложение без физической перестановки строк: perm[k] — глобальный
+  // номер строки, ставшей k-й ведущей
+  S21Matrix lu(local_);
+  std::vector<bool> pivoted(n, false);
+  std::vector<int> perm(n);
+  for (int k = 0; k < n; ++k) {
+    const int owner_col = OwnerCol(k);
+    std::vector<double> best = {-1.0, static_cast<double>(n)};
+    if (my_col_ == owner_col) {
+      int lk = LocalCol(k);
+      for (int li = 0; li < local_rows; ++li) {
+        int i = GlobalRow(li);
+        double value = std::fabs(lu(li, lk));
+        if (!pivoted[i] && (value > best[0] || (value == best[0] &&
+                                                 i < best[1]))) {
+          best = {value, static_cast<double>(i)};
+        }
+      }
+    }
+    best = AllReduceMaxLoc(transport, best);
+    if (!(best[0] > 0)) {
+      throw std::invalid_argument("Матрица вырождена");
+    }
+    const int p = static_cast<int>(best[1]);
+    const int owner_row = OwnerRow(p);
+
+    // Ведущая строка рассылается вдоль столбцов сетки
+    std::vector<double> pivot_row;
+    if (my_row_ == owner_row) {
+      int lp = LocalRow(p);
+      for (int lj = 0; lj < local_cols; ++lj) pivot_row.push_back(lu(lp, lj));
+    }
+    Broadcast(transport, col_group, RankOf(owner_row, my_col_), kTagPivotRow,
+              &pivot_row);
+
+    // Множители рассылаются вдоль строк сетки
+    std::vector<double> multipliers;
+    if (my_col_ == owner_col) {
+      int lk = LocalCol(k);
+      double pivot = pivot_row[lk];
+      multipliers.assign(local_rows, 0.0);
+      for (int li = 0; li < local_rows; ++li) {
+        int i = GlobalRow(li);
+        if (pivoted[i] || i == p) continue;
+        lu(li, lk) /= pivot;
+        multipliers[li] = lu(li, lk);
+      }
+    }
+    Broadcast(transport, row_group, RankOf(my_row_, owner_col),
+              kTagMultipliers, &multipliers);
+
+    for (int li = 0; li < local_rows; ++li) {
+      int i = GlobalRow(li);
+      double factor = multipliers[li];
+      if (pivoted[i] || i == p || factor == 0) continue;
+      for (int lj = 0; lj < local_cols; ++lj) {
+        if (GlobalCol(lj) > k) lu(li, lj) -= factor * pivot_row[lj];
+      }
+    }
+    pivoted[p] = true;
+    perm[k] = p;
+  }
+
+  // Прямой и обратный ход: частичные суммы по локальным столбцам строки
+  // perm[k] складываются общей редукцией
+  const int m = b.GetCols();
+  S21Matrix y(n, m);
+  for (int k = 0; k < n; ++k) {
+    const int i = perm[k];
+    std::vector<double> partial(m, 0.0);
+    if (my_row_ == OwnerRow(i)) {
+      int li = LocalRow(i);
+      for (int lj = 0; lj < local_cols; ++lj) {
+        int t = GlobalCol(lj);
+        if (t >= k) continue;
+        for (int c = 0; c < m; ++c) partial[c] += lu(li, lj) * y(t, c);
+      }
+    }
+    partial = AllReduceSum(transport, partial);
+    for (int c = 0; c < m; ++c) y(k, c) = b(i, c) - partial[c];
+  }
+
+  S21Matrix x(n, m);
+  for (int k = n - 1; k >= 0; --k) {
+    const int i = perm[k];
+    std::vector<double> partial(m + 1, 0.0);  // Последний элемент — U(k, k)
+    if (my_row_ == OwnerRow(i)) {
+      int li = LocalRow(i);
+      for (int lj = 0; lj < local_cols; ++lj) {
+        int t = GlobalCol(lj);
+        if (t == k) partial[m] = lu(li, lj);
+        if (t <= k) continue;
+        for (int c = 0; c < m; ++c) partial[c] += lu(li, lj) * x(t, c);
+      }
+    }
+    partial = AllReduceSum(transport, partial);
+    for (int c = 0; c < m; ++c) x(k, c) = (y(k, c) - partial[c]) / partial[m];
+  }
+  return x;
+}
+
+int S21DistMatrix::GetRows() const { return rows_; }
+
+int S21DistMatrix::GetCols() const { return cols_; }
+
+const S21Matrix& S21DistMatrix::Local() const { return local_; }
+
+int S21DistMatrix::OwnerRow(int i) const {
+  return (i / block_) % grid_rows_;
+}
+
+int S21DistMatrix::OwnerCol(int j) const {
+  return (j / block_) % grid_cols_;
+}
+
+int S21DistMatrix::LocalRow(int i) const {
+  return (i / block_ / grid_rows_) * block_ + i % block_;
+}
+
+int S21DistMatrix::LocalCol(int j) const {
+  return (j / block_ / grid_cols_) * block_ + j % block_;
+}
+
+int S21DistMatrix::GlobalRow(int li) const {
+  return GlobalIndex(li, block_, my_row_, grid_rows_);
+}
+
+int S21DistMatrix::GlobalCol(int lj) const {
+  return GlobalIndex(lj, block_, my_col_, grid_cols_);
+}
+
+int S21DistMatrix::RankOf(int grid_row, int grid_col) const {
+  return grid_row * grid_cols_ + grid_col;
+}
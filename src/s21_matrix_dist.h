@@ -0,0 +1,175 @@
+#ifndef S21_MATRIX_DIST
+#define S21_MATRIX_DIST
+
+// Небходимые зависимые директивы
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+/**
+ * @brief Транспорт сообщений между процессами распределённых вычислений.
+ *
+ * Сообщение — вектор double с целочисленным тегом. Сообщения от одного
+ * отправителя с одинаковым тегом доставляются в порядке отправки, а Recv()
+ * с другим тегом не теряет их, а откладывает.
+ */
+class S21Transport {
+ public:
+  virtual ~S21Transport() = default;
+
+  virtual int Rank() const = 0;
+  virtual int Size() const = 0;
+  virtual void Send(int dest, int tag, const std::vector<double>& data) = 0;
+  virtual std::vector<double> Recv(int source, int tag) = 0;
+};
+
+/**
+ * @brief Транспорт поверх Unix-сокетов для нескольких процессов одной машины.
+ *
+ * Launch() создаёт полную сеть socketpair между size процессами, порождает
+ * через fork() процессы с рангами 1..size-1 и выполняет body в каждом из них
+ * и в вызывающем процессе (ранг 0). Фоновый поток каждого процесса
+ * непрерывно вычитывает сокеты, поэтому отправка никогда не блокируется на
+ * заполненном буфере получателя.
+ *
+ * @note Дочерние процессы наследуют только вызвавший поток. Замки самой
+ * библиотеки (распределитель памяти, кэш результатов, профилировщик,
+ * глобальный S21ThreadPool) захватываются на время fork() через
+ * pthread_atfork, поэтому ни один из них не достаётся дочернему процессу
+ * захваченным другим потоком, а S21ThreadPool там выполняет задачи в
+ * вызывающем потоке. Замки вызывающего кода такой защиты не имеют: Launch
+ * нужно вызывать, пока другие потоки программы не держат замков, нужных
+ * body. exec не используется, так как body — произвольная функция.
+ *
+ * @return Число дочерних процессов, завершившихся ошибкой (body выбросил
+ * исключение или процесс был убит).
+ */
+class S21SocketTransport : public S21Transport {
+ public:
+  static int Launch(int size, const std::function<void(S21Transport&)>& body);
+
+  ~S21SocketTransport() override;
+
+  int Rank() const override;
+  int Size() const override;
+  void Send(int dest, int tag, const std::vector<double>& data) override;
+  std::vector<double> Recv(int source, int tag) override;
+
+ private:
+  S21SocketTransport(int rank, std::vector<int> peers);
+
+  void ReceiveLoop();
+
+  int rank_;
+  std::vector<int> peers_;  // Дескриптор сокета к каждому рангу, -1 для себя
+  int wakeup_[2];           // Канал для остановки фонового потока
+  std::mutex mutex_;
+  std::condition_variable arrived_;
+  std::vector<std::map<int, std::deque<std::vector<double>>>> inbox_;
+  std::vector<bool> closed_;  // Соединение с процессом разорвано
+  std::thread receiver_;
+};
+
+#ifdef S21_MATRIX_MPI
+/**
+ * @brief Транспорт поверх MPI_COMM_WORLD (сборка с -DS21_MATRIX_MPI).
+ *
+ * MPI должен быть инициализирован вызывающим кодом.
+ */
+class S21MpiTransport : public S21Transport {
+ public:
+  S21MpiTransport();
+
+  int Rank() const override;
+  int Size() const override;
+  void Send(int dest, int tag, const std::vector<double>& data) override;
+  std::vector<double> Recv(int source, int tag) override;
+
+ private:
+  int rank_, size_;
+};
+#endif  // S21_MATRIX_MPI
+
+/**
+ * @brief Матрица, распределённая блочно-циклически по сетке процессов.
+ *
+ * Блок (bi, bj) размером block x block принадлежит процессу в позиции
+ * (bi % grid_rows, bj % grid_cols) сетки, ранг процесса равен
+ * row * grid_cols + col. Локальные блоки хранятся одной плотной матрицей, как
+ * в ScaLAPACK.
+ *
+ * Все методы, кроме доступа к размерам и локальной части, являются
+ * коллективными: их должны вызвать все процессы транспорта.
+ */
+class S21DistMatrix {
+ public:
+  /**
+   * @throws std::invalid_argument Если размеры отрицательны, блок не
+   * положителен или сетка не совпадает с числом процессов транспорта.
+   */
+  S21DistMatrix(S21Transport& transport, int rows, int cols, int block,
+                int grid_rows, int grid_cols);
+
+  void Scatter(const S21Matrix& global, int root);  // Раздаёт матрицу root
+  S21Matrix Gather(int root) const;  // Собирает матрицу на root, на остальных
+                                     // процессах возвращает пустую
+
+  /**
+   * @brief Умножение по алгоритму SUMMA.
+   *
+   * Для каждой блочной колонки k панель A(:, k) рассылается вдоль строк
+   * сетки, а панель B(k, :) — вдоль столбцов, после чего каждый процесс
+   * обновляет свою часть произведения обычным S21Matrix::MulMatrix.
+   *
+   * @throws std::invalid_argument Если размеры или распределения
+   * несовместимы.
+   */
+  S21DistMatrix Multiply(const S21DistMatrix& other) const;
+
+  /**
+   * @brief Решает A * X = B через распределённое LU-разложение с частичным
+   * выбором ведущего элемента.
+   *
+   * Разложение хранится распределённо; ведущая строка выбирается общей
+   * редукцией, а её часть и столбец множителей рассылаются вдоль столбцов и
+   * строк сетки. Правая часть b должна быть одинаковой на всех процессах, и
+   * решение возвращается всем процессам.
+   *
+   * Стоимость: каждая редукция идёт звездой через ранг 0 (2(P - 1)
+   * сообщений и два последовательных шага на P процессах), а разложение,
+   * прямой и обратный ход выполняют по одной редукции на столбец. Число
+   * раундов обмена растёт линейно с n, и ранг 0 обрабатывает O(nP)
+   * сообщений, так что метод рассчитан на небольшие сетки процессов.
+   *
+   * @throws std::invalid_argument Если матрица не квадратная, размеры b не
+   * совпадают или матрица вырождена.
+   */
+  S21Matrix Solve(const S21Matrix& b) const;
+
+  int GetRows() const;
+  int GetCols() const;
+  const S21Matrix& Local() const;  // Локальная часть процесса
+
+ private:
+  int OwnerRow(int i) const;  // Строка сетки, владеющая глобальной строкой
+  int OwnerCol(int j) const;  // Столбец сетки, владеющий глобальным столбцом
+  int LocalRow(int i) const;  // Индекс глобальной строки в локальной части
+  int LocalCol(int j) const;
+  int GlobalRow(int li) const;
+  int GlobalCol(int lj) const;
+  int RankOf(int grid_row, int grid_col) const;
+
+  S21Transport* transport_;
+  int rows_, cols_, block_;
+  int grid_rows_, grid_cols_;
+  int my_row_, my_col_;
+  S21Matrix local_;
+};
+
+#endif  // S21_MATRIX_DIST
@@ -0,0 +1,601 @@
+#include "s21_matrix_factor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_thread_pool.h"
+
+namespace {
+
+// Ширина блока столбцов в разложении Холецкого: блок строк L шириной 64
+// занимает 512 байт и остаётся в кэше на всё обновление строки
+const int kCholeskyBlock = 64;
+
+// Ширина панели LDL^T: обновления от её столбцов откладываются и
+// применяются к остаточной подматрице одним проходом, как в LAPACK dlasyf
+const int kLdltBlock = 64;
+
+// Максимальное число шагов метода Хейгера, как в LAPACK dlacon
+const int kHagerIterations = 5;
+
+// Копия нижнего треугольника квадратной матрицы, построчно n x n
+std::vector<double> LowerDense(const S21Matrix& a) {
+  if (a.GetRows() != a.GetCols()) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = a.GetRows();
+  const double* const* rows = a.GetConstMatrixPointer();
+  std::vector<double> dense(static_cast<std::size_t>(n) * n);
+  for (int i = 0; i < n; ++i) {
+    std::copy(rows[i], rows[i] + i + 1,
+              dense.begin() + static_cast<std::size_t>(i) * n);
+  }
+  return dense;
+}
+
+// ||A||_1 симметричной матрицы по её нижнему треугольнику
+double SymmetricNorm1(const std::vector<double>& a, int n) {
+  std::vector<double> sums(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    const double* row = a.data() + static_cast<std::size_t>(i) * n;
+    for (int j = 0; j < i; ++j) {
+      sums[i] += std::fabs(row[j]);
+      sums[j] += std::fabs(row[j]);
+    }
+    sums[i] += std::fabs(row[i]);
+  }
+  double norm = 0.0;
+  for (double sum : sums) norm = std::max(norm, sum);
+  return norm;
+}
+
+// Симметричный обмен строк и столбцов r < p в нижнем треугольнике; в
+// столбцах левее r обмениваются строки уже найденного множителя L
+void SymmetricSwap(double* a, int n, int r, int p) {
+  double* row_r = a + static_cast<std::size_t>(r) * n;
+  double* row_p = a + static_cast<std::size_t>(p) * n;
+  std::swap_ranges(row_r, row_r + r, row_p);
+  std::swap(row_r[r], row_p[p]);
+  for (int i = r + 1; i < p; ++i) {
+    std::swap(a[static_cast<std::size_t>(i) * n + r], row_p[i]);
+  }
+  for (int i = p + 1; i < n; ++i) {
+    double* row_i = a + static_cast<std::size_t>(i) * n;
+    std::swap(row_i[r], row_i[p]);
+  }
+}
+
+// Собственные значения симметричного блока [[a, b], [b, c]]: меньшее по
+// модулю находится через определитель, а не вычитанием близких чисел
+void Eigen2x2(double a, double b, double c, double* big, double* small) {
+  const double mean = 0.5 * (a + c);
+  const double radius = std::hypot(0.5 * (a - c), b);
+  *big = mean >= 0 ? mean + radius : mean - radius;
+  *small = *big == 0 ? 0.0 : (a / *big) * c - (b / *big) * b;
+}
+
+// Решает [[d11, d21], [d21, d22]] x = y на месте с делением на d21, как в
+// LAPACK dsytrs, чтобы определитель блока не переполнялся
+void Solve2x2(double d11, double d21, double d22, double* y0, double* y1) {
+  const double p = d11 / d21;
+  const double q = d22 / d21;
+  const double denominator = p * q - 1.0;
+  const double b0 = *y0 / d21;
+  const double b1 = *y1 / d21;
+  *y0 = (q * b0 - b1) / denominator;
+  *y1 = (p * b1 - b0) / denominator;
+}
+
+// Решает систему для каждого столбца b через solve(столбец)
+template <typename SolveColumn>
+S21Matrix SolveColumns(int n, const S21Matrix& b, const SolveColumn& solve) {
+  if (b.GetRows() != n) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  S21Matrix x(n, b.GetCols());
+  const double* const* rhs = b.GetConstMatrixPointer();
+  double** out = x.GetMatrixPointer();
+  std::vector<double> column(n);
+  for (int j = 0; j < b.GetCols(); ++j) {
+    for (int i = 0; i < n; ++i) column[i] = rhs[i][j];
+    solve(column.data());
+    for (int i = 0; i < n; ++i) out[i][j] = column[i];
+  }
+  return x;
+}
+
+// x = A^-1 x для A, разложенной с симметричной перестановкой perm:
+// solve решает систему для переставленного вектора в буфере y
+template <typename SolvePermuted>
+void SolveInPlace(const std::vector<int>& perm, double* x,
+                  std::vector<double>* y, const SolvePermuted& solve) {
+  const int n = static_cast<int>(perm.size());
+  for (int i = 0; i < n; ++i) (*y)[i] = x[perm[i]];
+  solve(y->data());
+  for (int i = 0; i < n; ++i) x[perm[i]] = (*y)[i];
+}
+
+// Заполняет rcond по норме A и решателю для невырожденного разложения
+void EstimateRcond(S21FactorReport* report, double norm, int n,
+                   const std::function<void(double*, bool)>& solve) {
+  // Пустая матрица обусловлена идеально, как в LAPACK
+  if (n == 0) {
+    report->rcond = 1.0;
+    return;
+  }
+  const double inverse_norm = S21InverseNorm1Estimate(n, solve);
+  report->rcond = norm > 0 && inverse_norm > 0
+                      ? 1.0 / norm / inverse_norm
+                      : 0.0;
+}
+
+void MarkSingular(S21FactorReport* report) {
+  report->rcond = 0.0;
+  report->log_abs_det = -std::numeric_limits<double>::infinity();
+  report->det_sign = 0;
+}
+
+}  // namespace
+
+double S21InverseNorm1Estimate(
+    int n, const std::function<void(double* x, bool transpose)>& solve) {
+  // Рабочие векторы переиспользуются потоком: InverseInto() не выделяет
+  // память после первого вызова того же размера
+  if (n <= 0) return 0.0;
+  thread_local std::vector<double> x, y, z;
+  x.assign(n, 1.0 / n);
+  y.resize(n);
+  z.resize(n);
+  double estimate = 0.0;
+  for (int iteration = 0; iteration < kHagerIterations; ++iteration) {
+    y = x;
+    solve(y.data(), false);
+    double norm = 0.0;
+    for (double value : y) norm += std::fabs(value);
+    // Оценка перестала расти — максимум достигнут
+    if (iteration > 0 && !(norm > estimate)) break;
+    estimate = norm;
+    if (n == 1) break;
+    // Субградиент ||A^-1 x||_1 по x: z = A^-T sign(A^-1 x)
+    for (int i = 0; i < n; ++i) z[i] = y[i] >= 0 ? 1.0 : -1.0;
+    solve(z.data(), true);
+    int best = 0;
+    double projection = 0.0;
+    for (int i = 0; i < n; ++i) {
+      if (std::fabs(z[i]) > std::fabs(z[best])) best = i;
+      projection += z[i] * x[i];
+    }
+    if (iteration > 0 && std::fabs(z[best]) <= projection) break;
+    std::fill(x.begin(), x.end(), 0.0);
+    x[best] = 1.0;
+  }
+  // Чередующийся вектор Хайэма
+  if (n > 1) {
+    for (int i = 0; i < n; ++i) {
+      x[i] = (i % 2 == 0 ? 1.0 : -1.0) *
+             (1.0 + static_cast<double>(i) / (n - 1));
+    }
+    solve(x.data(), false);
+    double norm = 0.0;
+    for (double value : x) norm += std::fabs(value);
+    estimate = std::max(estimate, 2.0 * norm / (3.0 * n));
+  }
+  return estimate;
+}
+
+// =================================================================================================================================================================>
+
+S21Cholesky::S21Cholesky(const S21Matrix& a, double tolerance)
+    : n_(a.GetRows()), l_(LowerDense(a)), perm_(a.GetRows()) {
+  const int n = n_;
+  double* l = l_.data();
+  const double norm = SymmetricNorm1(l_, n);
+  for (int i = 0; i < n; ++i) perm_[i] = i;
+
+  // Диагональ остаточной подматрицы: a_ii минус квадраты найденных L_ik
+  std::vector<double> diagonal(n);
+  double max_diagonal = 0.0;
+  for (int i = 0; i < n; ++i) {
+    diagonal[i] = l[static_cast<std::size_t>(i) * n + i];
+    max_diagonal = std::max(max_diagonal, diagonal[i]);
+  }
+  if (tolerance < 0) {
+    tolerance = n * std::numeric_limits<double>::epsilon() * max_diagonal;
+  }
+
+  int rank = n;
+  for (int start = 0; start < n && rank == n; start += kCholeskyBlock) {
+    const int end = std::min(start + kCholeskyBlock, n);
+    for (int j = start; j < end; ++j) {
+      int pivot = j;
+      for (int i = j + 1; i < n; ++i) {
+        if (diagonal[i] > diagonal[pivot]) pivot = i;
+      }
+      // Отрицательный или NaN ведущий элемент тоже останавливает разложение
+      if (!(diagonal[pivot] > tolerance)) {
+        rank = j;
+        break;
+      }
+      if (pivot != j) {
+        SymmetricSwap(l, n, j, pivot);
+        std::swap(diagonal[j], diagonal[pivot]);
+        std::swap(perm_[j], perm_[pivot]);
+      }
+      double* row_j = l + static_cast<std::size_t>(j) * n;
+      const double root = std::sqrt(diagonal[j]);
+      row_j[j] = root;
+      // Столбцы левее start уже учтены обновлением остаточной подматрицы
+      for (int i = j + 1; i < n; ++i) {
+        double* row_i = l + static_cast<std::size_t>(i) * n;
+        double sum = row_i[j];
+        for (int k = start; k < j; ++k) sum -= row_i[k] * row_j[k];
+        row_i[j] = sum / root;
+        diagonal[i] -= row_i[j] * row_i[j];
+      }
+    }
+    if (rank < n || end == n) break;
+
+    // A22 -= L21 L21^T для столбцов блока, только нижний треугольник
+    const int trailing = n - end;
+    const int width = end - start;
+    auto update = [l, n, start, end, width](int begin, int stop) {
+      for (int i = end + begin; i < end + stop; ++i) {
+        double* row_i = l + static_cast<std::size_t>(i) * n;
+        const double* block_i = row_i + start;
+        for (int c = end; c <= i; ++c) {
+          const double* block_c = l + static_cast<std::size_t>(c) * n + start;
+          double sum = 0.0;
+          for (int k = 0; k < width; ++k) sum += block_i[k] * block_c[k];
+          row_i[c] -= sum;
+        }
+      }
+    };
+    S21ThreadPool::Instance().ParallelRowsIfWorth(
+        trailing, static_cast<std::uint64_t>(trailing) * trailing * width,
+        static_cast<std::size_t>(n) * sizeof(double), update);
+  }
+
+  // Всё правее ранга — не разложенный остаток
+  for (int i = 0; i < n; ++i) {
+    double* row_i = l + static_cast<std::size_t>(i) * n;
+    std::fill(row_i + std::min(i + 1, rank), row_i + n, 0.0);
+  }
+  report_.rank = rank;
+  if (rank < n) {
+    MarkSingular(&report_);
+    return;
+  }
+  report_.det_sign = 1;
+  report_.log_abs_det = 0.0;
+  for (int i = 0; i < n; ++i) {
+    report_.log_abs_det +=
+        2.0 * std::log(l[static_cast<std::size_t>(i) * n + i]);
+  }
+  EstimateRcond(&report_, norm, n, [this](double* x, bool) {
+    std::vector<double> y(n_);
+    SolveInPlace(perm_, x, &y, [this](double* z) { SolvePermuted(z); });
+  });
+}
+
+void S21Cholesky::SolvePermuted(double* y) const {
+  const int n = n_;
+  const double* l = l_.data();
+  // L z = y
+  for (int i = 0; i < n; ++i) {
+    const double* row = l + static_cast<std::size_t>(i) * n;
+    double sum = y[i];
+    for (int k = 0; k < i; ++k) sum -= row[k] * y[k];
+    y[i] = sum / row[i];
+  }
+  // L^T x = z
+  for (int i = n - 1; i >= 0; --i) {
+    double sum = y[i];
+    for (int k = i + 1; k < n; ++k) {
+      sum -= l[static_cast<std::size_t>(k) * n + i] * y[k];
+    }
+    y[i] = sum / l[static_cast<std::size_t>(i) * n + i];
+  }
+}
+
+bool S21Cholesky::IsPositiveDefinite() const { return report_.rank == n_; }
+
+const S21FactorReport& S21Cholesky::Report() const { return report_; }
+
+S21Matrix S21Cholesky::Solve(const S21Matrix& b) const {
+  if (!IsPositiveDefinite()) {
+    throw std::invalid_argument(
+        "Матрица не является положительно определённой");
+  }
+  std::vector<double> y(n_);
+  return SolveColumns(n_, b, [this, &y](double* x) {
+    SolveInPlace(perm_, x, &y, [this](double* z) { SolvePermuted(z); });
+  });
+}
+
+S21Matrix S21Cholesky::Inverse() const {
+  return Solve(S21Matrix::Identity(n_));
+}
+
+S21Matrix S21Cholesky::Lower() const {
+  const int rank = std::max(report_.rank, 1);
+  S21Matrix lower(n_, rank);
+  for (int i = 0; i < n_; ++i) {
+    for (int j = 0; j < std::min(i + 1, report_.rank); ++j) {
+      lower(i, j) = l_[static_cast<std::size_t>(i) * n_ + j];
+    }
+  }
+  return lower;
+}
+
+const std::vector<int>& S21Cholesky::Permutation() const { return perm_; }
+
+// =================================================================================================================================================================>
+
+S21Ldlt::S21Ldlt(const S21Matrix& a)
+    : n_(a.GetRows()),
+      ld_(LowerDense(a)),
+      block_(a.GetRows(), 1),
+      perm_(a.GetRows()) {
+  const int n = n_;
+  double* ld = ld_.data();
+  for (int i = 0; i < n; ++i) perm_[i] = i;
+  const double norm = SymmetricNorm1(ld_, n);
+  double max_element = 0.0;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      max_element = std::max(
+          max_element, std::fabs(ld[static_cast<std::size_t>(i) * n + j]));
+    }
+  }
+  const double tolerance =
+      n * std::numeric_limits<double>::epsilon() * max_element;
+  // Порог Банча — Кауфман, минимизирующий оценку роста элементов
+  const double alpha = (1.0 + std::sqrt(17.0)) / 8.0;
+  auto at = [ld, n](int i, int j) -> double& {
+    return ld[static_cast<std::size_t>(i) * n + j];
+  };
+
+  // В пределах панели остаточная подматрица не обновляется: её текущий
+  // элемент равен at(i, j) - sum_p L(i, p) W(j, p) по уже обработанным
+  // столбцам p панели, где W = L D — столбцы до деления на блок D.
+  // Блок 2 x 2 на краю панели расширяет её на один столбец. W и копия
+  // столбцов L панели хранятся по столбцам, чтобы и обновление строки, и
+  // вычисление текущего столбца шли подряд по памяти
+  const std::size_t panel_size = static_cast<std::size_t>(kLdltBlock + 1) * n;
+  std::vector<double> w(panel_size), l_panel(panel_size);
+  auto w_at = [&w, n](int i, int p) -> double& {
+    return w[static_cast<std::size_t>(p) * n + i];
+  };
+  auto l_at = [&l_panel, n](int i, int p) -> double& {
+    return l_panel[static_cast<std::size_t>(p) * n + i];
+  };
+  std::vector<double> column(n), candidate(n);
+  for (int start = 0; start < n;) {
+    int k = start;
+    // out[i] — текущий элемент (i, c) для i >= from >= k
+    auto current_column = [&at, &w_at, &l_at, n, &start, &k](int c, int from,
+                                                              double* out) {
+      for (int i = from; i < n; ++i) out[i] = i >= c ? at(i, c) : at(c, i);
+      for (int p = 0; p < k - start; ++p) {
+        const double factor = w_at(c, p);
+        const double* l_p = &l_at(0, p);
+        for (int i = from; i < n; ++i) out[i] -= l_p[i] * factor;
+      }
+    };
+    while (k < n && k - start < kLdltBlock) {
+      current_column(k, k, column.data());
+      const double diagonal = std::fabs(column[k]);
+      int max_row = k;
+      double column_max = 0.0;
+      for (int i = k + 1; i < n; ++i) {
+        if (std::fabs(column[i]) > column_max) {
+          column_max = std::fabs(column[i]);
+          max_row = i;
+        }
+      }
+      if (!(std::max(diagonal, column_max) > tolerance)) {
+        // Нулевой столбец: исключать нечего, D(k, k) = 0
+        for (int i = k; i < n; ++i) {
+          at(i, k) = w_at(i, k - start) = l_at(i, k - start) = 0.0;
+        }
+        ++k;
+        continue;
+      }
+
+      int step = 1, pivot = k;
+      if (diagonal < alpha * column_max) {
+        current_column(max_row, k, candidate.data());
+        double row_max = 0.0;
+        for (int j = k; j < n; ++j) {
+          if (j != max_row) {
+            row_max = std::max(row_max, std::fabs(candidate[j]));
+          }
+        }
+        if (diagonal * row_max >= alpha * column_max * column_max) {
+          pivot = k;
+        } else if (std::fabs(candidate[max_row]) >= alpha * row_max) {
+          pivot = max_row;
+        } else {
+          pivot = max_row;
+          step = 2;
+        }
+      }
+      const int last = k + step - 1;
+      if (pivot != last) {
+        SymmetricSwap(ld, n, last, pivot);
+        for (int p = 0; p < k - start; ++p) {
+          std::swap(w_at(last, p), w_at(pivot, p));
+          std::swap(l_at(last, p), l_at(pivot, p));
+        }
+        std::swap(perm_[last], perm_[pivot]);
+      }
+      // Столбцы ведущего блока обновляются сразу: из них получаются L и W
+      for (int c = k; c <= last; ++c) {
+        current_column(c, c, column.data());
+        for (int i = c; i < n; ++i) at(i, c) = column[i];
+      }
+
+      const int first = k + step;
+      if (step == 1) {
+        const double d = at(k, k);
+        for (int i = first; i < n; ++i) {
+          w_at(i, k - start) = at(i, k);
+          at(i, k) = l_at(i, k - start) = at(i, k) / d;
+        }
+      } else {
+        block_[k] = 2;
+        block_[k + 1] = 0;
+        for (int i = first; i < n; ++i) {
+          double l0 = w_at(i, k - start) = at(i, k);
+          double l1 = w_at(i, k + 1 - start) = at(i, k + 1);
+          Solve2x2(at(k, k), at(k + 1, k), at(k + 1, k + 1), &l0, &l1);
+          at(i, k) = l_at(i, k - start) = l0;
+          at(i, k + 1) = l_at(i, k + 1 - start) = l1;
+        }
+      }
+      k += step;
+    }
+
+    // A22 -= L21 W21^T по всем столбцам панели, только нижний треугольник
+    const int end = k;
+    const int width = end - start;
+    const int trailing = n - end;
+    // Полоса W из kLdltBlock столбцов остаётся в кэше на все строки
+    const double* w_data = w.data();
+    auto update = [ld, w_data, n, start, end, width](int begin, int stop) {
+      for (int jj = end; jj < end + stop; jj += kLdltBlock) {
+        for (int i = std::max(end + begin, jj); i < end + stop; ++i) {
+          double* row_i = ld + static_cast<std::size_t>(i) * n;
+          const int j_end = std::min(i + 1, jj + kLdltBlock);
+          for (int p = 0; p < width; ++p) {
+            const double factor = row_i[start + p];
+            const double* w_p = w_data + static_cast<std::size_t>(p) * n;
+            for (int j = jj; j < j_end; ++j) row_i[j] -= factor * w_p[j];
+          }
+        }
+      }
+    };
+    S21ThreadPool::Instance().ParallelRowsIfWorth(
+        trailing, static_cast<std::uint64_t>(trailing) * trailing * width,
+        static_cast<std::size_t>(n) * sizeof(double), update);
+    start = end;
+  }
+
+  // Инерция и определитель по собственным значениям блоков D
+  double log_abs_det = 0.0;
+  int sign = 1;
+  auto count = [&](double eigenvalue) {
+    if (!(std::fabs(eigenvalue) > tolerance)) {
+      ++inertia_.zero;
+      return;
+    }
+    if (eigenvalue > 0) {
+      ++inertia_.positive;
+    } else {
+      ++inertia_.negative;
+      sign = -sign;
+    }
+    log_abs_det += std::log(std::fabs(eigenvalue));
+  };
+  for (int k = 0; k < n; k += block_[k]) {
+    if (block_[k] == 1) {
+      count(at(k, k));
+    } else {
+      double big = 0.0, small = 0.0;
+      Eigen2x2(at(k, k), at(k + 1, k), at(k + 1, k + 1), &big, &small);
+      count(big);
+      count(small);
+    }
+  }
+  report_.rank = n - inertia_.zero;
+  if (report_.rank < n) {
+    MarkSingular(&report_);
+    return;
+  }
+  report_.log_abs_det = log_abs_det;
+  report_.det_sign = sign;
+  EstimateRcond(&report_, norm, n, [this](double* x, bool) {
+    std::vector<double> y(n_);
+    SolveInPlace(perm_, x, &y, [this](double* z) { SolvePermuted(z); });
+  });
+}
+
+void S21Ldlt::SolvePermuted(double* y) const {
+  const int n = n_;
+  const double* ld = ld_.data();
+  auto at = [ld, n](int i, int j) {
+    return ld[static_cast<std::size_t>(i) * n + j];
+  };
+  // L z = y
+  for (int k = 0; k < n; k += block_[k]) {
+    const int first = k + block_[k];
+    for (int c = k; c < first; ++c) {
+      for (int i = first; i < n; ++i) y[i] -= at(i, c) * y[c];
+    }
+  }
+  // D w = z
+  for (int k = 0; k < n; k += block_[k]) {
+    if (block_[k] == 1) {
+      y[k] /= at(k, k);
+    } else {
+      Solve2x2(at(k, k), at(k + 1, k), at(k + 1, k + 1), &y[k], &y[k + 1]);
+    }
+  }
+  // L^T x = w, блоки в обратном порядке
+  for (int k = n - 1; k >= 0; --k) {
+    const int start = block_[k] == 0 ? k - 1 : k;
+    for (int c = start; c <= k; ++c) {
+      double sum = y[c];
+      for (int i = k + 1; i < n; ++i) sum -= at(i, c) * y[i];
+      y[c] = sum;
+    }
+    k = start;
+  }
+}
+
+const S21FactorReport& S21Ldlt::Report() const { return report_; }
+
+const S21Inertia& S21Ldlt::Inertia() const { return inertia_; }
+
+S21Matrix S21Ldlt::Solve(const S21Matrix& b) const {
+  if (report_.rank < n_) {
+    throw std::invalid_argument("Матрица вырождена");
+  }
+  std::vector<double> y(n_);
+  return SolveColumns(n_, b, [this, &y](double* x) {
+    SolveInPlace(perm_, x, &y, [this](double* z) { SolvePermuted(z); });
+  });
+}
+
+S21Matrix S21Ldlt::Inverse() const { return Solve(S21Matrix::Identity(n_)); }
+
+S21Matrix S21Ldlt::Lower() const {
+  S21Matrix lower = S21Matrix::Identity(n_);
+  for (int k = 0; k < n_; k += block_[k]) {
+    for (int c = k; c < k + block_[k]; ++c) {
+      for (int i = k + block_[k]; i < n_; ++i) {
+        lower(i, c) = ld_[static_cast<std::size_t>(i) * n_ + c];
+      }
+    }
+  }
+  return lower;
+}
+
+S21Matrix S21Ldlt::Diagonal() const {
+  S21Matrix diagonal(n_, n_);
+  for (int k = 0; k < n_; k += block_[k]) {
+    for (int i = k; i < k + block_[k]; ++i) {
+      for (int j = k; j <= i; ++j) {
+        diagonal(i, j) = diagonal(j, i) =
+            ld_[static_cast<std::size_t>(i) * n_ + j];
+      }
+    }
+  }
+  return diagonal;
+}
+
+const std::vector<int>& S21Ldlt::Permutation() const { return perm_; }
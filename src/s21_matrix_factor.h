@@ -0,0 +1,143 @@
+#ifndef S21_MATRIX_FACTOR
+#define S21_MATRIX_FACTOR
+
+// Небходимые зависимые директивы
+#include <functional>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Что разложение сообщает о матрице до решения систем
+struct S21FactorReport {
+  int rank = 0;              // Численный ранг
+  double rcond = 0.0;        // Оценка 1 / (||A||_1 ||A^-1||_1); 0 — вырождена
+  double log_abs_det = 0.0;  // ln|det A| без переполнения; -inf — вырождена
+  int det_sign = 0;          // Знак det A: -1, 0 или 1
+};
+
+// Число положительных, отрицательных и нулевых собственных значений
+struct S21Inertia {
+  int positive = 0;
+  int negative = 0;
+  int zero = 0;
+};
+
+/**
+ * @brief Оценка ||A^-1||_1 по Хейгеру в варианте Хайэма (LAPACK dlacon).
+ *
+ * Не более пяти пар решений A x = b и A^T x = b с пробными векторами плюс
+ * одно решение с чередующимся вектором Хайэма, страхующее от редких
+ * матриц, на которых метод Хейгера сильно занижает норму. Оценка не больше
+ * истинной нормы и на практике почти всегда отличается от неё не более чем
+ * в 3 раза.
+ *
+ * @param solve Заменяет x (n элементов) на A^-1 x или, если transpose,
+ * на A^-T x.
+ * @return 0 для n <= 0.
+ */
+double S21InverseNorm1Estimate(
+    int n, const std::function<void(double* x, bool transpose)>& solve);
+
+/**
+ * @brief Разложение Холецкого с диагональным выбором: P^T A P = L L^T.
+ *
+ * На каждом шаге ведущим становится наибольший диагональный элемент
+ * остаточной подматрицы; разложение останавливается, когда он не больше
+ * tolerance, и номер шага — численный ранг (как LAPACK dpstrf). Поэтому
+ * вырожденная или неположительно определённая матрица распознаётся за те же
+ * O(n^3 / 3), без попытки обращения.
+ *
+ * Столбцы обрабатываются блоками: внутри блока обновляется только текущий
+ * столбец, а остаточная подматрица — один раз на блок произведением ранга
+ * блока, строки которого распределяются по S21ThreadPool.
+ *
+ * Читается только нижний треугольник A.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21Cholesky {
+ public:
+  // tolerance < 0 — n * eps * max a_ii; std::invalid_argument для
+  // неквадратной матрицы
+  explicit S21Cholesky(const S21Matrix& a, double tolerance = -1.0);
+
+  bool IsPositiveDefinite() const;  // Численный ранг равен n
+  const S21FactorReport& Report() const;
+
+  // A^-1 b; std::invalid_argument, если матрица не положительно определена
+  // или число строк b не равно n
+  S21Matrix Solve(const S21Matrix& b) const;
+  S21Matrix Inverse() const;
+
+  S21Matrix Lower() const;  // L размером n x rank
+  // (P^T A P)(i, j) = A(perm[i], perm[j])
+  const std::vector<int>& Permutation() const;
+
+ private:
+  // Решает L L^T y = y на месте для уже переставленной правой части
+  void SolvePermuted(double* y) const;
+
+  int n_;
+  std::vector<double> l_;  // n x n построчно, L в нижнем треугольнике
+  std::vector<int> perm_;
+  S21FactorReport report_;
+};
+
+/**
+ * @brief LDL^T-разложение симметричной матрицы по Банчу — Кауфман:
+ * P A P^T = L D L^T.
+ *
+ * L — нижняя унитреугольная, D — блочно-диагональная с блоками 1 x 1 и
+ * 2 x 2. Выбор ведущего блока ограничивает рост элементов без потери
+ * симметрии, поэтому разложение подходит для знаконеопределённых матриц, а
+ * его стоимость — O(n^3 / 3), вдвое меньше LU. По D определяются инерция,
+ * знак и логарифм модуля определителя.
+ *
+ * Столбец, все элементы которого не больше n * eps * max|a_ij|, считается
+ * нулевым: он не исключается, а даёт нулевое собственное значение D. В
+ * отличие от S21Cholesky, LDL^T не раскрывает ранг гарантированно: точно
+ * вырожденные матрицы распознаются, а близкие к вырожденным лучше
+ * отсеивать по rcond.
+ *
+ * Разложение блочное, как LAPACK dsytrf: внутри панели из 64 столбцов
+ * обновляются только столбцы, нужные для выбора ведущего блока, а
+ * остаточная подматрица обновляется один раз на панель произведением
+ * L W^T, которое распределяется по строкам между потоками S21ThreadPool.
+ * Читается только нижний треугольник A.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21Ldlt {
+ public:
+  // std::invalid_argument для неквадратной матрицы
+  explicit S21Ldlt(const S21Matrix& a);
+
+  const S21FactorReport& Report() const;
+  const S21Inertia& Inertia() const;
+
+  // A^-1 b; std::invalid_argument для вырожденной матрицы или если число
+  // строк b не равно n
+  S21Matrix Solve(const S21Matrix& b) const;
+  S21Matrix Inverse() const;
+
+  S21Matrix Lower() const;     // L
+  S21Matrix Diagonal() const;  // D
+  // (P A P^T)(i, j) = A(perm[i], perm[j])
+  const std::vector<int>& Permutation() const;
+
+ private:
+  // Решает L D L^T y = y на месте для уже переставленной правой части
+  void SolvePermuted(double* y) const;
+
+  int n_;
+  // n x n построчно: множители L ниже блоков D, блоки D в нижнем
+  // треугольнике диагонали
+  std::vector<double> ld_;
+  // 1 — блок 1 x 1, 2 — начало блока 2 x 2, 0 — его вторая строка
+  std::vector<int> block_;
+  std::vector<int> perm_;
+  S21FactorReport report_;
+  S21Inertia inertia_;
+};
+
+#endif  // S21_MATRIX_FACTOR
@@ -0,0 +1,643 @@
+#include "s21_matrix_fuzz.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_matrix_tune.h"
+
+namespace {
+
+const double kEps = std::numeric_limits<double>::epsilon();
+const double kInf = std::numeric_limits<double>::infinity();
+
+// Крайние значения, которые подставляются вместо обычных элементов
+const double kEdgeValues[] = {std::numeric_limits<double>::quiet_NaN(),
+                              kInf,
+                              -kInf,
+                              std::numeric_limits<double>::denorm_min(),
+                              -std::numeric_limits<double>::denorm_min(),
+                              1e-310,
+                              std::numeric_limits<double>::min(),
+                              -0.0,
+                              0.0,
+                              1e300,
+                              -1e300,
+                              std::numeric_limits<double>::max(),
+                              1e-300,
+                              1.0,
+                              -1.0,
+                              kEps};
+const int kEdgeSelector = 256 - 16;
+
+// Наибольшие размеры: умножение и транспонирование дёшевы, а определитель
+// и обратная через алгебраические дополнения стоят O(n!)
+const int kMaxDim = 40;
+const int kMaxCofactorDim = 6;
+const int kMaxPowerDim = 12;
+const int kMaxPower = 5;
+const int kMaxSolveDim = 24;
+const int kMaxRhs = 4;
+
+// Запас над оценками ошибки округления
+const double kSlack = 4.0;
+// Число обусловленности, выше которого решение систем не сравнивается
+const double kMaxCondition = 1e10;
+// Ненулевые элементы меньше этого порога дают исчезновение порядка в
+// произведениях, которое оценки ошибки округления не учитывают
+const double kTinyElement = 1e-100;
+
+// Байты входа фаззера; за концом данных читаются нули
+class ByteReader {
+ public:
+  ByteReader(const std::uint8_t* data, std::size_t size)
+      : data_(data), size_(size) {}
+
+  std::uint8_t Byte() { return pos_ < size_ ? data_[pos_++] : 0; }
+  int Range(int low, int high) { return low + Byte() % (high - low + 1); }
+
+  double Value(bool edges) {
+    int selector = Byte();
+    if (edges && selector >= kEdgeSelector) {
+      return kEdgeValues[selector - kEdgeSelector];
+    }
+    double mantissa = static_cast<std::int8_t>(Byte()) / 16.0;
+    return std::ldexp(mantissa, selector % 8 - 3);
+  }
+
+ private:
+  const std::uint8_t* data_;
+  std::size_t size_;
+  std::size_t pos_ = 0;
+};
+
+S21Matrix ReadMatrix(ByteReader* in, int rows, int cols, bool edges) {
+  S21Matrix m(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) m(i, j) = in->Value(edges);
+  }
+  return m;
+}
+
+// Последняя строка — сумма первых двух с возмущением порядка 1e-13
+void MakeNearlySingular(S21Matrix* m, ByteReader* in) {
+  const int n = m->GetRows();
+  if (n < 3) return;
+  for (int j = 0; j < n; ++j) {
+    (*m)(n - 1, j) = (*m)(0, j) + (*m)(1, j) + in->Value(false) * 1e-13;
+  }
+}
+
+bool AllFinite(const S21Matrix& m) {
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) {
+      if (!std::isfinite(m(i, j))) return false;
+    }
+  }
+  return true;
+}
+
+bool HasTiny(const S21Matrix& m) {
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) {
+      if (m(i, j) != 0 && std::fabs(m(i, j)) < kTinyElement) return true;
+    }
+  }
+  return false;
+}
+
+bool HasNan(const S21Matrix& m) {
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) {
+      if (std::isnan(m(i, j))) return true;
+    }
+  }
+  return false;
+}
+
+// Отношение |fast - expected| к допуску: NaN и бесконечности должны
+// совпадать точно, иначе отношение бесконечно
+double ElementRatio(double fast, double expected, double bound) {
+  if (std::isnan(fast) || std::isnan(expected)) {
+    return std::isnan(fast) && std::isnan(expected) ? 0.0 : kInf;
+  }
+  if (std::isinf(fast) || std::isinf(expected)) {
+    return fast == expected ? 0.0 : kInf;
+  }
+  if (fast == expected || std::isinf(bound)) return 0.0;
+  if (!(bound > 0)) return kInf;
+  return std::fabs(fast - expected) / bound;
+}
+
+std::string Describe(const char* what, int i, int j, double fast,
+                     double expected) {
+  std::ostringstream out;
+  out.precision(17);
+  out << what << " (" << i << ", " << j << "): получено " << fast
+      << ", ожидалось " << expected;
+  return out.str();
+}
+
+// Наибольшее по элементам отношение ошибки к допуску bound(i, j)
+template <typename Bound>
+double MatrixRatio(const S21Matrix& fast, const S21Matrix& expected,
+                   Bound bound, std::string* details) {
+  if (fast.GetRows() != expected.GetRows() ||
+      fast.GetCols() != expected.GetCols()) {
+    *details = "размеры результата не совпадают с эталоном";
+    return kInf;
+  }
+  double worst = 0.0;
+  for (int i = 0; i < fast.GetRows(); ++i) {
+    for (int j = 0; j < fast.GetCols(); ++j) {
+      double ratio = ElementRatio(fast(i, j), expected(i, j), bound(i, j));
+      if (ratio > worst || std::isnan(ratio)) {
+        worst = std::isnan(ratio) ? kInf : ratio;
+        *details = Describe("элемент", i, j, fast(i, j), expected(i, j));
+      }
+    }
+  }
+  return worst;
+}
+
+// Наивное умножение в том же порядке суммирования по k
+S21Matrix ReferenceMul(const S21Matrix& a, const S21Matrix& b) {
+  S21Matrix c(a.GetRows(), b.GetCols());
+  for (int i = 0; i < a.GetRows(); ++i) {
+    for (int j = 0; j < b.GetCols(); ++j) {
+      double sum = 0.0;
+      for (int k = 0; k < a.GetCols(); ++k) sum += a(i, k) * b(k, j);
+      c(i, j) = sum;
+    }
+  }
+  return c;
+}
+
+S21Matrix Absolute(const S21Matrix& m) {
+  S21Matrix result(m.GetRows(), m.GetCols());
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) result(i, j) = std::fabs(m(i, j));
+  }
+  return result;
+}
+
+using Dense = std::vector<std::vector<long double>>;
+
+Dense ToLong(const S21Matrix& m) {
+  Dense dense(m.GetRows(), std::vector<long double>(m.GetCols()));
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) dense[i][j] = m(i, j);
+  }
+  return dense;
+}
+
+// Определитель исключением Гаусса в long double
+long double ReferenceDeterminant(Dense a) {
+  const int n = static_cast<int>(a.size());
+  long double det = 1.0L;
+  for (int k = 0; k < n; ++k) {
+    int pivot = k;
+    for (int i = k + 1; i < n; ++i) {
+      if (std::fabs(a[i][k]) > std::fabs(a[pivot][k])) pivot = i;
+    }
+    if (a[pivot][k] == 0) return 0.0L;
+    if (pivot != k) {
+      std::swap(a[pivot], a[k]);
+      det = -det;
+    }
+    det *= a[k][k];
+    for (int i = k + 1; i < n; ++i) {
+      long double factor = a[i][k] / a[k][k];
+      for (int j = k; j < n; ++j) a[i][j] -= factor * a[k][j];
+    }
+  }
+  return det;
+}
+
+Dense DenseMinor(const Dense& a, int skip_row, int skip_col) {
+  Dense minor;
+  for (int i = 0; i < static_cast<int>(a.size()); ++i) {
+    if (i == skip_row) continue;
+    minor.emplace_back();
+    for (int j = 0; j < static_cast<int>(a[i].size()); ++j) {
+      if (j != skip_col) minor.back().push_back(a[i][j]);
+    }
+  }
+  return minor;
+}
+
+// Решение a * x = b методом Гаусса-Жордана в long double; false для
+// вырожденной матрицы
+bool ReferenceSolve(Dense a, Dense b, Dense* x) {
+  const int n = static_cast<int>(a.size());
+  const int m = b.empty() ? 0 : static_cast<int>(b[0].size());
+  for (int k = 0; k < n; ++k) {
+    int pivot = k;
+    for (int i = k + 1; i < n; ++i) {
+      if (std::fabs(a[i][k]) > std::fabs(a[pivot][k])) pivot = i;
+    }
+    if (a[pivot][k] == 0) return false;
+    std::swap(a[pivot], a[k]);
+    std::swap(b[pivot], b[k]);
+    for (int i = 0; i < n; ++i) {
+      if (i == k || a[i][k] == 0) continue;
+      long double factor = a[i][k] / a[k][k];
+      for (int j = k; j < n; ++j) a[i][j] -= factor * a[k][j];
+      for (int j = 0; j < m; ++j) b[i][j] -= factor * b[k][j];
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < m; ++j) b[i][j] /= a[i][i];
+  }
+  *x = b;
+  return true;
+}
+
+S21Matrix FromLong(const Dense& dense) {
+  S21Matrix m(static_cast<int>(dense.size()),
+              dense.empty() ? 0 : static_cast<int>(dense[0].size()));
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) {
+      m(i, j) = static_cast<double>(dense[i][j]);
+    }
+  }
+  return m;
+}
+
+long double NormInf(const Dense& a) {
+  long double norm = 0.0L;
+  for (const auto& row : a) {
+    long double sum = 0.0L;
+    for (long double value : row) sum += std::fabs(value);
+    norm = std::max(norm, sum);
+  }
+  return norm;
+}
+
+// Произведение 1-норм строк без строки skip_row и столбца skip_col: оценка
+// сверху перманента |A|, которым ограничена ошибка разложения по строке
+long double RowNormProduct(const S21Matrix& m, int skip_row, int skip_col) {
+  long double product = 1.0L;
+  for (int i = 0; i < m.GetRows(); ++i) {
+    if (i == skip_row) continue;
+    long double sum = 0.0L;
+    for (int j = 0; j < m.GetCols(); ++j) {
+      if (j != skip_col) sum += std::fabs(static_cast<long double>(m(i, j)));
+    }
+    product *= sum;
+  }
+  return product;
+}
+
+// Восстанавливает параметры S21Tuner после случайной подмены
+class TunerGuard {
+ public:
+  TunerGuard() : saved_(S21Tuner::Instance().Params()) {}
+  ~TunerGuard() { S21Tuner::Instance().SetParams(saved_); }
+
+  TunerGuard(const TunerGuard&) = delete;
+  TunerGuard& operator=(const TunerGuard&) = delete;
+
+ private:
+  S21TuneParams saved_;
+};
+
+}  // namespace
+
+bool S21MatrixFuzz::RunOne(const std::uint8_t* data, std::size_t size,
+                           std::string* failure) {
+  ByteReader in(data, size);
+  const std::uint8_t flags = in.Byte();
+  const bool edges = (flags & 1) != 0;
+  const bool near_singular = (flags & 2) != 0;
+
+  TunerGuard guard;
+  if ((flags & 4) != 0) {
+    // Блоки любого размера, в том числе не делящие матрицу, и
+    // принудительный параллельный режим
+    S21TuneParams params;
+    params.gemm_block_k = in.Range(1, 64);
+    params.gemm_block_n = in.Range(1, 64);
+    params.transpose_block = in.Range(1, 64);
+    params.parallel_flops = in.Byte() % 2 == 0 ? 0 : params.parallel_flops;
+    params.lu_parallel_size = in.Range(1, 64);
+    S21Tuner::Instance().SetParams(params);
+  }
+
+  try {
+    const int rows = in.Range(1, kMaxDim);
+    const int inner = in.Range(1, kMaxDim);
+    const int cols = in.Range(1, kMaxDim);
+    const S21Matrix a = ReadMatrix(&in, rows, inner, edges);
+    const S21Matrix b = ReadMatrix(&in, inner, cols, edges);
+    if (!CheckProduct(a, b, failure) || !CheckTranspose(a, failure) ||
+        !CheckSums(a, failure)) {
+      return false;
+    }
+
+    const int n = in.Range(1, kMaxCofactorDim);
+    S21Matrix square = ReadMatrix(&in, n, n, edges);
+    if (near_singular) MakeNearlySingular(&square, &in);
+    if (!CheckSquare(square, failure)) return false;
+
+    const int power_dim = in.Range(1, kMaxPowerDim);
+    const int power = in.Range(0, kMaxPower);
+    const S21Matrix base = ReadMatrix(&in, power_dim, power_dim, edges);
+    if (!CheckPower(base, power, failure)) return false;
+
+    const int system_dim = in.Range(1, kMaxSolveDim);
+    S21Matrix system = ReadMatrix(&in, system_dim, system_dim, edges);
+    if (near_singular) MakeNearlySingular(&system, &in);
+    const S21Matrix rhs =
+        ReadMatrix(&in, system_dim, in.Range(1, kMaxRhs), edges);
+    return CheckSolve(system, rhs, failure);
+  } catch (const std::exception& error) {
+    *failure = std::string("Неожиданное исключение: ") + error.what();
+    return false;
+  }
+}
+
+bool S21MatrixFuzz::RunRandom(std::uint64_t seed, std::string* failure) {
+  // Хватает на матрицы наибольших размеров, остаток читается нулями
+  std::vector<std::uint8_t> bytes(16384);
+  std::mt19937_64 random(seed);
+  for (std::uint8_t& byte : bytes) byte = static_cast<std::uint8_t>(random());
+  return RunOne(bytes.data(), bytes.size(), failure);
+}
+
+const std::map<std::string, S21FuzzKernelStats>& S21MatrixFuzz::Stats()
+    const {
+  return stats_;
+}
+
+std::string S21MatrixFuzz::Report() const {
+  std::ostringstream out;
+  out.precision(3);
+  for (const auto& [kernel, stats] : stats_) {
+    out << kernel << ": сравнений " << stats.cases << ", без проверки "
+        << stats.skipped << ", наибольшая доля допуска " << stats.worst_ratio
+        << "\n";
+  }
+  return out.str();
+}
+
+bool S21MatrixFuzz::Track(const std::string& kernel, double ratio,
+                          std::string* failure, const std::string& details) {
+  S21FuzzKernelStats& stats = stats_[kernel];
+  ++stats.cases;
+  if (std::isnan(ratio)) ratio = kInf;
+  stats.worst_ratio = std::max(stats.worst_ratio, ratio);
+  if (ratio <= 1.0) return true;
+  std::ostringstream out;
+  out << kernel << ": " << details << "; ошибка больше допуска в " << ratio
+      << " раз";
+  *failure = out.str();
+  return false;
+}
+
+void S21MatrixFuzz::Skip(const std::string& kernel) {
+  ++stats_[kernel].skipped;
+}
+
+bool S21MatrixFuzz::CheckProduct(const S21Matrix& a, const S21Matrix& b,
+                                 std::string* failure) {
+  const S21Matrix expected = ReferenceMul(a, b);
+  const S21Matrix magnitude = ReferenceMul(Absolute(a), Absolute(b));
+  const double scale = kSlack * a.GetCols() * kEps;
+  auto bound = [&magnitude, scale](int i, int j) {
+    return scale * magnitude(i, j);
+  };
+  std::string details;
+  S21Matrix product(a);
+  product.MulMatrix(b);
+  if (!Track("MulMatrix", MatrixRatio(product, expected, bound, &details),
+             failure, details)) {
+    return false;
+  }
+  return Track("operator*", MatrixRatio(a * b, expected, bound, &details),
+               failure, details);
+}
+
+bool S21MatrixFuzz::CheckTranspose(const S21Matrix& a, std::string* failure) {
+  S21Matrix expected(a.GetCols(), a.GetRows());
+  for (int i = 0; i < a.GetRows(); ++i) {
+    for (int j = 0; j < a.GetCols(); ++j) expected(j, i) = a(i, j);
+  }
+  std::string details;
+  double ratio = MatrixRatio(
+      a.Transpose(), expected, [](int, int) { return 0.0; }, &details);
+  if (!Track("Transpose", ratio, failure, details)) return false;
+
+  // Копия равна оригиналу, пока в нём нет NaN
+  const bool equal = S21Matrix(a).EqMatrix(a);
+  return Track("EqMatrix", equal == !HasNan(a) ? 0.0 : kInf, failure,
+               "EqMatrix(копия) не согласуется с наличием NaN");
+}
+
+bool S21MatrixFuzz::CheckSums(const S21Matrix& a, std::string* failure) {
+  long double sum = 0.0L, magnitude = 0.0L;
+  for (int i = 0; i < a.GetRows(); ++i) {
+    for (int j = 0; j < a.GetCols(); ++j) {
+      sum += a(i, j);
+      magnitude += std::fabs(static_cast<long double>(a(i, j)));
+    }
+  }
+  const double count = static_cast<double>(a.GetRows()) * a.GetCols();
+  const struct {
+    const char* kernel;
+    S21Summation mode;
+  } modes[] = {{"Sum/naive", S21Summation::kNaive},
+               {"Sum/pairwise", S21Summation::kPairwise},
+               {"Sum/kahan", S21Summation::kKahan}};
+  for (const auto& mode : modes) {
+    double fast = a.Sum(mode.mode);
+    if (HasNan(a)) {
+      if (!Track(mode.kernel, std::isnan(fast) ? 0.0 : kInf, failure,
+                 "NaN во входе не дал NaN в сумме")) {
+        return false;
+      }
+      continue;
+    }
+    // Переполнение промежуточных сумм зависит от порядка сложения
+    if (!AllFinite(a) ||
+        magnitude > std::numeric_limits<double>::max() / 4) {
+      Skip(mode.kernel);
+      continue;
+    }
+    double expected = static_cast<double>(sum);
+    double bound = kSlack * count * kEps * static_cast<double>(magnitude);
+    if (!Track(mode.kernel, ElementRatio(fast, expected, bound), failure,
+               Describe("сумма", 0, 0, fast, expected))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool S21MatrixFuzz::CheckSquare(const S21Matrix& a, std::string* failure) {
+  const int n = a.GetRows();
+  const double det = a.Determinant();
+  if (HasNan(a)) {
+    return Track("Determinant", std::isnan(det) ? 0.0 : kInf, failure,
+                 "NaN во входе не дал NaN в определителе");
+  }
+  // Промежуточные произведения разложения ограничены перманентом |A|;
+  // при его переполнении результат зависит от порядка вычислений
+  if (!AllFinite(a) || HasTiny(a) ||
+      RowNormProduct(a, -1, -1) > std::numeric_limits<double>::max() / 4) {
+    Skip("Determinant");
+    Skip("InverseMatrix");
+    return true;
+  }
+
+  // Ошибка разложения по строке ограничена gamma_2n * per(|A|), а
+  // перманент — произведением норм строк
+  const long double expected_det = ReferenceDeterminant(ToLong(a));
+  const double det_bound =
+      static_cast<double>(kSlack * 2 * n * kEps * RowNormProduct(a, -1, -1));
+  if (!Track("Determinant",
+             ElementRatio(det, static_cast<double>(expected_det), det_bound),
+             failure,
+             Describe("определитель", n, n, det,
+                      static_cast<double>(expected_det)))) {
+    return false;
+  }
+
+  // Обратная сравнивается, только если определитель заметно больше своей
+  // погрешности; иначе проверяется лишь отсутствие сбоев
+  if (std::fabs(static_cast<double>(expected_det)) <= 4 * det_bound ||
+      !std::isnormal(static_cast<double>(expected_det))) {
+    try {
+      (void)a.InverseMatrix();
+    } catch (const std::invalid_argument&) {
+      // Вырожденная матрица отклоняется — допустимый исход
+    }
+    Skip("InverseMatrix");
+    return true;
+  }
+  // Эталон — те же алгебраические дополнения, но в long double и через
+  // исключение Гаусса: исключение по всей матрице теряло бы точность на
+  // плохо масштабированных входах
+  const Dense dense = ToLong(a);
+  Dense inverse_long(n, std::vector<long double>(n));
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      long double cofactor = ReferenceDeterminant(DenseMinor(dense, j, i));
+      inverse_long[i][j] = ((i + j) % 2 == 0 ? 1 : -1) * cofactor /
+                           expected_det;
+    }
+  }
+  const S21Matrix expected = FromLong(inverse_long);
+
+  // inv(i, j) = C(j, i) / det: относительные ошибки дополнения и
+  // определителя складываются
+  const long double det_product = RowNormProduct(a, -1, -1);
+  const long double abs_det = std::fabs(expected_det);
+  auto bound = [&](int i, int j) {
+    long double error = RowNormProduct(a, j, i) +
+                        std::fabs(inverse_long[i][j]) * det_product;
+    return static_cast<double>(kSlack * 2 * n * kEps * error / abs_det);
+  };
+  std::string details;
+  return Track("InverseMatrix",
+               MatrixRatio(a.InverseMatrix(), expected, bound, &details),
+               failure, details);
+}
+
+bool S21MatrixFuzz::CheckPower(const S21Matrix& a, int power,
+                               std::string* failure) {
+  const int n = a.GetRows();
+  const S21Matrix fast = a.Pow(power);
+  if (power == 0) {
+    S21Matrix identity(n, n);
+    for (int i = 0; i < n; ++i) identity(i, i) = 1.0;
+    std::string details;
+    return Track("Pow",
+                 MatrixRatio(fast, identity, [](int, int) { return 0.0; },
+                             &details),
+                 failure, details);
+  }
+  // Порядок умножений у двоичного возведения другой, поэтому переполнение
+  // и NaN из inf * 0 для нечисловых входов могут отличаться
+  if (!AllFinite(a) || HasTiny(a)) {
+    Skip("Pow");
+    return true;
+  }
+  S21Matrix expected(a), magnitude = Absolute(a);
+  const S21Matrix abs_a = Absolute(a);
+  for (int k = 1; k < power; ++k) {
+    expected = ReferenceMul(expected, a);
+    magnitude = ReferenceMul(magnitude, abs_a);
+  }
+  if (!AllFinite(magnitude)) {
+    Skip("Pow");
+    return true;
+  }
+  const double scale = kSlack * (power - 1) * n * kEps;
+  std::string details;
+  return Track("Pow",
+               MatrixRatio(fast, expected,
+                           [&magnitude, scale](int i, int j) {
+                             return scale * magnitude(i, j);
+                           },
+                           &details),
+               failure, details);
+}
+
+bool S21MatrixFuzz::CheckSolve(const S21Matrix& a, const S21Matrix& b,
+                               std::string* failure) {
+  const int n = a.GetRows();
+  Dense x_long, inverse_long;
+  Dense identity(n, std::vector<long double>(n, 0.0L));
+  for (int i = 0; i < n; ++i) identity[i][i] = 1.0L;
+  const bool regular = AllFinite(a) && AllFinite(b) && !HasTiny(a) &&
+                       ReferenceSolve(ToLong(a), ToLong(b), &x_long) &&
+                       ReferenceSolve(ToLong(a), identity, &inverse_long);
+  const long double condition =
+      regular ? NormInf(ToLong(a)) * NormInf(inverse_long) : 0.0L;
+  const S21Matrix expected = regular ? FromLong(x_long) : S21Matrix();
+  // Невязка уточнения содержит произведения A * x, которые не должны
+  // переполняться
+  const bool representable =
+      regular && NormInf(ToLong(a)) * NormInf(x_long) <
+                     std::numeric_limits<double>::max() / 16;
+  if (!regular || !(condition < kMaxCondition) || !representable ||
+      !AllFinite(expected)) {
+    // Только отсутствие сбоев: вырожденная система может быть отклонена
+    try {
+      (void)a.Solve(b);
+      (void)a.SolveRefined(b);
+    } catch (const std::invalid_argument&) {
+    }
+    Skip("Solve");
+    Skip("SolveRefined");
+    return true;
+  }
+
+  // Нормированная оценка обратной устойчивости LU с частичным выбором:
+  // ||x - x*|| <= c * n^2 * eps * cond(A) * ||x*|| по каждому столбцу
+  std::vector<double> column_norm(b.GetCols(), 0.0);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < b.GetCols(); ++j) {
+      column_norm[j] = std::max(column_norm[j], std::fabs(expected(i, j)));
+    }
+  }
+  const double scale =
+      kSlack * n * n * kEps * static_cast<double>(condition);
+  auto bound = [&column_norm, scale](int, int j) {
+    return scale * column_norm[j];
+  };
+  std::string details;
+  if (!Track("Solve", MatrixRatio(a.Solve(b), expected, bound, &details),
+             failure, details)) {
+    return false;
+  }
+  return Track("SolveRefined",
+               MatrixRatio(a.SolveRefined(b), expected, bound, &details),
+               failure, details);
+}
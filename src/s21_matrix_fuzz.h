@@ -0,0 +1,71 @@
+#ifndef S21_MATRIX_FUZZ
+#define S21_MATRIX_FUZZ
+
+// Небходимые зависимые директивы
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+class S21Matrix;
+
+// Накопленная по одному ядру точность
+struct S21FuzzKernelStats {
+  std::uint64_t cases = 0;    // Сравнений с эталоном
+  std::uint64_t skipped = 0;  // Случаев без численной проверки (например,
+                              // почти вырожденных), проверенных только на
+                              // отсутствие сбоев
+  double worst_ratio = 0.0;   // Наибольшее отношение ошибки к допуску;
+                              // проверка падает, когда оно больше 1
+};
+
+/**
+ * @brief Дифференциальная проверка быстрых путей S21Matrix против эталона.
+ *
+ * RunOne() превращает произвольные байты в матрицы случайной формы с
+ * крайними значениями (NaN, бесконечности, денормализованные и очень
+ * большие числа, почти вырожденные строки) и случайными параметрами
+ * S21Tuner, после чего сравнивает MulMatrix, Pow, Transpose, Determinant,
+ * InverseMatrix, Solve, SolveRefined и суммы с наивными эталонными
+ * реализациями (определитель и обратная — в long double).
+ *
+ * Допуски выводятся из стандартных оценок ошибки округления: для
+ * умножения — n * eps * sum |a||b|, для обратной — с учётом числа
+ * обусловленности. NaN и бесконечности должны совпадать по положению и
+ * знаку. Отношение ошибки к допуску копится по каждому ядру в Stats(), так
+ * что постепенная потеря точности видна задолго до падения.
+ *
+ * Один и тот же разбор используется точкой входа libFuzzer, автономным
+ * прогоном (make fuzz) и модульными тестами.
+ */
+class S21MatrixFuzz {
+ public:
+  // false и описание расхождения в *failure, если быстрый путь разошёлся с
+  // эталоном или бросил неожиданное исключение
+  bool RunOne(const std::uint8_t* data, std::size_t size,
+              std::string* failure);
+  bool RunRandom(std::uint64_t seed, std::string* failure);  // Случайные
+                                                             // байты
+
+  const std::map<std::string, S21FuzzKernelStats>& Stats() const;
+  std::string Report() const;  // По строке на ядро
+
+ private:
+  // Учитывает сравнение; false, если ratio больше 1
+  bool Track(const std::string& kernel, double ratio, std::string* failure,
+             const std::string& details);
+  void Skip(const std::string& kernel);
+
+  bool CheckProduct(const S21Matrix& a, const S21Matrix& b,
+                    std::string* failure);
+  bool CheckTranspose(const S21Matrix& a, std::string* failure);
+  bool CheckSums(const S21Matrix& a, std::string* failure);
+  bool CheckSquare(const S21Matrix& a, std::string* failure);
+  bool CheckPower(const S21Matrix& a, int power, std::string* failure);
+  bool CheckSolve(const S21Matrix& a, const S21Matrix& b,
+                  std::string* failure);
+
+  std::map<std::string, S21FuzzKernelStats> stats_;
+};
+
+#endif  // S21_MATRIX_FUZZ
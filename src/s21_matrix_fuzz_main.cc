@@ -0,0 +1,73 @@
+// Точка входа дифференциального фаззинга. С -DS21_LIBFUZZER собирается
+// цель libFuzzer (clang++ -fsanitize=fuzzer); иначе — автономный прогон:
+//   fuzz [число_входов [первое_зерно]]  случайные входы
+//   fuzz файл...                        воспроизведение сохранённых входов
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "s21_matrix_fuzz.h"
+
+#ifdef S21_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size) {
+  static S21MatrixFuzz fuzz;
+  std::string failure;
+  if (!fuzz.RunOne(data, size, &failure)) {
+    std::cerr << failure << "\n";
+    std::abort();
+  }
+  return 0;
+}
+
+#else
+
+namespace {
+
+bool IsNumber(const char* text) {
+  if (*text == '\0') return false;
+  for (; *text != '\0'; ++text) {
+    if (*text < '0' || *text > '9') return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  S21MatrixFuzz fuzz;
+  std::string failure;
+  int status = 0;
+  if (argc > 1 && !IsNumber(argv[1])) {
+    for (int i = 1; i < argc && status == 0; ++i) {
+      std::ifstream in(argv[i], std::ios::binary);
+      std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)),
+                                     std::istreambuf_iterator<char>());
+      if (!fuzz.RunOne(data.data(), data.size(), &failure)) {
+        std::cerr << argv[i] << ": " << failure << "\n";
+        status = 1;
+      }
+    }
+  } else {
+    const std::uint64_t runs = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                        : 10000;
+    const std::uint64_t first = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                         : 0;
+    for (std::uint64_t seed = first; seed < first + runs; ++seed) {
+      if (!fuzz.RunRandom(seed, &failure)) {
+        std::cerr << "Зерно " << seed << ": " << failure << "\n";
+        status = 1;
+        break;
+      }
+    }
+  }
+  std::cout << fuzz.Report();
+  return status;
+}
+
+#endif  // S21_LIBFUZZER
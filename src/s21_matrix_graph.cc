@@ -0,0 +1,360 @@
+#include "s21_matrix_graph.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+S21MatrixGraph::NodeId S21MatrixGraph::Input() {
+  return AddNode(Kind::kInput, -1, -1, 0.0);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Add(NodeId a, NodeId b) {
+  return AddNode(Kind::kAdd, a, b, 0.0);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Sub(NodeId a, NodeId b) {
+  return AddNode(Kind::kSub, a, b, 0.0);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Mul(NodeId a, NodeId b) {
+  return AddNode(Kind::kMul, a, b, 0.0);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Scale(NodeId a, double number) {
+  return AddNode(Kind::kScale, a, -1, number);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Transpose(NodeId a) {
+  return AddNode(Kind::kTranspose, a, -1, 0.0);
+}
+
+S21MatrixGraph::NodeId S21MatrixGraph::Inverse(NodeId a) {
+  return AddNode(Kind::kInverse, a, -1, 0.0);
+}
+
+void S21MatrixGraph::Bind(NodeId input, const S21Matrix& value) {
+  CheckNode(input);
+  if (nodes_[input].kind != Kind::kInput) {
+    throw std::invalid_argument("Значение можно привязать только ко входу");
+  }
+  bound_[input] = &value;
+}
+
+S21Matrix S21MatrixGraph::Run(NodeId output) {
+  std::vector<S21Matrix> results = Run(std::vector<NodeId>{output});
+  return std::move(results.front());
+}
+
+std::vector<S21Matrix> S21MatrixGraph::Run(
+    const std::vector<NodeId>& outputs) {
+  for (NodeId id : outputs) CheckNode(id);
+  Plan& plan = FindPlan(outputs);
+
+  for (const std::vector<Step>& level : plan.levels) {
+    if (level.size() == 1) {
+      Execute(plan, level.front());
+      continue;
+    }
+    // Независимые узлы уровня выполняются параллельно: первый — в текущем
+    // потоке, остальные — в пуле
+    std::vector<std::future<void>> pending;
+    for (std::size_t i = 1; i < level.size(); ++i) {
+      auto task = std::make_shared<std::packaged_task<void()>>(
+          [this, &plan, &level, i] { Execute(plan, level[i]); });
+      pending.push_back(task->get_future());
+      S21ThreadPool::Instance().Submit([task] { (*task)(); });
+    }
+    std::exception_ptr error;
+    try {
+      Execute(plan, level.front());
+    } catch (...) {
+      error = std::current_exception();
+    }
+    for (std::future<void>& done : pending) {
+      try {
+        done.get();
+      } catch (...) {
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+  std::vector<S21Matrix> results;
+  results.reserve(outputs.size());
+  for (NodeId id : outputs) {
+    results.emplace_back(Value(plan, id));
+  }
+  return results;
+}
+
+std::size_t S21MatrixGraph::CompiledPlans() const { return plans_.size(); }
+
+S21MatrixGraph::NodeId S21MatrixGraph::AddNode(Kind kind, NodeId a, NodeId b,
+                                               double number) {
+  if (kind != Kind::kInput) CheckNode(a);
+  if (b != -1) CheckNode(b);
+  nodes_.push_back(Node{kind, a, b, number});
+  bound_.push_back(nullptr);
+  return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void S21MatrixGraph::CheckNode(NodeId id) const {
+  if (id < 0 || id >= static_cast<NodeId>(nodes_.size())) {
+    throw std::out_of_range("Узел графа вне диапазона");
+  }
+}
+
+bool S21MatrixGraph::IsElementwise(Kind kind) {
+  return kind == Kind::kAdd || kind == Kind::kSub || kind == Kind::kScale;
+}
+
+std::vector<std::pair<int, int>> S21MatrixGraph::InputShapes() const {
+  std::vector<std::pair<int, int>> shapes;
+  for (std::size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].kind != Kind::kInput) continue;
+    if (bound_[i] == nullptr) {
+      shapes.emplace_back(-1, -1);
+    } else {
+      shapes.emplace_back(bound_[i]->GetRows(), bound_[i]->GetCols());
+    }
+  }
+  return shapes;
+}
+
+S21MatrixGraph::Plan& S21MatrixGraph::FindPlan(
+    const std::vector<NodeId>& outputs) {
+  std::vector<std::pair<int, int>> shapes = InputShapes();
+  for (Plan& plan : plans_) {
+    if (plan.outputs == outputs && plan.input_shapes == shapes) return plan;
+  }
+  plans_.push_back(Compile(outputs));
+  return plans_.back();
+}
+
+S21MatrixGraph::Plan S21MatrixGraph::Compile(
+    const std::vector<NodeId>& outputs) const {
+  const int count = static_cast<int>(nodes_.size());
+  Plan plan;
+  plan.outputs = outputs;
+  plan.input_shapes = InputShapes();
+
+  // Достижимые узлы и число их потребителей
+  std::vector<bool> reachable(count, false);
+  std::vector<int> consumers(count, 0);
+  std::vector<bool> is_output(count, false);
+  std::function<void(NodeId)> visit = [&](NodeId id) {
+    if (reachable[id]) return;
+    reachable[id] = true;
+    const Node& node = nodes_[id];
+    if (node.kind == Kind::kInput) return;
+    visit(node.a);
+    ++consumers[node.a];
+    if (node.b != -1) {
+      visit(node.b);
+      ++consumers[node.b];
+    }
+  };
+  for (NodeId id : outputs) {
+    visit(id);
+    is_output[id] = true;
+  }
+
+  // Вывод размеров (узлы добавляются только после своих операндов, поэтому
+  // порядок номеров уже топологический)
+  std::vector<std::pair<int, int>> shape(count, std::make_pair(0, 0));
+  for (int id = 0; id < count; ++id) {
+    if (!reachable[id]) continue;
+    const Node& node = nodes_[id];
+    switch (node.kind) {
+      case Kind::kInput:
+        if (bound_[id] == nullptr) {
+          throw std::invalid_argument("Вход графа не привязан к матрице");
+        }
+        shape[id] = {bound_[id]->GetRows(), bound_[id]->GetCols()};
+        break;
+      case Kind::kAdd:
+      case Kind::kSub:
+        if (shape[node.a] != shape[node.b]) {
+          throw std::invalid_argument("Размеры матриц не совпадают");
+        }
+        shape[id] = shape[node.a];
+        break;
+      case Kind::kMul:
+        if (shape[node.a].second != shape[node.b].first) {
+          throw std::invalid_argument(
+              "Количество столбцов первой матрицы должно быть равно "
+              "количеству строк второй");
+        }
+        shape[id] = {shape[node.a].first, shape[node.b].second};
+        break;
+      case Kind::kScale:
+        shape[id] = shape[node.a];
+        break;
+      case Kind::kTranspose:
+        shape[id] = {shape[node.a].second, shape[node.a].first};
+        break;
+      case Kind::kInverse:
+        if (shape[node.a].first != shape[node.a].second) {
+          throw std::invalid_argument("Матрица должна быть квадратной");
+        }
+        shape[id] = shape[node.a];
+        break;
+    }
+  }
+
+  // Поэлементный узел с единственным поэлементным потребителем сливается с
+  // ним и не получает собственного буфера
+  std::vector<bool> fused(count, false);
+  for (int id = 0; id < count; ++id) {
+    const Node& node = nodes_[id];
+    if (!reachable[id] || node.kind == Kind::kInput) continue;
+    if (!IsElementwise(node.kind)) continue;
+    for (NodeId operand : {node.a, node.b}) {
+      if (operand != -1 && IsElementwise(nodes_[operand].kind) &&
+          consumers[operand] == 1 && !is_output[operand]) {
+        fused[operand] = true;
+      }
+    }
+  }
+
+  // Шаги плана и их уровни
+  std::vector<int> level(count, -1);
+  std::vector<int> last_use(count, -1);
+  for (int id = 0; id < count; ++id) {
+    if (!reachable[id] || fused[id] || nodes_[id].kind == Kind::kInput) {
+      continue;
+    }
+    Step step;
+    step.node = id;
+    if (IsElementwise(nodes_[id].kind)) {
+      Emit(id, id, fused, &step, 0);
+    } else {
+      step.leaves.push_back(nodes_[id].a);
+      if (nodes_[id].b != -1) step.leaves.push_back(nodes_[id].b);
+    }
+    int depends = -1;
+    for (NodeId leaf : step.leaves) depends = std::max(depends, level[leaf]);
+    level[id] = depends + 1;
+    for (NodeId leaf : step.leaves) {
+      last_use[leaf] = std::max(last_use[leaf], level[id]);
+    }
+    if (static_cast<int>(plan.levels.size()) <= level[id]) {
+      plan.levels.resize(level[id] + 1);
+    }
+    plan.levels[level[id]].push_back(std::move(step));
+  }
+  for (NodeId id : outputs) last_use[id] = INT_MAX;
+
+  // Назначение буферов: значение занимает буфер со своего уровня до уровня
+  // последнего потребителя, после чего буфер может получить другой узел
+  plan.buffer_of.assign(count, -1);
+  std::vector<int> buffer_free_after;  // Последний уровень чтения буфера
+  for (int current = 0; current < static_cast<int>(plan.levels.size());
+       ++current) {
+    for (const Step& step : plan.levels[current]) {
+      int rows = shape[step.node].first;
+      int cols = shape[step.node].second;
+      int chosen = -1;
+      for (std::size_t k = 0; k < plan.buffers.size(); ++k) {
+        if (buffer_free_after[k] < current &&
+            plan.buffers[k].GetRows() == rows &&
+            plan.buffers[k].GetCols() == cols) {
+          chosen = static_cast<int>(k);
+          break;
+        }
+      }
+      if (chosen == -1) {
+        plan.buffers.emplace_back(rows, cols);
+        buffer_free_after.push_back(0);
+        chosen = static_cast<int>(plan.buffers.size() - 1);
+      }
+      buffer_free_after[chosen] = last_use[step.node];
+      plan.buffer_of[step.node] = chosen;
+    }
+  }
+  return plan;
+}
+
+void S21MatrixGraph::Emit(NodeId node, NodeId root,
+                          const std::vector<bool>& fused, Step* step,
+                          int depth) const {
+  const Node& current = nodes_[node];
+  if (node != root && !fused[node]) {
+    step->program.push_back(
+        Instr{Kind::kInput, static_cast<int>(step->leaves.size()), 0.0});
+    step->leaves.push_back(node);
+    step->depth = std::max(step->depth, depth + 1);
+    return;
+  }
+  Emit(current.a, root, fused, step, depth);
+  if (current.b != -1) Emit(current.b, root, fused, step, depth + 1);
+  step->program.push_back(Instr{current.kind, -1, current.number});
+}
+
+void S21MatrixGraph::Execute(Plan& plan, const Step& step) const {
+  const Node& node = nodes_[step.node];
+  S21Matrix& out = plan.buffers[plan.buffer_of[step.node]];
+  if (!step.program.empty()) {
+    double** result = out.GetMatrixPointer();
+    const int rows = out.GetRows();
+    const int cols = out.GetCols();
+    // Слитое выражение вычисляется построчно: промежуточные строки лежат в
+    // небольшом стеке и не покидают кэш
+    std::vector<double> scratch(static_cast<std::size_t>(step.depth) * cols);
+    std::vector<const double*> stack(step.depth);
+    for (int i = 0; i < rows; ++i) {
+      int top = 0;
+      for (const Instr& instr : step.program) {
+        if (instr.kind == Kind::kInput) {
+          const S21Matrix& leaf = Value(plan, step.leaves[instr.leaf]);
+          stack[top++] = leaf.GetConstMatrixPointer()[i];
+          continue;
+        }
+        int slot = instr.kind == Kind::kScale ? top - 1 : top - 2;
+        double* target = &scratch[static_cast<std::size_t>(slot) * cols];
+        if (instr.kind == Kind::kScale) {
+          const double* a = stack[top - 1];
+          for (int j = 0; j < cols; ++j) target[j] = a[j] * instr.number;
+          stack[top - 1] = target;
+        } else {
+          const double* a = stack[top - 2];
+          const double* b = stack[top - 1];
+          if (instr.kind == Kind::kAdd) {
+            for (int j = 0; j < cols; ++j) target[j] = a[j] + b[j];
+          } else {
+            for (int j = 0; j < cols; ++j) target[j] = a[j] - b[j];
+          }
+          stack[top - 2] = target;
+          --top;
+        }
+      }
+      if (cols > 0) {
+        std::memcpy(result[i], stack[0], sizeof(double) * cols);
+      }
+    }
+    return;
+  }
+
+  // Те же блочные многопоточные ядра, что и при немедленном вычислении;
+  // результат пишется в буфер плана без выделения памяти
+  const S21Matrix& a = Value(plan, node.a);
+  switch (node.kind) {
+    case Kind::kMul:
+      S21Matrix::MulInto(a, Value(plan, node.b), &out);
+      break;
+    case Kind::kTranspose:
+      a.TransposeInto(&out);
+      break;
+    case Kind::kInverse:
+      a.InverseInto(&out);
+      break;
+    default:
+      break;
+  }
+}
+
+const S21Matrix& S21MatrixGraph::Value(const Plan& plan, NodeId node) const {
+  if (nodes_[node].kind == Kind::kInput) return *bound_[node];
+  return plan.buffers[plan.buffer_of[node]];
+}
@@ -0,0 +1,122 @@
+#ifndef S21_MATRIX_GRAPH
+#define S21_MATRIX_GRAPH
+
+// Небходимые зависимые директивы
+#include <utility>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+/**
+ * @brief Граф отложенных операций над матрицами.
+ *
+ * Операции не выполняются в момент вызова, а записываются как узлы
+ * ориентированного ациклического графа. Например, X = (A*B + C)^T * D^-1:
+ *
+ * @code
+ *   S21MatrixGraph g;
+ *   auto a = g.Input(), b = g.Input(), c = g.Input(), d = g.Input();
+ *   auto x = g.Mul(g.Transpose(g.Add(g.Mul(a, b), c)), g.Inverse(d));
+ *   g.Bind(a, A); g.Bind(b, B); g.Bind(c, C); g.Bind(d, D);
+ *   S21Matrix X = g.Run(x);
+ * @endcode
+ *
+ * При первом запуске для набора выходов и размеров входов строится план:
+ * - цепочки поэлементных узлов (Add, Sub, Scale) сливаются в один проход по
+ *   памяти без промежуточных матриц;
+ * - узлы разбиваются на уровни, и независимые ветви одного уровня
+ *   выполняются параллельно в S21ThreadPool;
+ * - промежуточные буферы назначаются по времени жизни значений, и буфер
+ *   переиспользуется, как только его последний потребитель выполнен;
+ * - умножение, транспонирование и обращение идут через MulInto,
+ *   TransposeInto и InverseInto — те же блочные многопоточные ядра, что и
+ *   при немедленном вычислении, — с записью прямо в буфер плана.
+ *
+ * Повторный Run() с входами тех же размеров переиспользует готовый план
+ * вместе с его буферами, не выделяя память под промежуточные результаты.
+ *
+ * @note Граф не потокобезопасен, а Run() не следует вызывать из задач
+ * самого S21ThreadPool.
+ */
+class S21MatrixGraph {
+ public:
+  using NodeId = int;
+
+  // Построение графа
+  NodeId Input();  // Входная матрица, значение задаётся через Bind()
+  NodeId Add(NodeId a, NodeId b);
+  NodeId Sub(NodeId a, NodeId b);
+  NodeId Mul(NodeId a, NodeId b);
+  NodeId Scale(NodeId a, double number);
+  NodeId Transpose(NodeId a);
+  NodeId Inverse(NodeId a);
+
+  /**
+   * @brief Привязывает значение ко входному узлу.
+   *
+   * Матрица не копируется и должна оставаться живой до завершения Run().
+   *
+   * @throws std::invalid_argument Если узел не является входом.
+   */
+  void Bind(NodeId input, const S21Matrix& value);
+
+  /**
+   * @brief Вычисляет значения указанных узлов.
+   *
+   * @throws std::invalid_argument Если вход не привязан или размеры
+   * операндов несовместимы.
+   */
+  std::vector<S21Matrix> Run(const std::vector<NodeId>& outputs);
+  S21Matrix Run(NodeId output);
+
+  std::size_t CompiledPlans() const;  // Число построенных планов
+
+ private:
+  enum class Kind { kInput, kAdd, kSub, kMul, kScale, kTranspose, kInverse };
+
+  struct Node {
+    Kind kind;
+    NodeId a, b;
+    double number;
+  };
+
+  // Инструкция слитого поэлементного выражения (стековая машина)
+  struct Instr {
+    Kind kind;      // kInput означает загрузку операнда leaf
+    int leaf;       // Номер операнда для загрузки
+    double number;  // Множитель для kScale
+  };
+
+  struct Step {
+    NodeId node;
+    std::vector<NodeId> leaves;  // Операнды слитого выражения
+    std::vector<Instr> program;  // Пусто для не поэлементных узлов
+    int depth = 0;               // Глубина стека программы
+  };
+
+  struct Plan {
+    std::vector<NodeId> outputs;
+    std::vector<std::pair<int, int>> input_shapes;
+    std::vector<std::vector<Step>> levels;
+    std::vector<int> buffer_of;  // Номер буфера для каждого узла или -1
+    std::vector<S21Matrix> buffers;
+  };
+
+  NodeId AddNode(Kind kind, NodeId a, NodeId b, double number);
+  void CheckNode(NodeId id) const;
+  static bool IsElementwise(Kind kind);
+
+  std::vector<std::pair<int, int>> InputShapes() const;
+  Plan& FindPlan(const std::vector<NodeId>& outputs);
+  Plan Compile(const std::vector<NodeId>& outputs) const;
+  void Emit(NodeId node, NodeId root, const std::vector<bool>& fused,
+            Step* step, int depth) const;
+  void Execute(Plan& plan, const Step& step) const;
+  const S21Matrix& Value(const Plan& plan, NodeId node) const;
+
+  std::vector<Node> nodes_;
+  std::vector<const S21Matrix*> bound_;
+  std::vector<Plan> plans_;
+};
+
+#endif  // S21_MATRIX_GRAPH
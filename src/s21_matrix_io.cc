@@ -0,0 +1,721 @@
+#include "s21_matrix_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+// Строк в одном пакете форматирования на поток при записи CSV
+const int kFormatBatchRows = 1024;
+
+const bool kLittleEndianHost = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+const char kNpyMagic[] = "\x93NUMPY";
+const std::size_t kNpyMagicSize = 6;
+const std::size_t kNpyAlignment = 64;
+
+// Сигнатуры записей ZIP
+const std::uint32_t kZipLocalHeader = 0x04034b50;
+const std::uint32_t kZipCentralHeader = 0x02014b50;
+const std::uint32_t kZipEndOfDirectory = 0x06054b50;
+const std::uint16_t kZip64Extra = 0x0001;
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Не удалось открыть файл " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Не удалось прочитать размер файла " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ != 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Не удалось отобразить файл " + path);
+      }
+      (void)::madvise(data, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(data);
+    }
+    ::close(fd);
+  }
+  ~MappedFile() {
+    if (data_ != nullptr) ::munmap(const_cast<char*>(data_), size_);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const { return data_; }
+  std::size_t Size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// CSV
+
+inline bool IsBlank(char c, char delimiter) {
+  return c == ' ' || c == '\r' || (c == '\t' && delimiter != '\t');
+}
+
+// Конец строки, начинающейся в begin (позиция '\n' или end)
+inline const char* LineEnd(const char* begin, const char* end) {
+  const void* newline = std::memchr(begin, '\n', end - begin);
+  return newline ? static_cast<const char*>(newline) : end;
+}
+
+inline bool IsBlankLine(const char* begin, const char* end, char delimiter) {
+  for (; begin != end; ++begin) {
+    if (!IsBlank(*begin, delimiter)) return false;
+  }
+  return true;
+}
+
+int CountFields(const char* begin, const char* end, char delimiter) {
+  return 1 + static_cast<int>(std::count(begin, end, delimiter));
+}
+
+// Разбирает одну строку ровно из cols чисел в row
+void ParseLine(const char* begin, const char* end, char delimiter, int cols,
+               int row_number, double* row) {
+  const char* cursor = begin;
+  for (int j = 0; j < cols; ++j) {
+    while (cursor != end && IsBlank(*cursor, delimiter)) ++cursor;
+    if (cursor != end && *cursor == '+') ++cursor;
+    double value = 0.0;
+    std::from_chars_result parsed = std::from_chars(cursor, end, value);
+    if (parsed.ec == std::errc::result_out_of_range) {
+      // Как и strtod, переполнение даёт ±inf, а исчезновение порядка — 0
+      value = std::strtod(std::string(cursor, parsed.ptr).c_str(), nullptr);
+      parsed.ec = std::errc();
+    }
+    const char* next = parsed.ptr;
+    while (next != end && IsBlank(*next, delimiter)) ++next;
+    bool last = j == cols - 1;
+    if (parsed.ec != std::errc() ||
+        (last ? next != end : next == end || *next != delimiter)) {
+      throw std::invalid_argument(
+          "Некорректное число в строке " + std::to_string(row_number + 1) +
+          ", столбце " + std::to_string(j + 1));
+    }
+    row[j] = value;
+    cursor = last ? next : next + 1;
+  }
+}
+
+void AppendNumber(double value, int precision, std::string* out) {
+  char buffer[64];
+  std::to_chars_result result =
+      precision > 0 ? std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                    std::chars_format::general, precision)
+                    : std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out->append(buffer, result.ptr);
+}
+
+void FormatRows(const double* const* matrix, int begin, int end, int cols,
+                const S21CsvOptions& options, std::string* out) {
+  for (int i = begin; i < end; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      if (j != 0) out->push_back(options.delimiter);
+      AppendNumber(matrix[i][j], options.precision, out);
+    }
+    out->push_back('\n');
+  }
+}
+
+// Форматирует строки [begin, end) пакетами по kFormatBatchRows параллельно
+// и передаёт готовый текст пакетов в sink по порядку
+template <typename Sink>
+void FormatParallel(const S21Matrix& matrix, const S21CsvOptions& options,
+                    Sink sink) {
+  const int rows = matrix.GetRows(), cols = matrix.GetCols();
+  const double* const* data = matrix.GetConstMatrixPointer();
+  S21ThreadPool& pool = S21ThreadPool::Instance();
+  const int threads = pool.ThreadCount();
+  const int round = kFormatBatchRows * threads;
+  std::vector<std::string> parts(threads);
+  for (int first = 0; first < rows; first += round) {
+    const int last = std::min(rows, first + round);
+    const int batches =
+        (last - first + kFormatBatchRows - 1) / kFormatBatchRows;
+    pool.ParallelRows(batches, 0, [&](int begin, int end) {
+      for (int batch = begin; batch < end; ++batch) {
+        int from = first + batch * kFormatBatchRows;
+        int to = std::min(last, from + kFormatBatchRows);
+        parts[batch].clear();
+        FormatRows(data, from, to, cols, options, &parts[batch]);
+      }
+    });
+    for (int batch = 0; batch < batches; ++batch) sink(parts[batch]);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Двоичные форматы
+
+template <typename T>
+T LoadLittle(const unsigned char* bytes) {
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+template <typename T>
+void StoreLittle(T value, std::string* out) {
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void ReadExactly(std::istream& in, char* data, std::size_t size) {
+  in.read(data, static_cast<std::streamsize>(size));
+  if (static_cast<std::size_t>(in.gcount()) != size) {
+    throw std::runtime_error("Файл закончился раньше ожидаемого");
+  }
+}
+
+// Тип элементов массива .npy
+struct NpyType {
+  char kind = 'f';  // 'f', 'i' или 'u'
+  int size = 8;
+  bool swap = false;  // Порядок байт отличается от порядка хоста
+};
+
+// Значение ключа из заголовка .npy вида {'key': value, ...}
+std::string HeaderValue(const std::string& header, const std::string& key) {
+  std::size_t position = header.find("'" + key + "'");
+  if (position == std::string::npos) {
+    throw std::invalid_argument("В заголовке .npy нет ключа " + key);
+  }
+  position = header.find(':', position);
+  if (position == std::string::npos) {
+    throw std::invalid_argument("Некорректный заголовок .npy");
+  }
+  ++position;
+  while (position < header.size() && header[position] == ' ') ++position;
+  std::size_t end = position;
+  if (end < header.size() && (header[end] == '(' || header[end] == '\'')) {
+    char close = header[end] == '(' ? ')' : '\'';
+    end = header.find(close, end + 1);
+    if (end == std::string::npos) {
+      throw std::invalid_argument("Некорректный заголовок .npy");
+    }
+    ++end;
+  } else {
+    while (end < header.size() && header[end] != ',' && header[end] != '}') {
+      ++end;
+    }
+  }
+  return header.substr(position, end - position);
+}
+
+NpyType ParseDescr(const std::string& quoted) {
+  // Например '<f8', '>i4', '|u1'
+  if (quoted.size() < 5 || quoted.front() != '\'' || quoted.back() != '\'') {
+    throw std::invalid_argument("Некорректный тип элементов .npy: " + quoted);
+  }
+  char order = quoted[1];
+  NpyType type;
+  type.kind = quoted[2];
+  type.size = std::atoi(quoted.c_str() + 3);
+  bool valid_size = type.kind == 'f'
+                        ? type.size == 4 || type.size == 8
+                        : type.size == 1 || type.size == 2 ||
+                              type.size == 4 || type.size == 8;
+  if ((type.kind != 'f' && type.kind != 'i' && type.kind != 'u') ||
+      !valid_size || (order != '<' && order != '>' && order != '|' &&
+                      order != '=')) {
+    throw std::invalid_argument("Неподдерживаемый тип элементов .npy: " +
+                                quoted);
+  }
+  bool little = order == '<' || (order != '>' && kLittleEndianHost);
+  type.swap = type.size > 1 && little != kLittleEndianHost;
+  return type;
+}
+
+template <typename T>
+double DecodeAs(const char* bytes, bool swap) {
+  char copy[sizeof(T)];
+  std::memcpy(copy, bytes, sizeof(T));
+  if (swap) std::reverse(copy, copy + sizeof(T));
+  T value;
+  std::memcpy(&value, copy, sizeof(T));
+  return static_cast<double>(value);
+}
+
+double Decode(const char* bytes, const NpyType& type) {
+  switch (type.kind * 16 + type.size) {
+    case 'f' * 16 + 4:
+      return DecodeAs<float>(bytes, type.swap);
+    case 'f' * 16 + 8:
+      return DecodeAs<double>(bytes, type.swap);
+    case 'i' * 16 + 1:
+      return DecodeAs<std::int8_t>(bytes, false);
+    case 'i' * 16 + 2:
+      return DecodeAs<std::int16_t>(bytes, type.swap);
+    case 'i' * 16 + 4:
+      return DecodeAs<std::int32_t>(bytes, type.swap);
+    case 'i' * 16 + 8:
+      return DecodeAs<std::int64_t>(bytes, type.swap);
+    case 'u' * 16 + 1:
+      return DecodeAs<std::uint8_t>(bytes, false);
+    case 'u' * 16 + 2:
+      return DecodeAs<std::uint16_t>(bytes, type.swap);
+    case 'u' * 16 + 4:
+      return DecodeAs<std::uint32_t>(bytes, type.swap);
+    default:
+      return DecodeAs<std::uint64_t>(bytes, type.swap);
+  }
+}
+
+std::vector<long long> ParseShape(const std::string& tuple) {
+  std::vector<long long> shape;
+  std::string digits;
+  for (char c : tuple) {
+    if (c >= '0' && c <= '9') {
+      digits.push_back(c);
+    } else if (!digits.empty()) {
+      shape.push_back(std::stoll(digits));
+      digits.clear();
+    }
+  }
+  return shape;
+}
+
+// Читает массив .npy с текущей позиции потока
+S21Matrix ReadNpyFrom(std::istream& in) {
+  char prefix[kNpyMagicSize + 2];
+  ReadExactly(in, prefix, sizeof(prefix));
+  if (std::memcmp(prefix, kNpyMagic, kNpyMagicSize) != 0) {
+    throw std::invalid_argument("Данные не в формате .npy");
+  }
+  int major = static_cast<unsigned char>(prefix[kNpyMagicSize]);
+  unsigned char length_bytes[4] = {};
+  ReadExactly(in, reinterpret_cast<char*>(length_bytes), major == 1 ? 2 : 4);
+  std::uint32_t header_length = major == 1
+                                    ? LoadLittle<std::uint16_t>(length_bytes)
+                                    : LoadLittle<std::uint32_t>(length_bytes);
+  std::string header(header_length, '\0');
+  ReadExactly(in, &header[0], header_length);
+
+  NpyType type = ParseDescr(HeaderValue(header, "descr"));
+  bool fortran = HeaderValue(header, "fortran_order") == "True";
+  std::vector<long long> shape = ParseShape(HeaderValue(header, "shape"));
+  if (shape.size() > 2) {
+    throw std::invalid_argument("Поддерживаются только массивы размерности 2");
+  }
+  long long rows = shape.empty() ? 1 : shape[0];
+  long long cols = shape.size() == 2 ? shape[1] : 1;
+  if (rows > std::numeric_limits<int>::max() ||
+      cols > std::numeric_limits<int>::max()) {
+    throw std::invalid_argument("Массив .npy слишком велик для S21Matrix");
+  }
+
+  // В Fortran-порядке файл хранит транспонированную матрицу по строкам
+  int stored_rows = static_cast<int>(fortran ? cols : rows);
+  int stored_cols = static_cast<int>(fortran ? rows : cols);
+  S21Matrix stored(stored_rows, stored_cols);
+  double** data = stored.GetMatrixPointer();
+  std::size_t row_bytes = static_cast<std::size_t>(stored_cols) * type.size;
+  if (type.kind == 'f' && type.size == 8 && !type.swap) {
+    // Совпадающий формат: данные читаются прямо в буфер матрицы
+    bool contiguous =
+        stored_rows < 2 ||
+        data[stored_rows - 1] == data[0] + static_cast<std::size_t>(
+                                               stored_rows - 1) * stored_cols;
+    if (contiguous && stored_rows > 0) {
+      ReadExactly(in, reinterpret_cast<char*>(data[0]),
+                  row_bytes * stored_rows);
+    } else {
+      for (int i = 0; i < stored_rows; ++i) {
+        ReadExactly(in, reinterpret_cast<char*>(data[i]), row_bytes);
+      }
+    }
+  } else {
+    std::vector<char> buffer(row_bytes);
+    for (int i = 0; i < stored_rows; ++i) {
+      ReadExactly(in, buffer.data(), row_bytes);
+      for (int j = 0; j < stored_cols; ++j) {
+        data[i][j] = Decode(buffer.data() + static_cast<std::size_t>(j) *
+                                                type.size,
+                            type);
+      }
+    }
+  }
+  return fortran ? stored.Transpose() : stored;
+}
+
+// Заголовок .npy версии 1.0 для матрицы '<f8' в C-порядке
+std::string NpyHeader(int rows, int cols) {
+  std::string dict = "{'descr': '<f8', 'fortran_order': False, 'shape': (" +
+                     std::to_string(rows) + ", " + std::to_string(cols) +
+                     "), }";
+  std::size_t unpadded = kNpyMagicSize + 2 + 2 + dict.size() + 1;
+  dict.append((kNpyAlignment - unpadded % kNpyAlignment) % kNpyAlignment, ' ');
+  dict.push_back('\n');
+  std::string header(kNpyMagic, kNpyMagicSize);
+  header.push_back('\x01');
+  header.push_back('\x00');
+  StoreLittle(static_cast<std::uint16_t>(dict.size()), &header);
+  return header + dict;
+}
+
+void AppendNpyData(const S21Matrix& matrix, std::string* out) {
+  const double* const* data = matrix.GetConstMatrixPointer();
+  std::size_t row_bytes = static_cast<std::size_t>(matrix.GetCols()) * 8;
+  for (int i = 0; i < matrix.GetRows(); ++i) {
+    const char* row = reinterpret_cast<const char*>(data[i]);
+    if (kLittleEndianHost) {
+      out->append(row, row_bytes);
+    } else {
+      for (int j = 0; j < matrix.GetCols(); ++j) {
+        std::string value(row + j * 8, 8);
+        out->append(value.rbegin(), value.rend());
+      }
+    }
+  }
+}
+
+std::uint32_t Crc32(const std::string& data) {
+  static const std::vector<std::uint32_t> table = [] {
+    std::vector<std::uint32_t> result(256);
+    for (std::uint32_t n = 0; n < 256; ++n) {
+      std::uint32_t c = n;
+      for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      result[n] = c;
+    }
+    return result;
+  }();
+  std::uint32_t crc = 0xffffffffu;
+  for (unsigned char byte : data) crc = table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffffu;
+}
+
+std::ifstream OpenInput(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("Не удалось открыть файл " + path);
+  return in;
+}
+
+std::ofstream OpenOutput(const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("Не удалось создать файл " + path);
+  return out;
+}
+
+void CheckWritten(const std::ofstream& out, const std::string& path) {
+  if (!out) throw std::runtime_error("Ошибка записи в файл " + path);
+}
+
+}  // namespace
+
+S21Matrix S21MatrixIO::ReadCsv(const std::string& path,
+                               const S21CsvOptions& options) {
+  MappedFile file(path);
+  return ParseCsv(file.Data(), file.Size(), options);
+}
+
+S21Matrix S21MatrixIO::ParseCsv(const char* text, std::size_t size,
+                                const S21CsvOptions& options) {
+  const char delimiter = options.delimiter;
+  const char* end = text + size;
+  const char* start = text;
+
+  // Первая непустая строка задаёт число столбцов (после заголовка)
+  const char* first = start;
+  bool header_pending = options.skip_header;
+  int cols = 0;
+  while (first != end) {
+    const char* line_end = LineEnd(first, end);
+    if (!IsBlankLine(first, line_end, delimiter)) {
+      if (header_pending) {
+        header_pending = false;
+        start = line_end == end ? end : line_end + 1;
+      } else {
+        cols = CountFields(first, line_end, delimiter);
+        break;
+      }
+    }
+    first = line_end == end ? end : line_end + 1;
+  }
+  if (cols == 0) return S21Matrix(0, 0);
+
+  // Участки по границам строк, по одному на рабочий поток
+  S21ThreadPool& pool = S21ThreadPool::Instance();
+  const int parts = pool.ThreadCount();
+  std::vector<const char*> bounds(parts + 1, end);
+  bounds[0] = start;
+  for (int k = 1; k < parts; ++k) {
+    const char* guess = start + (end - start) * k / parts;
+    guess = std::max(guess, bounds[k - 1]);
+    const char* line_end = LineEnd(guess, end);
+    bounds[k] = line_end == end ? end : line_end + 1;
+  }
+
+  // Первый проход: число непустых строк в каждом участке
+  std::vector<int> counts(parts, 0);
+  pool.ParallelRows(parts, 0, [&](int begin, int finish) {
+    for (int k = begin; k < finish; ++k) {
+      int count = 0;
+      for (const char* line = bounds[k]; line != bounds[k + 1];) {
+        const char* line_end = LineEnd(line, bounds[k + 1]);
+        if (!IsBlankLine(line, line_end, delimiter)) ++count;
+        line = line_end == bounds[k + 1] ? line_end : line_end + 1;
+      }
+      counts[k] = count;
+    }
+  });
+  std::vector<int> offsets(parts + 1, 0);
+  for (int k = 0; k < parts; ++k) offsets[k + 1] = offsets[k] + counts[k];
+
+  // Второй проход: разбор чисел прямо в строки выделенной матрицы
+  S21Matrix result(offsets[parts], cols);
+  double** rows = result.GetMatrixPointer();
+  pool.ParallelRows(
+      parts, static_cast<std::size_t>(cols) * sizeof(double),
+      [&](int begin, int finish) {
+        for (int k = begin; k < finish; ++k) {
+          int row = offsets[k];
+          for (const char* line = bounds[k]; line != bounds[k + 1];) {
+            const char* line_end = LineEnd(line, bounds[k + 1]);
+            if (!IsBlankLine(line, line_end, delimiter)) {
+              ParseLine(line, line_end, delimiter, cols, row, rows[row]);
+              ++row;
+            }
+            line = line_end == bounds[k + 1] ? line_end : line_end + 1;
+          }
+        }
+      });
+  return result;
+}
+
+void S21MatrixIO::WriteCsv(const S21Matrix& matrix, const std::string& path,
+                           const S21CsvOptions& options) {
+  std::ofstream out = OpenOutput(path);
+  FormatParallel(matrix, options, [&out](const std::string& part) {
+    out.write(part.data(), static_cast<std::streamsize>(part.size()));
+  });
+  out.flush();
+  CheckWritten(out, path);
+}
+
+std::string S21MatrixIO::FormatCsv(const S21Matrix& matrix,
+                                   const S21CsvOptions& options) {
+  std::string text;
+  FormatParallel(matrix, options,
+                 [&text](const std::string& part) { text += part; });
+  return text;
+}
+
+S21Matrix S21MatrixIO::ReadNpy(const std::string& path) {
+  std::ifstream in = OpenInput(path);
+  return ReadNpyFrom(in);
+}
+
+void S21MatrixIO::WriteNpy(const S21Matrix& matrix, const std::string& path) {
+  std::ofstream out = OpenOutput(path);
+  std::string header = NpyHeader(matrix.GetRows(), matrix.GetCols());
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  if (kLittleEndianHost) {
+    // Строки пишутся прямо из буфера матрицы
+    const double* const* data = matrix.GetConstMatrixPointer();
+    std::size_t row_bytes = static_cast<std::size_t>(matrix.GetCols()) * 8;
+    for (int i = 0; i < matrix.GetRows(); ++i) {
+      out.write(reinterpret_cast<const char*>(data[i]),
+                static_cast<std::streamsize>(row_bytes));
+    }
+  } else {
+    std::string data;
+    AppendNpyData(matrix, &data);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+  out.flush();
+  CheckWritten(out, path);
+}
+
+std::vector<std::pair<std::string, S21Matrix>> S21MatrixIO::ReadNpz(
+    const std::string& path) {
+  std::ifstream in = OpenInput(path);
+  in.seekg(0, std::ios::end);
+  const std::streamoff size = in.tellg();
+
+  // Запись конца центрального каталога ищется с конца файла: за ней может
+  // идти комментарий архива длиной до 64 КиБ
+  const std::streamoff tail = std::min<std::streamoff>(size, 65535 + 22);
+  std::string buffer(static_cast<std::size_t>(tail), '\0');
+  in.seekg(size - tail);
+  ReadExactly(in, &buffer[0], buffer.size());
+  std::size_t eocd = std::string::npos;
+  for (std::size_t i = buffer.size() < 22 ? 0 : buffer.size() - 21; i-- > 0;) {
+    if (LoadLittle<std::uint32_t>(reinterpret_cast<const unsigned char*>(
+            &buffer[i])) == kZipEndOfDirectory) {
+      eocd = i;
+      break;
+    }
+  }
+  if (eocd == std::string::npos) {
+    throw std::invalid_argument("Файл не является архивом .npz");
+  }
+  const unsigned char* end_record =
+      reinterpret_cast<const unsigned char*>(&buffer[eocd]);
+  const std::uint16_t entries = LoadLittle<std::uint16_t>(end_record + 10);
+  const std::uint32_t directory = LoadLittle<std::uint32_t>(end_record + 16);
+
+  std::vector<std::pair<std::string, S21Matrix>> arrays;
+  std::streamoff position = directory;
+  for (int e = 0; e < entries; ++e) {
+    unsigned char record[46];
+    in.seekg(position);
+    ReadExactly(in, reinterpret_cast<char*>(record), sizeof(record));
+    if (LoadLittle<std::uint32_t>(record) != kZipCentralHeader) {
+      throw std::invalid_argument("Повреждён центральный каталог .npz");
+    }
+    const std::uint16_t method = LoadLittle<std::uint16_t>(record + 10);
+    const std::uint32_t compressed = LoadLittle<std::uint32_t>(record + 20);
+    const std::uint32_t uncompressed = LoadLittle<std::uint32_t>(record + 24);
+    const std::uint16_t name_length = LoadLittle<std::uint16_t>(record + 28);
+    const std::uint16_t extra_length = LoadLittle<std::uint16_t>(record + 30);
+    const std::uint16_t comment_length = LoadLittle<std::uint16_t>(record + 32);
+    std::uint64_t local = LoadLittle<std::uint32_t>(record + 42);
+    std::string name(name_length, '\0');
+    ReadExactly(in, &name[0], name_length);
+    std::string extra(extra_length, '\0');
+    ReadExactly(in, &extra[0], extra_length);
+    position += 46 + name_length + extra_length + comment_length;
+
+    if (method != 0) {
+      throw std::invalid_argument(
+          "Сжатые записи .npz (np.savez_compressed) не поддерживаются: " +
+          name);
+    }
+    // Смещение больше 4 ГиБ хранится в дополнительном поле ZIP64 после
+    // 64-битных размеров, если те тоже вынесены туда
+    if (local == 0xffffffffu) {
+      for (std::size_t at = 0; at + 4 <= extra.size();) {
+        const unsigned char* field =
+            reinterpret_cast<const unsigned char*>(&extra[at]);
+        std::uint16_t id = LoadLittle<std::uint16_t>(field);
+        std::uint16_t length = LoadLittle<std::uint16_t>(field + 2);
+        if (id == kZip64Extra) {
+          std::size_t skip = (uncompressed == 0xffffffffu ? 8 : 0) +
+                             (compressed == 0xffffffffu ? 8 : 0);
+          if (skip + 8 <= length) {
+            local = LoadLittle<std::uint64_t>(field + 4 + skip);
+          }
+          break;
+        }
+        at += 4 + length;
+      }
+    }
+
+    unsigned char header[30];
+    in.seekg(static_cast<std::streamoff>(local));
+    ReadExactly(in, reinterpret_cast<char*>(header), sizeof(header));
+    if (LoadLittle<std::uint32_t>(header) != kZipLocalHeader) {
+      throw std::invalid_argument("Повреждена запись архива .npz: " + name);
+    }
+    in.seekg(static_cast<std::streamoff>(local) + 30 +
+             LoadLittle<std::uint16_t>(header + 26) +
+             LoadLittle<std::uint16_t>(header + 28));
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+      name.resize(name.size() - 4);
+    }
+    arrays.emplace_back(name, ReadNpyFrom(in));
+  }
+  return arrays;
+}
+
+void S21MatrixIO::WriteNpz(
+    const std::vector<std::pair<std::string, const S21Matrix*>>& arrays,
+    const std::string& path) {
+  if (arrays.size() > 0xffff) {
+    throw std::invalid_argument("Слишком много массивов для архива .npz");
+  }
+  std::ofstream out = OpenOutput(path);
+  std::string directory;
+  std::uint64_t offset = 0;
+  for (const auto& entry : arrays) {
+    const std::string name = entry.first + ".npy";
+    const S21Matrix& matrix = *entry.second;
+    std::string payload = NpyHeader(matrix.GetRows(), matrix.GetCols());
+    AppendNpyData(matrix, &payload);
+    if (payload.size() > 0xfffffffeu || offset > 0xfffffffeu) {
+      throw std::invalid_argument(
+          "Запись архивов .npz больше 4 ГиБ не поддерживается");
+    }
+    const std::uint32_t crc = Crc32(payload);
+    const std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+
+    // Общая часть локального заголовка и записи каталога: версия,
+    // флаги, метод 0 (без сжатия), время и дата 1980-01-01, CRC и размеры
+    std::string common;
+    StoreLittle<std::uint16_t>(20, &common);
+    StoreLittle<std::uint16_t>(0, &common);
+    StoreLittle<std::uint16_t>(0, &common);
+    StoreLittle<std::uint16_t>(0, &common);
+    StoreLittle<std::uint16_t>(0x21, &common);
+    StoreLittle<std::uint32_t>(crc, &common);
+    StoreLittle<std::uint32_t>(length, &common);
+    StoreLittle<std::uint32_t>(length, &common);
+    StoreLittle<std::uint16_t>(static_cast<std::uint16_t>(name.size()),
+                               &common);
+    StoreLittle<std::uint16_t>(0, &common);
+
+    std::string local;
+    StoreLittle<std::uint32_t>(kZipLocalHeader, &local);
+    local += common + name;
+    out.write(local.data(), static_cast<std::streamsize>(local.size()));
+    out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+
+    StoreLittle<std::uint32_t>(kZipCentralHeader, &directory);
+    StoreLittle<std::uint16_t>(20, &directory);  // Версия создателя
+    directory += common;
+    StoreLittle<std::uint16_t>(0, &directory);  // Длина комментария
+    StoreLittle<std::uint16_t>(0, &directory);  // Номер диска
+    StoreLittle<std::uint16_t>(0, &directory);  // Внутренние атрибуты
+    StoreLittle<std::uint32_t>(0, &directory);  // Внешние атрибуты
+    StoreLittle<std::uint32_t>(static_cast<std::uint32_t>(offset),
+                               &directory);
+    directory += name;
+    offset += local.size() + payload.size();
+  }
+  if (offset + directory.size() > 0xfffffffeu) {
+    throw std::invalid_argument(
+        "Запись архивов .npz больше 4 ГиБ не поддерживается");
+  }
+
+  std::string end_record;
+  StoreLittle<std::uint32_t>(kZipEndOfDirectory, &end_record);
+  StoreLittle<std::uint16_t>(0, &end_record);
+  StoreLittle<std::uint16_t>(0, &end_record);
+  StoreLittle<std::uint16_t>(static_cast<std::uint16_t>(arrays.size()),
+                             &end_record);
+  StoreLittle<std::uint16_t>(static_cast<std::uint16_t>(arrays.size()),
+                             &end_record);
+  StoreLittle<std::uint32_t>(static_cast<std::uint32_t>(directory.size()),
+                             &end_record);
+  StoreLittle<std::uint32_t>(static_cast<std::uint32_t>(offset), &end_record);
+  StoreLittle<std::uint16_t>(0, &end_record);
+  out.write(directory.data(), static_cast<std::streamsize>(directory.size()));
+  out.write(end_record.data(), static_cast<std::streamsize>(end_record.size()));
+  out.flush();
+  CheckWritten(out, path);
+}
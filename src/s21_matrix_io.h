@@ -0,0 +1,63 @@
+#ifndef S21_MATRIX_IO
+#define S21_MATRIX_IO
+
+// Небходимые зависимые директивы
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Параметры чтения и записи текстовых таблиц
+struct S21CsvOptions {
+  char delimiter = ',';      // '\t' для TSV
+  bool skip_header = false;  // Пропустить первую непустую строку
+  int precision = 0;  // Значащих цифр при записи; 0 — кратчайшая запись,
+                      // которая читается обратно без потерь
+};
+
+/**
+ * @brief Импорт и экспорт S21Matrix в CSV/TSV и форматы NumPy .npy/.npz.
+ *
+ * Текст разбирается параллельно: файл отображается в память через mmap и
+ * делится на участки по границам строк, по одному на поток S21ThreadPool.
+ * Первый проход считает строки, после чего матрица выделяется один раз, а
+ * второй проход разбирает числа (std::from_chars) прямо в её строки.
+ *
+ * Файлы .npy с типом '<f8' в C-порядке читаются одним read() прямо в
+ * буфер матрицы без промежуточных копий; прочие числовые типы, порядок
+ * байт и Fortran-порядок преобразуются при чтении. Из архивов .npz
+ * читаются несжатые записи (np.savez); записи np.savez_compressed требуют
+ * zlib и отклоняются.
+ *
+ * Ошибки ввода-вывода сообщаются через std::runtime_error, ошибки формата —
+ * через std::invalid_argument.
+ */
+class S21MatrixIO {
+ public:
+  static S21Matrix ReadCsv(const std::string& path,
+                           const S21CsvOptions& options = S21CsvOptions());
+  static S21Matrix ParseCsv(const char* text, std::size_t size,
+                            const S21CsvOptions& options = S21CsvOptions());
+
+  // Строки форматируются параллельно пакетами и записываются по мере
+  // готовности, поэтому весь текст в памяти не хранится
+  static void WriteCsv(const S21Matrix& matrix, const std::string& path,
+                       const S21CsvOptions& options = S21CsvOptions());
+  static std::string FormatCsv(const S21Matrix& matrix,
+                               const S21CsvOptions& options = S21CsvOptions());
+
+  // Одномерный массив читается как столбец n x 1, скаляр — как 1 x 1
+  static S21Matrix ReadNpy(const std::string& path);
+  static void WriteNpy(const S21Matrix& matrix, const std::string& path);
+
+  // Пары "имя массива — матрица" в порядке записи в архиве
+  static std::vector<std::pair<std::string, S21Matrix>> ReadNpz(
+      const std::string& path);
+  static void WriteNpz(
+      const std::vector<std::pair<std::string, const S21Matrix*>>& arrays,
+      const std::string& path);
+};
+
+#endif  // S21_MATRIX_IO
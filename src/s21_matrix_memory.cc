@@ -0,0 +1,319 @@
+#include "s21_matrix_memory.h"
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Буферы от 256 КиБ выделяются через mmap
+const std::size_t kLargeBytes = 256 * 1024;
+
+const std::size_t kHugePageBytes = 2 * 1024 * 1024;
+
+// Объём списка свободных буферов по умолчанию
+const std::size_t kDefaultCacheLimit = 256 * 1024 * 1024;
+
+inline std::size_t RoundUp(std::size_t value, std::size_t step) {
+  return (value + step - 1) / step * step;
+}
+
+// Анонимное отображение length байт, выровненное на alignment: лишние
+// страницы до и после выровненного участка сразу возвращаются системе
+void* MapAligned(std::size_t length, std::size_t alignment) {
+  std::size_t span = length + alignment;
+  void* raw = ::mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) return nullptr;
+  std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(raw);
+  std::uintptr_t aligned = RoundUp(begin, alignment);
+  if (aligned != begin) ::munmap(raw, aligned - begin);
+  std::size_t tail = span - (aligned - begin) - length;
+  if (tail != 0) ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+  return reinterpret_cast<void*>(aligned);
+}
+
+// Режимы mbind из <linux/mempolicy.h>
+const int kMpolBind = 2;
+const int kMpolInterleave = 3;
+
+// Соответствие процессоров узлам NUMA; пустое, если топология неизвестна
+const std::vector<int>& CpuNodes() {
+  static const std::vector<int> nodes = [] {
+    std::vector<int> result;
+    for (int node = 0;; ++node) {
+      std::ifstream list("/sys/devices/system/node/node" +
+                         std::to_string(node) + "/cpulist");
+      if (!list) break;
+      std::string text;
+      std::getline(list, text);
+      std::stringstream ranges(text);
+      std::string range;
+      while (std::getline(ranges, range, ',')) {
+        if (range.empty()) continue;
+        std::size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos
+                       ? first
+                       : std::stoi(range.substr(dash + 1));
+        if (static_cast<int>(result.size()) <= last) {
+          result.resize(last + 1, 0);
+        }
+        for (int cpu = first; cpu <= last; ++cpu) result[cpu] = node;
+      }
+    }
+    return result;
+  }();
+  return nodes;
+}
+
+void ApplyPolicy(void* data, std::size_t bytes, S21NumaPolicy policy,
+                 int node) {
+#ifdef SYS_mbind
+  if (policy != S21NumaPolicy::kInterleave && policy != S21NumaPolicy::kBind) {
+    return;
+  }
+  int nodes = S21MatrixMemory::NodeCount();
+  if (nodes < 2 || nodes > 64) return;
+  unsigned long mask = 0;
+  int mode = kMpolInterleave;
+  if (policy == S21NumaPolicy::kInterleave) {
+    mask = nodes == 64 ? ~0UL : (1UL << nodes) - 1;
+  } else {
+    mode = kMpolBind;
+    mask = 1UL << node;
+  }
+  // Ошибка mbind не критична: страницы просто разместятся по умолчанию
+  (void)syscall(SYS_mbind, data, bytes, mode, &mask, sizeof(mask) * 8, 0);
+#else
+  (void)data;
+  (void)bytes;
+  (void)policy;
+  (void)node;
+#endif
+}
+
+}  // namespace
+
+S21MatrixMemory::S21MatrixMemory() : cache_limit_(kDefaultCacheLimit) {
+  // Процесс, порождённый fork(), не должен унаследовать замок, захваченный
+  // другим потоком (S21SocketTransport::Launch)
+  ::pthread_atfork([] { Instance().mutex_.lock(); },
+                   [] { Instance().mutex_.unlock(); },
+                   [] { Instance().mutex_.unlock(); });
+}
+
+S21MatrixMemory& S21MatrixMemory::Instance() {
+  // Не уничтожается при выходе: матрицы в других статических объектах
+  // освобождают память в своих деструкторах
+  static S21MatrixMemory* instance = new S21MatrixMemory();
+  return *instance;
+}
+
+void S21MatrixMemory::SetNumaPolicy(S21NumaPolicy policy, int node) {
+  if (node < 0) {
+    throw std::invalid_argument("Номер узла NUMA не может быть отрицательным");
+  }
+  if (policy == S21NumaPolicy::kBind && node >= NodeCount()) {
+    throw std::invalid_argument("Узла NUMA с номером " +
+                                std::to_string(node) + " нет");
+  }
+  node_.store(node, std::memory_order_relaxed);
+  policy_.store(policy, std::memory_order_relaxed);
+}
+
+S21NumaPolicy S21MatrixMemory::GetNumaPolicy() const {
+  return policy_.load(std::memory_order_relaxed);
+}
+
+double* S21MatrixMemory::Allocate(std::size_t count, bool* needs_first_touch) {
+  *needs_first_touch = false;
+  if (!IsLarge(count)) {
+    return new double[count]();
+  }
+  std::size_t bytes = count * sizeof(double);
+  S21NumaPolicy policy = GetNumaPolicy();
+  int node = node_.load(std::memory_order_relaxed);
+  S21HugePages huge = GetHugePages();
+
+  Block block{nullptr, 0, policy, node, huge};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+      if (it->length >= bytes && it->length - bytes < kLargeBytes &&
+          it->policy == policy && it->node == node && it->huge == huge) {
+        block = *it;
+        stats_.cached_bytes -= it->length;
+        ++stats_.reuses;
+        free_.erase(it);
+        break;
+      }
+    }
+  }
+  bool reused = block.data != nullptr;
+  if (!reused) block = Map(bytes, policy, node, huge);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_[block.data] = block;
+  }
+
+  double* data = static_cast<double*>(block.data);
+  if (policy == S21NumaPolicy::kFirstTouch) {
+    // Анонимные страницы mmap уже нулевые, но касаться их первым должен
+    // рабочий поток, который затем обрабатывает строки
+    *needs_first_touch = true;
+  } else if (reused) {
+    std::fill(data, data + count, 0.0);
+  }
+  return data;
+}
+
+void S21MatrixMemory::Free(double* data, std::size_t count) noexcept {
+  // Вызывается из деструктора матрицы, где исключение всё равно завершило
+  // бы программу, только без сообщения
+  if (!TryFree(data, count)) {
+    std::fprintf(stderr,
+                 "S21MatrixMemory::Free: буфер %p не выделен распределителем "
+                 "или уже освобождён\n",
+                 static_cast<void*>(data));
+    std::abort();
+  }
+}
+
+bool S21MatrixMemory::TryFree(double* data, std::size_t count) {
+  if (data == nullptr) return true;
+  if (!IsLarge(count)) {
+    delete[] data;
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = live_.find(data);
+  if (it == live_.end()) return false;
+  Block block = it->second;
+  live_.erase(it);
+  free_.push_front(block);
+  stats_.cached_bytes += block.length;
+  EvictOverLimit();
+  return true;
+}
+
+void S21MatrixMemory::SetHugePages(S21HugePages mode) {
+  huge_.store(mode, std::memory_order_relaxed);
+}
+
+S21HugePages S21MatrixMemory::GetHugePages() const {
+  return huge_.load(std::memory_order_relaxed);
+}
+
+void S21MatrixMemory::SetCacheLimit(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_limit_ = bytes;
+  EvictOverLimit();
+}
+
+std::size_t S21MatrixMemory::CacheLimit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_limit_;
+}
+
+void S21MatrixMemory::TrimCache() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Block& block : free_) {
+    ::munmap(block.data, block.length);
+    ++stats_.unmaps;
+  }
+  free_.clear();
+  stats_.cached_bytes = 0;
+}
+
+S21MemoryStats S21MatrixMemory::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::size_t S21MatrixMemory::LargeThreshold() const { return kLargeBytes; }
+
+int S21MatrixMemory::NodeCount() {
+  int count = 1;
+  for (int node : CpuNodes()) count = std::max(count, node + 1);
+  return count;
+}
+
+int S21MatrixMemory::NodeOfCpu(int cpu) {
+  const std::vector<int>& nodes = CpuNodes();
+  if (cpu < 0 || cpu >= static_cast<int>(nodes.size())) return 0;
+  return nodes[cpu];
+}
+
+bool S21MatrixMemory::IsLarge(std::size_t count) const {
+  return count * sizeof(double) >= kLargeBytes;
+}
+
+S21MatrixMemory::Block S21MatrixMemory::Map(std::size_t bytes,
+                                            S21NumaPolicy policy, int node,
+                                            S21HugePages huge) {
+  Block block{nullptr, 0, policy, node, huge};
+  bool hugetlb = false;
+  if (huge == S21HugePages::kOff) {
+    block.length = RoundUp(bytes, static_cast<std::size_t>(::getpagesize()));
+    void* data = ::mmap(nullptr, block.length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    block.data = data == MAP_FAILED ? nullptr : data;
+  } else {
+    block.length = RoundUp(bytes, kHugePageBytes);
+#ifdef MAP_HUGETLB
+    if (huge == S21HugePages::kExplicit) {
+      void* data = ::mmap(nullptr, block.length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (data != MAP_FAILED) {
+        block.data = data;
+        hugetlb = true;
+      }
+    }
+#endif
+    if (block.data == nullptr) {
+      block.data = MapAligned(block.length, kHugePageBytes);
+#ifdef MADV_HUGEPAGE
+      // Отказ madvise (например, THP выключены) не мешает работе
+      if (block.data != nullptr) {
+        (void)::madvise(block.data, block.length, MADV_HUGEPAGE);
+      }
+#endif
+    }
+  }
+  if (block.data == nullptr) {
+    // Под давлением памяти сначала отдаём системе свободные буферы
+    TrimCache();
+    block.data = ::mmap(nullptr, block.length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block.data == MAP_FAILED) throw std::bad_alloc();
+  }
+  ApplyPolicy(block.data, block.length, policy, node);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.maps;
+  if (hugetlb) ++stats_.huge_maps;
+  return block;
+}
+
+void S21MatrixMemory::EvictOverLimit() {
+  while (stats_.cached_bytes > cache_limit_ && !free_.empty()) {
+    const Block& oldest = free_.back();
+    ::munmap(oldest.data, oldest.length);
+    stats_.cached_bytes -= oldest.length;
+    ++stats_.unmaps;
+    free_.pop_back();
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef S21_MATRIX_MEMORY
+#define S21_MATRIX_MEMORY
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// Политика размещения больших буферов матриц по узлам NUMA
+enum class S21NumaPolicy {
+  kDefault,     // Политика ядра по умолчанию (первое касание любым потоком)
+  kInterleave,  // Страницы чередуются по всем узлам
+  kFirstTouch,  // Строки обнуляются тем рабочим потоком пула, который
+                // затем обрабатывает их в параллельных ядрах
+  kBind         // Все страницы размещаются на одном узле
+};
+
+// Использование страниц по 2 МиБ для больших буферов
+enum class S21HugePages {
+  kOff,          // Обычные страницы
+  kTransparent,  // Буфер выравнивается на 2 МиБ и помечается MADV_HUGEPAGE
+  kExplicit      // MAP_HUGETLB из пула hugetlbfs; при нехватке страниц —
+                 // как kTransparent
+};
+
+// Счётчики распределителя
+struct S21MemoryStats {
+  std::uint64_t maps = 0;       // Новых отображений mmap
+  std::uint64_t unmaps = 0;     // Возвратов памяти системе
+  std::uint64_t reuses = 0;     // Выделений из списка свободных буферов
+  std::uint64_t huge_maps = 0;  // Отображений, получивших MAP_HUGETLB
+  std::size_t cached_bytes = 0;  // Объём буферов в списке свободных
+};
+
+/**
+ * @brief Распределитель памяти для элементов S21Matrix.
+ *
+ * Маленькие матрицы выделяются обычным образом, а буферы от
+ * LargeThreshold() байт — через mmap, что позволяет применить к ним политику
+ * NUMA (mbind) и отложить первое касание страниц до нужного потока.
+ *
+ * На системах без NUMA или без поддержки mbind политика молча
+ * игнорируется, и поведение совпадает с kDefault.
+ *
+ * Освобождённые большие буферы не сразу возвращаются системе, а попадают в
+ * общий для процесса список свободных (до CacheLimit() байт). Временные
+ * матрицы одной формы, которые создают operator* и InverseMatrix, получают
+ * уже отображённые страницы и не платят за повторные page fault. Буфер
+ * переиспользуется только при совпадении размера, политики NUMA и режима
+ * huge pages.
+ */
+class S21MatrixMemory {
+ public:
+  static S21MatrixMemory& Instance();
+
+  // std::invalid_argument для отрицательного node, а для kBind — и для
+  // node не меньше NodeCount()
+  void SetNumaPolicy(S21NumaPolicy policy, int node = 0);
+  S21NumaPolicy GetNumaPolicy() const;
+
+  /**
+   * @brief Выделяет буфер из count элементов.
+   *
+   * Буфер обнулён, кроме больших буферов под политикой kFirstTouch: для них
+   * needs_first_touch выставляется в true, и обнулять их должен вызывающий
+   * код параллельно по строкам, чтобы страницы оказались рядом с рабочими
+   * потоками.
+   */
+  double* Allocate(std::size_t count, bool* needs_first_touch);
+  // Освобождает буфер из Allocate; если большой буфер не выдан Allocate
+  // или уже освобождён, пишет сообщение в stderr и вызывает std::abort()
+  void Free(double* data, std::size_t count) noexcept;
+  // То же, но для чужого или уже освобождённого большого буфера ничего не
+  // делает и возвращает false
+  bool TryFree(double* data, std::size_t count);
+
+  std::size_t LargeThreshold() const;  // Порог "большого" буфера в байтах
+
+  void SetHugePages(S21HugePages mode);
+  S21HugePages GetHugePages() const;
+
+  void SetCacheLimit(std::size_t bytes);  // 0 отключает список свободных
+  std::size_t CacheLimit() const;
+  void TrimCache();  // Возвращает системе все свободные буферы
+  S21MemoryStats Stats() const;
+
+  // Топология NUMA, считанная из /sys/devices/system/node
+  static int NodeCount();
+  static int NodeOfCpu(int cpu);
+
+ private:
+  S21MatrixMemory();
+
+  // Большой буфер и параметры, с которыми он был отображён
+  struct Block {
+    void* data;
+    std::size_t length;  // Длина отображения (кратна размеру страницы)
+    S21NumaPolicy policy;
+    int node;
+    S21HugePages huge;
+  };
+
+  bool IsLarge(std::size_t count) const;
+  Block Map(std::size_t bytes, S21NumaPolicy policy, int node,
+            S21HugePages huge);
+  void EvictOverLimit();  // Вызывается под mutex_
+
+  std::atomic<S21NumaPolicy> policy_{S21NumaPolicy::kDefault};
+  std::atomic<int> node_{0};
+  std::atomic<S21HugePages> huge_{S21HugePages::kOff};
+
+  mutable std::mutex mutex_;
+  std::unordered_map<void*, Block> live_;  // Выданные большие буферы
+  std::list<Block> free_;  // Свободные буферы, недавние в начале
+  std::size_t cache_limit_;
+  S21MemoryStats stats_;
+};
+
+#endif  // S21_MATRIX_MEMORY
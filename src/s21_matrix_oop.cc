@@ -1,10 +1,169 @@
 #include "s21_matrix_oop.h"
 
-S21Matrix::S21Matrix() : rows_(0), cols_(0), matrix_(nullptr) {
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "s21_matrix_cache.h"
+#include "s21_matrix_factor.h"
+#include "s21_matrix_memory.h"
+#include "s21_matrix_profile.h"
+#include "s21_matrix_tune.h"
+
+namespace {
+
+// Оценка числа операций разложения определителя по строке
+inline std::uint64_t CofactorFlops(int n) {
+  std::uint64_t flops = n >= 2 ? 3 : 0;
+  for (int k = 3; k <= n && flops < (UINT64_MAX >> 4); ++k) {
+    flops = static_cast<std::uint64_t>(k) * (flops + 2);
+  }
+  return flops;
+}
+
+inline std::uint64_t Elements(int rows, int cols) {
+  return static_cast<std::uint64_t>(rows) * static_cast<std::uint64_t>(cols);
+}
+
+// Бросает S21Cancelled, если задана и отменена операция
+inline void ThrowIfCancelled(const S21CancelToken* cancel) {
+  if (cancel != nullptr && cancel->IsCancelled()) throw S21Cancelled();
+}
+
+// Рабочий буфер разложения по строке для матрицы n x n: списки строк и
+// столбцов и списки столбцов вложенных миноров. Растёт, но не сжимается,
+// поэтому после первого вызова память не выделяется
+int* CofactorScratch(int n) {
+  thread_local std::vector<int> scratch;
+  const std::size_t size = static_cast<std::size_t>(n) * (n + 2) + 1;
+  if (scratch.size() < size) scratch.resize(size);
+  for (int i = 0; i < n; ++i) scratch[i] = scratch[n + i] = i;
+  return scratch.data();
+}
+
+// Определитель подматрицы на строках rows[0..n) и столбцах cols[0..n)
+// разложением по первой строке — в том же порядке операций, что и через
+// копии миноров, но без них: столбцы вложенного минора пишутся в scratch
+double CofactorDeterminant(const double* const* m, const int* rows,
+                           const int* cols, int n, int* scratch) {
+  if (n == 2) {
+    return m[rows[0]][cols[0]] * m[rows[1]][cols[1]] -
+           m[rows[1]][cols[0]] * m[rows[0]][cols[1]];
+  }
+  if (n == 1) {
+    return m[rows[0]][cols[0]];
+  }
+  double det = 0.0;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0, k = 0; j < n; ++j) {
+      if (j != i) scratch[k++] = cols[j];
+    }
+    det += (i % 2 == 0 ? 1 : -1) * m[rows[0]][cols[i]] *
+           CofactorDeterminant(m, rows + 1, scratch, n - 1, scratch + n - 1);
+  }
+  return det;
+}
+
+// Длина блока сравнения: внутри блока цикл без ветвлений векторизуется
+// компилятором, а между блоками проверяется ранний выход
+const int kCompareBlock = 64;
+
+// Проверяет match(a, b) для всех пар элементов одинаковых по форме матриц
+template <typename Match>
+bool AllElementsMatch(double** a, double** b, int rows, int cols,
+                      Match match) {
+  for (int i = 0; i < rows; ++i) {
+    const double* row_a = a[i];
+    const double* row_b = b[i];
+    for (int begin = 0; begin < cols; begin += kCompareBlock) {
+      const int end = std::min(cols, begin + kCompareBlock);
+      bool equal = true;
+      for (int j = begin; j < end; ++j) equal &= match(row_a[j], row_b[j]);
+      if (!equal) return false;
+    }
+  }
+  return true;
+}
+
+// Отображение double в целые, монотонное по значению: соседние числа
+// отличаются на единицу, +0 и -0 совпадают
+inline std::int64_t OrderedBits(double value) {
+  std::int64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+}
+
+// Вес поэлементной операции относительно умножения-сложения: такие
+// операции упираются в память и окупают потоки на меньших матрицах
+const std::uint64_t kElementwiseWeight = 16;
+
+// Режим копирования при записи для вновь выделяемых матриц
+std::atomic<bool> copy_on_write{false};
+
+// c = alpha * a * b + beta * c для матриц rows x inner и inner x width;
+// при beta == 0 c перезаписывается без чтения. Порядок i-k-j: внутренний
+// цикл идёт по строкам c и b подряд. Полосы block_k x block_n матрицы b
+// переиспользуются всеми строками участка, пока лежат в кэше; каждый
+// элемент c по-прежнему накапливается по k подряд, поэтому результат не
+// зависит от размеров блоков
+void MultiplyInto(const double* const* a, const double* const* b, double** c,
+                  int rows, int inner, int width, double alpha = 1.0,
+                  double beta = 0.0) {
+  const S21TuneParams params = S21Tuner::Instance().Params();
+  const int block_k = params.gemm_block_k, block_n = params.gemm_block_n;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows, 2 * Elements(rows, width) * inner, (inner + width) * sizeof(double),
+      [a, b, c, inner, width, block_k, block_n, alpha, beta](int begin,
+                                                             int end) {
+        for (int i = begin; i < end; ++i) {
+          if (beta == 0.0) {
+            std::fill(c[i], c[i] + width, 0.0);
+          } else if (beta != 1.0) {
+            for (int j = 0; j < width; ++j) c[i][j] *= beta;
+          }
+        }
+        for (int jj = 0; jj < width; jj += block_n) {
+          const int j_end = std::min(width, jj + block_n);
+          for (int kk = 0; kk < inner; kk += block_k) {
+            const int k_end = std::min(inner, kk + block_k);
+            for (int i = begin; i < end; ++i) {
+              double* row = c[i];
+              for (int k = kk; k < k_end; ++k) {
+                const double factor = alpha * a[i][k];
+                const double* b_row = b[k];
+                for (int j = jj; j < j_end; ++j) {
+                  row[j] += factor * b_row[j];
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+}  // namespace
+
+S21Matrix::S21Matrix()
+    : rows_(0),
+      cols_(0),
+      matrix_(nullptr),
+      data_(nullptr),
+      refs_(nullptr),
+      capacity_(0),
+      row_capacity_(0) {
   // Дефолтный конструктор инициализирует матрицу нулевыми значениями
 }
 
-S21Matrix::S21Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
+S21Matrix::S21Matrix(int rows, int cols)
+    : rows_(rows),
+      cols_(cols),
+      matrix_(nullptr),
+      data_(nullptr),
+      refs_(nullptr),
+      capacity_(0),
+      row_capacity_(0) {
   if (rows < 0 || cols < 0) {
     throw std::invalid_argument(
         "Строки и столбцы должны быть положительными числами");
@@ -13,15 +172,35 @@ S21Matrix::S21Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
 }
 
 S21Matrix::S21Matrix(const S21Matrix& other)
-    : rows_(0), cols_(0), matrix_(nullptr) {
-  CopyMatrix(other);
+    : rows_(0),
+      cols_(0),
+      matrix_(nullptr),
+      data_(nullptr),
+      refs_(nullptr),
+      capacity_(0),
+      row_capacity_(0) {
+  if (other.refs_) {
+    ShareMatrix(other);
+  } else {
+    CopyMatrix(other);
+  }
 }
 
 S21Matrix::S21Matrix(S21Matrix&& other) noexcept
-    : rows_(other.rows_), cols_(other.cols_), matrix_(other.matrix_) {
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      matrix_(other.matrix_),
+      data_(other.data_),
+      refs_(other.refs_),
+      capacity_(other.capacity_),
+      row_capacity_(other.row_capacity_) {
   other.rows_ = 0;
   other.cols_ = 0;
   other.matrix_ = nullptr;
+  other.data_ = nullptr;
+  other.refs_ = nullptr;
+  other.capacity_ = 0;
+  other.row_capacity_ = 0;
 }
 
 S21Matrix& S21Matrix::operator=(S21Matrix&& other) noexcept {
@@ -30,36 +209,83 @@ S21Matrix& S21Matrix::operator=(S21Matrix&& other) noexcept {
     rows_ = other.rows_;
     cols_ = other.cols_;
     matrix_ = other.matrix_;
+    data_ = other.data_;
+    refs_ = other.refs_;
+    capacity_ = other.capacity_;
+    row_capacity_ = other.row_capacity_;
     other.rows_ = 0;
     other.cols_ = 0;
     other.matrix_ = nullptr;
+    other.data_ = nullptr;
+    other.refs_ = nullptr;
+    other.capacity_ = 0;
+    other.row_capacity_ = 0;
   }
   return *this;
 }
 
 void S21Matrix::AllocateMatrix(int rows, int cols) {
+  S21_PROFILE_ALLOCATION(static_cast<std::size_t>(rows) *
+                         (static_cast<std::size_t>(cols) * sizeof(double) +
+                          sizeof(double*)));
+  std::size_t count =
+      static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols);
+  bool first_touch = false;
+  data_ = S21MatrixMemory::Instance().Allocate(count, &first_touch);
   matrix_ = new double*[rows];
   for (int i = 0; i < rows; ++i) {
-    matrix_[i] = new double[cols]{0};  // Инициализация нулями
+    matrix_[i] = data_ + static_cast<std::size_t>(i) * cols;
+  }
+  if (first_touch) {
+    // Первое касание страниц строки обычно делает тот же рабочий поток,
+    // который затем обрабатывает эту строку в ParallelRows
+    double* data = data_;
+    S21ThreadPool::Instance().ParallelRows(
+        rows, cols * sizeof(double), [data, cols](int begin, int end) {
+          std::fill(data + static_cast<std::size_t>(begin) * cols,
+                    data + static_cast<std::size_t>(end) * cols, 0.0);
+        });
+  }
+  if (copy_on_write.load(std::memory_order_relaxed)) {
+    refs_ = new std::atomic<long>(1);
   }
   rows_ = rows;
   cols_ = cols;
+  capacity_ = count;
+  row_capacity_ = rows;
 }
 
 void S21Matrix::DeallocateMatrix() {
   if (matrix_) {
-    for (int i = 0; i < rows_; ++i) {
-      delete[] matrix_[i];
-    }
+    ReleaseBuffer();
     delete[] matrix_;
     matrix_ = nullptr;
+    data_ = nullptr;
+    refs_ = nullptr;
     rows_ = 0;
     cols_ = 0;
+    capacity_ = 0;
+    row_capacity_ = 0;
+  }
+}
+
+void S21Matrix::ReleaseBuffer() const {
+  // Буфер освобождает последний из владельцев; acq_rel упорядочивает его
+  // освобождение после чтений и записей остальных копий
+  if (!refs_ || refs_->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    S21MatrixMemory::Instance().Free(data_, capacity_);
+    delete refs_;
   }
 }
 
 S21Matrix::~S21Matrix() { DeallocateMatrix(); }
 
+S21Matrix S21Matrix::Identity(int n) {
+  S21Matrix identity(n, n);
+  for (int i = 0; i < n; ++i) identity.matrix_[i][i] = 1.0;
+  return identity;
+}
+
 void S21Matrix::CopyMatrix(const S21Matrix& other) {
   AllocateMatrix(other.rows_, other.cols_);
   for (int i = 0; i < rows_; ++i) {
@@ -69,27 +295,376 @@ void S21Matrix::CopyMatrix(const S21Matrix& other) {
   }
 }
 
+void S21Matrix::ShareMatrix(const S21Matrix& other) {
+  // Счётчик источника создан при его выделении, поэтому параллельные копии
+  // одной константной матрицы только увеличивают его
+  other.refs_->fetch_add(1, std::memory_order_relaxed);
+  refs_ = other.refs_;
+  data_ = other.data_;
+  capacity_ = other.capacity_;
+  matrix_ = new double*[other.rows_];
+  row_capacity_ = other.rows_;
+  rows_ = other.rows_;
+  cols_ = other.cols_;
+  LinkRows(0);
+}
+
+void S21Matrix::MakeUnique() const {
+  // Единственный владелец не может получить новую копию без обращения к
+  // этому объекту, поэтому после проверки счётчик не вырастет
+  if (!refs_ || refs_->load(std::memory_order_acquire) == 1) return;
+  std::size_t count =
+      static_cast<std::size_t>(rows_) * static_cast<std::size_t>(cols_);
+  bool first_touch = false;
+  double* data = S21MatrixMemory::Instance().Allocate(count, &first_touch);
+  if (count > 0) std::memcpy(data, data_, count * sizeof(double));
+  for (int i = 0; i < rows_; ++i) {
+    matrix_[i] = data + static_cast<std::size_t>(i) * cols_;
+  }
+  // Остальные владельцы могли отделиться одновременно с нами: последний
+  // из них освобождает старый буфер
+  ReleaseBuffer();
+  data_ = data;
+  capacity_ = count;
+  refs_ = copy_on_write.load(std::memory_order_relaxed)
+              ? new std::atomic<long>(1)
+              : nullptr;
+}
+
+void S21Matrix::MakeUnshareable() const {
+  MakeUnique();
+  // Теперь объект — единственный владелец, и без счётчика конструктор
+  // копирования пойдёт по пути CopyMatrix
+  delete refs_;
+  refs_ = nullptr;
+}
+
+void S21Matrix::LinkRows(int begin) {
+  for (int i = begin; i < rows_; ++i) {
+    matrix_[i] = data_ + static_cast<std::size_t>(i) * cols_;
+  }
+}
+
+void S21Matrix::Regrow(int row_capacity, std::size_t capacity) {
+  S21_PROFILE_ALLOCATION(capacity * sizeof(double) +
+                         static_cast<std::size_t>(row_capacity) *
+                             sizeof(double*));
+  bool first_touch = false;
+  double* data = S21MatrixMemory::Instance().Allocate(capacity, &first_touch);
+  const std::size_t count =
+      static_cast<std::size_t>(rows_) * static_cast<std::size_t>(cols_);
+  if (count > 0) std::memcpy(data, data_, count * sizeof(double));
+  if (matrix_) ReleaseBuffer();
+  delete[] matrix_;
+  matrix_ = new double*[row_capacity];
+  row_capacity_ = row_capacity;
+  data_ = data;
+  capacity_ = capacity;
+  refs_ = copy_on_write.load(std::memory_order_relaxed)
+              ? new std::atomic<long>(1)
+              : nullptr;
+  LinkRows(0);
+}
+
+void S21Matrix::Resize(int rows, int cols) {
+  if (rows < 0 || cols < 0) {
+    throw std::invalid_argument(
+        "Строки и столбцы должны быть положительными числами");
+  }
+  if (rows == rows_ && cols == cols_) return;
+  const int kept_rows = std::min(rows, rows_);
+  const int kept_cols = std::min(cols, cols_);
+  const std::size_t count =
+      static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols);
+  if (!matrix_ || IsShared() || count > capacity_ || rows > row_capacity_) {
+    S21Matrix resized(rows, cols);
+    for (int i = 0; i < kept_rows; ++i) {
+      std::copy(matrix_[i], matrix_[i] + kept_cols, resized.matrix_[i]);
+    }
+    *this = std::move(resized);
+    return;
+  }
+  // Строки сдвигаются на месте: к началу буфера при сужении и от конца при
+  // расширении, чтобы ещё не перенесённые строки не затирались
+  if (cols < cols_) {
+    for (int i = 1; i < kept_rows; ++i) {
+      std::memmove(data_ + static_cast<std::size_t>(i) * cols, matrix_[i],
+                   cols * sizeof(double));
+    }
+  } else if (cols > cols_) {
+    for (int i = kept_rows - 1; i >= 0; --i) {
+      double* row = data_ + static_cast<std::size_t>(i) * cols;
+      std::memmove(row, matrix_[i], cols_ * sizeof(double));
+      std::fill(row + cols_, row + cols, 0.0);
+    }
+  }
+  // Память за прежними строками может хранить старые значения
+  std::fill(data_ + static_cast<std::size_t>(kept_rows) * cols, data_ + count,
+            0.0);
+  rows_ = rows;
+  cols_ = cols;
+  LinkRows(0);
+}
+
+void S21Matrix::Reshape(int rows, int cols) {
+  if (rows < 0 || cols < 0) {
+    throw std::invalid_argument(
+        "Строки и столбцы должны быть положительными числами");
+  }
+  if (static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols) !=
+      static_cast<std::size_t>(rows_) * static_cast<std::size_t>(cols_)) {
+    throw std::invalid_argument(
+        "Число элементов при изменении формы должно сохраняться");
+  }
+  if (!matrix_) {
+    AllocateMatrix(rows, cols);
+    return;
+  }
+  if (rows > row_capacity_) {
+    delete[] matrix_;
+    matrix_ = new double*[rows];
+    row_capacity_ = rows;
+  }
+  rows_ = rows;
+  cols_ = cols;
+  LinkRows(0);
+}
+
+void S21Matrix::AppendRowData(const double* const* rows, int count,
+                              int cols) {
+  if (rows_ > 0 && cols != cols_) {
+    throw std::invalid_argument(
+        "Число столбцов добавляемых строк не совпадает с матрицей");
+  }
+  if (rows_ == 0) cols_ = cols;
+  const int total = rows_ + count;
+  const std::size_t needed =
+      static_cast<std::size_t>(total) * static_cast<std::size_t>(cols);
+  if (!matrix_ || IsShared() || needed > capacity_ || total > row_capacity_) {
+    // Геометрический рост: каждое выделение хотя бы удваивает ёмкость
+    const int grown = std::max(total, 2 * rows_);
+    Regrow(grown, static_cast<std::size_t>(grown) * cols);
+  }
+  for (int i = 0; i < count; ++i) {
+    std::copy(rows[i], rows[i] + cols,
+              data_ + static_cast<std::size_t>(rows_ + i) * cols);
+  }
+  const int first = rows_;
+  rows_ = total;
+  LinkRows(first);
+}
+
+void S21Matrix::AppendRow(const std::vector<double>& row) {
+  const double* data = row.data();
+  AppendRowData(&data, 1, static_cast<int>(row.size()));
+}
+
+void S21Matrix::AppendRows(const S21Matrix& rows) {
+  if (&rows == this) {
+    // Рост буфера сделал бы источник недействительным
+    S21Matrix copy(rows);
+    AppendRowData(copy.matrix_, copy.rows_, copy.cols_);
+    return;
+  }
+  AppendRowData(rows.matrix_, rows.rows_, rows.cols_);
+}
+
+void S21Matrix::Reserve(int rows) {
+  if (rows < 0) {
+    throw std::invalid_argument(
+        "Строки и столбцы должны быть положительными числами");
+  }
+  if (matrix_ && rows <= GetRowCapacity()) return;
+  rows = std::max(rows, rows_);
+  Regrow(rows, static_cast<std::size_t>(rows) * cols_);
+}
+
+int S21Matrix::GetRowCapacity() const {
+  if (cols_ == 0) return row_capacity_;
+  return static_cast<int>(
+      std::min<std::size_t>(row_capacity_, capacity_ / cols_));
+}
+
+void S21Matrix::VStackInto(const S21Matrix& a, const S21Matrix& b,
+                           S21Matrix* out) {
+  if (a.cols_ != b.cols_) {
+    throw std::invalid_argument(
+        "Число столбцов объединяемых по вертикали матриц не совпадает");
+  }
+  if (out == &a) {
+    out->AppendRows(b);
+    return;
+  }
+  if (out == &b) {
+    S21Matrix stacked;
+    VStackInto(a, b, &stacked);
+    *out = std::move(stacked);
+    return;
+  }
+  PrepareOutput(out, a.rows_ + b.rows_, a.cols_);
+  const std::size_t top =
+      static_cast<std::size_t>(a.rows_) * static_cast<std::size_t>(a.cols_);
+  if (top > 0) std::memcpy(out->data_, a.data_, top * sizeof(double));
+  for (int i = 0; i < b.rows_; ++i) {
+    std::copy(b.matrix_[i], b.matrix_[i] + b.cols_,
+              out->matrix_[a.rows_ + i]);
+  }
+}
+
+void S21Matrix::HStackInto(const S21Matrix& a, const S21Matrix& b,
+                           S21Matrix* out) {
+  if (a.rows_ != b.rows_) {
+    throw std::invalid_argument(
+        "Число строк объединяемых по горизонтали матриц не совпадает");
+  }
+  if (out == &a || out == &b) {
+    S21Matrix stacked;
+    HStackInto(a, b, &stacked);
+    *out = std::move(stacked);
+    return;
+  }
+  PrepareOutput(out, a.rows_, a.cols_ + b.cols_);
+  for (int i = 0; i < a.rows_; ++i) {
+    double* row = std::copy(a.matrix_[i], a.matrix_[i] + a.cols_,
+                            out->matrix_[i]);
+    std::copy(b.matrix_[i], b.matrix_[i] + b.cols_, row);
+  }
+}
+
+S21Matrix S21Matrix::VStack(const S21Matrix& a, const S21Matrix& b) {
+  S21Matrix stacked;
+  VStackInto(a, b, &stacked);
+  return stacked;
+}
+
+S21Matrix S21Matrix::HStack(const S21Matrix& a, const S21Matrix& b) {
+  S21Matrix stacked;
+  HStackInto(a, b, &stacked);
+  return stacked;
+}
+
+void S21Matrix::SetCopyOnWrite(bool enabled) {
+  copy_on_write.store(enabled, std::memory_order_relaxed);
+}
+
+bool S21Matrix::CopyOnWrite() {
+  return copy_on_write.load(std::memory_order_relaxed);
+}
+
+bool S21Matrix::IsShared() const {
+  return refs_ && refs_->load(std::memory_order_acquire) > 1;
+}
+
 // Инциализация функций
 bool S21Matrix::EqMatrix(const S21Matrix& other) const {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     return false;
   }
 
+  return AllElementsMatch(matrix_, other.matrix_, rows_, cols_,
+                          [](double a, double b) { return a == b; });
+}
+
+bool S21Matrix::EqMatrix(const S21Matrix& other, double abs_tol,
+                         double rel_tol) const {
+  if (!(abs_tol >= 0) || !(rel_tol >= 0)) {
+    throw std::invalid_argument("Допуск сравнения не может быть отрицательным");
+  }
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+
+  // Отрицание сравнения отбрасывает NaN: NaN не равен ничему
+  return AllElementsMatch(
+      matrix_, other.matrix_, rows_, cols_,
+      [abs_tol, rel_tol](double a, double b) {
+        // Одинаковые бесконечности: разность была бы NaN. Бесконечность не
+        // близка ни к какому другому числу, даже при rel_tol * inf
+        if (a == b) return true;
+        if (std::isinf(a) || std::isinf(b)) return false;
+        double limit =
+            std::max(abs_tol, rel_tol * std::max(std::fabs(a), std::fabs(b)));
+        return std::fabs(a - b) <= limit;
+      });
+}
+
+bool S21Matrix::EqMatrixUlps(const S21Matrix& other,
+                             std::uint64_t max_ulps) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+
+  return AllElementsMatch(
+      matrix_, other.matrix_, rows_, cols_, [max_ulps](double a, double b) {
+        std::int64_t x = OrderedBits(a), y = OrderedBits(b);
+        std::uint64_t distance = static_cast<std::uint64_t>(x) -
+                                 static_cast<std::uint64_t>(y);
+        if (x < y) distance = 0 - distance;
+        return (a == a) & (b == b) & (distance <= max_ulps);
+      });
+}
+
+bool S21Matrix::EqMatrixNorm(const S21Matrix& other, double tol) const {
+  if (!(tol >= 0)) {
+    throw std::invalid_argument("Допуск сравнения не может быть отрицательным");
+  }
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+
+  // Норма разности накапливается как scale * sqrt(ssq), как в LAPACK
+  // dnrm2: квадраты не переполняются и не исчезают, поэтому сравнивается
+  // сама норма с tol, а не квадраты. Выходим, как только частичная норма
+  // превысила tol
+  double scale = 0.0, ssq = 1.0;
+  double diff[kCompareBlock];
   for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      if (matrix_[i][j] != other.matrix_[i][j]) {
+    const double* row_a = matrix_[i];
+    const double* row_b = other.matrix_[i];
+    for (int begin = 0; begin < cols_; begin += kCompareBlock) {
+      const int count = std::min(cols_, begin + kCompareBlock) - begin;
+      double block_max = 0.0;
+      for (int j = 0; j < count; ++j) {
+        const double a = row_a[begin + j], b = row_b[begin + j];
+        // Одинаковые бесконечности совпадают, как в EqMatrix()
+        diff[j] = a == b ? 0.0 : std::fabs(a - b);
+        block_max = std::max(block_max, diff[j]);
+      }
+      for (int j = 0; j < count; ++j) {
+        if (diff[j] != diff[j]) return false;  // NaN
+      }
+      if (block_max == 0.0) continue;
+      if (std::isinf(block_max)) {
+        if (std::isinf(tol)) continue;
         return false;
       }
+      double block = 0.0;
+      for (int j = 0; j < count; ++j) {
+        const double scaled = diff[j] / block_max;
+        block += scaled * scaled;
+      }
+      // Слияние (block_max, block) с (scale, ssq)
+      if (scale < block_max) {
+        const double ratio = scale / block_max;
+        ssq = block + ssq * ratio * ratio;
+        scale = block_max;
+      } else {
+        const double ratio = block_max / scale;
+        ssq += block * ratio * ratio;
+      }
+      if (!(scale * std::sqrt(ssq) <= tol)) return false;
     }
   }
-
   return true;
 }
 
 void S21Matrix::SumMatrix(const S21Matrix& other) {
+  S21_PROFILE_SCOPE(kSumMatrix, Elements(rows_, cols_),
+                    Elements(rows_, cols_));
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("Размеры матриц не подходят для сложения.");
   }
+  MakeUnique();
 
   for (int i = 0; i < rows_; ++i) {
     for (int j = 0; j < cols_; ++j) {
@@ -99,10 +674,13 @@ void S21Matrix::SumMatrix(const S21Matrix& other) {
 }
 
 void S21Matrix::SubMatrix(const S21Matrix& other) {
+  S21_PROFILE_SCOPE(kSubMatrix, Elements(rows_, cols_),
+                    Elements(rows_, cols_));
   // Проверка на совпадение размеров матриц
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("Размеры матриц не подходят для вычитания.");
   }
+  MakeUnique();
 
   // Выполнение поэлементного вычитания
   for (int i = 0; i < rows_; ++i) {
@@ -113,6 +691,9 @@ void S21Matrix::SubMatrix(const S21Matrix& other) {
 }
 
 void S21Matrix::MulNumber(const double num) {
+  S21_PROFILE_SCOPE(kMulNumber, Elements(rows_, cols_),
+                    Elements(rows_, cols_));
+  MakeUnique();
   for (int i = 0; i < rows_; ++i) {
     for (int j = 0; j < cols_; ++j) {
       matrix_[i][j] *= num;
@@ -121,6 +702,8 @@ void S21Matrix::MulNumber(const double num) {
 }
 
 void S21Matrix::MulMatrix(const S21Matrix& other) {
+  S21_PROFILE_SCOPE(kMulMatrix, Elements(rows_, other.cols_),
+                    2 * Elements(rows_, other.cols_) * cols_);
   if (cols_ != other.rows_) {
     throw std::invalid_argument(
         "Количество столбцов в текущей матрице должно быть равно количеству "
@@ -131,84 +714,1426 @@ void S21Matrix::MulMatrix(const S21Matrix& other) {
   S21Matrix result(rows_, other.cols_);
 
   // Выполняем умножение матриц
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < other.cols_; ++j) {
-      result.matrix_[i][j] = 0;
-      for (int k = 0; k < cols_; ++k) {
-        result.matrix_[i][j] += matrix_[i][k] * other.matrix_[k][j];
-      }
-    }
-  }
+  MultiplyInto(matrix_, other.matrix_, result.matrix_, rows_, cols_,
+               other.cols_);
 
   // Заменяем текущую матрицу результатом умножения
   *this = std::move(result);
 }
 
-S21Matrix S21Matrix::Transpose() const {
-  S21Matrix result(cols_, rows_);
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      result.matrix_[j][i] = matrix_[i][j];
+void S21Matrix::PrepareOutput(S21Matrix* out, int rows, int cols) {
+  if (out->matrix_ != nullptr && out->rows_ == rows && out->cols_ == cols) {
+    out->MakeUnique();
+    return;
+  }
+  // Меньший результат помещается в уже выделенный буфер
+  if (out->matrix_ != nullptr && !out->IsShared() &&
+      static_cast<std::size_t>(rows) * cols <= out->capacity_ &&
+      rows <= out->row_capacity_) {
+    out->rows_ = rows;
+    out->cols_ = cols;
+    out->LinkRows(0);
+    return;
+  }
+  out->DeallocateMatrix();
+  out->AllocateMatrix(rows, cols);
+}
+
+void S21Matrix::SumInto(const S21Matrix& a, const S21Matrix& b,
+                        S21Matrix* out) {
+  S21_PROFILE_SCOPE(kSumMatrix, Elements(a.rows_, a.cols_),
+                    Elements(a.rows_, a.cols_));
+  if (a.rows_ != b.rows_ || a.cols_ != b.cols_) {
+    throw std::invalid_argument("Размеры матриц не подходят для сложения.");
+  }
+  // Поэлементная операция: out может совпадать с a или b, так как каждый
+  // элемент читается до записи на его место
+  PrepareOutput(out, a.rows_, a.cols_);
+  for (int i = 0; i < a.rows_; ++i) {
+    for (int j = 0; j < a.cols_; ++j) {
+      out->matrix_[i][j] = a.matrix_[i][j] + b.matrix_[i][j];
+    }
+  }
+}
+
+void S21Matrix::SubInto(const S21Matrix& a, const S21Matrix& b,
+                        S21Matrix* out) {
+  S21_PROFILE_SCOPE(kSubMatrix, Elements(a.rows_, a.cols_),
+                    Elements(a.rows_, a.cols_));
+  if (a.rows_ != b.rows_ || a.cols_ != b.cols_) {
+    throw std::invalid_argument("Размеры матриц не подходят для вычитания.");
+  }
+  PrepareOutput(out, a.rows_, a.cols_);
+  for (int i = 0; i < a.rows_; ++i) {
+    for (int j = 0; j < a.cols_; ++j) {
+      out->matrix_[i][j] = a.matrix_[i][j] - b.matrix_[i][j];
+    }
+  }
+}
+
+void S21Matrix::MulNumberInto(const S21Matrix& a, double num,
+                              S21Matrix* out) {
+  S21_PROFILE_SCOPE(kMulNumber, Elements(a.rows_, a.cols_),
+                    Elements(a.rows_, a.cols_));
+  PrepareOutput(out, a.rows_, a.cols_);
+  for (int i = 0; i < a.rows_; ++i) {
+    for (int j = 0; j < a.cols_; ++j) {
+      out->matrix_[i][j] = a.matrix_[i][j] * num;
     }
   }
+}
+
+void S21Matrix::MulInto(const S21Matrix& a, const S21Matrix& b, S21Matrix* c,
+                        double alpha, double beta) {
+  if (a.cols_ != b.rows_) {
+    throw std::invalid_argument(
+        "Количество столбцов в текущей матрице должно быть равно количеству "
+        "строк в матрице other.");
+  }
+  if (beta != 0.0 && (c->rows_ != a.rows_ || c->cols_ != b.cols_)) {
+    throw std::invalid_argument(
+        "Размер матрицы результата не совпадает с размером произведения.");
+  }
+  if (c == &a || c == &b) {
+    // Строки c перезаписывались бы, пока ещё читаются как множитель
+    S21Matrix product;
+    if (beta != 0.0) product = S21Matrix(*c);
+    MulInto(a, b, &product, alpha, beta);
+    *c = std::move(product);
+    return;
+  }
+  S21_PROFILE_SCOPE(kMulMatrix, Elements(a.rows_, b.cols_),
+                    2 * Elements(a.rows_, b.cols_) * a.cols_);
+  PrepareOutput(c, a.rows_, b.cols_);
+  MultiplyInto(a.matrix_, b.matrix_, c->matrix_, a.rows_, a.cols_, b.cols_,
+               alpha, beta);
+}
+
+S21Matrix S21Matrix::Transpose() const {
+  S21Matrix result;
+  TransposeInto(&result);
   return result;
 }
 
+void S21Matrix::TransposeInto(S21Matrix* out) const {
+  if (out == this && rows_ != cols_) {
+    S21Matrix result;
+    TransposeInto(&result);
+    *out = std::move(result);
+    return;
+  }
+  S21_PROFILE_SCOPE(kTranspose, Elements(rows_, cols_), 0);
+  if (out == this) {
+    MakeUnique();
+    for (int i = 0; i < rows_; ++i) {
+      for (int j = i + 1; j < cols_; ++j) {
+        std::swap(matrix_[i][j], matrix_[j][i]);
+      }
+    }
+    return;
+  }
+  PrepareOutput(out, cols_, rows_);
+  double** result = out->matrix_;
+  // Квадратными блоками: и чтение строк, и запись столбцов остаются в
+  // пределах нескольких строк кэша
+  const int block = S21Tuner::Instance().Params().transpose_block;
+  for (int ii = 0; ii < rows_; ii += block) {
+    const int i_end = std::min(rows_, ii + block);
+    for (int jj = 0; jj < cols_; jj += block) {
+      const int j_end = std::min(cols_, jj + block);
+      for (int i = ii; i < i_end; ++i) {
+        for (int j = jj; j < j_end; ++j) {
+          result[j][i] = matrix_[i][j];
+        }
+      }
+    }
+  }
+}
+
 S21Matrix S21Matrix::Minor(int row, int col) const {
-  S21Matrix minor(rows_ - 1, cols_ - 1);
+  S21Matrix minor;
+  MinorInto(row, col, &minor);
+  return minor;
+}
+
+void S21Matrix::MinorInto(int row, int col, S21Matrix* out) const {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::out_of_range("Матрица вне диапазона");
+  }
+  if (out == this) {
+    S21Matrix minor;
+    MinorInto(row, col, &minor);
+    *out = std::move(minor);
+    return;
+  }
+  S21_PROFILE_SCOPE(kMinor, Elements(rows_ - 1, cols_ - 1), 0);
+  PrepareOutput(out, rows_ - 1, cols_ - 1);
   for (int i = 0, mi = 0; i < rows_; ++i) {
     if (i == row) continue;
     for (int j = 0, mj = 0; j < cols_; ++j) {
       if (j == col) continue;
-      minor.matrix_[mi][mj] = matrix_[i][j];
+      out->matrix_[mi][mj] = matrix_[i][j];
       ++mj;
     }
     ++mi;
   }
-  return minor;
 }
 
 double S21Matrix::Determinant() const {
+  S21_PROFILE_SCOPE(kDeterminant, Elements(rows_, cols_),
+                    CofactorFlops(rows_));
   if (cols_ != rows_) {
     throw std::invalid_argument("Матрица должна быть квадратной");
   }
-  if (rows_ == 2) {
-    return (matrix_[0][0] * matrix_[1][1] - matrix_[1][0] * matrix_[0][1]);
-  }
-  if (rows_ == 1) {
-    return matrix_[0][0];
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  if (!cache.IsEnabled()) {
+    return ComputeDeterminant();
   }
   double det = 0.0;
-  for (int i = 0; i < rows_; ++i) {
-    S21Matrix minor = Minor(0, i);
-    det += (i % 2 == 0 ? 1 : -1) * matrix_[0][i] * minor.Determinant();
+  if (!cache.FindDeterminant(*this, &det)) {
+    det = ComputeDeterminant();
+    cache.StoreDeterminant(*this, det);
   }
   return det;
 }
 
+double S21Matrix::ComputeDeterminant() const {
+  int* rows = CofactorScratch(rows_);
+  return CofactorDeterminant(matrix_, rows, rows + rows_, rows_,
+                             rows + 2 * rows_);
+}
+
 S21Matrix S21Matrix::CalcComplements() const {
+  S21Matrix complement;
+  CalcComplementsInto(&complement);
+  return complement;
+}
+
+void S21Matrix::CalcComplementsInto(S21Matrix* out) const {
   if (cols_ != rows_) {
     throw std::invalid_argument("Матрица должна быть квадратной");
   }
-  S21Matrix complement(rows_, cols_);
+  if (out == this) {
+    S21Matrix complement;
+    CalcComplementsInto(&complement);
+    *out = std::move(complement);
+    return;
+  }
+  S21_PROFILE_SCOPE(kCalcComplements, Elements(rows_, cols_),
+                    Elements(rows_, cols_) * CofactorFlops(rows_ - 1));
+  PrepareOutput(out, rows_, cols_);
+  if (rows_ == 1) {
+    // Минор 1x1 матрицы пуст, его определитель равен единице
+    out->matrix_[0][0] = 1.0;
+    return;
+  }
   for (int i = 0; i < rows_; ++i) {
     for (int j = 0; j < cols_; ++j) {
-      S21Matrix minor = Minor(i, j);
-      complement.matrix_[i][j] =
-          ((i + j) % 2 == 0 ? 1 : -1) * minor.Determinant();
+      out->matrix_[i][j] = Cofactor(i, j);
     }
   }
-  return complement;
+}
+
+double S21Matrix::Cofactor(int row, int col) const {
+  const int n = rows_ - 1;
+  int* rows = CofactorScratch(n);
+  int* cols = rows + n;
+  for (int i = 0, k = 0; i <= n; ++i) {
+    if (i != row) rows[k++] = i;
+  }
+  for (int j = 0, k = 0; j <= n; ++j) {
+    if (j != col) cols[k++] = j;
+  }
+  return ((row + col) % 2 == 0 ? 1 : -1) *
+         CofactorDeterminant(matrix_, rows, cols, n, cols + n);
 }
 
 S21Matrix S21Matrix::InverseMatrix() const {
-  double det = Determinant();
+  S21Matrix inverse;
+  InverseInto(&inverse);
+  return inverse;
+}
+
+void S21Matrix::InverseInto(S21Matrix* out) const {
+  InverseIntoCancellable(out, nullptr);
+}
+
+void S21Matrix::InverseIntoCancellable(S21Matrix* out,
+                                       const S21CancelToken* cancel) const {
+  if (out == this) {
+    S21Matrix inverse;
+    InverseIntoCancellable(&inverse, cancel);
+    *out = std::move(inverse);
+    return;
+  }
+  S21_PROFILE_SCOPE(kInverseMatrix, Elements(rows_, cols_),
+                    Elements(rows_, cols_) * (CofactorFlops(rows_ - 1) + 1) +
+                        CofactorFlops(rows_));
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  if (!cache.IsEnabled()) {
+    ComputeInverseInto(out, cancel);
+    return;
+  }
+  if (!cache.FindInverse(*this, out)) {
+    ComputeInverseInto(out, cancel);
+    cache.StoreInverse(*this, *out);
+  }
+}
+
+namespace {
+
+// LU-разложение с частичным выбором ведущего элемента для плотной матрицы n
+// x n, хранящейся построчно в lu. Возвращает false для вырожденной матрицы.
+// Обновление остаточной подматрицы идёт в потоках, начиная с размера
+// S21TuneParams::lu_parallel_size
+template <typename T>
+bool LuFactor(std::vector<T>* lu, std::vector<int>* pivots, int n) {
+  T* a = lu->data();
+  pivots->resize(n);
+  S21ThreadPool& pool = S21ThreadPool::Instance();
+  const int parallel_size =
+      pool.ThreadCount() > 1 ? S21Tuner::Instance().Params().lu_parallel_size
+                             : std::numeric_limits<int>::max();
+  for (int k = 0; k < n; ++k) {
+    int pivot = k;
+    for (int i = k + 1; i < n; ++i) {
+      if (std::fabs(a[i * n + k]) > std::fabs(a[pivot * n + k])) pivot = i;
+    }
+    (*pivots)[k] = pivot;
+    if (a[pivot * n + k] == 0) return false;
+    if (pivot != k) {
+      std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+    }
+    const T* row_k = a + k * n;
+    auto update = [a, row_k, k, n](int begin, int end) {
+      for (int i = k + 1 + begin; i < k + 1 + end; ++i) {
+        T* row_i = a + i * n;
+        T factor = row_i[k] / row_k[k];
+        row_i[k] = factor;
+        if (factor == 0) continue;
+        for (int j = k + 1; j < n; ++j) row_i[j] -= factor * row_k[j];
+      }
+    };
+    const int trailing = n - k - 1;
+    if (trailing >= parallel_size) {
+      pool.ParallelRows(trailing, (n - k) * sizeof(T), update);
+    } else {
+      update(0, trailing);
+    }
+  }
+  return true;
+}
+
+// Решает L * U * x = P * rhs на месте
+template <typename T>
+void LuSolve(const std::vector<T>& lu, const std::vector<int>& pivots, int n,
+             T* rhs) {
+  const T* a = lu.data();
+  for (int k = 0; k < n; ++k) {
+    if (pivots[k] != k) std::swap(rhs[k], rhs[pivots[k]]);
+  }
+  for (int i = 1; i < n; ++i) {
+    T sum = rhs[i];
+    for (int j = 0; j < i; ++j) sum -= a[i * n + j] * rhs[j];
+    rhs[i] = sum;
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    T sum = rhs[i];
+    for (int j = i + 1; j < n; ++j) sum -= a[i * n + j] * rhs[j];
+    rhs[i] = sum / a[i * n + i];
+  }
+}
+
+// Решает (L * U)^T * y = rhs и возвращает x = P^T * y на месте
+template <typename T>
+void LuSolveTransposed(const std::vector<T>& lu, const std::vector<int>& pivots,
+                       int n, T* rhs) {
+  const T* a = lu.data();
+  for (int i = 0; i < n; ++i) {
+    T sum = rhs[i];
+    for (int j = 0; j < i; ++j) sum -= a[j * n + i] * rhs[j];
+    rhs[i] = sum / a[i * n + i];
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    T sum = rhs[i];
+    for (int j = i + 1; j < n; ++j) sum -= a[j * n + i] * rhs[j];
+    rhs[i] = sum;
+  }
+  for (int k = n - 1; k >= 0; --k) {
+    if (pivots[k] != k) std::swap(rhs[k], rhs[pivots[k]]);
+  }
+}
+
+template <typename T>
+std::vector<T> ToDense(double** matrix, int rows, int cols) {
+  std::vector<T> dense(static_cast<std::size_t>(rows) * cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      dense[static_cast<std::size_t>(i) * cols + j] =
+          static_cast<T>(matrix[i][j]);
+    }
+  }
+  return dense;
+}
+
+// Оценка 1 / (||A||_1 ||A^-1||_1) для плотной матрицы n x n в lu; lu
+// заменяется своим LU-разложением. 0 для вырожденной матрицы
+double DenseConditionEstimate(std::vector<double>* lu,
+                              std::vector<int>* pivots, int n) {
+  double norm = 0.0;
+  for (int j = 0; j < n; ++j) {
+    double column_sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+      column_sum += std::fabs((*lu)[static_cast<std::size_t>(i) * n + j]);
+    }
+    norm = std::max(norm, column_sum);
+  }
+  if (!LuFactor(lu, pivots, n) || norm == 0) return 0.0;
+  // Одна ссылка в замыкании помещается во встроенный буфер std::function
+  struct Factors {
+    const std::vector<double>& lu;
+    const std::vector<int>& pivots;
+    int n;
+  } factors{*lu, *pivots, n};
+  const double inverse_norm = S21InverseNorm1Estimate(
+      n, [&factors](double* x, bool transpose) {
+        if (transpose) {
+          LuSolveTransposed(factors.lu, factors.pivots, factors.n, x);
+        } else {
+          LuSolve(factors.lu, factors.pivots, factors.n, x);
+        }
+      });
+  return inverse_norm > 0 ? 1.0 / norm / inverse_norm : 0.0;
+}
+
+// Максимальное число шагов уточнения, как в LAPACK dsgesv
+const int kRefineMaxIterations = 30;
+
+}  // namespace
+
+S21Matrix S21Matrix::Solve(const S21Matrix& b) const {
+  return SolveCancellable(b, nullptr);
+}
+
+S21Matrix S21Matrix::SolveCancellable(const S21Matrix& b,
+                                      const S21CancelToken* cancel) const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  if (b.rows_ != rows_) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  const int n = rows_;
+  std::vector<double> lu = ToDense<double>(matrix_, n, n);
+  std::vector<int> pivots;
+  if (!LuFactor(&lu, &pivots, n)) {
+    throw std::invalid_argument("Матрица вырождена");
+  }
+  S21Matrix x(n, b.cols_);
+  std::vector<double> column(n);
+  for (int j = 0; j < b.cols_; ++j) {
+    ThrowIfCancelled(cancel);
+    for (int i = 0; i < n; ++i) column[i] = b.matrix_[i][j];
+    LuSolve(lu, pivots, n, column.data());
+    for (int i = 0; i < n; ++i) x.matrix_[i][j] = column[i];
+  }
+  return x;
+}
+
+S21Matrix S21Matrix::LuDecompose(std::vector<int>* pivots) const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = rows_;
+  std::vector<double> lu = ToDense<double>(matrix_, n, n);
+  if (!LuFactor(&lu, pivots, n)) {
+    throw std::invalid_argument("Матрица вырождена");
+  }
+  S21Matrix packed(n, n);
+  for (int i = 0; i < n; ++i) {
+    std::copy(lu.begin() + static_cast<std::size_t>(i) * n,
+              lu.begin() + static_cast<std::size_t>(i + 1) * n,
+              packed.matrix_[i]);
+  }
+  return packed;
+}
+
+double S21Matrix::ConditionEstimate() const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  std::vector<double> lu = ToDense<double>(matrix_, rows_, rows_);
+  std::vector<int> pivots;
+  return DenseConditionEstimate(&lu, &pivots, rows_);
+}
+
+void S21Matrix::ComputeInverseInto(S21Matrix* out,
+                                   const S21CancelToken* cancel) const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = rows_;
+  // Буферы проверки переиспользуются между вызовами в потоке
+  thread_local std::vector<double> scaled;
+  thread_local std::vector<int> pivots;
+  scaled.resize(static_cast<std::size_t>(n) * n);
+  for (int i = 0; i < n; ++i) {
+    std::copy(matrix_[i], matrix_[i] + n,
+              scaled.begin() + static_cast<std::size_t>(i) * n);
+  }
+  // Масштабирование степенями двойки точно и убирает плохую
+  // обусловленность, вызванную только разным масштабом строк и столбцов
+  for (int pass = 0; pass < 2; ++pass) {
+    const std::size_t step_i = pass == 0 ? n : 1, step_j = pass == 0 ? 1 : n;
+    for (int i = 0; i < n; ++i) {
+      double* line = scaled.data() + i * step_i;
+      double max_abs = 0.0;
+      for (int j = 0; j < n; ++j) {
+        max_abs = std::max(max_abs, std::fabs(line[j * step_j]));
+      }
+      if (!std::isnormal(max_abs)) continue;
+      const int shift = -std::ilogb(max_abs);
+      for (int j = 0; j < n; ++j) {
+        line[j * step_j] = std::ldexp(line[j * step_j], shift);
+      }
+    }
+  }
+  if (DenseConditionEstimate(&scaled, &pivots, n) <
+      std::numeric_limits<double>::epsilon()) {
+    throw std::invalid_argument("Матрица вырождена или плохо обусловлена");
+  }
+  ThrowIfCancelled(cancel);
+  // Без кэша и профиля: их уже учла сама InverseMatrix
+  double det = ComputeDeterminant();
   if (det == 0) {
+    throw std::invalid_argument("Матрица вырождена");
+  }
+  ThrowIfCancelled(cancel);
+  // Транспонированная матрица дополнений, делённая на определитель
+  PrepareOutput(out, n, n);
+  const double inverse_det = 1.0 / det;
+  if (n == 1) {
+    out->matrix_[0][0] = 1.0 * inverse_det;
+    return;
+  }
+  for (int i = 0; i < n; ++i) {
+    ThrowIfCancelled(cancel);
+    for (int j = 0; j < n; ++j) {
+      out->matrix_[j][i] = Cofactor(i, j) * inverse_det;
+    }
+  }
+}
+
+double S21Matrix::LogDeterminant(int* sign) const {
+  if (cols_ != rows_) {
     throw std::invalid_argument("Матрица должна быть квадратной");
   }
-  S21Matrix inverse = CalcComplements().Transpose();
-  inverse.MulNumber(1.0 / det);
-  return inverse;
+  const int n = rows_;
+  std::vector<double> lu = ToDense<double>(matrix_, n, n);
+  std::vector<int> pivots;
+  int result_sign = 0;
+  double log_abs = -std::numeric_limits<double>::infinity();
+  if (LuFactor(&lu, &pivots, n)) {
+    result_sign = 1;
+    log_abs = 0.0;
+    for (int k = 0; k < n; ++k) {
+      const double pivot = lu[static_cast<std::size_t>(k) * n + k];
+      if (pivot < 0) result_sign = -result_sign;
+      if (pivots[k] != k) result_sign = -result_sign;
+      log_abs += std::log(std::fabs(pivot));
+    }
+  }
+  if (sign != nullptr) *sign = result_sign;
+  return log_abs;
+}
+
+S21Matrix S21Matrix::SolveRefined(const S21Matrix& b,
+                                  S21RefineReport* report) const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  if (b.rows_ != rows_) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  const int n = rows_;
+  const double eps = std::numeric_limits<double>::epsilon();
+  S21RefineReport local;
+  S21RefineReport& result = report != nullptr ? *report : local;
+  result = S21RefineReport();
+
+  double norm_a = 0.0;
+  for (int i = 0; i < n; ++i) {
+    double row_sum = 0.0;
+    for (int j = 0; j < n; ++j) row_sum += std::fabs(matrix_[i][j]);
+    norm_a = std::max(norm_a, row_sum);
+  }
+
+  // Разложение в одинарной точности
+  std::vector<float> lu = ToDense<float>(matrix_, n, n);
+  std::vector<int> pivots;
+  bool factored = LuFactor(&lu, &pivots, n);
+  for (std::size_t k = 0; factored && k < lu.size(); ++k) {
+    if (!std::isfinite(lu[k])) factored = false;
+  }
+
+  S21Matrix x(n, b.cols_);
+  std::vector<double> residual(n);
+  std::vector<float> correction(n);
+  for (int j = 0; factored && j < b.cols_; ++j) {
+    for (int i = 0; i < n; ++i) residual[i] = b.matrix_[i][j];
+    bool converged = false;
+    double previous = std::numeric_limits<double>::infinity();
+    double column_residual = 0.0;
+    for (int iteration = 0; iteration <= kRefineMaxIterations; ++iteration) {
+      // Невязка r = b - A * x вычисляется в двойной точности
+      double norm_r = 0.0, norm_x = 0.0, norm_b = 0.0;
+      for (int i = 0; i < n; ++i) {
+        double sum = b.matrix_[i][j];
+        for (int k = 0; k < n; ++k) sum -= matrix_[i][k] * x.matrix_[k][j];
+        residual[i] = sum;
+        norm_r = std::max(norm_r, std::fabs(sum));
+        norm_x = std::max(norm_x, std::fabs(x.matrix_[i][j]));
+        norm_b = std::max(norm_b, std::fabs(b.matrix_[i][j]));
+      }
+      double scale = norm_a * norm_x + norm_b;
+      column_residual = scale > 0 ? norm_r / scale : 0.0;
+      if (norm_r <= std::sqrt(static_cast<double>(n)) * eps * scale) {
+        converged = true;
+        break;
+      }
+      // Отсутствие сходимости означает плохую обусловленность для float
+      if (iteration > 0 && !(norm_r < 0.5 * previous)) break;
+      previous = norm_r;
+      if (iteration == kRefineMaxIterations) break;
+
+      for (int i = 0; i < n; ++i) {
+        correction[i] = static_cast<float>(residual[i]);
+      }
+      LuSolve(lu, pivots, n, correction.data());
+      // Невязка вне диапазона float даёт бесконечную поправку, и проверка
+      // сходимости по бесконечным нормам приняла бы её: решаем в double
+      if (!std::all_of(correction.begin(), correction.end(),
+                       [](float value) { return std::isfinite(value); })) {
+        break;
+      }
+      for (int i = 0; i < n; ++i) x.matrix_[i][j] += correction[i];
+      result.iterations = std::max(result.iterations, iteration + 1);
+    }
+    result.residual = std::max(result.residual, column_residual);
+    if (!converged) factored = false;
+  }
+
+  if (factored) {
+    result.converged = true;
+    return x;
+  }
+
+  // Полное решение в двойной точности
+  result = S21RefineReport();
+  result.fell_back = true;
+  x = Solve(b);
+  for (int j = 0; j < b.cols_; ++j) {
+    double norm_r = 0.0, norm_x = 0.0, norm_b = 0.0;
+    for (int i = 0; i < n; ++i) {
+      double sum = b.matrix_[i][j];
+      for (int k = 0; k < n; ++k) sum -= matrix_[i][k] * x.matrix_[k][j];
+      norm_r = std::max(norm_r, std::fabs(sum));
+      norm_x = std::max(norm_x, std::fabs(x.matrix_[i][j]));
+      norm_b = std::max(norm_b, std::fabs(b.matrix_[i][j]));
+    }
+    double scale = norm_a * norm_x + norm_b;
+    result.residual = std::max(result.residual,
+                               scale > 0 ? norm_r / scale : 0.0);
+  }
+  result.converged = true;
+  return x;
+}
+
+S21Matrix S21Matrix::InverseRefined(S21RefineReport* report) const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  S21Matrix identity(rows_, cols_);
+  for (int i = 0; i < rows_; ++i) identity.matrix_[i][i] = 1.0;
+  return SolveRefined(identity, report);
+}
+
+namespace {
+
+// Пороги 1-нормы и степени аппроксимантов Паде для экспоненты
+// (Higham, "The scaling and squaring method for the matrix exponential
+// revisited", 2005)
+const int kPadeDegrees[] = {3, 5, 7, 9, 13};
+const double kPadeThetas[] = {1.495585217958292e-2, 2.539398330063230e-1,
+                              9.504178996162932e-1, 2.097847961257068e0,
+                              5.371920351148152e0};
+const double kPade3[] = {120.0, 60.0, 12.0, 1.0};
+const double kPade5[] = {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0};
+const double kPade7[] = {17297280.0, 8648640.0, 1995840.0, 277200.0,
+                         25200.0,    1512.0,    56.0,      1.0};
+const double kPade9[] = {17643225600.0, 8821612800.0, 2075673600.0,
+                         302702400.0,   30270240.0,   2162160.0,
+                         110880.0,      3960.0,       90.0,
+                         1.0};
+const double kPade13[] = {64764752532480000.0,
+                          32382376266240000.0,
+                          7771770303897600.0,
+                          1187353796428800.0,
+                          129060195264000.0,
+                          10559470521600.0,
+                          670442572800.0,
+                          33522128640.0,
+                          1323241920.0,
+                          40840800.0,
+                          960960.0,
+                          16380.0,
+                          182.0,
+                          1.0};
+
+// to += alpha * from для матриц одного размера
+void AddScaled(const S21Matrix& from, double alpha, S21Matrix* to) {
+  const double* const* x = from.GetConstMatrixPointer();
+  double** y = to->GetMatrixPointer();
+  for (int i = 0; i < from.GetRows(); ++i) {
+    for (int j = 0; j < from.GetCols(); ++j) y[i][j] += alpha * x[i][j];
+  }
+}
+
+// Результат умножения пишется в scratch, после чего буферы меняются
+// местами: *target = a * b без новых выделений памяти
+void MultiplySwap(const S21Matrix& a, const S21Matrix& b, S21Matrix* target,
+                  S21Matrix* scratch) {
+  MultiplyInto(a.GetConstMatrixPointer(), b.GetConstMatrixPointer(),
+               scratch->GetMatrixPointer(), a.GetRows(), a.GetCols(),
+               b.GetCols());
+  std::swap(*target, *scratch);
+}
+
+}  // namespace
+
+S21Matrix S21Matrix::Pow(int k) const {
+  S21_PROFILE_SCOPE(kPow, Elements(rows_, cols_), 0);
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = rows_;
+  // Отрицательная степень — степень обратной матрицы, найденной через LU
+  S21Matrix base = k < 0 ? Solve(Identity(n)) : S21Matrix(*this);
+  std::uint64_t exponent =
+      k < 0 ? static_cast<std::uint64_t>(-static_cast<std::int64_t>(k))
+            : static_cast<std::uint64_t>(k);
+  if (exponent == 0) return Identity(n);
+
+  // Двоичное возведение: результат и база по очереди пишутся в общий
+  // буфер scratch, и каждый шаг обходится без выделения памяти
+  S21Matrix result(n, n), scratch(n, n);
+  bool has_result = false;
+  while (exponent != 0) {
+    if (exponent & 1) {
+      if (has_result) {
+        MultiplySwap(result, base, &result, &scratch);
+      } else {
+        for (int i = 0; i < n; ++i) {
+          std::copy(base.matrix_[i], base.matrix_[i] + n, result.matrix_[i]);
+        }
+        has_result = true;
+      }
+    }
+    exponent >>= 1;
+    if (exponent != 0) MultiplySwap(base, base, &base, &scratch);
+  }
+  return result;
+}
+
+S21Matrix S21Matrix::Exp() const {
+  S21_PROFILE_SCOPE(kExp, Elements(rows_, cols_), 0);
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = rows_;
+  const double norm = Norm1();
+  if (!std::isfinite(norm)) {
+    throw std::invalid_argument("Матрица содержит бесконечные или NaN");
+  }
+
+  // Наименьшая степень Паде, точная для данной нормы; иначе степень 13 и
+  // масштабирование A / 2^s
+  int choice = 0;
+  while (choice < 4 && norm > kPadeThetas[choice]) ++choice;
+  const int degree = kPadeDegrees[choice];
+  int squarings = 0;
+  if (norm > kPadeThetas[4]) {
+    squarings = static_cast<int>(std::ceil(std::log2(norm / kPadeThetas[4])));
+  }
+  S21Matrix a(*this);
+  if (squarings > 0) a.MulNumber(std::ldexp(1.0, -squarings));
+
+  const double* b = degree == 3   ? kPade3
+                    : degree == 5 ? kPade5
+                    : degree == 7 ? kPade7
+                    : degree == 9 ? kPade9
+                                  : kPade13;
+  S21Matrix u(n, n), v(n, n), scratch(n, n);
+  S21Matrix a2(n, n);
+  MultiplyInto(a.matrix_, a.matrix_, a2.matrix_, n, n, n);
+  if (degree < 13) {
+    // U = A * sum b[2j+1] A^(2j), V = sum b[2j] A^(2j)
+    S21Matrix odd(n, n), power = Identity(n);
+    for (int j = 0; 2 * j <= degree; ++j) {
+      AddScaled(power, b[2 * j], &v);
+      AddScaled(power, b[2 * j + 1], &odd);
+      if (2 * j + 2 <= degree) MultiplySwap(power, a2, &power, &scratch);
+    }
+    MultiplyInto(a.matrix_, odd.matrix_, u.matrix_, n, n, n);
+  } else {
+    // Схема Хайэма: шесть умножений на аппроксимант степени 13
+    S21Matrix a4(n, n), a6(n, n), identity = Identity(n);
+    MultiplyInto(a2.matrix_, a2.matrix_, a4.matrix_, n, n, n);
+    MultiplyInto(a2.matrix_, a4.matrix_, a6.matrix_, n, n, n);
+    S21Matrix high(n, n), low(n, n);
+    AddScaled(a6, b[13], &high);
+    AddScaled(a4, b[11], &high);
+    AddScaled(a2, b[9], &high);
+    MultiplyInto(a6.matrix_, high.matrix_, low.matrix_, n, n, n);
+    AddScaled(a6, b[7], &low);
+    AddScaled(a4, b[5], &low);
+    AddScaled(a2, b[3], &low);
+    AddScaled(identity, b[1], &low);
+    MultiplyInto(a.matrix_, low.matrix_, u.matrix_, n, n, n);
+
+    S21Matrix even(n, n);
+    AddScaled(a6, b[12], &even);
+    AddScaled(a4, b[10], &even);
+    AddScaled(a2, b[8], &even);
+    MultiplyInto(a6.matrix_, even.matrix_, v.matrix_, n, n, n);
+    AddScaled(a6, b[6], &v);
+    AddScaled(a4, b[4], &v);
+    AddScaled(a2, b[2], &v);
+    AddScaled(identity, b[0], &v);
+  }
+
+  // r = (V - U)^-1 (V + U) через LU-разложение, затем r^(2^s)
+  S21Matrix numerator(v), denominator(v);
+  AddScaled(u, 1.0, &numerator);
+  AddScaled(u, -1.0, &denominator);
+  S21Matrix result = denominator.Solve(numerator);
+  for (int i = 0; i < squarings; ++i) {
+    MultiplySwap(result, result, &result, &scratch);
+  }
+  return result;
+}
+
+S21Matrix S21Matrix::Polynomial(const std::vector<double>& coefficients) const {
+  S21_PROFILE_SCOPE(kPolynomial, Elements(rows_, cols_), 0);
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  const int n = rows_;
+  S21Matrix result(n, n);
+  if (coefficients.empty()) return result;
+
+  // Паттерсон–Стокмейер: p(A) = sum_j B_j (A^s)^j, где B_j — многочлены
+  // степени меньше s; около 2 sqrt(d) умножений вместо d
+  const int degree = static_cast<int>(coefficients.size()) - 1;
+  const int step = std::max(1, static_cast<int>(std::ceil(
+                                  std::sqrt(static_cast<double>(degree + 1)))));
+  const int blocks = degree / step;
+  std::vector<S21Matrix> powers;
+  powers.reserve(step + 1);
+  powers.push_back(Identity(n));
+  const int needed = blocks > 0 ? step : std::min(step - 1, degree);
+  for (int i = 1; i <= needed; ++i) {
+    S21Matrix next(n, n);
+    MultiplyInto(powers.back().matrix_, matrix_, next.matrix_, n, n, n);
+    powers.push_back(std::move(next));
+  }
+
+  S21Matrix scratch(n, n);
+  for (int block = blocks; block >= 0; --block) {
+    if (block != blocks) {
+      MultiplySwap(result, powers[step], &result, &scratch);
+    }
+    for (int i = 0; i < step && block * step + i <= degree; ++i) {
+      AddScaled(powers[i], coefficients[block * step + i], &result);
+    }
+  }
+  return result;
+}
+
+S21Matrix S21Matrix::Kronecker(const S21Matrix& other) const {
+  const std::uint64_t rows = Elements(rows_, other.rows_);
+  const std::uint64_t cols = Elements(cols_, other.cols_);
+  S21_PROFILE_SCOPE(kKronecker, rows * cols, rows * cols);
+  if (rows > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+      cols > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    throw std::invalid_argument("Размер произведения Кронекера слишком велик");
+  }
+  S21Matrix result(static_cast<int>(rows), static_cast<int>(cols));
+  // Строка i * p + k результата — это строка k матрицы other, умноженная
+  // поочерёдно на элементы строки i текущей матрицы
+  double** a = matrix_;
+  double** b = other.matrix_;
+  double** c = result.matrix_;
+  const int p = other.rows_, q = other.cols_, n = cols_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      result.rows_, rows * cols, cols * sizeof(double),
+      [a, b, c, p, q, n](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+          const double* source = b[row % p];
+          const double* factors = a[row / p];
+          for (int j = 0; j < n; ++j) {
+            double* target = c[row] + static_cast<std::size_t>(j) * q;
+            const double factor = factors[j];
+            for (int l = 0; l < q; ++l) target[l] = factor * source[l];
+          }
+        }
+      });
+  return result;
+}
+
+S21Matrix S21Matrix::KroneckerMul(const S21Matrix& other,
+                                  const S21Matrix& x) const {
+  const int m = rows_, n = cols_, p = other.rows_, q = other.cols_;
+  const int r = x.cols_;
+  const std::uint64_t rows = Elements(m, p);
+  const std::uint64_t flops =
+      2 * Elements(m, q) * (n + p) * static_cast<std::uint64_t>(r);
+  S21_PROFILE_SCOPE(kKronecker, rows * r, flops);
+  if (Elements(n, q) != static_cast<std::uint64_t>(x.rows_)) {
+    throw std::invalid_argument(
+        "Число строк x должно быть равно произведению числа столбцов "
+        "сомножителей Кронекера");
+  }
+  if (rows > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    throw std::invalid_argument("Размер произведения Кронекера слишком велик");
+  }
+  // (A ⊗ B) x = vec(A X B^T) для каждого столбца x, свёрнутого в матрицу
+  // X размером n x q: произведение Кронекера не строится
+  S21Matrix result(static_cast<int>(rows), r);
+  double** a = matrix_;
+  double** b = other.matrix_;
+  double** xs = x.matrix_;
+  double** c = result.matrix_;
+  auto columns = [a, b, xs, c, m, n, p, q](int begin, int end) {
+    std::vector<double> folded(static_cast<std::size_t>(n) * q);
+    std::vector<double> left(static_cast<std::size_t>(m) * q);
+    for (int col = begin; col < end; ++col) {
+      for (int t = 0; t < n * q; ++t) folded[t] = xs[t][col];
+      // left = A * X
+      std::fill(left.begin(), left.end(), 0.0);
+      for (int i = 0; i < m; ++i) {
+        double* target = left.data() + static_cast<std::size_t>(i) * q;
+        for (int j = 0; j < n; ++j) {
+          const double factor = a[i][j];
+          const double* source =
+              folded.data() + static_cast<std::size_t>(j) * q;
+          for (int l = 0; l < q; ++l) target[l] += factor * source[l];
+        }
+      }
+      // result[i * p + k] = left[i] · B[k]
+      for (int i = 0; i < m; ++i) {
+        const double* row = left.data() + static_cast<std::size_t>(i) * q;
+        for (int k = 0; k < p; ++k) {
+          double sum = 0.0;
+          for (int l = 0; l < q; ++l) sum += row[l] * b[k][l];
+          c[i * p + k][col] = sum;
+        }
+      }
+    }
+  };
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      r, flops, Elements(n, q) * sizeof(double), columns);
+  return result;
+}
+
+void S21Matrix::HadamardMul(const S21Matrix& other) {
+  S21_PROFILE_SCOPE(kHadamard, Elements(rows_, cols_), Elements(rows_, cols_));
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    throw std::invalid_argument(
+        "Размеры матриц не подходят для поэлементного умножения.");
+  }
+  MakeUnique();
+  double** a = matrix_;
+  double** b = other.matrix_;
+  const int cols = cols_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows_, Elements(rows_, cols_) * kElementwiseWeight,
+      2 * cols * sizeof(double), [a, b, cols](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          for (int j = 0; j < cols; ++j) a[i][j] *= b[i][j];
+        }
+      });
+}
+
+void S21Matrix::HadamardDiv(const S21Matrix& other) {
+  S21_PROFILE_SCOPE(kHadamard, Elements(rows_, cols_), Elements(rows_, cols_));
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    throw std::invalid_argument(
+        "Размеры матриц не подходят для поэлементного деления.");
+  }
+  MakeUnique();
+  double** a = matrix_;
+  double** b = other.matrix_;
+  const int cols = cols_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows_, Elements(rows_, cols_) * kElementwiseWeight,
+      2 * cols * sizeof(double), [a, b, cols](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          for (int j = 0; j < cols; ++j) a[i][j] /= b[i][j];
+        }
+      });
+}
+
+void S21Matrix::RankUpdate(const S21Matrix& x, const S21Matrix& y,
+                           double alpha) {
+  S21_PROFILE_SCOPE(kRankUpdate, Elements(rows_, cols_),
+                    2 * Elements(rows_, cols_) * x.cols_);
+  if (x.rows_ != rows_ || y.cols_ != cols_ || x.cols_ != y.rows_) {
+    throw std::invalid_argument(
+        "Размеры x и y не подходят для обновления ранга: нужны x размером "
+        "rows x k и y размером k x cols");
+  }
+  MakeUnique();
+  double** c = matrix_;
+  double** xs = x.matrix_;
+  double** ys = y.matrix_;
+  const int k = x.cols_, cols = cols_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows_, 2 * Elements(rows_, cols_) * k, (k + cols) * sizeof(double),
+      [c, xs, ys, k, cols, alpha](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          for (int t = 0; t < k; ++t) {
+            const double factor = alpha * xs[i][t];
+            for (int j = 0; j < cols; ++j) c[i][j] += factor * ys[t][j];
+          }
+        }
+      });
+}
+
+void S21Matrix::SymmetricRankUpdate(const S21Matrix& x, double alpha,
+                                    double beta) {
+  S21_PROFILE_SCOPE(kRankUpdate, Elements(rows_, cols_),
+                    Elements(rows_, cols_) * x.cols_);
+  if (rows_ != cols_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  if (x.rows_ != rows_) {
+    throw std::invalid_argument(
+        "Число строк x должно совпадать с размером матрицы");
+  }
+  MakeUnique();
+  // Считается только нижний треугольник, верхний заполняется отражением:
+  // вдвое меньше операций, чем у RankUpdate(x, x^T)
+  double** c = matrix_;
+  double** xs = x.matrix_;
+  const int k = x.cols_;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows_, Elements(rows_, cols_) * k, (k + cols_) * sizeof(double),
+      [c, xs, k, alpha, beta](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          for (int j = 0; j <= i; ++j) {
+            double dot = 0.0;
+            for (int t = 0; t < k; ++t) dot += xs[i][t] * xs[j][t];
+            c[i][j] = beta * c[i][j] + alpha * dot;
+          }
+        }
+      });
+  for (int i = 0; i < rows_; ++i) {
+    for (int j = i + 1; j < cols_; ++j) c[i][j] = c[j][i];
+  }
+}
+
+namespace {
+
+// Размер блока строк, между которыми проверяется отмена
+const int kAsyncRowBlock = 64;
+
+// Ставит вычисление в пул и связывает его результат с future
+template <typename Compute>
+std::future<S21Matrix> RunAsync(const S21AsyncOptions& options,
+                                Compute compute) {
+  auto promise = std::make_shared<std::promise<S21Matrix>>();
+  std::future<S21Matrix> future = promise->get_future();
+  S21CancelToken token = options.token;
+  S21ThreadPool::Instance().Submit(
+      [promise, token, compute]() {
+        try {
+          ThrowIfCancelled(&token);
+          promise->set_value(compute(token));
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      },
+      options.priority);
+  return future;
+}
+
+}  // namespace
+
+std::future<S21Matrix> S21Matrix::MulMatrixAsync(
+    const S21Matrix& other, const S21AsyncOptions& options) const {
+  auto a = std::make_shared<const S21Matrix>(*this);
+  auto b = std::make_shared<const S21Matrix>(other);
+  return RunAsync(options, [a, b](const S21CancelToken& token) {
+    if (a->cols_ != b->rows_) {
+      throw std::invalid_argument(
+          "Количество столбцов в текущей матрице должно быть равно "
+          "количеству строк в матрице other.");
+    }
+    S21Matrix result(a->rows_, b->cols_);
+    // Полосы по kAsyncRowBlock строк на поток: каждая умножается блочным
+    // ядром MulMatrix и делится между потоками пула
+    const int band =
+        kAsyncRowBlock * S21ThreadPool::Instance().ThreadCount();
+    for (int block = 0; block < a->rows_; block += band) {
+      ThrowIfCancelled(&token);
+      const int end = std::min(block + band, a->rows_);
+      MultiplyInto(a->matrix_ + block, b->matrix_, result.matrix_ + block,
+                   end - block, a->cols_, b->cols_);
+    }
+    return result;
+  });
+}
+
+std::future<S21Matrix> S21Matrix::InverseAsync(
+    const S21AsyncOptions& options) const {
+  auto a = std::make_shared<const S21Matrix>(*this);
+  return RunAsync(options, [a](const S21CancelToken& token) {
+    S21Matrix inverse;
+    a->InverseIntoCancellable(&inverse, &token);
+    return inverse;
+  });
+}
+
+std::future<S21Matrix> S21Matrix::SolveAsync(
+    const S21Matrix& b, const S21AsyncOptions& options) const {
+  auto a = std::make_shared<const S21Matrix>(*this);
+  auto rhs = std::make_shared<const S21Matrix>(b);
+  return RunAsync(options, [a, rhs](const S21CancelToken& token) {
+    return a->SolveCancellable(*rhs, &token);
+  });
+}
+
+namespace {
+
+// Число элементов, с которого редукция распределяется по пулу
+const std::uint64_t kParallelReduceElements = std::uint64_t(1) << 16;
+
+// Число независимых аккумуляторов: позволяет векторизовать суммирование без
+// -ffast-math, так как порядок сложения задан явно
+const int kReduceLanes = 4;
+
+// Частичные итоги по участку матрицы
+struct Partial {
+  double sum = 0.0, abs_sum = 0.0, squares = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+};
+
+inline void Merge(const Partial& from, Partial* to) {
+  to->sum += from.sum;
+  to->abs_sum += from.abs_sum;
+  to->squares += from.squares;
+  to->min = std::min(to->min, from.min);
+  to->max = std::max(to->max, from.max);
+}
+
+// Сумма с компенсацией ошибки округления (вариант Ноймайера)
+struct Compensated {
+  double sum = 0.0, correction = 0.0;
+
+  void Add(double value) {
+    double total = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) {
+      correction += (sum - total) + value;
+    } else {
+      correction += (value - total) + sum;
+    }
+    sum = total;
+  }
+  double Value() const { return sum + correction; }
+};
+
+// Все итоги отрезка за один проход по памяти
+Partial ReduceNaive(const double* x, int n) {
+  double sum[kReduceLanes] = {}, abs_sum[kReduceLanes] = {};
+  double squares[kReduceLanes] = {};
+  double low[kReduceLanes], high[kReduceLanes];
+  for (int l = 0; l < kReduceLanes; ++l) {
+    low[l] = std::numeric_limits<double>::infinity();
+    high[l] = -std::numeric_limits<double>::infinity();
+  }
+  int j = 0;
+  for (; j + kReduceLanes <= n; j += kReduceLanes) {
+    for (int l = 0; l < kReduceLanes; ++l) {
+      double value = x[j + l];
+      sum[l] += value;
+      abs_sum[l] += std::fabs(value);
+      squares[l] += value * value;
+      low[l] = value < low[l] ? value : low[l];
+      high[l] = value > high[l] ? value : high[l];
+    }
+  }
+  for (int l = 0; j < n; ++j, ++l) {
+    sum[l] += x[j];
+    abs_sum[l] += std::fabs(x[j]);
+    squares[l] += x[j] * x[j];
+    low[l] = std::min(low[l], x[j]);
+    high[l] = std::max(high[l], x[j]);
+  }
+  Partial result;
+  for (int l = 0; l < kReduceLanes; ++l) {
+    result.sum += sum[l];
+    result.abs_sum += abs_sum[l];
+    result.squares += squares[l];
+    result.min = std::min(result.min, low[l]);
+    result.max = std::max(result.max, high[l]);
+  }
+  return result;
+}
+
+// Попарное суммирование: ошибка растёт как O(log n) вместо O(n)
+Partial ReducePairwise(const double* x, int n) {
+  if (n <= kCompareBlock) return ReduceNaive(x, n);
+  int half = n / 2;
+  Partial result = ReducePairwise(x, half);
+  Merge(ReducePairwise(x + half, n - half), &result);
+  return result;
+}
+
+Partial ReduceKahan(const double* x, int n) {
+  Compensated sum, abs_sum, squares;
+  Partial result;
+  for (int j = 0; j < n; ++j) {
+    sum.Add(x[j]);
+    abs_sum.Add(std::fabs(x[j]));
+    squares.Add(x[j] * x[j]);
+    result.min = std::min(result.min, x[j]);
+    result.max = std::max(result.max, x[j]);
+  }
+  result.sum = sum.Value();
+  result.abs_sum = abs_sum.Value();
+  result.squares = squares.Value();
+  return result;
+}
+
+Partial ReduceRow(const double* row, int n, S21Summation mode) {
+  switch (mode) {
+    case S21Summation::kPairwise:
+      return ReducePairwise(row, n);
+    case S21Summation::kKahan:
+      return ReduceKahan(row, n);
+    default:
+      return ReduceNaive(row, n);
+  }
+}
+
+// Объединяет итоги строк [begin, end) тем же способом суммирования
+Partial FoldRows(const std::vector<Partial>& rows, int begin, int end,
+                 S21Summation mode) {
+  Partial result;
+  if (mode == S21Summation::kPairwise && end - begin > 2) {
+    int middle = begin + (end - begin) / 2;
+    result = FoldRows(rows, begin, middle, mode);
+    Merge(FoldRows(rows, middle, end, mode), &result);
+  } else if (mode == S21Summation::kKahan) {
+    Compensated sum, abs_sum, squares;
+    for (int i = begin; i < end; ++i) {
+      sum.Add(rows[i].sum);
+      abs_sum.Add(rows[i].abs_sum);
+      squares.Add(rows[i].squares);
+      result.min = std::min(result.min, rows[i].min);
+      result.max = std::max(result.max, rows[i].max);
+    }
+    result.sum = sum.Value();
+    result.abs_sum = abs_sum.Value();
+    result.squares = squares.Value();
+  } else {
+    for (int i = begin; i < end; ++i) Merge(rows[i], &result);
+  }
+  return result;
+}
+
+// Итоги по строкам и, при необходимости, по столбцам матрицы
+struct Reduction {
+  std::vector<Partial> rows;
+  std::vector<double> column_sums, column_abs_sums;
+  Partial total;
+};
+
+Reduction ReduceMatrix(double** matrix, int rows, int cols,
+                       S21Summation mode, bool columns) {
+  Reduction reduction;
+  reduction.rows.resize(rows);
+  if (columns) {
+    reduction.column_sums.assign(cols, 0.0);
+    reduction.column_abs_sums.assign(cols, 0.0);
+  }
+  std::mutex merge_mutex;
+  // Каждый участок строк копит суммы столбцов локально и сливает их в
+  // общий итог один раз
+  auto reduce_rows = [&](int begin, int end) {
+    std::vector<double> sums, abs_sums, sum_errors, abs_errors;
+    if (columns) {
+      sums.assign(cols, 0.0);
+      abs_sums.assign(cols, 0.0);
+      if (mode == S21Summation::kKahan) {
+        sum_errors.assign(cols, 0.0);
+        abs_errors.assign(cols, 0.0);
+      }
+    }
+    for (int i = begin; i < end; ++i) {
+      const double* row = matrix[i];
+      reduction.rows[i] = ReduceRow(row, cols, mode);
+      if (!columns) continue;
+      if (mode == S21Summation::kKahan) {
+        for (int j = 0; j < cols; ++j) {
+          Compensated sum{sums[j], sum_errors[j]};
+          sum.Add(row[j]);
+          sums[j] = sum.sum;
+          sum_errors[j] = sum.correction;
+          Compensated abs_sum{abs_sums[j], abs_errors[j]};
+          abs_sum.Add(std::fabs(row[j]));
+          abs_sums[j] = abs_sum.sum;
+          abs_errors[j] = abs_sum.correction;
+        }
+      } else {
+        for (int j = 0; j < cols; ++j) {
+          sums[j] += row[j];
+          abs_sums[j] += std::fabs(row[j]);
+        }
+      }
+    }
+    if (!columns) return;
+    for (std::size_t j = 0; j < sum_errors.size(); ++j) {
+      sums[j] += sum_errors[j];
+      abs_sums[j] += abs_errors[j];
+    }
+    std::lock_guard<std::mutex> lock(merge_mutex);
+    for (int j = 0; j < cols; ++j) {
+      reduction.column_sums[j] += sums[j];
+      reduction.column_abs_sums[j] += abs_sums[j];
+    }
+  };
+
+  S21ThreadPool& pool = S21ThreadPool::Instance();
+  if (pool.ThreadCount() > 1 &&
+      Elements(rows, cols) >= kParallelReduceElements) {
+    pool.ParallelRows(rows, cols * sizeof(double), reduce_rows);
+  } else {
+    reduce_rows(0, rows);
+  }
+  reduction.total = FoldRows(reduction.rows, 0, rows, mode);
+  return reduction;
+}
+
+}  // namespace
+
+S21MatrixStats S21Matrix::Statistics(S21Summation mode) const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_),
+                    5 * Elements(rows_, cols_));
+  if (rows_ == 0 || cols_ == 0) {
+    throw std::invalid_argument("Матрица не должна быть пустой");
+  }
+  Reduction reduction = ReduceMatrix(matrix_, rows_, cols_, mode, true);
+  S21MatrixStats stats;
+  stats.sum = reduction.total.sum;
+  stats.mean = stats.sum / static_cast<double>(Elements(rows_, cols_));
+  stats.min = reduction.total.min;
+  stats.max = reduction.total.max;
+  stats.frobenius = std::sqrt(reduction.total.squares);
+  for (const Partial& row : reduction.rows) {
+    stats.norm_inf = std::max(stats.norm_inf, row.abs_sum);
+  }
+  for (double column : reduction.column_abs_sums) {
+    stats.norm1 = std::max(stats.norm1, column);
+  }
+  Compensated trace;
+  for (int i = 0; i < std::min(rows_, cols_); ++i) trace.Add(matrix_[i][i]);
+  stats.trace = trace.Value();
+  return stats;
+}
+
+double S21Matrix::Sum(S21Summation mode) const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_), Elements(rows_, cols_));
+  return ReduceMatrix(matrix_, rows_, cols_, mode, false).total.sum;
+}
+
+double S21Matrix::Mean(S21Summation mode) const {
+  if (rows_ == 0 || cols_ == 0) {
+    throw std::invalid_argument("Матрица не должна быть пустой");
+  }
+  return Sum(mode) / static_cast<double>(Elements(rows_, cols_));
+}
+
+double S21Matrix::Min() const {
+  if (rows_ == 0 || cols_ == 0) {
+    throw std::invalid_argument("Матрица не должна быть пустой");
+  }
+  return ReduceMatrix(matrix_, rows_, cols_, S21Summation::kNaive, false)
+      .total.min;
+}
+
+double S21Matrix::Max() const {
+  if (rows_ == 0 || cols_ == 0) {
+    throw std::invalid_argument("Матрица не должна быть пустой");
+  }
+  return ReduceMatrix(matrix_, rows_, cols_, S21Summation::kNaive, false)
+      .total.max;
+}
+
+double S21Matrix::Trace() const {
+  if (cols_ != rows_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  Compensated trace;
+  for (int i = 0; i < rows_; ++i) trace.Add(matrix_[i][i]);
+  return trace.Value();
+}
+
+double S21Matrix::NormFrobenius(S21Summation mode) const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_),
+                    2 * Elements(rows_, cols_));
+  return std::sqrt(
+      ReduceMatrix(matrix_, rows_, cols_, mode, false).total.squares);
+}
+
+double S21Matrix::Norm1() const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_), Elements(rows_, cols_));
+  Reduction reduction =
+      ReduceMatrix(matrix_, rows_, cols_, S21Summation::kNaive, true);
+  double norm = 0.0;
+  for (double column : reduction.column_abs_sums) norm = std::max(norm, column);
+  return norm;
+}
+
+double S21Matrix::NormInf() const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_), Elements(rows_, cols_));
+  Reduction reduction =
+      ReduceMatrix(matrix_, rows_, cols_, S21Summation::kNaive, false);
+  double norm = 0.0;
+  for (const Partial& row : reduction.rows) norm = std::max(norm, row.abs_sum);
+  return norm;
+}
+
+S21Matrix S21Matrix::RowSums(S21Summation mode) const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_), Elements(rows_, cols_));
+  Reduction reduction = ReduceMatrix(matrix_, rows_, cols_, mode, false);
+  S21Matrix sums(rows_, 1);
+  for (int i = 0; i < rows_; ++i) sums.matrix_[i][0] = reduction.rows[i].sum;
+  return sums;
+}
+
+S21Matrix S21Matrix::ColSums(S21Summation mode) const {
+  S21_PROFILE_SCOPE(kReduce, Elements(rows_, cols_), Elements(rows_, cols_));
+  Reduction reduction = ReduceMatrix(matrix_, rows_, cols_, mode, true);
+  S21Matrix sums(1, cols_);
+  for (int j = 0; j < cols_; ++j) {
+    sums.matrix_[0][j] = reduction.column_sums[j];
+  }
+  return sums;
 }
 
 S21Matrix& S21Matrix::operator+=(const S21Matrix& B) {
@@ -232,24 +2157,29 @@ S21Matrix& S21Matrix::operator*=(const S21Matrix& B) {
 }
 
 S21Matrix S21Matrix::operator+(const S21Matrix& B) const {
+  // Работу учитывает SumMatrix
+  S21_PROFILE_SCOPE(kOperatorPlus, Elements(rows_, cols_), 0);
   S21Matrix result(*this);
   result += B;
   return result;
 }
 
 S21Matrix S21Matrix::operator-(const S21Matrix& B) const {
+  S21_PROFILE_SCOPE(kOperatorMinus, Elements(rows_, cols_), 0);
   S21Matrix result(*this);
   result -= B;
   return result;
 }
 
 S21Matrix S21Matrix::operator*(const S21Matrix& B) const {
+  S21_PROFILE_SCOPE(kOperatorMulMatrix, Elements(rows_, B.cols_), 0);
   S21Matrix result(*this);
   result *= B;
   return result;
 }
 
 S21Matrix S21Matrix::operator*(double B) const {
+  S21_PROFILE_SCOPE(kOperatorMulNumber, Elements(rows_, cols_), 0);
   S21Matrix result(*this);
   result *= B;
   return result;
@@ -263,6 +2193,7 @@ double& S21Matrix::operator()(int i, int j) {
   if (i < 0 || i >= rows_ || j < 0 || j >= cols_) {
     throw std::out_of_range("Матрица вне диапазона");
   }
+  MakeUnshareable();
   return matrix_[i][j];
 }
 
@@ -276,6 +2207,7 @@ const double& S21Matrix::operator()(int i, int j) const {
 // Геттеры и Сеттеры
 
 void S21Matrix::SetElement(int rows, int cols, double number) {
+  MakeUnique();
   matrix_[rows][cols] = number;
 }
 
@@ -287,4 +2219,11 @@ int S21Matrix::GetRows() const { return rows_; }
 
 int S21Matrix::GetCols() const { return cols_; }
 
-double** S21Matrix::GetMatrixPointer() const { return matrix_; }
+double** S21Matrix::GetMatrixPointer() const {
+  MakeUnshareable();
+  return matrix_;
+}
+
+const double* const* S21Matrix::GetConstMatrixPointer() const {
+  return matrix_;
+}
@@ -1,22 +1,102 @@
+#ifndef S21_MATRIX_OOP
 #define S21_MATRIX_OOP
-#ifdef S21_MATRIX_OOP
 
 // Небходимые зависимые директивы
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
+#include "s21_thread_pool.h"
+
+// Отчёт об итерационном уточнении решения
+struct S21RefineReport {
+  int iterations = 0;      // Число шагов уточнения
+  double residual = 0.0;   // Итоговая относительная невязка (max-норма)
+  bool converged = false;  // Достигнута ли точность double
+  bool fell_back = false;  // Решено полностью в двойной точности
+};
+
+// Способ суммирования в редукциях
+enum class S21Summation {
+  kNaive,     // Несколько независимых аккумуляторов, самый быстрый
+  kPairwise,  // Попарное суммирование, ошибка O(log n)
+  kKahan      // Компенсированное суммирование, ошибка O(1), медленнее
+};
+
+// Статистики матрицы, собранные за один проход по памяти
+struct S21MatrixStats {
+  double sum = 0.0;
+  double mean = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double frobenius = 0.0;  // sqrt(сумма квадратов элементов)
+  double norm1 = 0.0;      // Максимальная сумма модулей по столбцам
+  double norm_inf = 0.0;   // Максимальная сумма модулей по строкам
+  double trace = 0.0;      // Сумма элементов главной диагонали
+};
+
+/**
+ * @brief Матрица вещественных чисел двойной точности.
+ *
+ * Потокобезопасность: константные методы (Determinant, Transpose,
+ * InverseMatrix, Solve, operator*, копирование и т. д.) можно одновременно
+ * вызывать для одного объекта из многих потоков, в том числе при включённом
+ * копировании при записи. Исключение — GetMatrixPointer(): он отделяет
+ * общий буфер. Неконстантные методы и присваивание требуют, чтобы объект в
+ * это время не использовал никакой другой поток; матрицу, которую читают
+ * другие потоки, заменяют через S21SharedMatrix.
+ */
 class S21Matrix {
  private:
   // Атрибуты
   int rows_, cols_;  // Сроки и столбцы
-  double** matrix_;  // Указатель на то где матрица будет размещаться в памяти
+  // matrix_, data_ и refs_ изменяются в константных методах только при
+  // отделении общего буфера (копирование при записи), значения элементов
+  // при этом не меняются
+  mutable double**
+      matrix_;  // Указатель на то где матрица будет размещаться в памяти
+  mutable double* data_;  // Непрерывный буфер элементов, на который
+                          // указывают строки matrix_
+  mutable std::atomic<long>* refs_;  // Число владельцев data_ или nullptr,
+                                     // если буфер не разделяется
+  mutable std::size_t capacity_;  // Число элементов, выделенных под data_
+  int row_capacity_;              // Длина массива указателей matrix_
 
   // Вспомогательные методы
   void AllocateMatrix(int rows, int cols);  // Выделяет место в памяти
   void DeallocateMatrix();  // Освобождает место в памяти
   void CopyMatrix(const S21Matrix& other);  // Копирует матрицу для другой
+  void ShareMatrix(const S21Matrix& other);  // Разделяет буфер другой матрицы
+  void MakeUnique() const;  // Отделяет общий буфер перед изменением
+  // Отделяет буфер и больше не даёт его разделять: копии, сделанные после
+  // выдачи изменяемой ссылки или указателя, копируют элементы сразу
+  void MakeUnshareable() const;
+  void ReleaseBuffer() const;  // Отказывается от владения data_
+  // Переносит элементы в новый буфер на capacity элементов и массив строк
+  // длины row_capacity
+  void Regrow(int row_capacity, std::size_t capacity);
+  void LinkRows(int begin);  // Указатели строк begin..rows_ на data_
+  // Добавляет count строк длины cols с геометрическим ростом ёмкости
+  void AppendRowData(const double* const* rows, int count, int cols);
+  double ComputeDeterminant() const;  // Определитель без обращения к кэшу
+  // Обратная матрица в *out без обращения к кэшу; out не совпадает с this.
+  // cancel, если задан, проверяется между фазами и строками дополнений
+  void ComputeInverseInto(S21Matrix* out,
+                          const S21CancelToken* cancel = nullptr) const;
+  // InverseInto() и Solve() с проверкой отмены для асинхронных вариантов
+  void InverseIntoCancellable(S21Matrix* out,
+                              const S21CancelToken* cancel) const;
+  S21Matrix SolveCancellable(const S21Matrix& b,
+                             const S21CancelToken* cancel) const;
+  double Cofactor(int row, int col) const;  // Алгебраическое дополнение
+  // Готовит *out к записи rows x cols: буфер, в который помещается
+  // результат, отделяется и переиспользуется, иначе выделяется заново
+  static void PrepareOutput(S21Matrix* out, int rows, int cols);
 
  public:
   S21Matrix();   // Дефолтный конструктор
@@ -29,6 +109,8 @@ class S21Matrix {
   S21Matrix(S21Matrix&& other) noexcept;  // Конструктор перемещения
   S21Matrix& operator=(
       S21Matrix&& other) noexcept;  // Оператор присваивания для перемещения
+  // Единичная матрица n x n; std::invalid_argument для n < 0
+  static S21Matrix Identity(int n);
 
   // Функции для опрераций над матрицами
   // =================================================================================================================================================================>
@@ -49,6 +131,34 @@ class S21Matrix {
    */
   bool EqMatrix(const S21Matrix& other) const;
 
+  /**
+   * @brief Сравнение матриц с допуском.
+   *
+   * Элементы a и b считаются равными, если |a - b| <= max(abs_tol,
+   * rel_tol * max(|a|, |b|)). Бесконечности одного знака равны, а
+   * конечному числу бесконечность не равна ни при каком допуске. NaN не
+   * равен ничему, в том числе NaN.
+   *
+   * @throw std::invalid_argument Если допуск отрицателен.
+   */
+  bool EqMatrix(const S21Matrix& other, double abs_tol,
+                double rel_tol = 0.0) const;
+
+  /**
+   * @brief Сравнение матриц с допуском в единицах последнего разряда.
+   *
+   * Элементы равны, если между ними не больше max_ulps представимых чисел
+   * double; +0 и -0 совпадают, NaN не равен ничему.
+   */
+  bool EqMatrixUlps(const S21Matrix& other, std::uint64_t max_ulps) const;
+
+  /**
+   * @brief Сравнение по норме Фробениуса: ||A - B||_F <= tol.
+   *
+   * @throw std::invalid_argument Если допуск отрицателен.
+   */
+  bool EqMatrixNorm(const S21Matrix& other, double tol) const;
+
   // =================================================================================================================================================================>
 
   /**
@@ -100,6 +210,20 @@ class S21Matrix {
    */
   void MulNumber(const double num);
   // =================================================================================================================================================================>
+  /**
+   * @brief Варианты сложения, вычитания и умножения на число с записью в
+   * готовую матрицу.
+   *
+   * Результат пишется в *out. Если результат помещается в уже выделенный
+   * буфер *out, память не выделяется; иначе *out перевыделяется. out может
+   * совпадать с a или b.
+   *
+   * @throws std::invalid_argument Если размеры a и b не совпадают.
+   */
+  static void SumInto(const S21Matrix& a, const S21Matrix& b, S21Matrix* out);
+  static void SubInto(const S21Matrix& a, const S21Matrix& b, S21Matrix* out);
+  static void MulNumberInto(const S21Matrix& a, double num, S21Matrix* out);
+  // =================================================================================================================================================================>
   /**
    * @brief Умножает текущую матрицу на указанную матрицу.
    *
@@ -116,6 +240,20 @@ class S21Matrix {
    */
   void MulMatrix(const S21Matrix& other);
   // =================================================================================================================================================================>
+  /**
+   * @brief c = alpha * a * b + beta * c, как dgemm в BLAS.
+   *
+   * При beta == 0 прежнее содержимое c не читается (NaN в нём не
+   * распространяется), а буфер c переиспользуется, как в SumInto(). При
+   * beta != 0 c должна уже иметь размер результата. Если c совпадает с a
+   * или b, произведение считается во временную матрицу.
+   *
+   * @throws std::invalid_argument Если число столбцов a не равно числу строк
+   * b или при beta != 0 размер c не равен размеру произведения.
+   */
+  static void MulInto(const S21Matrix& a, const S21Matrix& b, S21Matrix* c,
+                      double alpha = 1.0, double beta = 0.0);
+  // =================================================================================================================================================================>
   /**
    * @brief Транспонирует текущую матрицу.
    *
@@ -130,6 +268,9 @@ class S21Matrix {
    * объекта.
    */
   S21Matrix Transpose() const;
+  // Transpose() с записью в *out: буфер *out подходящего размера
+  // переиспользуется без выделения памяти. out может совпадать с this
+  void TransposeInto(S21Matrix* out) const;
   // =================================================================================================================================================================>
   /**
    * @brief Вычисляет определитель текущей матрицы.
@@ -143,6 +284,9 @@ class S21Matrix {
    * NaN), чтобы указать на ошибку.
    *
    * @throws std::invalid_argument Если матрица не является квадратной.
+   *
+   * @note Если включён S21MatrixCache, результат для уже встречавшейся
+   * матрицы берётся из кэша.
    */
   double Determinant() const;
   // =================================================================================================================================================================>
@@ -160,6 +304,9 @@ class S21Matrix {
    *
    */
   S21Matrix Minor(int row, int col) const;
+  // Minor() с записью в *out, как TransposeInto(); std::out_of_range для
+  // индексов вне матрицы
+  void MinorInto(int row, int col, S21Matrix* out) const;
   // =================================================================================================================================================================>
   /**
    * @brief Вычисляет матрицу алгебраических дополнений.
@@ -176,6 +323,10 @@ class S21Matrix {
    * @throws std::invalid_argument Если матрица не является квадратной.
    */
   S21Matrix CalcComplements() const;
+  // CalcComplements() с записью в *out, как TransposeInto(). Миноры не
+  // копируются: дополнения считаются по индексам строк и столбцов исходной
+  // матрицы в рабочем буфере потока
+  void CalcComplementsInto(S21Matrix* out) const;
   // =================================================================================================================================================================>
   /**
    * @brief Вычисляет обратную матрицу.
@@ -188,9 +339,333 @@ class S21Matrix {
    * @return Возвращает объект типа S21Matrix, представляющий обратную матрицу
    * исходной матрицы.
    *
-   * @throws std::invalid_argument Если матрица не является квадратной.
+   * До обращения алгебраическими дополнениями матрица проверяется за
+   * O(n^3): если после масштабирования строк и столбцов степенями двойки
+   * ConditionEstimate() меньше машинного эпсилона, результат не имел бы
+   * верных знаков, и обращение не выполняется.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной,
+   * вырождена или настолько плохо обусловлена.
+   *
+   * @note Если включён S21MatrixCache, результат для уже встречавшейся
+   * матрицы берётся из кэша.
    */
   S21Matrix InverseMatrix() const;
+  // InverseMatrix() с записью в *out, как TransposeInto(); рабочие буферы
+  // проверки обусловленности переиспользуются потоком между вызовами
+  void InverseInto(S21Matrix* out) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Решает систему линейных уравнений A * X = B.
+   *
+   * Текущая матрица выступает матрицей коэффициентов A. Система решается
+   * методом Гаусса с частичным выбором ведущего элемента, поэтому
+   * вычисление занимает O(n^3) и не требует построения обратной матрицы.
+   *
+   * @param b Матрица правых частей размером n x m, каждый столбец которой
+   * является отдельной правой частью.
+   *
+   * @return Возвращает матрицу решений X размером n x m.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной, число
+   * строк b не совпадает с размером матрицы или матрица вырождена.
+   */
+  S21Matrix Solve(const S21Matrix& b) const;
+
+  /**
+   * @brief LU-разложение с частичным выбором ведущего элемента: P A = L U.
+   *
+   * L (с единичной диагональю, не хранится) и U упакованы в одну матрицу
+   * n x n: ниже диагонали лежат множители L, на диагонали и выше — U.
+   *
+   * @param pivots Перестановка в виде последовательности обменов: на шаге k
+   * строка k обменивается со строкой (*pivots)[k].
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной или
+   * вырождена.
+   */
+  S21Matrix LuDecompose(std::vector<int>* pivots) const;
+
+  /**
+   * @brief Оценка обратного числа обусловленности 1 / (||A||_1 ||A^-1||_1).
+   *
+   * По LU-разложению за O(n^3) и нескольким решениям за O(n^2) методом
+   * Хейгера — Хайэма (S21InverseNorm1Estimate), без построения обратной.
+   * Значение порядка машинного эпсилона и меньше означает, что решение
+   * системы с этой матрицей не имеет верных знаков.
+   *
+   * @return Оценка из [0, 1]; 0 для вырожденной матрицы.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной.
+   */
+  double ConditionEstimate() const;
+
+  /**
+   * @brief Натуральный логарифм |det A| по LU-разложению.
+   *
+   * В отличие от Determinant() не переполняется и не теряет значение в
+   * нуле при больших n и занимает O(n^3).
+   *
+   * @param sign Если задан, получает знак определителя: -1, 0 или 1.
+   *
+   * @return ln|det A|; минус бесконечность для вырожденной матрицы.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной.
+   */
+  double LogDeterminant(int* sign = nullptr) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Решает систему A * X = B со смешанной точностью.
+   *
+   * Матрица раскладывается в одинарной точности (float), после чего решение
+   * уточняется итерациями: невязка b - A * x считается в двойной точности, а
+   * поправка находится по готовому float-разложению. Для хорошо
+   * обусловленных систем результат имеет точность double при стоимости
+   * разложения float.
+   *
+   * Если уточнение не сходится (невязка перестаёт убывать вдвое за шаг, что
+   * означает слишком большое число обусловленности для float) или
+   * float-разложение вырождено, система решается полностью в double.
+   *
+   * @param b Матрица правых частей размером n x m.
+   * @param report Необязательный отчёт: число итераций, итоговая
+   * относительная невязка ||b - Ax|| / (||A|| ||x|| + ||b||) и признак
+   * перехода на double.
+   *
+   * @throws std::invalid_argument В тех же случаях, что и Solve().
+   */
+  S21Matrix SolveRefined(const S21Matrix& b,
+                         S21RefineReport* report = nullptr) const;
+  S21Matrix InverseRefined(S21RefineReport* report = nullptr) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Возводит матрицу в целую степень k.
+   *
+   * Используется двоичное возведение: около 2 log2(k) умножений, причём
+   * промежуточные произведения пишутся по очереди в два заранее выделенных
+   * буфера. Отрицательная степень — степень обратной матрицы, которая
+   * находится через LU-разложение. Pow(0) возвращает единичную матрицу.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной или
+   * k < 0 для вырожденной матрицы.
+   */
+  S21Matrix Pow(int k) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Вычисляет матричную экспоненту exp(A).
+   *
+   * Метод масштабирования и возведения в квадрат с аппроксимантом Паде
+   * степени 3–13, выбранной по 1-норме матрицы (Higham, 2005). Знаменатель
+   * аппроксиманта обращается не явно, а решением системы через
+   * LU-разложение.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной или
+   * содержит бесконечности и NaN.
+   */
+  S21Matrix Exp() const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Вычисляет многочлен p(A) = c[0] I + c[1] A + ... + c[d] A^d.
+   *
+   * Схема Паттерсона–Стокмейера требует около 2 sqrt(d) умножений матриц
+   * вместо d у схемы Горнера.
+   *
+   * @param coefficients Коэффициенты по возрастанию степени. Пустой вектор
+   * даёт нулевую матрицу.
+   *
+   * @throws std::invalid_argument Если матрица не является квадратной.
+   */
+  S21Matrix Polynomial(const std::vector<double>& coefficients) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Произведение Кронекера A ⊗ B.
+   *
+   * Для A размером m x n и B размером p x q результат имеет размер
+   * mp x nq, блок (i, j) которого равен A(i, j) * B.
+   *
+   * @throws std::invalid_argument Если размер результата не помещается в int.
+   */
+  S21Matrix Kronecker(const S21Matrix& other) const;
+
+  /**
+   * @brief Вычисляет (A ⊗ B) * x, не строя произведение Кронекера.
+   *
+   * Используется тождество (A ⊗ B) vec(X) = vec(A X B^T): каждый столбец x
+   * сворачивается в матрицу n x q. Вместо O(mnpq) памяти и операций на
+   * столбец требуется O(mq(n + p)).
+   *
+   * @param other Матрица B размером p x q.
+   * @param x Матрица размером nq x r.
+   * @return Матрица размером mp x r.
+   * @throws std::invalid_argument Если число строк x не равно nq или mp не
+   * помещается в int.
+   */
+  S21Matrix KroneckerMul(const S21Matrix& other, const S21Matrix& x) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Поэлементное (адамарово) умножение и деление на другую матрицу.
+   *
+   * Результат записывается в текущую матрицу. Деление следует правилам
+   * IEEE 754: деление на ноль даёт бесконечность или NaN.
+   *
+   * @throws std::invalid_argument Если размеры матриц не совпадают.
+   */
+  void HadamardMul(const S21Matrix& other);
+  void HadamardDiv(const S21Matrix& other);
+  // =================================================================================================================================================================>
+  /**
+   * @brief Обновление ранга k (GER): C += alpha * x * y.
+   *
+   * @param x Матрица размером rows x k (при k = 1 — вектор-столбец).
+   * @param y Матрица размером k x cols (при k = 1 — вектор-строка).
+   */
+  void RankUpdate(const S21Matrix& x, const S21Matrix& y, double alpha = 1.0);
+
+  /**
+   * @brief Симметричное обновление ранга k (SYRK): C = alpha x x^T + beta C.
+   *
+   * Текущая матрица считается симметричной: вычисляется нижний треугольник,
+   * а верхний заполняется его отражением.
+   *
+   * @param x Матрица размером n x k.
+   * @throws std::invalid_argument Если матрица не квадратная или число
+   * строк x не равно её размеру.
+   */
+  void SymmetricRankUpdate(const S21Matrix& x, double alpha = 1.0,
+                           double beta = 1.0);
+  // =================================================================================================================================================================>
+  /**
+   * @brief Асинхронные варианты MulMatrix, InverseMatrix и Solve.
+   *
+   * Операция ставится в очередь пула потоков библиотеки (S21ThreadPool) с
+   * приоритетом options.priority и немедленно возвращает future. Операнды
+   * копируются при постановке, поэтому исходные матрицы можно изменять или
+   * уничтожать сразу после вызова.
+   *
+   * MulMatrixAsync умножает полосами строк тем же блочным многопоточным
+   * ядром, что и MulMatrix. Отмена через options.token проверяется перед
+   * запуском и затем: в MulMatrixAsync — между полосами строк, в
+   * InverseAsync — после проверки обусловленности, после определителя и
+   * между строками алгебраических дополнений, в SolveAsync — после
+   * LU-разложения и между правыми частями. Сами LU-разложение и
+   * определитель не прерываются. Отменённая операция завершает future
+   * исключением S21Cancelled.
+   * Прочие ошибки (несовпадение размеров, вырожденность) передаются через
+   * future теми же исключениями, что и у синхронных вариантов.
+   *
+   * @return std::future с матрицей-результатом.
+   */
+  std::future<S21Matrix> MulMatrixAsync(
+      const S21Matrix& other,
+      const S21AsyncOptions& options = S21AsyncOptions()) const;
+  std::future<S21Matrix> InverseAsync(
+      const S21AsyncOptions& options = S21AsyncOptions()) const;
+  std::future<S21Matrix> SolveAsync(
+      const S21Matrix& b,
+      const S21AsyncOptions& options = S21AsyncOptions()) const;
+  // =================================================================================================================================================================>
+  /**
+   * @brief Собирает статистики матрицы за один проход по памяти.
+   *
+   * Сумма, среднее, минимум, максимум, норма Фробениуса, 1-норма,
+   * бесконечная норма и след считаются одновременно. Строки обрабатываются
+   * блоками, которые компилятор векторизует, а большие матрицы делятся
+   * между потоками S21ThreadPool.
+   *
+   * @param mode Способ суммирования. Суммы столбцов (для norm1 и ColSums)
+   * при kPairwise накапливаются последовательно внутри участка строк
+   * каждого потока.
+   *
+   * @throws std::invalid_argument Если матрица пуста.
+   */
+  S21MatrixStats Statistics(
+      S21Summation mode = S21Summation::kPairwise) const;
+
+  // Отдельные редукции; каждая также выполняется за один проход
+  double Sum(S21Summation mode = S21Summation::kPairwise) const;
+  double Mean(S21Summation mode = S21Summation::kPairwise) const;
+  double Min() const;
+  double Max() const;
+  double Trace() const;  // Бросает std::invalid_argument для неквадратной
+  double NormFrobenius(S21Summation mode = S21Summation::kPairwise) const;
+  double Norm1() const;
+  double NormInf() const;
+  S21Matrix RowSums(S21Summation mode = S21Summation::kPairwise) const;
+  S21Matrix ColSums(S21Summation mode = S21Summation::kPairwise) const;
+  // =================================================================================================================================================================>
+
+  /**
+   * @brief Изменение размеров матрицы.
+   *
+   * Элементы всегда хранятся одним непрерывным буфером по строкам, и под
+   * буфер может быть выделено больше, чем rows * cols элементов. Resize()
+   * сохраняет общий левый верхний блок и заполняет новые элементы нулями;
+   * если новый размер помещается в выделенную память, строки сдвигаются на
+   * месте, иначе выделяется буфер ровно нужного размера. Reshape() меняет
+   * только указатели строк, поэтому элементы не копируются даже у матрицы с
+   * общим буфером.
+   *
+   * AppendRow() и AppendRows() при нехватке места увеличивают ёмкость
+   * вдвое, так что добавление n строк по одной стоит O(n * cols) с
+   * O(log n) выделениями памяти. Пустой матрице (0 строк) первая
+   * добавленная строка задаёт число столбцов. Reserve() выделяет место
+   * заранее.
+   *
+   * @throws std::invalid_argument Для отрицательных размеров, при
+   * несовпадении числа элементов в Reshape() или числа столбцов в
+   * AppendRow(s).
+   */
+  void Resize(int rows, int cols);
+  void Reshape(int rows, int cols);
+  void AppendRow(const std::vector<double>& row);
+  void AppendRows(const S21Matrix& rows);
+  void Reserve(int rows);  // Ёмкость не меньше rows строк текущей длины
+  int GetRowCapacity() const;  // Строк, добавляемых без выделения памяти
+
+  /**
+   * @brief Объединение матриц по вертикали (a над b) и по горизонтали
+   * (a слева от b).
+   *
+   * Результат выделяется один раз и заполняется построчным копированием.
+   * Into-варианты пишут в *out, как TransposeInto(); VStackInto(a, b, &a)
+   * добавляет строки b к a через AppendRows(), используя запас ёмкости a.
+   *
+   * @throws std::invalid_argument Если число столбцов (для VStack) или
+   * строк (для HStack) не совпадает.
+   */
+  static S21Matrix VStack(const S21Matrix& a, const S21Matrix& b);
+  static S21Matrix HStack(const S21Matrix& a, const S21Matrix& b);
+  static void VStackInto(const S21Matrix& a, const S21Matrix& b,
+                         S21Matrix* out);
+  static void HStackInto(const S21Matrix& a, const S21Matrix& b,
+                         S21Matrix* out);
+  // =================================================================================================================================================================>
+
+  /**
+   * @brief Режим копирования при записи (по умолчанию выключен).
+   *
+   * Во включённом режиме матрицы, созданные после включения, получают
+   * атомарный счётчик владельцев, а их копии разделяют буфер элементов
+   * вместо выделения и копирования. Первая изменяющая операция над копией
+   * (SumMatrix, SubMatrix, MulNumber, неконстантный operator(), SetElement,
+   * HadamardMul/Div, RankUpdate, GetMatrixPointer) отделяет собственный
+   * буфер. Матрицы, созданные при выключенном режиме, копируются как
+   * обычно.
+   *
+   * Неконстантный operator() и GetMatrixPointer() выдают ссылку или
+   * указатель, через которые можно писать и после следующего копирования,
+   * поэтому такая матрица перестаёт разделять буфер: все её последующие
+   * копии получают собственные элементы, пока буфер не будет выделен
+   * заново (Resize, присваивание). Чтобы копии оставались дешёвыми,
+   * заполняйте матрицу через SetElement().
+   *
+   * Разные объекты с общим буфером можно читать и изменять из разных
+   * потоков; один объект по-прежнему нельзя изменять параллельно с любым
+   * другим обращением к нему, в том числе с копированием.
+   */
+  static void SetCopyOnWrite(bool enabled);
+  static bool CopyOnWrite();
+  bool IsShared() const;  // Разделяет ли матрица буфер с другими копиями
   // =================================================================================================================================================================>
 
   // Операторы перегрузки
@@ -212,7 +687,9 @@ class S21Matrix {
   // Методы доступа к размеру матрицы
   int GetRows() const;
   int GetCols() const;
-  double** GetMatrixPointer() const;
+  double** GetMatrixPointer() const;  // Для записи: отделяет общий буфер,
+                                      // поэтому не потокобезопасен
+  const double* const* GetConstMatrixPointer() const;  // Только для чтения
 
   void SetElement(int rows, int cols, double number);
   double GetElement(int rows, int cols) const;
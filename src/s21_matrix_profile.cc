@@ -0,0 +1,337 @@
+#include "s21_matrix_profile.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <sstream>
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+// Пробы ссылаются на семафоры s21matrix_<проба>_semaphore ниже
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define S21_USDT_PROBE3(name, a, b, c) DTRACE_PROBE3(s21matrix, name, a, b, c)
+#define S21_USDT_SEMAPHORE __attribute__((section(".probes")))
+#endif
+#endif
+
+#ifndef S21_USDT_PROBE3
+#define S21_USDT_PROBE3(name, a, b, c) ((void)sizeof((a), (b), (c)))
+#define S21_USDT_SEMAPHORE
+#endif
+
+// Без <sys/sdt.h> семафоры всегда нулевые и пробы не срабатывают
+volatile unsigned short s21matrix_op_begin_semaphore S21_USDT_SEMAPHORE = 0;
+volatile unsigned short s21matrix_op_end_semaphore S21_USDT_SEMAPHORE = 0;
+
+namespace {
+
+const int kOpCount = static_cast<int>(S21ProfileOp::kCount);
+
+// Номер корзины логарифмической гистограммы
+inline int Bucket(std::uint64_t value) {
+  int bucket = 0;
+  while (value > 1 && bucket < kS21ProfileBuckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Счётчик, который пишется только своим потоком, а читается любым
+struct Counter {
+  std::atomic<std::uint64_t> value{0};
+
+  void Add(std::uint64_t delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+  }
+  std::uint64_t Get() const { return value.load(std::memory_order_relaxed); }
+  void Clear() { value.store(0, std::memory_order_relaxed); }
+};
+
+struct NodeCounters {
+  Counter bytes, ns;
+};
+
+struct OpCounters {
+  Counter calls, flops, bytes, total_ns;
+  Counter time_histogram[kS21ProfileBuckets];
+  Counter size_histogram[kS21ProfileBuckets];
+};
+
+void Accumulate(const OpCounters& from, S21OpStats* to) {
+  to->calls += from.calls.Get();
+  to->flops += from.flops.Get();
+  to->bytes_allocated += from.bytes.Get();
+  to->total_ns += from.total_ns.Get();
+  for (int k = 0; k < kS21ProfileBuckets; ++k) {
+    to->time_histogram[k] += from.time_histogram[k].Get();
+    to->size_histogram[k] += from.size_histogram[k].Get();
+  }
+}
+
+void AppendHistogram(std::ostringstream& out, const char* name,
+                     const std::uint64_t* histogram) {
+  out << "\"" << name << "\":[";
+  int last = kS21ProfileBuckets - 1;
+  while (last > 0 && histogram[last] == 0) --last;
+  for (int k = 0; k <= last; ++k) {
+    if (k != 0) out << ",";
+    out << histogram[k];
+  }
+  out << "]";
+}
+
+thread_local S21ProfileOp current_op = S21ProfileOp::kOther;
+
+}  // namespace
+
+struct S21Profiler::ThreadBlock {
+  OpCounters ops[kOpCount];
+  NodeCounters nodes[kS21ProfileMaxNodes];
+};
+
+// Владелец блока счётчиков потока: регистрирует его при первом обращении и
+// переносит счётчики в общий накопитель при завершении потока
+struct S21ProfileThreadHolder {
+  S21Profiler::ThreadBlock block;
+
+  S21ProfileThreadHolder() { S21Profiler::Instance().Register(&block); }
+  ~S21ProfileThreadHolder() { S21Profiler::Instance().Retire(&block); }
+};
+
+namespace {
+
+S21Profiler::ThreadBlock& LocalBlock() {
+  thread_local S21ProfileThreadHolder holder;
+  return holder.block;
+}
+
+}  // namespace
+
+S21Profiler& S21Profiler::Instance() {
+  // Не уничтожается при выходе: рабочие потоки S21ThreadPool завершаются в
+  // его статическом деструкторе, и их блоки счётчиков вызывают Retire()
+  // уже после уничтожения обычных статических объектов
+  static S21Profiler* instance = [] {
+    // Замок не должен остаться захваченным в процессе, порождённом fork()
+    ::pthread_atfork([] { Instance().mutex_.lock(); },
+                     [] { Instance().mutex_.unlock(); },
+                     [] { Instance().mutex_.unlock(); });
+    return new S21Profiler();
+  }();
+  return *instance;
+}
+
+bool S21Profiler::Enabled() {
+#ifdef S21_MATRIX_PROFILE
+  return true;
+#else
+  return false;
+#endif
+}
+
+void S21Profiler::Register(ThreadBlock* block) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  live_.push_back(block);
+}
+
+void S21Profiler::Retire(ThreadBlock* block) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int i = 0; i < kOpCount; ++i) {
+    Accumulate(block->ops[i], &retired_.ops[i]);
+  }
+  for (int n = 0; n < kS21ProfileMaxNodes; ++n) {
+    retired_.nodes[n].bytes += block->nodes[n].bytes.Get();
+    retired_.nodes[n].ns += block->nodes[n].ns.Get();
+  }
+  live_.erase(std::remove(live_.begin(), live_.end(), block), live_.end());
+}
+
+S21ProfileSnapshot S21Profiler::Snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  S21ProfileSnapshot snapshot = retired_;
+  for (const ThreadBlock* block : live_) {
+    for (int i = 0; i < kOpCount; ++i) {
+      Accumulate(block->ops[i], &snapshot.ops[i]);
+    }
+    for (int n = 0; n < kS21ProfileMaxNodes; ++n) {
+      snapshot.nodes[n].bytes += block->nodes[n].bytes.Get();
+      snapshot.nodes[n].ns += block->nodes[n].ns.Get();
+    }
+  }
+  return snapshot;
+}
+
+void S21Profiler::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  retired_ = S21ProfileSnapshot();
+  for (ThreadBlock* block : live_) {
+    for (OpCounters& op : block->ops) {
+      op.calls.Clear();
+      op.flops.Clear();
+      op.bytes.Clear();
+      op.total_ns.Clear();
+      for (int k = 0; k < kS21ProfileBuckets; ++k) {
+        op.time_histogram[k].Clear();
+        op.size_histogram[k].Clear();
+      }
+    }
+    for (NodeCounters& node : block->nodes) {
+      node.bytes.Clear();
+      node.ns.Clear();
+    }
+  }
+}
+
+std::string S21Profiler::ToJson() const {
+  S21ProfileSnapshot snapshot = Snapshot();
+  std::ostringstream out;
+  out << "{\"enabled\":" << (Enabled() ? "true" : "false") << ",\"ops\":{";
+  bool first = true;
+  for (int i = 0; i < kOpCount; ++i) {
+    const S21OpStats& op = snapshot.ops[i];
+    if (op.calls == 0 && op.bytes_allocated == 0) continue;
+    if (!first) out << ",";
+    first = false;
+    out << "\"" << OpName(static_cast<S21ProfileOp>(i)) << "\":{"
+        << "\"calls\":" << op.calls << ",\"flops\":" << op.flops
+        << ",\"bytes_allocated\":" << op.bytes_allocated
+        << ",\"total_ns\":" << op.total_ns << ",";
+    AppendHistogram(out, "time_ns_log2", op.time_histogram);
+    out << ",";
+    AppendHistogram(out, "elements_log2", op.size_histogram);
+    out << "}";
+  }
+  out << "},\"numa_nodes\":[";
+  first = true;
+  for (int n = 0; n < kS21ProfileMaxNodes; ++n) {
+    const S21NodeStats& node = snapshot.nodes[n];
+    if (node.bytes == 0) continue;
+    if (!first) out << ",";
+    first = false;
+    double seconds = static_cast<double>(node.ns) * 1e-9;
+    out << "{\"node\":" << n << ",\"bytes\":" << node.bytes
+        << ",\"ns\":" << node.ns << ",\"gb_per_s\":"
+        << (seconds > 0 ? static_cast<double>(node.bytes) / seconds * 1e-9
+                        : 0.0)
+        << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+const char* S21Profiler::OpName(S21ProfileOp op) {
+  switch (op) {
+    case S21ProfileOp::kSumMatrix:
+      return "SumMatrix";
+    case S21ProfileOp::kSubMatrix:
+      return "SubMatrix";
+    case S21ProfileOp::kMulNumber:
+      return "MulNumber";
+    case S21ProfileOp::kMulMatrix:
+      return "MulMatrix";
+    case S21ProfileOp::kTranspose:
+      return "Transpose";
+    case S21ProfileOp::kDeterminant:
+      return "Determinant";
+    case S21ProfileOp::kMinor:
+      return "Minor";
+    case S21ProfileOp::kCalcComplements:
+      return "CalcComplements";
+    case S21ProfileOp::kInverseMatrix:
+      return "InverseMatrix";
+    case S21ProfileOp::kOperatorPlus:
+      return "operator+";
+    case S21ProfileOp::kOperatorMinus:
+      return "operator-";
+    case S21ProfileOp::kOperatorMulMatrix:
+      return "operator*(matrix)";
+    case S21ProfileOp::kOperatorMulNumber:
+      return "operator*(number)";
+    case S21ProfileOp::kReduce:
+      return "Reduce";
+    case S21ProfileOp::kPow:
+      return "Pow";
+    case S21ProfileOp::kExp:
+      return "Exp";
+    case S21ProfileOp::kPolynomial:
+      return "Polynomial";
+    case S21ProfileOp::kKronecker:
+      return "Kronecker";
+    case S21ProfileOp::kHadamard:
+      return "Hadamard";
+    case S21ProfileOp::kRankUpdate:
+      return "RankUpdate";
+    default:
+      return "other";
+  }
+}
+
+void S21Profiler::Record(S21ProfileOp op, std::uint64_t ns,
+                         std::uint64_t elements, std::uint64_t flops) {
+  OpCounters& counters = LocalBlock().ops[static_cast<int>(op)];
+  counters.calls.Add(1);
+  counters.flops.Add(flops);
+  counters.total_ns.Add(ns);
+  counters.time_histogram[Bucket(ns)].Add(1);
+  counters.size_histogram[Bucket(elements)].Add(1);
+}
+
+void S21Profiler::RecordAllocation(std::size_t bytes) {
+  LocalBlock().ops[static_cast<int>(current_op)].bytes.Add(bytes);
+}
+
+void S21Profiler::RecordNode(int node, std::uint64_t bytes,
+                             std::uint64_t ns) {
+  if (node < 0 || node >= kS21ProfileMaxNodes) return;
+  NodeCounters& counters = LocalBlock().nodes[node];
+  counters.bytes.Add(bytes);
+  counters.ns.Add(ns);
+}
+
+S21ProfileOp S21Profiler::SwapCurrent(S21ProfileOp op) {
+  S21ProfileOp previous = current_op;
+  current_op = op;
+  return previous;
+}
+
+S21ProfileScope::S21ProfileScope(S21ProfileOp op, std::uint64_t elements,
+                                 std::uint64_t flops)
+    : op_(op),
+      previous_(S21Profiler::SwapCurrent(op)),
+      elements_(elements),
+      flops_(flops),
+      start_(std::chrono::steady_clock::now()) {
+  if (S21TraceActive()) {
+    S21_USDT_PROBE3(op_begin, static_cast<int>(op_), elements_, flops_);
+  }
+}
+
+S21ProfileScope::~S21ProfileScope() {
+  std::uint64_t ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_)
+          .count());
+  if (S21TraceActive()) {
+    S21_USDT_PROBE3(op_end, static_cast<int>(op_), elements_, ns);
+  }
+  S21Profiler::Record(op_, ns, elements_, flops_);
+  S21Profiler::SwapCurrent(previous_);
+}
+
+void S21TraceScope::Begin(std::uint64_t elements, std::uint64_t flops) {
+  active_ = true;
+  elements_ = elements;
+  start_ = std::chrono::steady_clock::now();
+  S21_USDT_PROBE3(op_begin, static_cast<int>(op_), elements, flops);
+}
+
+void S21TraceScope::End() {
+  std::uint64_t ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_)
+          .count());
+  S21_USDT_PROBE3(op_end, static_cast<int>(op_), elements_, ns);
+}
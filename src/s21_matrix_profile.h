@@ -0,0 +1,199 @@
+#ifndef S21_MATRIX_PROFILE_H
+#define S21_MATRIX_PROFILE_H
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Счётчики потоков включаются флагом сборки -DS21_MATRIX_PROFILE. Без
+// него S21Profiler ничего не считает, а API снимков остаётся доступным и
+// возвращает нулевые счётчики.
+//
+// USDT-пробы s21matrix:op_begin(op, elements, flops) и
+// s21matrix:op_end(op, elements, ns) встраиваются в любую сборку, если при
+// компиляции доступен <sys/sdt.h> (пакет systemtap-sdt-dev): perf и
+// bpftrace подключаются к уже запущенному процессу без пересборки. Пробы
+// снабжены семафорами, поэтому, пока трассировщик не подключён, операция
+// лишь читает два слова памяти и не вычисляет аргументы проб.
+//
+// Операторы (operator+, operator* и т. д.) учитывают вызовы и время, но не
+// flops: работу записывает вызываемый ими метод, иначе сумма flops по
+// операциям считала бы её дважды.
+
+// Операции, для которых собирается статистика
+enum class S21ProfileOp {
+  kSumMatrix,
+  kSubMatrix,
+  kMulNumber,
+  kMulMatrix,
+  kTranspose,
+  kDeterminant,
+  kMinor,
+  kCalcComplements,
+  kInverseMatrix,
+  // Операторы учитывают вызовы и время; flops записывает вызываемый метод
+  kOperatorPlus,
+  kOperatorMinus,
+  kOperatorMulMatrix,
+  kOperatorMulNumber,
+  kReduce,  // Нормы, суммы и статистики
+  kPow,
+  kExp,
+  kPolynomial,
+  kKronecker,
+  kHadamard,
+  kRankUpdate,
+  kOther,  // Выделения памяти вне профилируемых операций
+  kCount
+};
+
+// Число корзин гистограмм: корзина k соответствует значениям [2^k, 2^(k+1))
+const int kS21ProfileBuckets = 40;
+
+// Максимальное число узлов NUMA в статистике пропускной способности
+const int kS21ProfileMaxNodes = 8;
+
+// Объём памяти, обработанный рабочими потоками одного узла NUMA
+struct S21NodeStats {
+  std::uint64_t bytes = 0;
+  std::uint64_t ns = 0;  // Суммарное время работы потоков узла
+};
+
+// Статистика одной операции
+struct S21OpStats {
+  std::uint64_t calls = 0;
+  std::uint64_t flops = 0;            // Оценка числа операций с плавающей
+                                      // точкой
+  std::uint64_t bytes_allocated = 0;  // Память, выделенная внутри операции
+  std::uint64_t total_ns = 0;         // Суммарное время выполнения
+  std::uint64_t time_histogram[kS21ProfileBuckets] = {};  // По наносекундам
+  std::uint64_t size_histogram[kS21ProfileBuckets] = {};  // По числу
+                                                          // элементов
+};
+
+// Снимок статистики, объединённый по всем потокам
+struct S21ProfileSnapshot {
+  S21OpStats ops[static_cast<int>(S21ProfileOp::kCount)];
+  S21NodeStats nodes[kS21ProfileMaxNodes];
+
+  const S21OpStats& operator[](S21ProfileOp op) const {
+    return ops[static_cast<int>(op)];
+  }
+};
+
+/**
+ * @brief Сборщик статистики вызовов S21Matrix.
+ *
+ * Каждый поток пишет в собственный блок счётчиков без блокировок и без
+ * атомарных read-modify-write операций. Блоки регистрируются в общем реестре,
+ * а Snapshot() суммирует их; при завершении потока его счётчики переносятся в
+ * общий накопитель и не теряются.
+ */
+class S21Profiler {
+ public:
+  static S21Profiler& Instance();
+
+  static bool Enabled();  // Собрана ли библиотека с S21_MATRIX_PROFILE
+
+  S21ProfileSnapshot Snapshot() const;  // Объединяет счётчики всех потоков
+  void Reset();  // Обнуляет счётчики (запись, идущая параллельно, может
+                 // пережить сброс)
+  std::string ToJson() const;  // Снимок в формате JSON
+
+  static const char* OpName(S21ProfileOp op);
+
+  // Точки записи, используемые макросами инструментирования
+  static void Record(S21ProfileOp op, std::uint64_t ns, std::uint64_t elements,
+                     std::uint64_t flops);
+  static void RecordAllocation(std::size_t bytes);
+  static void RecordNode(int node, std::uint64_t bytes, std::uint64_t ns);
+  static S21ProfileOp SwapCurrent(S21ProfileOp op);  // Текущая операция потока
+
+  struct ThreadBlock;  // Счётчики одного потока
+
+ private:
+  S21Profiler() = default;
+
+  friend struct S21ProfileThreadHolder;
+  void Register(ThreadBlock* block);
+  void Retire(ThreadBlock* block);
+
+  mutable std::mutex mutex_;
+  std::vector<ThreadBlock*> live_;
+  S21ProfileSnapshot retired_;  // Счётчики завершившихся потоков
+};
+
+// Семафоры USDT-проб: трассировщик увеличивает их при подключении
+extern "C" volatile unsigned short s21matrix_op_begin_semaphore;
+extern "C" volatile unsigned short s21matrix_op_end_semaphore;
+
+// Подключён ли к пробам хотя бы один трассировщик
+inline bool S21TraceActive() {
+  return (s21matrix_op_begin_semaphore | s21matrix_op_end_semaphore) != 0;
+}
+
+// Пара проб op_begin/op_end без счётчиков для сборки без
+// S21_MATRIX_PROFILE; Begin() вызывается, только если S21TraceActive()
+class S21TraceScope {
+ public:
+  explicit S21TraceScope(S21ProfileOp op) : op_(op) {}
+  ~S21TraceScope() {
+    if (active_) End();
+  }
+
+  S21TraceScope(const S21TraceScope&) = delete;
+  S21TraceScope& operator=(const S21TraceScope&) = delete;
+
+  void Begin(std::uint64_t elements, std::uint64_t flops);
+
+ private:
+  void End();
+
+  S21ProfileOp op_;
+  bool active_ = false;
+  std::uint64_t elements_ = 0;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// RAII-замер одной операции
+class S21ProfileScope {
+ public:
+  S21ProfileScope(S21ProfileOp op, std::uint64_t elements,
+                  std::uint64_t flops);
+  ~S21ProfileScope();
+
+  S21ProfileScope(const S21ProfileScope&) = delete;
+  S21ProfileScope& operator=(const S21ProfileScope&) = delete;
+
+ private:
+  S21ProfileOp op_, previous_;
+  std::uint64_t elements_, flops_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#ifdef S21_MATRIX_PROFILE
+#define S21_PROFILE_SCOPE(op, elements, flops)                             \
+  S21ProfileScope s21_profile_scope_(S21ProfileOp::op,                     \
+                                     static_cast<std::uint64_t>(elements), \
+                                     static_cast<std::uint64_t>(flops))
+#define S21_PROFILE_ALLOCATION(bytes) S21Profiler::RecordAllocation(bytes)
+#define S21_PROFILE_NODE(node, bytes, ns)                          \
+  S21Profiler::RecordNode(node, static_cast<std::uint64_t>(bytes), \
+                          static_cast<std::uint64_t>(ns))
+#else
+// Аргументы вычисляются, только когда подключён трассировщик
+#define S21_PROFILE_SCOPE(op, elements, flops)                     \
+  S21TraceScope s21_profile_scope_(S21ProfileOp::op);              \
+  if (S21TraceActive())                                            \
+  s21_profile_scope_.Begin(static_cast<std::uint64_t>(elements),   \
+                           static_cast<std::uint64_t>(flops))
+#define S21_PROFILE_ALLOCATION(bytes) ((void)0)
+#define S21_PROFILE_NODE(node, bytes, ns) ((void)sizeof((node), (bytes), (ns)))
+#endif
+
+#endif  // S21_MATRIX_PROFILE_H
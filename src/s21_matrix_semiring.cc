@@ -0,0 +1,176 @@
+#include "s21_matrix_semiring.h"
+
+namespace {
+
+constexpr int kWordBits = 64;
+
+inline int WordsFor(int cols) { return (cols + kWordBits - 1) / kWordBits; }
+
+}  // namespace
+
+S21Matrix S21ShortestPaths(const S21Matrix& weights) {
+  const int n = weights.GetRows();
+  if (weights.GetCols() != n) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  S21Matrix distances(weights);
+  // Путь из нуля рёбер: вершина достижима из себя за 0
+  for (int i = 0; i < n; ++i) {
+    distances(i, i) = std::min(distances(i, i), 0.0);
+  }
+  // Цикл через все n вершин тоже должен попасть в диагональ
+  for (int length = 1; length < n; length *= 2) {
+    S21Matrix squared = S21SemiringMultiply<S21MinPlus>(distances, distances);
+    const bool converged = squared == distances;
+    distances = std::move(squared);
+    if (converged) break;
+  }
+  for (int i = 0; i < n; ++i) {
+    if (distances(i, i) < 0) {
+      throw std::invalid_argument("Граф содержит цикл отрицательного веса");
+    }
+  }
+  return distances;
+}
+
+S21BitMatrix::S21BitMatrix(int rows, int cols)
+    : rows_(rows), cols_(cols), words_(WordsFor(cols)) {
+  if (rows < 0 || cols < 0) {
+    throw std::invalid_argument(
+        "Строки и столбцы должны быть положительными числами");
+  }
+  bits_.assign(static_cast<std::size_t>(rows) * words_, 0);
+}
+
+S21BitMatrix S21BitMatrix::FromMatrix(const S21Matrix& matrix) {
+  S21BitMatrix bits(matrix.GetRows(), matrix.GetCols());
+  const double* const* m = matrix.GetConstMatrixPointer();
+  for (int i = 0; i < bits.rows_; ++i) {
+    std::uint64_t* row = bits.Row(i);
+    for (int j = 0; j < bits.cols_; ++j) {
+      if (m[i][j] != 0) {
+        row[j / kWordBits] |= std::uint64_t(1) << (j % kWordBits);
+      }
+    }
+  }
+  return bits;
+}
+
+S21BitMatrix S21BitMatrix::Identity(int n) {
+  S21BitMatrix identity(n, n);
+  for (int i = 0; i < n; ++i) identity.Set(i, i, true);
+  return identity;
+}
+
+S21Matrix S21BitMatrix::ToMatrix() const {
+  S21Matrix matrix(rows_, cols_);
+  double** m = matrix.GetMatrixPointer();
+  for (int i = 0; i < rows_; ++i) {
+    const std::uint64_t* row = Row(i);
+    for (int j = 0; j < cols_; ++j) {
+      m[i][j] = (row[j / kWordBits] >> (j % kWordBits)) & 1;
+    }
+  }
+  return matrix;
+}
+
+int S21BitMatrix::GetRows() const { return rows_; }
+
+int S21BitMatrix::GetCols() const { return cols_; }
+
+bool S21BitMatrix::Get(int row, int col) const {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::out_of_range("Матрица вне диапазона");
+  }
+  return (Row(row)[col / kWordBits] >> (col % kWordBits)) & 1;
+}
+
+void S21BitMatrix::Set(int row, int col, bool value) {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::out_of_range("Матрица вне диапазона");
+  }
+  const std::uint64_t mask = std::uint64_t(1) << (col % kWordBits);
+  std::uint64_t& word = Row(row)[col / kWordBits];
+  word = value ? word | mask : word & ~mask;
+}
+
+std::int64_t S21BitMatrix::Count() const {
+  std::int64_t count = 0;
+  for (std::uint64_t word : bits_) count += __builtin_popcountll(word);
+  return count;
+}
+
+S21BitMatrix S21BitMatrix::Multiply(const S21BitMatrix& other) const {
+  if (cols_ != other.rows_) {
+    throw std::invalid_argument(
+        "Количество столбцов в текущей матрице должно быть равно количеству "
+        "строк в матрице other.");
+  }
+  S21BitMatrix product(rows_, other.cols_);
+  const int words = product.words_;
+  // Полоса b той же величины в байтах, что и у MulMatrix: block_k строк по
+  // block_n слов; по k полоса кратна слову строки a
+  const S21TuneParams params = S21Tuner::Instance().Params();
+  const int block_words_k = std::max(1, params.gemm_block_k / kWordBits);
+  const int block_n = params.gemm_block_n;
+  const S21BitMatrix& a = *this;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows_,
+      static_cast<std::uint64_t>(rows_) * static_cast<std::uint64_t>(cols_) *
+          static_cast<std::uint64_t>(words),
+      (words_ + words) * sizeof(std::uint64_t),
+      [&a, &other, &product, words, block_words_k, block_n](int begin,
+                                                            int end) {
+        for (int jj = 0; jj < words; jj += block_n) {
+          const int j_end = std::min(words, jj + block_n);
+          for (int kk = 0; kk < a.words_; kk += block_words_k) {
+            const int k_end = std::min(a.words_, kk + block_words_k);
+            for (int i = begin; i < end; ++i) {
+              const std::uint64_t* a_row = a.Row(i);
+              std::uint64_t* row = product.Row(i);
+              for (int w = kk; w < k_end; ++w) {
+                // Единичные биты слова по одному, младший первым
+                for (std::uint64_t bits = a_row[w]; bits != 0;
+                     bits &= bits - 1) {
+                  const int k = w * kWordBits + __builtin_ctzll(bits);
+                  const std::uint64_t* b_row = other.Row(k);
+                  for (int j = jj; j < j_end; ++j) row[j] |= b_row[j];
+                }
+              }
+            }
+          }
+        }
+      });
+  return product;
+}
+
+S21BitMatrix S21BitMatrix::Closure() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("Матрица должна быть квадратной");
+  }
+  S21BitMatrix closure(*this);
+  for (int i = 0; i < rows_; ++i) closure.Set(i, i, true);
+  // После s шагов учтены пути длины до 2^s
+  for (int length = 1; length < rows_; length *= 2) {
+    S21BitMatrix squared = closure.Multiply(closure);
+    if (squared == closure) break;
+    closure = std::move(squared);
+  }
+  return closure;
+}
+
+bool S21BitMatrix::operator==(const S21BitMatrix& other) const {
+  return rows_ == other.rows_ && cols_ == other.cols_ && bits_ == other.bits_;
+}
+
+bool S21BitMatrix::operator!=(const S21BitMatrix& other) const {
+  return !(*this == other);
+}
+
+std::uint64_t* S21BitMatrix::Row(int row) {
+  return bits_.data() + static_cast<std::size_t>(row) * words_;
+}
+
+const std::uint64_t* S21BitMatrix::Row(int row) const {
+  return bits_.data() + static_cast<std::size_t>(row) * words_;
+}
@@ -0,0 +1,200 @@
+#ifndef S21_MATRIX_SEMIRING
+#define S21_MATRIX_SEMIRING
+
+// Небходимые зависимые директивы
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_matrix_tune.h"
+#include "s21_thread_pool.h"
+
+// Полукольца для S21SemiringMultiply. Zero() — нейтральный элемент Add,
+// One() — нейтральный элемент Mul. Любой тип с такими же статическими
+// функциями задаёт своё полукольцо. kZeroAbsorbs == true обещает, что
+// Mul(Zero(), x) == Zero() для любого x во входных данных, и разрешает
+// пропускать такие слагаемые; без этой константы ничего не пропускается
+
+// Обычное умножение матриц (+, *). В double 0 * inf и 0 * NaN дают NaN,
+// поэтому нули a не пропускаются и результат совпадает с MulMatrix
+struct S21PlusTimes {
+  static constexpr bool kZeroAbsorbs = false;
+  static double Zero() { return 0.0; }
+  static double One() { return 1.0; }
+  static double Add(double a, double b) { return a + b; }
+  static double Mul(double a, double b) { return a * b; }
+};
+
+// Тропическое (min, +): кратчайшие пути, отсутствие ребра — +inf. +inf
+// поглощает, пока во входных данных нет -inf и NaN
+struct S21MinPlus {
+  static constexpr bool kZeroAbsorbs = true;
+  static double Zero() { return std::numeric_limits<double>::infinity(); }
+  static double One() { return 0.0; }
+  static double Add(double a, double b) { return b < a ? b : a; }
+  static double Mul(double a, double b) { return a + b; }
+};
+
+// (max, +): самые длинные пути в ациклическом графе, критический путь;
+// -inf поглощает, пока во входных данных нет +inf и NaN
+struct S21MaxPlus {
+  static constexpr bool kZeroAbsorbs = true;
+  static double Zero() { return -std::numeric_limits<double>::infinity(); }
+  static double One() { return 0.0; }
+  static double Add(double a, double b) { return b > a ? b : a; }
+  static double Mul(double a, double b) { return a + b; }
+};
+
+// Булево (OR, AND) над значениями 0 и 1; для больших матриц быстрее
+// S21BitMatrix
+struct S21OrAnd {
+  static constexpr bool kZeroAbsorbs = true;
+  static double Zero() { return 0.0; }
+  static double One() { return 1.0; }
+  static double Add(double a, double b) { return a != 0 || b != 0 ? 1 : 0; }
+  static double Mul(double a, double b) { return a != 0 && b != 0 ? 1 : 0; }
+};
+
+/**
+ * @brief Произведение a * b над полукольцом:
+ * c(i, j) = Add по k от Mul(a(i, k), b(k, j)).
+ *
+ * Тот же обход, что и у MulMatrix: порядок i-k-j, полосы b размером
+ * gemm_block_k x gemm_block_n из S21Tuner, строки результата делятся между
+ * потоками S21ThreadPool, когда работа не меньше parallel_flops. Каждый
+ * элемент c накапливается по k подряд, поэтому результат не зависит от
+ * размеров блоков и числа потоков. Для полуколец с kZeroAbsorbs слагаемые
+ * с a(i, k) == Zero() не вычисляются, так что разреженные графы (много
+ * +inf в min-plus) обрабатываются быстрее плотных.
+ *
+ * @throws std::invalid_argument Если число столбцов a не равно числу строк b.
+ */
+template <typename Semiring>
+S21Matrix S21SemiringMultiply(const S21Matrix& a, const S21Matrix& b);
+
+/**
+ * @brief Кратчайшие пути между всеми парами вершин.
+ *
+ * weights(i, j) — вес ребра i -> j, +inf — ребра нет. Матрица расстояний
+ * получается возведением в квадрат по min-plus: после s шагов учтены пути
+ * из 2^s рёбер, поэтому хватает ceil(log2 n) умножений (цикл
+ * останавливается раньше, если матрица перестала меняться). Каждое
+ * умножение идёт блочным многопоточным S21SemiringMultiply, а не тройным
+ * циклом Флойда — Уоршелла с зависимостью по k.
+ *
+ * @throws std::invalid_argument Если матрица не квадратная или граф
+ * содержит цикл отрицательного веса.
+ */
+S21Matrix S21ShortestPaths(const S21Matrix& weights);
+
+/**
+ * @brief Булева матрица, упакованная по 64 элемента в машинное слово.
+ *
+ * Строка хранится словами std::uint64_t, так что Multiply() (OR, AND)
+ * для каждого единичного a(i, k) объединяет c(i, :) |= b(k, :) сразу по 64
+ * столбца на операцию. Единичные биты строки a перебираются через подсчёт
+ * младших нулей, а нулевые слова пропускаются целиком. Полосы b, как в
+ * MulMatrix, занимают в байтах те же gemm_block_k x gemm_block_n, а строки
+ * результата делятся между потоками S21ThreadPool.
+ *
+ * Матрица занимает в 64 раза меньше памяти, чем S21Matrix из 0 и 1.
+ *
+ * @note Константные методы потокобезопасны.
+ */
+class S21BitMatrix {
+ public:
+  // std::invalid_argument для отрицательных размеров
+  S21BitMatrix(int rows, int cols);
+
+  // Единица для каждого ненулевого элемента (в том числе NaN)
+  static S21BitMatrix FromMatrix(const S21Matrix& matrix);
+  static S21BitMatrix Identity(int n);
+  S21Matrix ToMatrix() const;  // Элементы 0 и 1
+
+  int GetRows() const;
+  int GetCols() const;
+  bool Get(int row, int col) const;  // std::out_of_range вне матрицы
+  void Set(int row, int col, bool value);
+  std::int64_t Count() const;  // Число единиц
+
+  // this * other над (OR, AND); std::invalid_argument, если число столбцов
+  // this не равно числу строк other
+  S21BitMatrix Multiply(const S21BitMatrix& other) const;
+  // Рефлексивно-транзитивное замыкание (достижимость) квадратной матрицы
+  // возведением (A | I) в квадрат до неподвижной точки, не более
+  // ceil(log2 n) умножений; std::invalid_argument для неквадратной
+  S21BitMatrix Closure() const;
+
+  bool operator==(const S21BitMatrix& other) const;
+  bool operator!=(const S21BitMatrix& other) const;
+
+ private:
+  std::uint64_t* Row(int row);
+  const std::uint64_t* Row(int row) const;
+
+  int rows_, cols_;
+  int words_;  // Слов на строку
+  std::vector<std::uint64_t> bits_;  // Строки подряд, хвост слова — нули
+};
+
+// Semiring::kZeroAbsorbs, если константа объявлена, иначе false
+template <typename Semiring, typename = void>
+struct S21ZeroAbsorbs : std::false_type {};
+
+template <typename Semiring>
+struct S21ZeroAbsorbs<Semiring, std::void_t<decltype(Semiring::kZeroAbsorbs)>>
+    : std::bool_constant<Semiring::kZeroAbsorbs> {};
+
+template <typename Semiring>
+S21Matrix S21SemiringMultiply(const S21Matrix& a, const S21Matrix& b) {
+  if (a.GetCols() != b.GetRows()) {
+    throw std::invalid_argument(
+        "Количество столбцов в текущей матрице должно быть равно количеству "
+        "строк в матрице other.");
+  }
+  const int rows = a.GetRows(), inner = a.GetCols(), width = b.GetCols();
+  S21Matrix c(rows, width);
+  const double* const* pa = a.GetConstMatrixPointer();
+  const double* const* pb = b.GetConstMatrixPointer();
+  double** pc = c.GetMatrixPointer();
+  const S21TuneParams params = S21Tuner::Instance().Params();
+  const int block_k = params.gemm_block_k, block_n = params.gemm_block_n;
+  S21ThreadPool::Instance().ParallelRowsIfWorth(
+      rows,
+      2 * static_cast<std::uint64_t>(rows) * static_cast<std::uint64_t>(width) *
+          static_cast<std::uint64_t>(inner),
+      (inner + width) * sizeof(double),
+      [pa, pb, pc, inner, width, block_k, block_n](int begin, int end) {
+        const double zero = Semiring::Zero();
+        for (int i = begin; i < end; ++i) {
+          std::fill(pc[i], pc[i] + width, zero);
+        }
+        for (int jj = 0; jj < width; jj += block_n) {
+          const int j_end = std::min(width, jj + block_n);
+          for (int kk = 0; kk < inner; kk += block_k) {
+            const int k_end = std::min(inner, kk + block_k);
+            for (int i = begin; i < end; ++i) {
+              double* row = pc[i];
+              for (int k = kk; k < k_end; ++k) {
+                const double factor = pa[i][k];
+                // Zero() поглощает: слагаемое ничего не меняет
+                if (S21ZeroAbsorbs<Semiring>::value && factor == zero) {
+                  continue;
+                }
+                const double* b_row = pb[k];
+                for (int j = jj; j < j_end; ++j) {
+                  row[j] =
+                      Semiring::Add(row[j], Semiring::Mul(factor, b_row[j]));
+                }
+              }
+            }
+          }
+        }
+      });
+  return c;
+}
+
+#endif  // S21_MATRIX_SEMIRING
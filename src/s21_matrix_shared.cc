@@ -0,0 +1,162 @@
+#include "s21_matrix_shared.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Слот читающего потока. Эпоха 0 означает, что поток ничего не читает;
+// иначе это глобальная эпоха на момент входа в самое внешнее чтение
+struct ReaderSlot {
+  std::atomic<std::uint64_t> epoch{0};
+  std::atomic<bool> in_use{false};
+  ReaderSlot* next = nullptr;
+  int depth = 0;  // Вложенность чтений; меняет только поток-владелец
+};
+
+// Слоты общие для всех S21SharedMatrix и не освобождаются: их число
+// ограничено наибольшим числом одновременно живших потоков
+std::atomic<ReaderSlot*> slots{nullptr};
+std::atomic<std::uint64_t> global_epoch{1};
+
+ReaderSlot* AcquireSlot() {
+  for (ReaderSlot* slot = slots.load(std::memory_order_acquire);
+       slot != nullptr; slot = slot->next) {
+    bool expected = false;
+    if (!slot->in_use.load(std::memory_order_relaxed) &&
+        slot->in_use.compare_exchange_strong(expected, true,
+                                             std::memory_order_acquire)) {
+      return slot;
+    }
+  }
+  ReaderSlot* slot = new ReaderSlot();
+  slot->in_use.store(true, std::memory_order_relaxed);
+  ReaderSlot* head = slots.load(std::memory_order_relaxed);
+  do {
+    slot->next = head;
+  } while (!slots.compare_exchange_weak(head, slot, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  return slot;
+}
+
+// Возвращает слот в общий список при завершении потока
+struct SlotOwner {
+  ReaderSlot* slot = AcquireSlot();
+  ~SlotOwner() {
+    slot->depth = 0;
+    slot->epoch.store(0, std::memory_order_release);
+    slot->in_use.store(false, std::memory_order_release);
+  }
+};
+
+ReaderSlot& LocalSlot() {
+  thread_local SlotOwner owner;
+  return *owner.slot;
+}
+
+// Эпоха записывается до загрузки указателя на версию. Писатель заменяет
+// указатель до увеличения эпохи и просматривает слоты после, поэтому
+// (при последовательной согласованности) читатель либо уже виден ему с
+// эпохой не новее замены, либо загрузит новую версию
+void EnterRead() {
+  ReaderSlot& slot = LocalSlot();
+  if (slot.depth++ == 0) {
+    slot.epoch.store(global_epoch.load(std::memory_order_seq_cst),
+                     std::memory_order_seq_cst);
+  }
+}
+
+void ExitRead() {
+  ReaderSlot& slot = LocalSlot();
+  if (--slot.depth == 0) slot.epoch.store(0, std::memory_order_release);
+}
+
+// Наименьшая эпоха среди читающих потоков
+std::uint64_t OldestReader() {
+  std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+  for (ReaderSlot* slot = slots.load(std::memory_order_acquire);
+       slot != nullptr; slot = slot->next) {
+    std::uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0) oldest = std::min(oldest, epoch);
+  }
+  return oldest;
+}
+
+}  // namespace
+
+S21SharedMatrix::Snapshot::Snapshot(const Node* node) : node_(node) {}
+
+S21SharedMatrix::Snapshot::Snapshot(Snapshot&& other) noexcept
+    : node_(other.node_) {
+  other.node_ = nullptr;
+}
+
+S21SharedMatrix::Snapshot& S21SharedMatrix::Snapshot::operator=(
+    Snapshot&& other) noexcept {
+  if (this != &other) {
+    if (node_ != nullptr) ExitRead();
+    node_ = other.node_;
+    other.node_ = nullptr;
+  }
+  return *this;
+}
+
+S21SharedMatrix::Snapshot::~Snapshot() {
+  if (node_ != nullptr) ExitRead();
+}
+
+S21SharedMatrix::S21SharedMatrix(S21Matrix initial)
+    : current_(new Node{std::move(initial), 1}) {}
+
+S21SharedMatrix::~S21SharedMatrix() {
+  delete current_.load(std::memory_order_relaxed);
+  for (const auto& retired : retired_) delete retired.first;
+}
+
+S21SharedMatrix::Snapshot S21SharedMatrix::Read() const {
+  EnterRead();
+  return Snapshot(current_.load(std::memory_order_seq_cst));
+}
+
+std::uint64_t S21SharedMatrix::Publish(S21Matrix next) {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  return PublishLocked(std::move(next));
+}
+
+std::uint64_t S21SharedMatrix::PublishLocked(S21Matrix next) {
+  // Текущую версию освобождают только писатели, поэтому под мьютексом её
+  // можно читать без снимка
+  const Node* previous = current_.load(std::memory_order_relaxed);
+  const Node* fresh = new Node{std::move(next), previous->version + 1};
+  current_.store(fresh, std::memory_order_seq_cst);
+  // Читатели с эпохой не новее этой могли получить previous
+  retired_.emplace_back(previous,
+                        global_epoch.fetch_add(1, std::memory_order_seq_cst));
+  ReclaimLocked();
+  return fresh->version;
+}
+
+std::uint64_t S21SharedMatrix::Version() const { return Read().Version(); }
+
+void S21SharedMatrix::Reclaim() {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  ReclaimLocked();
+}
+
+void S21SharedMatrix::ReclaimLocked() {
+  if (retired_.empty()) return;
+  const std::uint64_t oldest = OldestReader();
+  auto kept = std::remove_if(
+      retired_.begin(), retired_.end(),
+      [oldest](const std::pair<const Node*, std::uint64_t>& retired) {
+        if (retired.second >= oldest) return false;
+        delete retired.first;
+        return true;
+      });
+  retired_.erase(kept, retired_.end());
+}
+
+std::size_t S21SharedMatrix::PendingReclaim() const {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  return retired_.size();
+}
@@ -0,0 +1,105 @@
+#ifndef S21_MATRIX_SHARED
+#define S21_MATRIX_SHARED
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+/**
+ * @brief Матрица, которую читают многие потоки, а изредка заменяет писатель.
+ *
+ * Читатель получает неизменяемый снимок через Read() без блокировок и без
+ * ожидания (wait-free): вход в чтение — одна запись эпохи в слот потока и
+ * одна загрузка указателя. Писатель публикует новую версию атомарной
+ * заменой указателя, после чего старая версия освобождается отложенно,
+ * когда ни один читатель, начавший чтение до замены, её уже не держит
+ * (освобождение по эпохам, как в RCU).
+ *
+ * @code
+ *   S21SharedMatrix model(Train());
+ *   // Читатели
+ *   auto snapshot = model.Read();
+ *   S21Matrix y = *snapshot * x;
+ *   // Писатель
+ *   model.Publish(Retrain());
+ *   model.Update([](S21Matrix& m) { m(0, 0) = 1.0; });
+ * @endcode
+ *
+ * Пока поток держит хотя бы один снимок (любой S21SharedMatrix), версии,
+ * заменённые после начала его чтения, не освобождаются, поэтому снимки не
+ * следует держать дольше, чем нужно. Publish() и Update() между собой
+ * сериализуются мьютексом, который читатели никогда не берут.
+ *
+ * @note Снимок должен уничтожаться в том потоке, в котором получен, и до
+ * уничтожения самого S21SharedMatrix.
+ */
+class S21SharedMatrix {
+ private:
+  struct Node {
+    S21Matrix matrix;
+    std::uint64_t version;
+  };
+
+ public:
+  // Неизменяемая версия матрицы, защищённая от освобождения
+  class Snapshot {
+   public:
+    Snapshot(Snapshot&& other) noexcept;
+    Snapshot& operator=(Snapshot&& other) noexcept;
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot();
+
+    const S21Matrix& operator*() const { return node_->matrix; }
+    const S21Matrix* operator->() const { return &node_->matrix; }
+    std::uint64_t Version() const { return node_->version; }
+
+   private:
+    friend class S21SharedMatrix;
+    explicit Snapshot(const Node* node);
+
+    const Node* node_;
+  };
+
+  explicit S21SharedMatrix(S21Matrix initial = S21Matrix());
+  S21SharedMatrix(const S21SharedMatrix&) = delete;
+  S21SharedMatrix& operator=(const S21SharedMatrix&) = delete;
+  ~S21SharedMatrix();
+
+  Snapshot Read() const;  // Без блокировок и ожидания
+
+  // Публикует новую версию и возвращает её номер; номера растут с 1
+  std::uint64_t Publish(S21Matrix next);
+  // Копирует текущую версию, изменяет копию и публикует её; параллельные
+  // Update() не теряют изменений друг друга
+  template <typename Mutate>
+  std::uint64_t Update(Mutate mutate) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    S21Matrix next = current_.load(std::memory_order_acquire)->matrix;
+    mutate(next);
+    return PublishLocked(std::move(next));
+  }
+
+  std::uint64_t Version() const;  // Номер текущей версии
+  // Освобождает заменённые версии, которые уже никто не читает;
+  // Publish() делает это сам
+  void Reclaim();
+  std::size_t PendingReclaim() const;  // Заменённых, но не освобождённых
+
+ private:
+  std::uint64_t PublishLocked(S21Matrix next);
+  void ReclaimLocked();
+
+  std::atomic<const Node*> current_;
+  mutable std::mutex writer_mutex_;
+  // Заменённые версии с эпохой замены
+  std::vector<std::pair<const Node*, std::uint64_t>> retired_;
+};
+
+#endif  // S21_MATRIX_SHARED
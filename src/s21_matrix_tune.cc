@@ -0,0 +1,338 @@
+#include "s21_matrix_tune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+const char kConfigHeader[] = "# Параметры s21_matrix, подобранные S21Tuner";
+
+// Кандидаты, перебираемые Tune()
+const int kGemmBlocksK[] = {64, 128, 256, 512};
+const int kGemmBlocksN[] = {256, 1024, 4096};
+const int kTransposeBlocks[] = {8, 16, 32, 64, 128};
+const int kParallelProbeSizes[] = {16, 24, 32, 48, 64, 96, 128, 192, 256};
+const int kLuParallelSizes[] = {64, 128, 256, 512};
+
+// Параллельная версия должна выигрывать заметно, иначе шум измерений
+// переносит порог на слишком малые задачи
+const double kParallelGain = 0.9;
+
+// Возвращает параметры, действовавшие до Tune(), если подбор не дошёл до
+// конца: иначе в S21Tuner остался бы последний измеренный кандидат
+class ParamsRestorer {
+ public:
+  explicit ParamsRestorer(S21Tuner* tuner)
+      : tuner_(tuner), saved_(tuner->Params()) {}
+  ~ParamsRestorer() {
+    if (tuner_ != nullptr) tuner_->SetParams(saved_);
+  }
+
+  ParamsRestorer(const ParamsRestorer&) = delete;
+  ParamsRestorer& operator=(const ParamsRestorer&) = delete;
+
+  void Release() { tuner_ = nullptr; }  // Подбор завершён
+
+ private:
+  S21Tuner* tuner_;
+  S21TuneParams saved_;
+};
+
+std::string Trim(const std::string& text) {
+  std::size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) return "";
+  std::size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+std::uint64_t ParseValue(const std::string& key, const std::string& value) {
+  std::size_t used = 0;
+  unsigned long long parsed = 0;
+  try {
+    parsed = std::stoull(value, &used);
+  } catch (const std::exception&) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size() || value[0] == '-') {
+    throw std::invalid_argument("Неверное значение параметра " + key + ": " +
+                                value);
+  }
+  return parsed;
+}
+
+int ParseInt(const std::string& key, const std::string& value) {
+  std::uint64_t parsed = ParseValue(key, value);
+  if (parsed > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+    throw std::invalid_argument("Слишком большое значение параметра " + key);
+  }
+  return static_cast<int>(parsed);
+}
+
+// Невырожденная матрица с диагональным преобладанием
+S21Matrix ProbeMatrix(int n) {
+  S21Matrix m(n, n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      m(i, j) = static_cast<double>((i * 31 + j * 17) % 13 - 6) +
+                (i == j ? 8.0 * n : 0.0);
+    }
+  }
+  return m;
+}
+
+// Лучшее из repeats время выполнения body в секундах
+template <typename Body>
+double BestTime(int repeats, Body body) {
+  double best = std::numeric_limits<double>::infinity();
+  for (int r = 0; r < repeats; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+}  // namespace
+
+S21Tuner& S21Tuner::Instance() {
+  // Не уничтожается при выходе: параметры читаются операциями над матрицами
+  // из деструкторов других статических объектов
+  static S21Tuner* instance = new S21Tuner();
+  return *instance;
+}
+
+S21Tuner::S21Tuner() {
+  Reset();
+  try {
+    Load(ConfigPath());
+  } catch (const std::exception&) {
+    // Испорченный файл не должен мешать запуску: остаются значения по
+    // умолчанию, а следующий Tune() и Save() перезапишут файл
+    Reset();
+  }
+}
+
+S21TuneParams S21Tuner::Params() const {
+  S21TuneParams params;
+  params.gemm_block_k = gemm_block_k_.load(std::memory_order_relaxed);
+  params.gemm_block_n = gemm_block_n_.load(std::memory_order_relaxed);
+  params.transpose_block = transpose_block_.load(std::memory_order_relaxed);
+  params.parallel_flops = parallel_flops_.load(std::memory_order_relaxed);
+  params.lu_parallel_size = lu_parallel_size_.load(std::memory_order_relaxed);
+  return params;
+}
+
+void S21Tuner::SetParams(const S21TuneParams& params) {
+  if (params.gemm_block_k <= 0 || params.gemm_block_n <= 0 ||
+      params.transpose_block <= 0 || params.lu_parallel_size <= 0) {
+    throw std::invalid_argument(
+        "Размеры блоков и порогов должны быть положительными");
+  }
+  gemm_block_k_.store(params.gemm_block_k, std::memory_order_relaxed);
+  gemm_block_n_.store(params.gemm_block_n, std::memory_order_relaxed);
+  transpose_block_.store(params.transpose_block, std::memory_order_relaxed);
+  parallel_flops_.store(params.parallel_flops, std::memory_order_relaxed);
+  lu_parallel_size_.store(params.lu_parallel_size, std::memory_order_relaxed);
+}
+
+void S21Tuner::Reset() { SetParams(S21TuneParams()); }
+
+S21TuneParams S21Tuner::Tune(const S21TuneOptions& options) {
+  if (options.gemm_size <= 0 || options.transpose_size <= 0 ||
+      options.lu_size <= 0 || options.repeats <= 0) {
+    throw std::invalid_argument(
+        "Параметры измерений должны быть положительными");
+  }
+  ParamsRestorer restorer(this);
+  S21TuneParams best = Params();
+  const int repeats = options.repeats;
+
+  // Блоки умножения; пороги пока прежние, чтобы замер шёл в том же режиме,
+  // в котором умножение будет работать
+  {
+    const S21Matrix a = ProbeMatrix(options.gemm_size);
+    const S21Matrix b = ProbeMatrix(options.gemm_size);
+    double best_time = std::numeric_limits<double>::infinity();
+    S21TuneParams candidate = best;
+    for (int block_k : kGemmBlocksK) {
+      for (int block_n : kGemmBlocksN) {
+        candidate.gemm_block_k = block_k;
+        candidate.gemm_block_n = block_n;
+        SetParams(candidate);
+        double time = BestTime(repeats, [&a, &b] { (void)(a * b); });
+        if (time < best_time) {
+          best_time = time;
+          best.gemm_block_k = block_k;
+          best.gemm_block_n = block_n;
+        }
+      }
+    }
+    SetParams(best);
+  }
+
+  {
+    const S21Matrix m = ProbeMatrix(options.transpose_size);
+    double best_time = std::numeric_limits<double>::infinity();
+    S21TuneParams candidate = best;
+    for (int block : kTransposeBlocks) {
+      candidate.transpose_block = block;
+      SetParams(candidate);
+      double time = BestTime(repeats, [&m] { (void)m.Transpose(); });
+      if (time < best_time) {
+        best_time = time;
+        best.transpose_block = block;
+      }
+    }
+    SetParams(best);
+  }
+
+  // Пороги распараллеливания имеют смысл только при нескольких потоках
+  if (S21ThreadPool::Instance().ThreadCount() > 1) {
+    // Наименьшее умножение, которое в потоках заметно быстрее, задаёт порог
+    // работы для всех операций, распределяемых по строкам
+    S21TuneParams serial = best, parallel = best;
+    serial.parallel_flops = std::numeric_limits<std::uint64_t>::max();
+    parallel.parallel_flops = 0;
+    const std::uint64_t largest =
+        kParallelProbeSizes[std::size(kParallelProbeSizes) - 1];
+    best.parallel_flops = 2 * largest * largest * largest;
+    for (int n : kParallelProbeSizes) {
+      const S21Matrix a = ProbeMatrix(n);
+      SetParams(serial);
+      double serial_time = BestTime(repeats, [&a] { (void)(a * a); });
+      SetParams(parallel);
+      double parallel_time = BestTime(repeats, [&a] { (void)(a * a); });
+      if (parallel_time < kParallelGain * serial_time) {
+        const std::uint64_t size = n;
+        best.parallel_flops = 2 * size * size * size;
+        break;
+      }
+    }
+    SetParams(best);
+
+    const S21Matrix a = ProbeMatrix(options.lu_size);
+    const S21Matrix rhs(options.lu_size, 1);  // Время уходит на разложение
+    double best_time = std::numeric_limits<double>::infinity();
+    S21TuneParams candidate = best;
+    for (int size : kLuParallelSizes) {
+      candidate.lu_parallel_size = size;
+      SetParams(candidate);
+      double time = BestTime(repeats, [&a, &rhs] { (void)a.Solve(rhs); });
+      if (time < best_time) {
+        best_time = time;
+        best.lu_parallel_size = size;
+      }
+    }
+    SetParams(best);
+  }
+  restorer.Release();
+  return best;
+}
+
+bool S21Tuner::Load(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) return false;
+  S21TuneParams params = S21TuneParams();
+  bool same_host = false;
+  std::string line;
+  while (std::getline(in, line)) {
+    line = Trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    std::size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      throw std::invalid_argument("Ожидалась строка вида ключ = значение: " +
+                                  line);
+    }
+    std::string key = Trim(line.substr(0, equals));
+    std::string value = Trim(line.substr(equals + 1));
+    if (key == "host") {
+      same_host = value == HostId();
+    } else if (key == "gemm_block_k") {
+      params.gemm_block_k = ParseInt(key, value);
+    } else if (key == "gemm_block_n") {
+      params.gemm_block_n = ParseInt(key, value);
+    } else if (key == "transpose_block") {
+      params.transpose_block = ParseInt(key, value);
+    } else if (key == "parallel_flops") {
+      params.parallel_flops = ParseValue(key, value);
+    } else if (key == "lu_parallel_size") {
+      params.lu_parallel_size = ParseInt(key, value);
+    }
+    // Неизвестные ключи пропускаются: файл могла записать более новая версия
+  }
+  if (!same_host) return false;
+  SetParams(params);
+  return true;
+}
+
+void S21Tuner::Save(const std::string& path) const {
+  S21TuneParams params = Params();
+  std::ostringstream text;
+  text << kConfigHeader << "\n"
+       << "host = " << HostId() << "\n"
+       << "gemm_block_k = " << params.gemm_block_k << "\n"
+       << "gemm_block_n = " << params.gemm_block_n << "\n"
+       << "transpose_block = " << params.transpose_block << "\n"
+       << "parallel_flops = " << params.parallel_flops << "\n"
+       << "lu_parallel_size = " << params.lu_parallel_size << "\n";
+
+  // Запись через временный файл: параллельно запущенный процесс не прочтёт
+  // файл наполовину
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::trunc);
+    out << text.str();
+    out.flush();
+    if (!out) {
+      throw std::runtime_error("Не удалось записать файл " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw std::runtime_error("Не удалось записать файл " + path);
+  }
+}
+
+std::string S21Tuner::ConfigPath() {
+  const char* file = std::getenv("S21_MATRIX_TUNE_FILE");
+  if (file != nullptr && *file != '\0') return file;
+  const char* home = std::getenv("HOME");
+  if (home != nullptr && *home != '\0') {
+    return std::string(home) + "/.s21_matrix_tune";
+  }
+  return ".s21_matrix_tune";
+}
+
+std::string S21Tuner::HostId() {
+  // x86 сообщает модель строкой "model name", ARM — кодами производителя
+  // и ядра
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line, model, implementer, part;
+  while (std::getline(cpuinfo, line)) {
+    std::size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string key = Trim(line.substr(0, colon));
+    std::string value = Trim(line.substr(colon + 1));
+    if (key == "model name" && model.empty()) model = value;
+    if (key == "CPU implementer" && implementer.empty()) implementer = value;
+    if (key == "CPU part" && part.empty()) part = value;
+  }
+  if (model.empty() && !implementer.empty()) {
+    model = "arm " + implementer + " " + part;
+  }
+  if (model.empty()) model = "unknown";
+  return model + " x" + std::to_string(std::thread::hardware_concurrency());
+}
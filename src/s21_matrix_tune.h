@@ -0,0 +1,80 @@
+#ifndef S21_MATRIX_TUNE
+#define S21_MATRIX_TUNE
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Параметры блочности и порогов распараллеливания
+struct S21TuneParams {
+  int gemm_block_k = 256;   // Полоса умножения по внутреннему измерению
+  int gemm_block_n = 1024;  // Полоса умножения по столбцам результата
+  int transpose_block = 32;  // Сторона квадратного блока транспонирования
+  std::uint64_t parallel_flops = std::uint64_t(1) << 22;  // Работа, с
+                                                          // которой операции
+                                                          // уходят в потоки
+  int lu_parallel_size = 256;  // Размер остаточной подматрицы LU, с которого
+                               // её обновление идёт в потоках
+};
+
+// Размеры задач, на которых измеряются кандидаты
+struct S21TuneOptions {
+  int gemm_size = 384;
+  int transpose_size = 1024;
+  int lu_size = 384;
+  int repeats = 3;  // Берётся лучшее время из повторов
+};
+
+/**
+ * @brief Подбор параметров блочности MulMatrix, Transpose и LU под машину.
+ *
+ * Оптимальные размеры блоков и пороги распараллеливания зависят от кэшей и
+ * числа ядер, поэтому значения по умолчанию лишь разумное среднее. Tune()
+ * измеряет кандидатов на текущей машине и применяет лучших; Save() сохраняет
+ * их в небольшой текстовый файл "ключ = значение".
+ *
+ * При первом обращении к Instance() параметры читаются из ConfigPath(), что
+ * стоит одного чтения короткого файла. Файл помечается идентификатором
+ * процессора, и конфигурация, снятая на машине другой модели (например,
+ * из общего домашнего каталога), игнорируется.
+ *
+ * @note Все методы потокобезопасны; Params() не берёт блокировок и
+ * вызывается в горячих путях. Tune() на время замеров подставляет
+ * кандидатов в глобальные параметры, поэтому его нельзя запускать
+ * одновременно с другой работой над матрицами: она пойдёт с пробными
+ * блоками, а её нагрузка исказит замеры. Если подбор прерван исключением,
+ * возвращаются параметры, действовавшие до вызова.
+ */
+class S21Tuner {
+ public:
+  static S21Tuner& Instance();  // Глобальные параметры
+
+  S21TuneParams Params() const;
+  void SetParams(const S21TuneParams& params);  // Бросает
+                                                // std::invalid_argument для
+                                                // неположительных значений
+  void Reset();  // Возвращает значения по умолчанию
+
+  // Измеряет кандидатов, применяет и возвращает лучшие параметры; не
+  // вызывать параллельно с другими операциями над матрицами
+  S21TuneParams Tune(const S21TuneOptions& options = S21TuneOptions());
+
+  // false, если файла нет или он снят на процессоре другой модели;
+  // std::invalid_argument при ошибке формата
+  bool Load(const std::string& path);
+  void Save(const std::string& path) const;  // std::runtime_error при ошибке
+
+  // $S21_MATRIX_TUNE_FILE, иначе $HOME/.s21_matrix_tune
+  static std::string ConfigPath();
+  static std::string HostId();  // Модель процессора и число потоков
+
+ private:
+  S21Tuner();
+
+  std::atomic<int> gemm_block_k_, gemm_block_n_, transpose_block_;
+  std::atomic<std::uint64_t> parallel_flops_;
+  std::atomic<int> lu_parallel_size_;
+};
+
+#endif  // S21_MATRIX_TUNE
@@ -0,0 +1,26 @@
+// Подбор параметров под текущую машину: make tune [TUNE_FILE=путь]
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "s21_matrix_tune.h"
+
+int main(int argc, char** argv) {
+  try {
+    std::string path = argc > 1 ? argv[1] : S21Tuner::ConfigPath();
+    S21Tuner& tuner = S21Tuner::Instance();
+    S21TuneParams params = tuner.Tune();
+    tuner.Save(path);
+    std::cout << "Машина: " << S21Tuner::HostId() << "\n"
+              << "gemm_block_k = " << params.gemm_block_k << "\n"
+              << "gemm_block_n = " << params.gemm_block_n << "\n"
+              << "transpose_block = " << params.transpose_block << "\n"
+              << "parallel_flops = " << params.parallel_flops << "\n"
+              << "lu_parallel_size = " << params.lu_parallel_size << "\n"
+              << "Сохранено в " << path << "\n";
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,327 @@
+#include "s21_matrix_update.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+void CheckOptions(const S21UpdateOptions& options) {
+  if (!(options.drift_tolerance > 0) || options.check_interval <= 0 ||
+      options.refactor_interval < 0) {
+    throw std::invalid_argument("Неверные параметры обновления");
+  }
+}
+
+void CheckUpdate(const S21Matrix& a, const S21Matrix& u, const S21Matrix& v) {
+  if (u.GetRows() != a.GetRows() || v.GetCols() != a.GetCols() ||
+      u.GetCols() != v.GetRows()) {
+    throw std::invalid_argument(
+        "Обновление A + U V требует U размером n x k и V размером k x n");
+  }
+}
+
+// Изменение A, заменяющее строки rows строками values: U из столбцов
+// единичной матрицы, V — разность новых и старых строк
+void RowChange(const S21Matrix& a, const std::vector<int>& rows,
+               const S21Matrix& values, S21Matrix* u, S21Matrix* v) {
+  const int n = a.GetRows(), k = static_cast<int>(rows.size());
+  if (k == 0 || values.GetRows() != k || values.GetCols() != a.GetCols()) {
+    throw std::invalid_argument(
+        "Число новых строк должно совпадать с числом индексов");
+  }
+  std::vector<int> sorted = rows;
+  std::sort(sorted.begin(), sorted.end());
+  if (sorted.front() < 0 || sorted.back() >= n ||
+      std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+    throw std::out_of_range("Индексы строк вне матрицы или повторяются");
+  }
+  *u = S21Matrix(n, k);
+  *v = S21Matrix(k, a.GetCols());
+  for (int t = 0; t < k; ++t) {
+    (*u)(rows[t], t) = 1.0;
+    for (int j = 0; j < a.GetCols(); ++j) {
+      (*v)(t, j) = values(t, j) - a(rows[t], j);
+    }
+  }
+}
+
+// Фиксированный пробный вектор со значениями разного знака и величины,
+// чтобы ошибка не пряталась в сокращениях
+S21Matrix Probe(int n) {
+  S21Matrix z(n, 1);
+  for (int i = 0; i < n; ++i) {
+    z(i, 0) = (i % 2 == 0 ? 1.0 : -1.0) * (1.0 + (i * 7 % 11) / 11.0);
+  }
+  return z;
+}
+
+// ||A x - z|| / (||A|| ||x|| + ||z||) в max-норме
+double BackwardError(const S21Matrix& a, const S21Matrix& x,
+                     const S21Matrix& z) {
+  const int n = a.GetRows();
+  const double* const* rows = a.GetConstMatrixPointer();
+  double norm_r = 0.0, norm_x = 0.0, norm_z = 0.0;
+  for (int i = 0; i < n; ++i) {
+    double sum = -z(i, 0);
+    for (int j = 0; j < n; ++j) sum += rows[i][j] * x(j, 0);
+    norm_r = std::max(norm_r, std::fabs(sum));
+    norm_x = std::max(norm_x, std::fabs(x(i, 0)));
+    norm_z = std::max(norm_z, std::fabs(z(i, 0)));
+  }
+  double drift = norm_r / (a.NormInf() * norm_x + norm_z);
+  return std::isnan(drift) ? std::numeric_limits<double>::infinity() : drift;
+}
+
+double InverseDrift(const S21Matrix& a, const S21Matrix& inverse) {
+  S21Matrix z = Probe(a.GetRows());
+  return BackwardError(a, inverse * z, z);
+}
+
+// Обновление ранга 1 множителей P A = L U до P (A + x y) = L' U' по
+// алгоритму Беннетта. Шаг k отделяет первую строку и столбец остаточной
+// задачи: U'[k][k] = U[k][k] + x_k y_k, строка U и столбец L пересчитываются
+// явно, а остаток снова является обновлением ранга 1 с векторами
+// x - x_k L[:,k] и y - y_k / U'[k][k] * U'[k,:]
+bool UpdateRankOne(double** lu, const std::vector<int>& pivots,
+                   std::vector<double> x, std::vector<double> y) {
+  const int n = static_cast<int>(pivots.size());
+  for (int k = 0; k < n; ++k) {
+    if (pivots[k] != k) std::swap(x[k], x[pivots[k]]);
+  }
+  for (int k = 0; k < n; ++k) {
+    double* row_k = lu[k];
+    const double diagonal = row_k[k] + x[k] * y[k];
+    if (diagonal == 0 || !std::isfinite(diagonal)) return false;
+    const double xk = x[k];
+    for (int j = k + 1; j < n; ++j) row_k[j] += xk * y[j];
+    for (int i = k + 1; i < n; ++i) {
+      const double l = lu[i][k];
+      lu[i][k] = (l * row_k[k] + x[i] * y[k]) / diagonal;
+      x[i] -= xk * l;
+    }
+    const double scale = y[k] / diagonal;
+    for (int j = k + 1; j < n; ++j) y[j] -= scale * row_k[j];
+    row_k[k] = diagonal;
+  }
+  return true;
+}
+
+bool UpdateFactors(S21Matrix* lu, const std::vector<int>& pivots,
+                   const S21Matrix& u, const S21Matrix& v) {
+  const int n = lu->GetRows();
+  double** factors = lu->GetMatrixPointer();
+  std::vector<double> x(n), y(n);
+  for (int t = 0; t < u.GetCols(); ++t) {
+    for (int i = 0; i < n; ++i) {
+      x[i] = u(i, t);
+      y[i] = v(t, i);
+    }
+    if (!UpdateRankOne(factors, pivots, x, y)) return false;
+  }
+  return true;
+}
+
+S21Matrix LuSolve(const S21Matrix& lu, const std::vector<int>& pivots,
+                  const S21Matrix& b) {
+  const int n = lu.GetRows();
+  if (b.GetRows() != n) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  const double* const* a = lu.GetConstMatrixPointer();
+  S21Matrix x(n, b.GetCols());
+  std::vector<double> column(n);
+  for (int j = 0; j < b.GetCols(); ++j) {
+    for (int i = 0; i < n; ++i) column[i] = b(i, j);
+    for (int k = 0; k < n; ++k) {
+      if (pivots[k] != k) std::swap(column[k], column[pivots[k]]);
+    }
+    for (int i = 1; i < n; ++i) {
+      double sum = column[i];
+      for (int k = 0; k < i; ++k) sum -= a[i][k] * column[k];
+      column[i] = sum;
+    }
+    for (int i = n - 1; i >= 0; --i) {
+      double sum = column[i];
+      for (int k = i + 1; k < n; ++k) sum -= a[i][k] * column[k];
+      column[i] = sum / a[i][i];
+    }
+    for (int i = 0; i < n; ++i) x(i, j) = column[i];
+  }
+  return x;
+}
+
+// Нужен ли пересчёт после обновления с порядковым номером count
+bool Due(const S21UpdateOptions& options, std::uint64_t count) {
+  return options.refactor_interval > 0 &&
+         count % static_cast<std::uint64_t>(options.refactor_interval) == 0;
+}
+
+bool CheckDue(const S21UpdateOptions& options, std::uint64_t count) {
+  return count % static_cast<std::uint64_t>(options.check_interval) == 0;
+}
+
+}  // namespace
+
+S21InverseUpdater::S21InverseUpdater(const S21Matrix& a,
+                                     const S21UpdateOptions& options)
+    : a_(a), options_(options) {
+  CheckOptions(options_);
+  inverse_ = a_.Solve(S21Matrix::Identity(a_.GetRows()));
+  stats_.drift = InverseDrift(a_, inverse_);
+}
+
+void S21InverseUpdater::Update(const S21Matrix& u, const S21Matrix& v) {
+  CheckUpdate(a_, u, v);
+  S21Matrix a = a_;
+  a.RankUpdate(u, v);
+
+  S21Matrix ainv_u = inverse_ * u;
+  S21Matrix v_ainv = v * inverse_;
+  S21Matrix capacitance = v * ainv_u;
+  for (int i = 0; i < capacitance.GetRows(); ++i) capacitance(i, i) += 1.0;
+  S21Matrix inverse = inverse_;
+  bool updated = true;
+  try {
+    inverse.RankUpdate(ainv_u, capacitance.Solve(v_ainv), -1.0);
+  } catch (const std::invalid_argument&) {
+    // I + V A^-1 U вырождена вместе с A + U V либо из-за ошибки в A^-1;
+    // решает полный пересчёт
+    updated = false;
+  }
+  Commit(std::move(a), std::move(inverse), updated);
+}
+
+void S21InverseUpdater::ReplaceRows(const std::vector<int>& rows,
+                                    const S21Matrix& values) {
+  S21Matrix u, v;
+  RowChange(a_, rows, values, &u, &v);
+  Update(u, v);
+}
+
+void S21InverseUpdater::Commit(S21Matrix a, S21Matrix inverse, bool updated) {
+  const std::uint64_t count = stats_.updates + 1;
+  bool refactor = !updated || Due(options_, count);
+  double drift = stats_.drift;
+  if (!refactor && CheckDue(options_, count)) {
+    drift = InverseDrift(a, inverse);
+    refactor = !(drift <= options_.drift_tolerance);
+  }
+  if (refactor) {
+    // Бросает для вырожденной A, оставляя объект в прежнем состоянии
+    inverse = a.Solve(S21Matrix::Identity(a.GetRows()));
+    drift = InverseDrift(a, inverse);
+    ++stats_.refactorizations;
+  }
+  a_ = std::move(a);
+  inverse_ = std::move(inverse);
+  stats_.drift = drift;
+  stats_.updates = count;
+}
+
+S21Matrix S21InverseUpdater::Solve(const S21Matrix& b) const {
+  if (b.GetRows() != a_.GetRows()) {
+    throw std::invalid_argument(
+        "Количество строк правой части должно совпадать с размером матрицы");
+  }
+  return inverse_ * b;
+}
+
+double S21InverseUpdater::Drift() const { return InverseDrift(a_, inverse_); }
+
+void S21InverseUpdater::Refactor() {
+  inverse_ = a_.Solve(S21Matrix::Identity(a_.GetRows()));
+  stats_.drift = InverseDrift(a_, inverse_);
+  ++stats_.refactorizations;
+}
+
+const S21Matrix& S21InverseUpdater::Matrix() const { return a_; }
+
+const S21Matrix& S21InverseUpdater::Inverse() const { return inverse_; }
+
+const S21UpdateStats& S21InverseUpdater::Stats() const { return stats_; }
+
+S21LuUpdater::S21LuUpdater(const S21Matrix& a, const S21UpdateOptions& options)
+    : a_(a), options_(options) {
+  CheckOptions(options_);
+  lu_ = a_.LuDecompose(&pivots_);
+  stats_.drift = Drift();
+}
+
+void S21LuUpdater::Update(const S21Matrix& u, const S21Matrix& v) {
+  CheckUpdate(a_, u, v);
+  S21Matrix a = a_;
+  a.RankUpdate(u, v);
+  S21Matrix lu = lu_;
+  bool updated = UpdateFactors(&lu, pivots_, u, v);
+  Commit(std::move(a), std::move(lu), updated);
+}
+
+void S21LuUpdater::ReplaceRows(const std::vector<int>& rows,
+                               const S21Matrix& values) {
+  S21Matrix u, v;
+  RowChange(a_, rows, values, &u, &v);
+  Update(u, v);
+}
+
+void S21LuUpdater::Commit(S21Matrix a, S21Matrix lu, bool updated) {
+  const std::uint64_t count = stats_.updates + 1;
+  const S21Matrix z = Probe(a.GetRows());
+  bool refactor = !updated || Due(options_, count);
+  double drift = stats_.drift;
+  if (!refactor && CheckDue(options_, count)) {
+    drift = BackwardError(a, LuSolve(lu, pivots_, z), z);
+    refactor = !(drift <= options_.drift_tolerance);
+  }
+  std::vector<int> pivots = pivots_;
+  if (refactor) {
+    lu = a.LuDecompose(&pivots);
+    drift = BackwardError(a, LuSolve(lu, pivots, z), z);
+    ++stats_.refactorizations;
+  }
+  a_ = std::move(a);
+  lu_ = std::move(lu);
+  pivots_ = std::move(pivots);
+  stats_.drift = drift;
+  stats_.updates = count;
+}
+
+S21Matrix S21LuUpdater::Solve(const S21Matrix& b) const {
+  return LuSolve(lu_, pivots_, b);
+}
+
+S21Matrix S21LuUpdater::Inverse() const {
+  return LuSolve(lu_, pivots_, S21Matrix::Identity(a_.GetRows()));
+}
+
+double S21LuUpdater::Determinant() const {
+  double det = 1.0;
+  for (int k = 0; k < lu_.GetRows(); ++k) {
+    det *= pivots_[k] != k ? -lu_(k, k) : lu_(k, k);
+  }
+  return det;
+}
+
+double S21LuUpdater::Drift() const {
+  const S21Matrix z = Probe(a_.GetRows());
+  return BackwardError(a_, LuSolve(lu_, pivots_, z), z);
+}
+
+void S21LuUpdater::Refactor() {
+  std::vector<int> pivots;
+  lu_ = a_.LuDecompose(&pivots);
+  pivots_ = std::move(pivots);
+  stats_.drift = Drift();
+  ++stats_.refactorizations;
+}
+
+const S21Matrix& S21LuUpdater::Matrix() const { return a_; }
+
+const S21Matrix& S21LuUpdater::Factors() const { return lu_; }
+
+const std::vector<int>& S21LuUpdater::Pivots() const { return pivots_; }
+
+const S21UpdateStats& S21LuUpdater::Stats() const { return stats_; }
@@ -0,0 +1,120 @@
+#ifndef S21_MATRIX_UPDATE
+#define S21_MATRIX_UPDATE
+
+// Небходимые зависимые директивы
+#include <cstdint>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Когда накопленную после обновлений ошибку пора сбросить полным пересчётом
+struct S21UpdateOptions {
+  double drift_tolerance = 1e-10;  // Допустимая обратная ошибка Drift()
+  int check_interval = 1;     // Drift() проверяется после каждых N обновлений
+  int refactor_interval = 0;  // Плановый пересчёт через N обновлений; 0 — нет
+};
+
+struct S21UpdateStats {
+  std::uint64_t updates = 0;           // Применённых обновлений
+  std::uint64_t refactorizations = 0;  // Полных пересчётов после начального
+  double drift = 0.0;                  // Последняя измеренная обратная ошибка
+};
+
+/**
+ * @brief Обратная матрица, поддерживаемая при малоранговых изменениях A.
+ *
+ * После изменения A += U V (U размером n x k, V — k x n) обратная
+ * обновляется по формуле Шермана — Моррисона — Вудбери
+ *
+ *   (A + U V)^-1 = A^-1 - A^-1 U (I + V A^-1 U)^-1 V A^-1
+ *
+ * за O(n^2 k) вместо O(n^3) для нового обращения. Замена k строк A — частный
+ * случай с U из столбцов единичной матрицы.
+ *
+ * Ошибка округления накапливается от обновления к обновлению, поэтому после
+ * каждых check_interval обновлений за O(n^2) измеряется обратная ошибка
+ * ||A x - z|| / (||A|| ||x|| + ||z||) для x = A^-1 z и фиксированного
+ * пробного z. Если она больше drift_tolerance или матрица I + V A^-1 U
+ * вырождена, обратная пересчитывается заново из A.
+ *
+ * @note Объект не потокобезопасен.
+ */
+class S21InverseUpdater {
+ public:
+  // Бросает std::invalid_argument для неквадратной или вырожденной матрицы
+  // и неположительных параметров
+  explicit S21InverseUpdater(const S21Matrix& a,
+                             const S21UpdateOptions& options = {});
+
+  // A += U V; std::invalid_argument при несовпадении размеров или если
+  // обновлённая матрица вырождена
+  void Update(const S21Matrix& u, const S21Matrix& v);
+  // Заменяет строки rows матрицы A строками values (k x n)
+  void ReplaceRows(const std::vector<int>& rows, const S21Matrix& values);
+
+  S21Matrix Solve(const S21Matrix& b) const;  // A^-1 b
+  double Drift() const;  // Обратная ошибка текущей обратной
+  void Refactor();       // Пересчёт обратной из A за O(n^3)
+
+  const S21Matrix& Matrix() const;
+  const S21Matrix& Inverse() const;
+  const S21UpdateStats& Stats() const;
+
+ private:
+  // Принимает обновлённые A и обратную, при необходимости пересчитывая её;
+  // updated == false, если формула Вудбери неприменима
+  void Commit(S21Matrix a, S21Matrix inverse, bool updated);
+
+  S21Matrix a_, inverse_;
+  S21UpdateOptions options_;
+  S21UpdateStats stats_;
+};
+
+/**
+ * @brief LU-разложение P A = L U, поддерживаемое при малоранговых
+ * изменениях A.
+ *
+ * Каждый столбец изменения A += U V применяется к множителям как обновление
+ * ранга 1 по алгоритму Беннетта за O(n^2), так что изменение ранга k стоит
+ * O(n^2 k) против O(n^3) для нового разложения; отрицательные слагаемые
+ * (понижение ранга) обрабатываются тем же путём.
+ *
+ * Обновление сохраняет перестановку исходного разложения и не выбирает
+ * ведущие элементы заново, поэтому может терять устойчивость. Как и в
+ * S21InverseUpdater, обратная ошибка решения проверяется после каждых
+ * check_interval обновлений, а при её росте, нулевом или нечисловом
+ * диагональном элементе U матрица раскладывается заново.
+ *
+ * @note Объект не потокобезопасен.
+ */
+class S21LuUpdater {
+ public:
+  explicit S21LuUpdater(const S21Matrix& a,
+                        const S21UpdateOptions& options = {});
+
+  void Update(const S21Matrix& u, const S21Matrix& v);
+  void ReplaceRows(const std::vector<int>& rows, const S21Matrix& values);
+
+  S21Matrix Solve(const S21Matrix& b) const;  // Решение A X = B за O(n^2 m)
+  S21Matrix Inverse() const;                   // O(n^3)
+  double Determinant() const;                  // O(n) по диагонали U
+  double Drift() const;
+  void Refactor();
+
+  const S21Matrix& Matrix() const;
+  const S21Matrix& Factors() const;  // Упакованные L и U, как LuDecompose()
+  const std::vector<int>& Pivots() const;
+  const S21UpdateStats& Stats() const;
+
+ private:
+  // То же для множителей; updated == false, если обновление встретило
+  // нулевой или нечисловой ведущий элемент
+  void Commit(S21Matrix a, S21Matrix lu, bool updated);
+
+  S21Matrix a_, lu_;
+  std::vector<int> pivots_;
+  S21UpdateOptions options_;
+  S21UpdateStats stats_;
+};
+
+#endif  // S21_MATRIX_UPDATE
@@ -0,0 +1,245 @@
+#include "s21_thread_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "s21_matrix_memory.h"
+#include "s21_matrix_profile.h"
+#include "s21_matrix_tune.h"
+
+namespace {
+
+// Пул, которому принадлежит текущий поток, и номер потока в нём
+thread_local const S21ThreadPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+}  // namespace
+
+// Общее состояние одного вызова ParallelRows. Задачи, поставленные
+// потокам, держат его через shared_ptr: задача, до которой очередь дошла
+// уже после возврата из ParallelRows, находит все диапазоны занятыми и
+// ничего не трогает
+struct S21ThreadPool::RowChunks {
+  RowChunks(int rows, int count, std::size_t bytes_per_row,
+            const std::function<void(int begin, int end)>& body)
+      : rows(rows),
+        count(count),
+        bytes_per_row(bytes_per_row),
+        body(&body),
+        claimed(new std::atomic<bool>[count]()),
+        remaining(count) {}
+
+  int Begin(int chunk) const {
+    return static_cast<int>(static_cast<long long>(rows) * chunk / count);
+  }
+
+  const int rows, count;
+  const std::size_t bytes_per_row;
+  const std::function<void(int begin, int end)>* body;
+  std::unique_ptr<std::atomic<bool>[]> claimed;  // Диапазон уже взят
+  std::mutex mutex;
+  std::condition_variable done;
+  int remaining;  // Диапазонов, ещё не выполненных до конца
+  std::exception_ptr error;
+};
+
+S21ThreadPool& S21ThreadPool::Instance() {
+  static S21ThreadPool instance(
+      static_cast<int>(std::thread::hardware_concurrency()));
+  // Только у глобального пула: обработчики fork() нельзя снять, а локальный
+  // пул может быть уже уничтожен
+  static const bool fork_safe = [] {
+    ::pthread_atfork([] { instance.mutex_.lock(); },
+                     [] { instance.mutex_.unlock(); },
+                     [] { instance.mutex_.unlock(); });
+    return true;
+  }();
+  (void)fork_safe;
+  return instance;
+}
+
+S21ThreadPool::S21ThreadPool(int threads) : owner_pid_(::getpid()) {
+  if (threads < 1) threads = 1;
+  pinned_.resize(threads);
+  worker_nodes_.assign(threads, 0);
+  workers_.reserve(threads);
+  for (int i = 0; i < threads; ++i) {
+    workers_.emplace_back(&S21ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+S21ThreadPool::~S21ThreadPool() {
+  if (IsForeignProcess()) {
+    // Потоков пула в этом процессе нет, объекты потоков можно только бросить
+    for (std::thread& worker : workers_) worker.detach();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void S21ThreadPool::Submit(std::function<void()> task, int priority) {
+  if (IsForeignProcess()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(Task{priority, sequence_++, std::move(task)});
+  }
+  ready_.notify_one();
+}
+
+void S21ThreadPool::SubmitTo(int worker, std::function<void()> task) {
+  if (worker < 0 || worker >= ThreadCount()) {
+    throw std::out_of_range("Номер рабочего потока вне диапазона");
+  }
+  if (IsForeignProcess()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pinned_[worker].push_back(std::move(task));
+  }
+  // Очередь общая для всех потоков ожидания, будим всех, чтобы проснулся
+  // именно нужный
+  ready_.notify_all();
+}
+
+int S21ThreadPool::ThreadCount() const {
+  return static_cast<int>(workers_.size());
+}
+
+void S21ThreadPool::ParallelRows(
+    int rows, std::size_t bytes_per_row,
+    const std::function<void(int begin, int end)>& body) {
+  if (rows <= 0) return;
+  if (IsForeignProcess()) {
+    body(0, rows);
+    return;
+  }
+
+  const int count = ThreadCount();
+  auto chunks = std::make_shared<RowChunks>(rows, count, bytes_per_row, body);
+  // Поток w сначала берёт свой диапазон, затем все ещё не начатые
+  for (int w = 0; w < count; ++w) {
+    SubmitTo(w, [this, chunks, w] {
+      for (int i = 0; i < chunks->count; ++i) {
+        RunChunk(chunks.get(), (w + i) % chunks->count);
+      }
+    });
+  }
+  // Вызывающий поток не ждёт потоков, занятых долгими задачами: он
+  // забирает не начатые диапазоны с конца, пока потоки берут свои с начала
+  for (int chunk = count - 1; chunk >= 0; --chunk) {
+    RunChunk(chunks.get(), chunk);
+  }
+  std::unique_lock<std::mutex> lock(chunks->mutex);
+  chunks->done.wait(lock, [&chunks] { return chunks->remaining == 0; });
+  if (chunks->error) std::rethrow_exception(chunks->error);
+}
+
+void S21ThreadPool::ParallelRowsIfWorth(
+    int rows, std::uint64_t flops, std::size_t bytes_per_row,
+    const std::function<void(int begin, int end)>& body) {
+  if (ThreadCount() > 1 &&
+      flops >= S21Tuner::Instance().Params().parallel_flops) {
+    ParallelRows(rows, bytes_per_row, body);
+  } else if (rows > 0) {
+    body(0, rows);
+  }
+}
+
+void S21ThreadPool::RunChunk(RowChunks* state, int chunk) {
+  RowChunks& chunks = *state;
+  if (chunks.claimed[chunk].exchange(true, std::memory_order_acq_rel)) return;
+  const int begin = chunks.Begin(chunk), end = chunks.Begin(chunk + 1);
+  try {
+    if (begin < end) {
+      auto start = std::chrono::steady_clock::now();
+      (*chunks.body)(begin, end);
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+      S21_PROFILE_NODE(CurrentNode(), (end - begin) * chunks.bytes_per_row,
+                       ns);
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(chunks.mutex);
+    if (!chunks.error) chunks.error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(chunks.mutex);
+  if (--chunks.remaining == 0) chunks.done.notify_one();
+}
+
+int S21ThreadPool::CurrentNode() const {
+  if (current_pool == this) return WorkerNode(current_worker);
+  const int cpu = ::sched_getcpu();
+  return cpu < 0 ? 0 : S21MatrixMemory::NodeOfCpu(cpu);
+}
+
+bool S21ThreadPool::PinWorkers() {
+  long cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1 || IsForeignProcess()) return false;
+  bool pinned = true;
+  for (int w = 0; w < ThreadCount(); ++w) {
+    int cpu = static_cast<int>(w % cpus);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (::pthread_setaffinity_np(workers_[w].native_handle(), sizeof(set),
+                                 &set) != 0) {
+      pinned = false;
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker_nodes_[w] = S21MatrixMemory::NodeOfCpu(cpu);
+  }
+  return pinned;
+}
+
+int S21ThreadPool::WorkerNode(int worker) const {
+  if (worker < 0 || worker >= ThreadCount()) return 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return worker_nodes_[worker];
+}
+
+void S21ThreadPool::WorkerLoop(int index) {
+  current_pool = this;
+  current_worker = index;
+  for (;;) {
+    std::function<void()> run;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this, index] {
+        return stopping_ || !tasks_.empty() || !pinned_[index].empty();
+      });
+      // При остановке сначала выполняем уже поставленные задачи, чтобы ни
+      // одна future не осталась без результата
+      if (!pinned_[index].empty()) {
+        run = std::move(pinned_[index].front());
+        pinned_[index].pop_front();
+      } else if (!tasks_.empty()) {
+        run = std::move(const_cast<Task&>(tasks_.top()).run);
+        tasks_.pop();
+      } else {
+        return;
+      }
+    }
+    run();
+  }
+}
+
+bool S21ThreadPool::IsForeignProcess() const {
+  return ::getpid() != owner_pid_;
+}
@@ -0,0 +1,145 @@
+#ifndef S21_THREAD_POOL
+#define S21_THREAD_POOL
+
+// Небходимые зависимые директивы
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Признак отмены асинхронной операции.
+ *
+ * Копии токена разделяют одно состояние: вызов Cancel() на любой из них
+ * виден во всех остальных. Операция проверяет токен перед запуском и между
+ * крупными шагами вычисления.
+ */
+class S21CancelToken {
+ public:
+  S21CancelToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void Cancel() { cancelled_->store(true, std::memory_order_relaxed); }
+  bool IsCancelled() const {
+    return cancelled_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// Исключение, которым завершается future отменённой операции
+class S21Cancelled : public std::runtime_error {
+ public:
+  S21Cancelled() : std::runtime_error("Операция над матрицей отменена") {}
+};
+
+// Параметры запуска асинхронной операции
+struct S21AsyncOptions {
+  int priority = 0;  // Задачи с большим приоритетом запускаются раньше
+  S21CancelToken token;
+};
+
+/**
+ * @brief Пул рабочих потоков библиотеки.
+ *
+ * Задачи выбираются по убыванию приоритета, при равном приоритете — в
+ * порядке постановки. Глобальный пул создаётся при первом обращении и
+ * использует по одному потоку на аппаратное ядро.
+ *
+ * Для NUMA-систем пул умеет закреплять рабочие потоки за процессорами
+ * (PinWorkers) и предлагать строки статически (ParallelRows): диапазон с
+ * номером w сначала достаётся потоку w, поэтому при политике
+ * S21NumaPolicy::kFirstTouch поток обычно обрабатывает строки, страницы
+ * которых сам же и коснулся первым.
+ *
+ * В процессе, порождённом через fork(), рабочих потоков нет, поэтому там
+ * задачи выполняются сразу в вызывающем потоке.
+ */
+class S21ThreadPool {
+ public:
+  static S21ThreadPool& Instance();  // Глобальный пул библиотеки
+
+  explicit S21ThreadPool(int threads);
+  ~S21ThreadPool();  // Дожидается выполнения поставленных задач
+
+  S21ThreadPool(const S21ThreadPool&) = delete;
+  S21ThreadPool& operator=(const S21ThreadPool&) = delete;
+
+  void Submit(std::function<void()> task, int priority = 0);
+  void SubmitTo(int worker, std::function<void()> task);  // Конкретному потоку
+  int ThreadCount() const;
+
+  /**
+   * @brief Выполняет body(begin, end) над строками [0, rows), разбитыми на
+   * ThreadCount() равных диапазонов, и дожидается завершения.
+   *
+   * Диапазон с номером w ставится в очередь рабочего потока w, но это
+   * только подсказка размещения: диапазон, который ещё не начат, забирает
+   * любой освободившийся поток пула или сам вызывающий поток. Поэтому
+   * долгая задача (например, InverseAsync) на одном потоке не задерживает
+   * весь вызов, а вложенный вызов из задачи пула не может заблокироваться.
+   *
+   * @param bytes_per_row Объём памяти, который body читает и пишет на одну
+   * строку; используется для статистики пропускной способности по узлам
+   * NUMA в S21Profiler.
+   */
+  void ParallelRows(int rows, std::size_t bytes_per_row,
+                    const std::function<void(int begin, int end)>& body);
+
+  /**
+   * @brief ParallelRows, если оценка работы flops не меньше порога
+   * S21TuneParams::parallel_flops и в пуле больше одного потока, иначе
+   * body(0, rows) в текущем потоке.
+   */
+  void ParallelRowsIfWorth(int rows, std::uint64_t flops,
+                           std::size_t bytes_per_row,
+                           const std::function<void(int begin, int end)>& body);
+
+  /**
+   * @brief Закрепляет рабочий поток w за процессором w по модулю числа
+   * процессоров.
+   *
+   * @return true, если закрепление удалось для всех потоков.
+   */
+  bool PinWorkers();
+  int WorkerNode(int worker) const;  // Узел NUMA потока (0, если неизвестен)
+
+ private:
+  struct Task {
+    int priority;
+    std::uint64_t sequence;
+    std::function<void()> run;
+
+    bool operator<(const Task& other) const {
+      if (priority != other.priority) return priority < other.priority;
+      return sequence > other.sequence;
+    }
+  };
+
+  struct RowChunks;  // Состояние одного вызова ParallelRows
+
+  // Выполняет диапазон chunk, если его ещё не забрал другой поток
+  void RunChunk(RowChunks* chunks, int chunk);
+  int CurrentNode() const;  // Узел NUMA текущего потока для статистики
+  void WorkerLoop(int index);
+  bool IsForeignProcess() const;  // Вызов из процесса, порождённого fork()
+
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::priority_queue<Task> tasks_;
+  std::vector<std::deque<std::function<void()>>> pinned_;  // Очереди потоков
+  std::vector<int> worker_nodes_;
+  std::uint64_t sequence_ = 0;
+  bool stopping_ = false;
+  int owner_pid_;
+  std::vector<std::thread> workers_;
+};
+
+#endif  // S21_THREAD_POOL
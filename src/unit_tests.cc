@@ -1,6 +1,34 @@
+#include <dirent.h>
 #include <gtest/gtest.h>
-
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "s21_matrix_cache.h"
+#include "s21_matrix_compressed.h"
+#include "s21_matrix_conv.h"
+#include "s21_matrix_dist.h"
+#include "s21_matrix_factor.h"
+#include "s21_matrix_fuzz.h"
+#include "s21_matrix_graph.h"
+#include "s21_matrix_io.h"
+#include "s21_matrix_memory.h"
 #include "s21_matrix_oop.h"
+#include "s21_matrix_profile.h"
+#include "s21_matrix_semiring.h"
+#include "s21_matrix_shared.h"
+#include "s21_matrix_tune.h"
+#include "s21_matrix_update.h"
 
 // Для дефолтного конструктора
 
@@ -780,6 +808,2721 @@ TEST(S21MatrixTest, AccessValidIndex) {
   EXPECT_NO_THROW(matrix(2, 2));
 }
 
+// Для кэша результатов
+
+TEST(S21MatrixCacheTest, DeterminantHitAndMiss) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  cache.Enable(1 << 20);
+  cache.ResetStats();
+
+  S21Matrix matrix(3, 3);
+  matrix(0, 0) = 2.0;
+  matrix(1, 1) = 3.0;
+  matrix(2, 2) = 4.0;
+
+  EXPECT_DOUBLE_EQ(matrix.Determinant(), 24.0);
+  EXPECT_DOUBLE_EQ(matrix.Determinant(), 24.0);
+
+  S21CacheStats stats = cache.Stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+  cache.Disable();
+}
+
+TEST(S21MatrixCacheTest, MutationInvalidatesEntry) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  cache.Enable(1 << 20);
+  cache.ResetStats();
+
+  S21Matrix matrix(2, 2);
+  matrix(0, 0) = 1.0;
+  matrix(0, 1) = 2.0;
+  matrix(1, 0) = 3.0;
+  matrix(1, 1) = 4.0;
+
+  S21Matrix inverse = matrix.InverseMatrix();
+  EXPECT_DOUBLE_EQ(inverse(0, 0), -2.0);
+
+  matrix.MulNumber(2.0);
+  S21Matrix scaled = matrix.InverseMatrix();
+  EXPECT_DOUBLE_EQ(scaled(0, 0), -1.0);
+
+  matrix(0, 0) = 4.0;
+  EXPECT_DOUBLE_EQ(matrix.Determinant(), 8.0);
+
+  matrix(0, 0) = 2.0;
+  matrix.MulNumber(0.5);
+  EXPECT_DOUBLE_EQ(matrix.InverseMatrix()(1, 1), -0.5);
+  EXPECT_GE(cache.Stats().hits, 1u);
+  cache.Disable();
+}
+
+TEST(S21MatrixCacheTest, NonFiniteKeysAndInverseStats) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  cache.Enable(1 << 20);
+  cache.ResetStats();
+
+  S21Matrix with_nan(2, 2);
+  with_nan(0, 0) = std::numeric_limits<double>::quiet_NaN();
+  with_nan(1, 1) = 1.0;
+  EXPECT_TRUE(std::isnan(with_nan.Determinant()));
+  EXPECT_TRUE(std::isnan(with_nan.Determinant()));
+  EXPECT_EQ(cache.Stats().hits, 1u);
+
+  // Один промах обращения, без вложенного определителя
+  cache.ResetStats();
+  S21Matrix matrix(2, 2);
+  matrix(0, 0) = 4.0;
+  matrix(1, 1) = 2.0;
+  matrix.InverseMatrix();
+  S21CacheStats stats = cache.Stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 0u);
+
+  // Отличие в последнем бите — другая запись, а не попадание по допуску
+  S21Matrix nearby(matrix);
+  nearby(0, 0) = std::nextafter(4.0, 5.0);
+  EXPECT_NE(nearby.InverseMatrix()(0, 0), 0.25);
+  EXPECT_EQ(cache.Stats().misses, 2u);
+  cache.Disable();
+}
+
+TEST(S21MatrixCacheTest, BudgetEvictsLeastRecentlyUsed) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  S21Matrix first(4, 4);
+  S21Matrix second(4, 4);
+  first(0, 0) = 1.0;
+  second(0, 0) = 2.0;
+  std::size_t one_entry = 4 * (4 * sizeof(double) + sizeof(double*));
+
+  cache.Enable(one_entry);
+  cache.ResetStats();
+  first.Determinant();
+  second.Determinant();
+
+  S21CacheStats stats = cache.Stats();
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_LE(stats.bytes, one_entry);
+  cache.Disable();
+}
+
+TEST(S21MatrixCacheTest, ToggleWhileOtherThreadsCompute) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  cache.ResetStats();
+  std::atomic<bool> stop{false};
+  std::thread toggler([&] {
+    for (int i = 0; i < 200; ++i) {
+      cache.Enable(1 << 20);
+      cache.Disable();
+    }
+    stop = true;
+  });
+
+  S21Matrix matrix(3, 3);
+  matrix(0, 0) = 2.0;
+  matrix(1, 1) = 3.0;
+  matrix(2, 2) = 4.0;
+  int wrong = 0;
+  while (!stop) {
+    if (matrix.Determinant() != 24.0) ++wrong;
+    if (matrix.InverseMatrix()(2, 2) != 0.25) ++wrong;
+  }
+  toggler.join();
+  EXPECT_EQ(wrong, 0);
+  EXPECT_FALSE(cache.IsEnabled());
+}
+
+TEST(S21MatrixCacheTest, HashDependsOnContent) {
+  S21Matrix a(2, 3);
+  S21Matrix b(2, 3);
+  EXPECT_EQ(S21MatrixCache::Hash(a), S21MatrixCache::Hash(b));
+  b(1, 2) = 1.0;
+  EXPECT_NE(S21MatrixCache::Hash(a), S21MatrixCache::Hash(b));
+}
+
+// Для инструментирования
+
+TEST(S21ProfilerTest, JsonSnapshotIsWellFormed) {
+  std::string json = S21Profiler::Instance().ToJson();
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+  EXPECT_NE(json.find("\"enabled\":"), std::string::npos);
+  EXPECT_NE(json.find("\"ops\":"), std::string::npos);
+}
+
+TEST(S21ProfilerTest, ScopeArgumentsAreLazyWithoutTracer) {
+  if (S21TraceActive()) GTEST_SKIP() << "к пробам подключён трассировщик";
+  int evaluated = 0;
+  { S21_PROFILE_SCOPE(kOther, ++evaluated, 0); }
+  EXPECT_EQ(evaluated, S21Profiler::Enabled() ? 1 : 0);
+}
+
+#ifdef S21_MATRIX_PROFILE
+TEST(S21ProfilerTest, CountsCallsAndFlops) {
+  S21Profiler& profiler = S21Profiler::Instance();
+  profiler.Reset();
+
+  S21Matrix a(2, 3);
+  S21Matrix b(3, 4);
+  a.MulMatrix(b);
+  S21Matrix c = a * 2.0;
+  (void)c;
+
+  S21ProfileSnapshot snapshot = profiler.Snapshot();
+  EXPECT_EQ(snapshot[S21ProfileOp::kMulMatrix].calls, 1u);
+  EXPECT_EQ(snapshot[S21ProfileOp::kMulMatrix].flops, 2u * 2 * 3 * 4);
+  EXPECT_GT(snapshot[S21ProfileOp::kMulMatrix].bytes_allocated, 0u);
+  EXPECT_EQ(snapshot[S21ProfileOp::kOperatorMulNumber].calls, 1u);
+  EXPECT_EQ(snapshot[S21ProfileOp::kMulNumber].calls, 1u);
+  EXPECT_NE(profiler.ToJson().find("\"MulMatrix\""), std::string::npos);
+}
+
+TEST(S21ProfilerTest, OperatorWorkIsCountedOnce) {
+  S21Profiler& profiler = S21Profiler::Instance();
+  profiler.Reset();
+
+  S21Matrix a(2, 3);
+  S21Matrix b(3, 4);
+  S21Matrix c = a * b;
+  (void)c;
+
+  S21ProfileSnapshot snapshot = profiler.Snapshot();
+  std::uint64_t total = 0;
+  for (const S21OpStats& counters : snapshot.ops) {
+    total += counters.flops;
+  }
+  EXPECT_EQ(snapshot[S21ProfileOp::kOperatorMulMatrix].calls, 1u);
+  EXPECT_EQ(snapshot[S21ProfileOp::kOperatorMulMatrix].flops, 0u);
+  EXPECT_EQ(total, 2u * 2 * 3 * 4);
+}
+
+TEST(S21ProfilerTest, MergesThreadLocalCounters) {
+  S21Profiler& profiler = S21Profiler::Instance();
+  profiler.Reset();
+
+  std::thread worker([] {
+    S21Matrix m(2, 2);
+    m.Transpose();
+    m.Transpose();
+  });
+  worker.join();
+  S21Matrix m(2, 2);
+  m.Transpose();
+
+  EXPECT_EQ(profiler.Snapshot()[S21ProfileOp::kTranspose].calls, 3u);
+}
+#endif  // S21_MATRIX_PROFILE
+
+// Для решения систем и асинхронных операций
+
+TEST(S21MatrixTest, Solve_3x3System) {
+  S21Matrix a(3, 3);
+  a(0, 0) = 0.0;
+  a(0, 1) = 2.0;
+  a(0, 2) = 1.0;
+  a(1, 0) = 1.0;
+  a(1, 1) = 1.0;
+  a(1, 2) = 1.0;
+  a(2, 0) = 2.0;
+  a(2, 1) = 1.0;
+  a(2, 2) = 3.0;
+  S21Matrix b(3, 1);
+  b(0, 0) = 7.0;
+  b(1, 0) = 6.0;
+  b(2, 0) = 13.0;
+
+  S21Matrix x = a.Solve(b);
+
+  EXPECT_NEAR(x(0, 0), 1.0, 1e-12);
+  EXPECT_NEAR(x(1, 0), 2.0, 1e-12);
+  EXPECT_NEAR(x(2, 0), 3.0, 1e-12);
+}
+
+TEST(S21MatrixTest, Solve_SingularMatrix) {
+  S21Matrix a(2, 2);
+  a(0, 0) = 1.0;
+  a(0, 1) = 2.0;
+  a(1, 0) = 2.0;
+  a(1, 1) = 4.0;
+  S21Matrix b(2, 1);
+
+  EXPECT_THROW(a.Solve(b), std::invalid_argument);
+  EXPECT_THROW(a.Solve(S21Matrix(3, 1)), std::invalid_argument);
+}
+
+TEST(S21MatrixAsyncTest, MulMatrixAsyncMatchesSync) {
+  S21Matrix a(70, 5);
+  S21Matrix b(5, 3);
+  for (int i = 0; i < 70; ++i) {
+    for (int j = 0; j < 5; ++j) a(i, j) = i - j;
+  }
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 3; ++j) b(i, j) = i * j + 1;
+  }
+
+  std::future<S21Matrix> future = a.MulMatrixAsync(b);
+  S21Matrix expected = a * b;
+
+  EXPECT_TRUE(future.get() == expected);
+}
+
+TEST(S21MatrixAsyncTest, InverseAndSolveAsync) {
+  S21Matrix a(2, 2);
+  a(0, 0) = 1.0;
+  a(0, 1) = 2.0;
+  a(1, 0) = 3.0;
+  a(1, 1) = 4.0;
+  S21Matrix b(2, 1);
+  b(0, 0) = 5.0;
+  b(1, 0) = 11.0;
+
+  std::future<S21Matrix> inverse = a.InverseAsync();
+  std::future<S21Matrix> solution = a.SolveAsync(b);
+
+  EXPECT_DOUBLE_EQ(inverse.get()(1, 1), -0.5);
+  S21Matrix x = solution.get();
+  EXPECT_NEAR(x(0, 0), 1.0, 1e-12);
+  EXPECT_NEAR(x(1, 0), 2.0, 1e-12);
+  EXPECT_THROW(S21Matrix(2, 3).InverseAsync().get(), std::invalid_argument);
+}
+
+TEST(S21MatrixAsyncTest, CancelledBeforeStart) {
+  S21AsyncOptions options;
+  options.token.Cancel();
+  S21Matrix a(2, 2);
+
+  std::future<S21Matrix> future = a.MulMatrixAsync(a, options);
+
+  EXPECT_THROW(future.get(), S21Cancelled);
+  EXPECT_THROW(a.InverseAsync(options).get(), S21Cancelled);
+  EXPECT_THROW(a.SolveAsync(a, options).get(), S21Cancelled);
+}
+
+TEST(S21MatrixAsyncTest, MulMatrixAsyncUsesBlockedKernel) {
+  // Несколько полос строк; то же ядро, что и у operator*, даёт точное
+  // совпадение
+  S21Matrix a(300, 80);
+  S21Matrix b(80, 50);
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 80; ++j) a(i, j) = (i * 7 + j) % 13 - 6.5;
+  }
+  for (int i = 0; i < 80; ++i) {
+    for (int j = 0; j < 50; ++j) b(i, j) = (i + j * 3) % 11 * 0.25;
+  }
+
+  EXPECT_TRUE(a.MulMatrixAsync(b).get() == a * b);
+}
+
+TEST(S21ThreadPoolTest, RunsHigherPriorityFirst) {
+  S21ThreadPool pool(1);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  std::vector<int> order;
+  std::mutex order_mutex;
+
+  pool.Submit([opened] { opened.wait(); });
+  for (int priority : {1, 5, 3}) {
+    pool.Submit(
+        [priority, &order, &order_mutex] {
+          std::lock_guard<std::mutex> lock(order_mutex);
+          order.push_back(priority);
+        },
+        priority);
+  }
+  gate.set_value();
+  while (true) {
+    std::lock_guard<std::mutex> lock(order_mutex);
+    if (order.size() == 3) break;
+  }
+
+  EXPECT_EQ(order, (std::vector<int>{5, 3, 1}));
+}
+
+// Для графа отложенных операций
+
+namespace {
+
+S21Matrix FilledMatrix(int rows, int cols, double seed) {
+  S21Matrix matrix(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      // SetElement, а не operator(): копии должны разделять буфер
+      matrix.SetElement(i, j,
+                        seed + i * 0.5 - j * 0.25 + (i == j ? rows : 0));
+    }
+  }
+  return matrix;
+}
+
+// Элементы из [-1, 1) от линейного конгруэнтного генератора с начальным
+// состоянием seed, к диагонали прибавляется diagonal; один seed даёт одну и
+// ту же матрицу на любой платформе
+S21Matrix RandomMatrix(int rows, int cols, std::uint64_t seed,
+                       double diagonal = 0.0) {
+  S21Matrix matrix(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      const double uniform = static_cast<double>(seed >> 11) * 0x1.0p-52;
+      matrix.SetElement(i, j, uniform - 1.0 + (i == j ? diagonal : 0.0));
+    }
+  }
+  return matrix;
+}
+
+void ExpectMatrixNear(const S21Matrix& actual, const S21Matrix& expected,
+                      double tolerance) {
+  ASSERT_EQ(actual.GetRows(), expected.GetRows());
+  ASSERT_EQ(actual.GetCols(), expected.GetCols());
+  for (int i = 0; i < actual.GetRows(); ++i) {
+    for (int j = 0; j < actual.GetCols(); ++j) {
+      EXPECT_NEAR(actual(i, j), expected(i, j), tolerance);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(S21MatrixGraphTest, PipelineMatchesEagerEvaluation) {
+  S21Matrix a = FilledMatrix(3, 4, 1.0);
+  S21Matrix b = FilledMatrix(4, 3, -2.0);
+  S21Matrix c = FilledMatrix(3, 3, 0.5);
+  S21Matrix d = FilledMatrix(3, 3, 3.0);
+
+  S21MatrixGraph graph;
+  S21MatrixGraph::NodeId in_a = graph.Input(), in_b = graph.Input(),
+                         in_c = graph.Input(), in_d = graph.Input();
+  S21MatrixGraph::NodeId x =
+      graph.Mul(graph.Transpose(graph.Add(graph.Mul(in_a, in_b), in_c)),
+                graph.Inverse(in_d));
+  graph.Bind(in_a, a);
+  graph.Bind(in_b, b);
+  graph.Bind(in_c, c);
+  graph.Bind(in_d, d);
+
+  S21Matrix expected = (a * b + c).Transpose() * d.InverseMatrix();
+  ExpectMatrixNear(graph.Run(x), expected, 1e-9);
+}
+
+TEST(S21MatrixGraphTest, FusedElementwiseChain) {
+  S21Matrix a = FilledMatrix(5, 7, 1.0);
+  S21Matrix b = FilledMatrix(5, 7, 2.0);
+  S21Matrix c = FilledMatrix(5, 7, -1.0);
+
+  S21MatrixGraph graph;
+  S21MatrixGraph::NodeId in_a = graph.Input(), in_b = graph.Input(),
+                         in_c = graph.Input();
+  S21MatrixGraph::NodeId y =
+      graph.Sub(graph.Scale(graph.Add(in_a, in_b), 2.0),
+                graph.Add(in_c, graph.Scale(in_a, -1.0)));
+  graph.Bind(in_a, a);
+  graph.Bind(in_b, b);
+  graph.Bind(in_c, c);
+
+  S21Matrix expected = (a + b) * 2.0 - (c + a * -1.0);
+  ExpectMatrixNear(graph.Run(y), expected, 1e-12);
+}
+
+TEST(S21MatrixGraphTest, UsesEagerKernels) {
+  // Те же ядра, что и у немедленных операций: результаты совпадают точно,
+  // в том числе при повторном запуске плана
+  S21Matrix a = FilledMatrix(70, 40, 0.5), b = FilledMatrix(40, 70, 1.5);
+  S21MatrixGraph graph;
+  S21MatrixGraph::NodeId in_a = graph.Input(), in_b = graph.Input();
+  S21MatrixGraph::NodeId product = graph.Mul(in_a, in_b);
+  graph.Bind(in_a, a);
+  graph.Bind(in_b, b);
+  S21Matrix small = FilledMatrix(4, 4, 1.0);
+  S21MatrixGraph inverse_graph;
+  S21MatrixGraph::NodeId in_small = inverse_graph.Input();
+  S21MatrixGraph::NodeId small_inverse =
+      inverse_graph.Inverse(inverse_graph.Transpose(in_small));
+  inverse_graph.Bind(in_small, small);
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    EXPECT_TRUE(graph.Run(product) == a * b);
+    EXPECT_TRUE(inverse_graph.Run(small_inverse) ==
+                small.Transpose().InverseMatrix());
+  }
+}
+
+TEST(S21MatrixGraphTest, ReplayReusesPlanForSameShapes) {
+  S21Matrix a = FilledMatrix(3, 3, 1.0);
+  S21Matrix b = FilledMatrix(3, 3, 2.0);
+  S21Matrix wide = FilledMatrix(2, 5, 1.0);
+
+  S21MatrixGraph graph;
+  S21MatrixGraph::NodeId in_a = graph.Input(), in_b = graph.Input();
+  S21MatrixGraph::NodeId sum = graph.Add(in_a, in_b);
+  S21MatrixGraph::NodeId product = graph.Mul(sum, graph.Transpose(in_b));
+
+  graph.Bind(in_a, a);
+  graph.Bind(in_b, b);
+  std::vector<S21Matrix> first = graph.Run({sum, product});
+  ExpectMatrixNear(first[1], (a + b) * b.Transpose(), 1e-12);
+
+  a(0, 0) = 10.0;
+  S21Matrix second = graph.Run(product);
+  second = graph.Run(product);
+  ExpectMatrixNear(second, (a + b) * b.Transpose(), 1e-12);
+  EXPECT_EQ(graph.CompiledPlans(), 2u);
+
+  graph.Bind(in_a, wide);
+  EXPECT_THROW(graph.Run(product), std::invalid_argument);
+}
+
+TEST(S21MatrixGraphTest, LongChainReusesBuffers) {
+  S21Matrix a = FilledMatrix(4, 4, 0.1);
+  S21Matrix b = FilledMatrix(4, 4, -0.2);
+
+  S21MatrixGraph graph;
+  S21MatrixGraph::NodeId in_a = graph.Input(), in_b = graph.Input();
+  S21MatrixGraph::NodeId x = in_a;
+  S21Matrix expected(a);
+  for (int step = 0; step < 5; ++step) {
+    x = graph.Scale(graph.Transpose(graph.Mul(x, in_b)), 0.1);
+    expected = (expected * b).Transpose() * 0.1;
+  }
+  graph.Bind(in_a, a);
+  graph.Bind(in_b, b);
+
+  ExpectMatrixNear(graph.Run(x), expected, 1e-9);
+}
+
+// Для решения со смешанной точностью
+
+TEST(S21MatrixTest, SolveRefined_ReachesDoubleAccuracy) {
+  const int n = 40;
+  S21Matrix a(n, n);
+  S21Matrix expected(n, 2);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      a(i, j) = 1.0 / (1.0 + i + 2.0 * j) + (i == j ? 4.0 : 0.0);
+    }
+    expected(i, 0) = std::sin(i + 1.0);
+    expected(i, 1) = 1.0 / 3.0 + i;
+  }
+  S21Matrix b = a * expected;
+
+  S21RefineReport report;
+  S21Matrix x = a.SolveRefined(b, &report);
+
+  EXPECT_TRUE(report.converged);
+  EXPECT_FALSE(report.fell_back);
+  EXPECT_GE(report.iterations, 1);
+  EXPECT_LT(report.residual, 1e-14);
+  ExpectMatrixNear(x, expected, 1e-12);
+}
+
+TEST(S21MatrixTest, SolveRefined_FallsBackOnIllConditioned) {
+  const int n = 10;
+  S21Matrix hilbert(n, n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) hilbert(i, j) = 1.0 / (i + j + 1.0);
+  }
+  S21Matrix b(n, 1);
+  for (int i = 0; i < n; ++i) b(i, 0) = 1.0;
+
+  S21RefineReport report;
+  S21Matrix x = hilbert.SolveRefined(b, &report);
+
+  EXPECT_TRUE(report.fell_back);
+  EXPECT_LT(report.residual, 1e-12);
+  ExpectMatrixNear(x, hilbert.Solve(b), 0.0);
+}
+
+TEST(S21MatrixTest, InverseRefined_2x2Matrix) {
+  S21Matrix matrix(2, 2);
+  matrix(0, 0) = 1.0;
+  matrix(0, 1) = 2.0;
+  matrix(1, 0) = 3.0;
+  matrix(1, 1) = 4.0;
+
+  S21Matrix inverse = matrix.InverseRefined();
+
+  ExpectMatrixNear(inverse, matrix.InverseMatrix(), 1e-15);
+  EXPECT_THROW(S21Matrix(2, 3).InverseRefined(), std::invalid_argument);
+}
+
+// Для распределённых вычислений
+
+TEST(S21DistMatrixTest, SummaMatchesLocalProduct) {
+  S21Matrix a = FilledMatrix(5, 7, 1.0);
+  S21Matrix b = FilledMatrix(7, 4, -0.5);
+  S21Matrix expected = a * b;
+  S21Matrix gathered;
+
+  int failed = S21SocketTransport::Launch(4, [&](S21Transport& transport) {
+    S21DistMatrix dist_a(transport, 5, 7, 2, 2, 2);
+    S21DistMatrix dist_b(transport, 7, 4, 2, 2, 2);
+    dist_a.Scatter(a, 0);
+    dist_b.Scatter(b, 0);
+    S21DistMatrix product = dist_a.Multiply(dist_b);
+    S21Matrix result = product.Gather(0);
+    if (transport.Rank() == 0) gathered = std::move(result);
+  });
+
+  EXPECT_EQ(failed, 0);
+  ExpectMatrixNear(gathered, expected, 1e-12);
+}
+
+TEST(S21DistMatrixTest, DistributedSolve) {
+  const int n = 7;
+  S21Matrix a = FilledMatrix(n, n, 0.3);
+  a(0, 0) = 0.0;  // Требует перестановки строк
+  S21Matrix b = FilledMatrix(n, 2, 1.0);
+  S21Matrix expected = a.Solve(b);
+  S21Matrix solution;
+
+  int failed = S21SocketTransport::Launch(3, [&](S21Transport& transport) {
+    S21DistMatrix dist_a(transport, n, n, 2, 1, 3);
+    dist_a.Scatter(a, 0);
+    S21Matrix x = dist_a.Solve(b);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < 2; ++j) {
+        if (std::fabs(x(i, j) - expected(i, j)) > 1e-9) {
+          throw std::runtime_error("Решения процессов расходятся");
+        }
+      }
+    }
+    if (transport.Rank() == 0) solution = std::move(x);
+  });
+
+  EXPECT_EQ(failed, 0);
+  ExpectMatrixNear(solution, expected, 1e-9);
+}
+
+TEST(S21DistMatrixTest, LaunchWhileOtherThreadsHoldLibraryLocks) {
+  S21MatrixCache& cache = S21MatrixCache::Instance();
+  cache.Enable(1 << 24);
+  std::atomic<bool> stop{false};
+  // Поток постоянно берёт замки распределителя и кэша; без обработчиков
+  // fork дочерний процесс мог бы унаследовать их захваченными
+  std::thread busy([&stop] {
+    for (int i = 0; !stop.load(); ++i) {
+      S21Matrix large(300, 300);
+      S21Matrix small = FilledMatrix(3, 3, i % 7);
+      (void)large;
+      (void)small.Determinant();
+    }
+  });
+  int failed = 0;
+  for (int round = 0; round < 20; ++round) {
+    failed += S21SocketTransport::Launch(2, [round](S21Transport&) {
+      S21Matrix large(300, 300);
+      S21Matrix small = FilledMatrix(3, 3, round);
+      (void)large;
+      (void)small.Determinant();
+    });
+  }
+  stop = true;
+  busy.join();
+  cache.Disable();
+  EXPECT_EQ(failed, 0);
+}
+
+TEST(S21DistMatrixTest, FailedLaunchClosesSockets) {
+  auto open_descriptors = [] {
+    int count = 0;
+    DIR* dir = ::opendir("/proc/self/fd");
+    while (::readdir(dir) != nullptr) ++count;
+    ::closedir(dir);
+    return count;
+  };
+  const int before = open_descriptors();
+  rlimit saved{};
+  ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+  // 8 процессам нужно 56 сокетов: socketpair откажет на полпути
+  rlimit low = saved;
+  low.rlim_cur = before + 16;
+  ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &low), 0);
+  EXPECT_THROW(S21SocketTransport::Launch(8, [](S21Transport&) {}),
+               std::system_error);
+  ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &saved), 0);
+  EXPECT_EQ(open_descriptors(), before);
+}
+
+TEST(S21DistMatrixTest, InvalidGridThrows) {
+  int failed = S21SocketTransport::Launch(2, [](S21Transport& transport) {
+    EXPECT_THROW(S21DistMatrix(transport, 4, 4, 2, 2, 2),
+                 std::invalid_argument);
+  });
+  EXPECT_EQ(failed, 0);
+}
+
+// Для сравнения с допуском
+
+TEST(S21MatrixTest, EqMatrixAbsoluteAndRelativeTolerance) {
+  S21Matrix a = FilledMatrix(3, 70, 1.0);
+  S21Matrix b = a;
+  b(2, 69) += 1e-9;
+  EXPECT_FALSE(a.EqMatrix(b));
+  EXPECT_TRUE(a.EqMatrix(b, 1e-8));
+  EXPECT_FALSE(a.EqMatrix(b, 1e-10));
+
+  b(0, 0) = a(0, 0) * (1.0 + 1e-6);
+  EXPECT_FALSE(a.EqMatrix(b, 1e-8));
+  EXPECT_TRUE(a.EqMatrix(b, 1e-8, 2e-6));
+  EXPECT_FALSE(a.EqMatrix(S21Matrix(3, 69), 1.0));
+  EXPECT_THROW(a.EqMatrix(b, -1.0), std::invalid_argument);
+
+  S21Matrix with_nan = a;
+  with_nan(1, 1) = std::nan("");
+  EXPECT_FALSE(with_nan.EqMatrix(with_nan, 1.0));
+}
+
+TEST(S21MatrixTest, EqMatrixUlps) {
+  S21Matrix a(1, 3);
+  a(0, 0) = 1.0;
+  a(0, 1) = 0.0;
+  a(0, 2) = -2.5;
+  S21Matrix b = a;
+  b(0, 0) = std::nextafter(std::nextafter(1.0, 2.0), 2.0);
+  b(0, 1) = -0.0;
+  b(0, 2) = std::nextafter(-2.5, 0.0);
+  EXPECT_TRUE(a.EqMatrixUlps(b, 2));
+  EXPECT_FALSE(a.EqMatrixUlps(b, 1));
+
+  // Через ноль: наименьшие денормализованные числа разных знаков
+  S21Matrix tiny(1, 1), negative_tiny(1, 1);
+  tiny(0, 0) = std::numeric_limits<double>::denorm_min();
+  negative_tiny(0, 0) = -tiny(0, 0);
+  EXPECT_TRUE(tiny.EqMatrixUlps(negative_tiny, 2));
+  EXPECT_FALSE(tiny.EqMatrixUlps(negative_tiny, 1));
+}
+
+TEST(S21MatrixTest, EqMatrixNorm) {
+  S21Matrix a = FilledMatrix(4, 4, 0.0);
+  S21Matrix b = a;
+  b(0, 0) += 3e-3;
+  b(3, 3) -= 4e-3;
+  EXPECT_TRUE(a.EqMatrixNorm(b, 5e-3 + 1e-12));
+  EXPECT_FALSE(a.EqMatrixNorm(b, 4.9e-3));
+  EXPECT_FALSE(a.EqMatrixNorm(S21Matrix(4, 3), 1.0));
+  EXPECT_THROW(a.EqMatrixNorm(b, -1.0), std::invalid_argument);
+
+  // tol^2 исчез бы в ноль, а квадраты разностей — тем более
+  S21Matrix tiny(1, 2), tiny_b(1, 2);
+  tiny(0, 0) = 3e-170;
+  tiny(0, 1) = 4e-170;
+  EXPECT_TRUE(tiny.EqMatrixNorm(tiny_b, 5e-170 * (1 + 1e-12)));
+  EXPECT_FALSE(tiny.EqMatrixNorm(tiny_b, 4.9e-170));
+  // Квадраты переполнились бы
+  S21Matrix huge(1, 2), huge_b(1, 2);
+  huge(0, 0) = 3e200;
+  huge(0, 1) = 4e200;
+  EXPECT_TRUE(huge.EqMatrixNorm(huge_b, 5e200 * (1 + 1e-12)));
+  EXPECT_FALSE(huge.EqMatrixNorm(huge_b, 4.9e200));
+}
+
+TEST(S21MatrixTest, EqMatrixInfinities) {
+  const double inf = std::numeric_limits<double>::infinity();
+  S21Matrix a(1, 3);
+  a(0, 0) = inf;
+  a(0, 1) = -inf;
+  a(0, 2) = 1.0;
+  S21Matrix b = a;
+  EXPECT_TRUE(a.EqMatrix(b));
+  EXPECT_TRUE(a.EqMatrix(b, 0.0));
+  EXPECT_TRUE(a.EqMatrix(b, 1e-9, 1e-9));
+  EXPECT_TRUE(a.EqMatrixUlps(b, 0));
+  EXPECT_TRUE(a.EqMatrixNorm(b, 0.0));
+  b(0, 1) = inf;
+  EXPECT_FALSE(a.EqMatrix(b, 1e300));
+  EXPECT_FALSE(a.EqMatrixNorm(b, 1e300));
+  b(0, 1) = -1e308;
+  EXPECT_FALSE(a.EqMatrix(b, 1e300, 0.5));
+}
+
+// Для норм и статистик
+
+TEST(S21MatrixTest, StatisticsOfSmallMatrix) {
+  S21Matrix m(2, 3);
+  m(0, 0) = 1.0;
+  m(0, 1) = -2.0;
+  m(0, 2) = 3.0;
+  m(1, 0) = -4.0;
+  m(1, 1) = 5.0;
+  m(1, 2) = -6.0;
+  for (S21Summation mode : {S21Summation::kNaive, S21Summation::kPairwise,
+                            S21Summation::kKahan}) {
+    S21MatrixStats stats = m.Statistics(mode);
+    EXPECT_DOUBLE_EQ(stats.sum, -3.0);
+    EXPECT_DOUBLE_EQ(stats.mean, -0.5);
+    EXPECT_DOUBLE_EQ(stats.min, -6.0);
+    EXPECT_DOUBLE_EQ(stats.max, 5.0);
+    EXPECT_DOUBLE_EQ(stats.frobenius, std::sqrt(91.0));
+    EXPECT_DOUBLE_EQ(stats.norm1, 9.0);
+    EXPECT_DOUBLE_EQ(stats.norm_inf, 15.0);
+    EXPECT_DOUBLE_EQ(stats.trace, 6.0);
+  }
+  EXPECT_DOUBLE_EQ(m.Sum(), -3.0);
+  EXPECT_DOUBLE_EQ(m.Mean(), -0.5);
+  EXPECT_DOUBLE_EQ(m.Min(), -6.0);
+  EXPECT_DOUBLE_EQ(m.Max(), 5.0);
+  EXPECT_DOUBLE_EQ(m.NormFrobenius(), std::sqrt(91.0));
+  EXPECT_DOUBLE_EQ(m.Norm1(), 9.0);
+  EXPECT_DOUBLE_EQ(m.NormInf(), 15.0);
+
+  S21Matrix rows = m.RowSums();
+  EXPECT_DOUBLE_EQ(rows(0, 0), 2.0);
+  EXPECT_DOUBLE_EQ(rows(1, 0), -5.0);
+  S21Matrix cols = m.ColSums(S21Summation::kKahan);
+  EXPECT_EQ(cols.GetRows(), 1);
+  EXPECT_DOUBLE_EQ(cols(0, 0), -3.0);
+  EXPECT_DOUBLE_EQ(cols(0, 1), 3.0);
+  EXPECT_DOUBLE_EQ(cols(0, 2), -3.0);
+}
+
+TEST(S21MatrixTest, ReductionsRejectInvalidShapes) {
+  S21Matrix empty;
+  EXPECT_THROW(empty.Statistics(), std::invalid_argument);
+  EXPECT_THROW(empty.Mean(), std::invalid_argument);
+  EXPECT_THROW(empty.Min(), std::invalid_argument);
+  EXPECT_DOUBLE_EQ(empty.Sum(), 0.0);
+  EXPECT_DOUBLE_EQ(empty.NormFrobenius(), 0.0);
+  EXPECT_THROW(S21Matrix(2, 3).Trace(), std::invalid_argument);
+  EXPECT_DOUBLE_EQ(FilledMatrix(3, 3, 1.0).Trace(), 3 * (1.0 + 3) + 0.75);
+}
+
+TEST(S21MatrixTest, KahanSumIsExact) {
+  const int n = 1002;
+  S21Matrix row(1, n);
+  row(0, 0) = 1e16;
+  for (int j = 1; j < n - 1; ++j) row(0, j) = 1.0;
+  row(0, n - 1) = -1e16;
+  EXPECT_DOUBLE_EQ(row.Sum(S21Summation::kKahan), 1000.0);
+  EXPECT_DOUBLE_EQ(row.Transpose().Sum(S21Summation::kKahan), 1000.0);
+  EXPECT_DOUBLE_EQ(row.Transpose().ColSums(S21Summation::kKahan)(0, 0),
+                   1000.0);
+}
+
+TEST(S21MatrixTest, ParallelStatisticsMatchReference) {
+  const int rows = 300, cols = 350;
+  S21Matrix m = FilledMatrix(rows, cols, -2.0);
+  double sum = 0.0, squares = 0.0, norm_inf = 0.0, norm1 = 0.0;
+  for (int i = 0; i < rows; ++i) {
+    double row_abs = 0.0;
+    for (int j = 0; j < cols; ++j) {
+      sum += m(i, j);
+      squares += m(i, j) * m(i, j);
+      row_abs += std::fabs(m(i, j));
+    }
+    norm_inf = std::max(norm_inf, row_abs);
+  }
+  for (int j = 0; j < cols; ++j) {
+    double column_abs = 0.0;
+    for (int i = 0; i < rows; ++i) column_abs += std::fabs(m(i, j));
+    norm1 = std::max(norm1, column_abs);
+  }
+  S21MatrixStats stats = m.Statistics();
+  EXPECT_NEAR(stats.sum, sum, 1e-9 * std::fabs(sum));
+  EXPECT_NEAR(stats.frobenius, std::sqrt(squares), 1e-9);
+  EXPECT_NEAR(stats.norm_inf, norm_inf, 1e-9);
+  EXPECT_NEAR(stats.norm1, norm1, 1e-9);
+  EXPECT_DOUBLE_EQ(stats.min, m(0, cols - 1));
+  EXPECT_DOUBLE_EQ(stats.max, m(rows - 1, rows - 1));
+}
+
+// Для степеней, экспоненты и многочленов
+
+TEST(S21MatrixTest, IdentityHasUnitDiagonal) {
+  S21Matrix identity = S21Matrix::Identity(3);
+  EXPECT_DOUBLE_EQ(identity.Trace(), 3.0);
+  EXPECT_DOUBLE_EQ(identity(0, 1), 0.0);
+  EXPECT_TRUE(S21Matrix::Identity(0).EqMatrix(S21Matrix(0, 0)));
+  EXPECT_THROW(S21Matrix::Identity(-1), std::invalid_argument);
+}
+
+TEST(S21MatrixTest, PowMatchesRepeatedMultiplication) {
+  S21Matrix a = FilledMatrix(4, 4, 0.1);
+  a.MulNumber(0.2);
+  S21Matrix expected(4, 4);
+  for (int i = 0; i < 4; ++i) expected(i, i) = 1.0;
+  ExpectMatrixNear(a.Pow(0), expected, 0.0);
+  for (int k = 1; k <= 7; ++k) {
+    expected.MulMatrix(a);
+    ExpectMatrixNear(a.Pow(k), expected, 1e-12);
+  }
+  S21Matrix inverse = a.InverseMatrix();
+  ExpectMatrixNear(a.Pow(-2), inverse * inverse, 1e-9);
+  EXPECT_THROW(S21Matrix(2, 3).Pow(2), std::invalid_argument);
+  EXPECT_THROW(S21Matrix(2, 2).Pow(-1), std::invalid_argument);
+}
+
+TEST(S21MatrixTest, ExpOfKnownMatrices) {
+  S21Matrix nilpotent(2, 2);
+  nilpotent(0, 1) = 1.0;
+  S21Matrix shear(2, 2);
+  shear(0, 0) = shear(0, 1) = shear(1, 1) = 1.0;
+  ExpectMatrixNear(nilpotent.Exp(), shear, 1e-14);
+
+  S21Matrix diagonal(3, 3);
+  diagonal(0, 0) = -1.0;
+  diagonal(1, 1) = 0.5;
+  diagonal(2, 2) = 3.0;
+  S21Matrix expected(3, 3);
+  for (int i = 0; i < 3; ++i) expected(i, i) = std::exp(diagonal(i, i));
+  ExpectMatrixNear(diagonal.Exp(), expected, 1e-12);
+
+  // Большая норма: путь с масштабированием и возведением в квадрат
+  const double t = 10.0;
+  S21Matrix rotation(2, 2);
+  rotation(0, 1) = -t;
+  rotation(1, 0) = t;
+  S21Matrix turned(2, 2);
+  turned(0, 0) = turned(1, 1) = std::cos(t);
+  turned(0, 1) = -std::sin(t);
+  turned(1, 0) = std::sin(t);
+  ExpectMatrixNear(rotation.Exp(), turned, 1e-12);
+
+  EXPECT_THROW(S21Matrix(2, 3).Exp(), std::invalid_argument);
+}
+
+TEST(S21MatrixTest, ExpOfNegationIsInverse) {
+  for (double scale : {0.01, 0.1, 0.3, 0.7, 2.0}) {
+    S21Matrix a = FilledMatrix(4, 4, -0.3);
+    a.MulNumber(scale / a.Norm1());
+    S21Matrix product = a.Exp() * (a * -1.0).Exp();
+    S21Matrix identity(4, 4);
+    for (int i = 0; i < 4; ++i) identity(i, i) = 1.0;
+    ExpectMatrixNear(product, identity, 1e-13);
+  }
+}
+
+TEST(S21MatrixTest, PolynomialMatchesHorner) {
+  S21Matrix a = FilledMatrix(3, 3, 0.2);
+  a.MulNumber(0.3);
+  std::vector<double> c = {1.0, -2.0, 0.5, 3.0, -1.0, 0.25, 2.0, -0.75};
+  S21Matrix expected(3, 3);
+  S21Matrix identity(3, 3);
+  for (int i = 0; i < 3; ++i) identity(i, i) = 1.0;
+  for (int d = static_cast<int>(c.size()) - 1; d >= 0; --d) {
+    expected = expected * a + identity * c[d];
+  }
+  ExpectMatrixNear(a.Polynomial(c), expected, 1e-12);
+  ExpectMatrixNear(a.Polynomial({2.0}), identity * 2.0, 0.0);
+  ExpectMatrixNear(a.Polynomial({}), S21Matrix(3, 3), 0.0);
+  ExpectMatrixNear(a.Polynomial({0.0, 1.0}), a, 0.0);
+}
+
+// Для произведений Кронекера, Адамара и обновлений ранга
+
+TEST(S21MatrixTest, KroneckerProduct) {
+  S21Matrix a(2, 2);
+  a(0, 0) = 1.0;
+  a(0, 1) = 2.0;
+  a(1, 0) = 3.0;
+  a(1, 1) = 4.0;
+  S21Matrix b(1, 2);
+  b(0, 0) = 0.0;
+  b(0, 1) = 5.0;
+  S21Matrix k = a.Kronecker(b);
+  ASSERT_EQ(k.GetRows(), 2);
+  ASSERT_EQ(k.GetCols(), 4);
+  double expected[2][4] = {{0, 5, 0, 10}, {0, 15, 0, 20}};
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 4; ++j) EXPECT_DOUBLE_EQ(k(i, j), expected[i][j]);
+  }
+}
+
+TEST(S21MatrixTest, KroneckerMulMatchesMaterialisedProduct) {
+  S21Matrix a = FilledMatrix(3, 2, 0.5);
+  S21Matrix b = FilledMatrix(4, 5, -1.0);
+  S21Matrix x = FilledMatrix(10, 3, 0.25);
+  ExpectMatrixNear(a.KroneckerMul(b, x), a.Kronecker(b) * x, 1e-12);
+  EXPECT_THROW(a.KroneckerMul(b, S21Matrix(9, 3)), std::invalid_argument);
+  // 50000 * 50000 строк результата не помещаются в int
+  S21Matrix tall(50000, 1);
+  EXPECT_THROW(tall.KroneckerMul(tall, S21Matrix(1, 1)),
+               std::invalid_argument);
+}
+
+TEST(S21MatrixTest, HadamardMulAndDiv) {
+  S21Matrix a = FilledMatrix(3, 4, 1.0);
+  S21Matrix b = FilledMatrix(3, 4, 2.0);
+  S21Matrix product = a;
+  product.HadamardMul(b);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_DOUBLE_EQ(product(i, j), a(i, j) * b(i, j));
+    }
+  }
+  product.HadamardDiv(b);
+  ExpectMatrixNear(product, a, 1e-15);
+  EXPECT_THROW(product.HadamardMul(S21Matrix(4, 3)), std::invalid_argument);
+  EXPECT_THROW(product.HadamardDiv(S21Matrix(4, 3)), std::invalid_argument);
+
+  S21Matrix zero(1, 1), one(1, 1);
+  one(0, 0) = 1.0;
+  one.HadamardDiv(zero);
+  EXPECT_TRUE(std::isinf(one(0, 0)));
+}
+
+TEST(S21MatrixTest, RankUpdates) {
+  S21Matrix c = FilledMatrix(3, 4, 0.0);
+  S21Matrix x = FilledMatrix(3, 2, 1.0);
+  S21Matrix y = FilledMatrix(2, 4, -0.5);
+  S21Matrix expected = c + x * y * 2.0;
+  c.RankUpdate(x, y, 2.0);
+  ExpectMatrixNear(c, expected, 1e-12);
+  EXPECT_THROW(c.RankUpdate(y, x), std::invalid_argument);
+
+  S21Matrix s(3, 3);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) s(i, j) = 1.0 + i + j;
+  }
+  S21Matrix w = FilledMatrix(3, 5, 0.3);
+  S21Matrix symmetric = s * 0.5 + w * w.Transpose() * -1.5;
+  s.SymmetricRankUpdate(w, -1.5, 0.5);
+  ExpectMatrixNear(s, symmetric, 1e-12);
+  EXPECT_THROW(S21Matrix(2, 3).SymmetricRankUpdate(w), std::invalid_argument);
+  EXPECT_THROW(s.SymmetricRankUpdate(y), std::invalid_argument);
+}
+
+TEST(S21MatrixTest, LargeElementwiseKernelsRunInParallel) {
+  const int n = 300;
+  S21Matrix a = FilledMatrix(n, n, 1.0);
+  S21Matrix b = FilledMatrix(n, n, 3.0);
+  S21Matrix c = a;
+  c.HadamardMul(b);
+  EXPECT_DOUBLE_EQ(c(n - 1, 7), a(n - 1, 7) * b(n - 1, 7));
+  S21Matrix x = FilledMatrix(n, 60, 0.1);
+  S21Matrix gram(n, n);
+  gram.SymmetricRankUpdate(x);
+  ExpectMatrixNear(gram, x * x.Transpose(), 1e-9);
+}
+
+// Для импорта и экспорта
+
+TEST(S21MatrixIOTest, ParsesCsvVariants) {
+  std::string text = "a,b,c\r\n1, +2.5 ,-3e2\r\n\n4,5,6\n   \n";
+  S21CsvOptions options;
+  options.skip_header = true;
+  S21Matrix m = S21MatrixIO::ParseCsv(text.data(), text.size(), options);
+  ASSERT_EQ(m.GetRows(), 2);
+  ASSERT_EQ(m.GetCols(), 3);
+  EXPECT_DOUBLE_EQ(m(0, 1), 2.5);
+  EXPECT_DOUBLE_EQ(m(0, 2), -300.0);
+  EXPECT_DOUBLE_EQ(m(1, 2), 6.0);
+
+  std::string tsv = "1\t2\n3\t4";
+  options = S21CsvOptions();
+  options.delimiter = '\t';
+  S21Matrix t = S21MatrixIO::ParseCsv(tsv.data(), tsv.size(), options);
+  EXPECT_DOUBLE_EQ(t(1, 0), 3.0);
+  EXPECT_DOUBLE_EQ(t(1, 1), 4.0);
+
+  std::string empty = "\n\n";
+  EXPECT_EQ(S21MatrixIO::ParseCsv(empty.data(), empty.size()).GetRows(), 0);
+}
+
+TEST(S21MatrixIOTest, RejectsMalformedCsv) {
+  std::string ragged = "1,2\n3\n";
+  EXPECT_THROW(S21MatrixIO::ParseCsv(ragged.data(), ragged.size()),
+               std::invalid_argument);
+  std::string extra = "1,2\n3,4,5\n";
+  EXPECT_THROW(S21MatrixIO::ParseCsv(extra.data(), extra.size()),
+               std::invalid_argument);
+  std::string garbage = "1,x\n";
+  EXPECT_THROW(S21MatrixIO::ParseCsv(garbage.data(), garbage.size()),
+               std::invalid_argument);
+  EXPECT_THROW(S21MatrixIO::ReadCsv("/nonexistent/s21.csv"),
+               std::runtime_error);
+}
+
+TEST(S21MatrixIOTest, CsvRoundTripIsExact) {
+  S21Matrix m = FilledMatrix(3001, 7, 0.1);
+  m(5, 3) = 1.0 / 3.0;
+  m(17, 0) = -1e-300;
+  std::string path = testing::TempDir() + "s21_matrix_io.csv";
+  S21MatrixIO::WriteCsv(m, path);
+  S21Matrix back = S21MatrixIO::ReadCsv(path);
+  EXPECT_TRUE(back.EqMatrix(m));
+  std::remove(path.c_str());
+
+  S21CsvOptions options;
+  options.precision = 3;
+  std::string text = S21MatrixIO::FormatCsv(m, options);
+  EXPECT_EQ(text.substr(0, text.find('\n')),
+            "3e+03,-0.15,-0.4,-0.65,-0.9,-1.15,-1.4");
+}
+
+TEST(S21MatrixIOTest, NpyRoundTrip) {
+  S21Matrix m = FilledMatrix(5, 3, -0.5);
+  std::string path = testing::TempDir() + "s21_matrix_io.npy";
+  S21MatrixIO::WriteNpy(m, path);
+  std::ifstream in(path, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_EQ(bytes.substr(1, 5), "NUMPY");
+  EXPECT_EQ((bytes.size() - 5 * 3 * 8) % 64, 0u);
+  EXPECT_TRUE(S21MatrixIO::ReadNpy(path).EqMatrix(m));
+  std::remove(path.c_str());
+}
+
+TEST(S21MatrixIOTest, ReadsConvertedNpyTypes) {
+  // int32 с обратным порядком байт в Fortran-порядке: [[1, 2, 3], [4, 5, 6]]
+  std::string dict =
+      "{'descr': '>i4', 'fortran_order': True, 'shape': (2, 3), }";
+  dict.append(128 - 10 - dict.size() - 1, ' ');
+  dict.push_back('\n');
+  std::string bytes = std::string("\x93NUMPY\x01\x00", 8);
+  bytes.push_back(static_cast<char>(dict.size()));
+  bytes.push_back('\0');
+  bytes += dict;
+  for (int value : {1, 4, 2, 5, 3, 6}) {
+    bytes += std::string("\0\0\0", 3);
+    bytes.push_back(static_cast<char>(value));
+  }
+  std::string path = testing::TempDir() + "s21_matrix_io_i4.npy";
+  std::ofstream(path, std::ios::binary) << bytes;
+  S21Matrix m = S21MatrixIO::ReadNpy(path);
+  ASSERT_EQ(m.GetRows(), 2);
+  ASSERT_EQ(m.GetCols(), 3);
+  EXPECT_DOUBLE_EQ(m(0, 2), 3.0);
+  EXPECT_DOUBLE_EQ(m(1, 0), 4.0);
+  std::remove(path.c_str());
+}
+
+TEST(S21MatrixIOTest, NpzRoundTrip) {
+  S21Matrix a = FilledMatrix(4, 4, 1.0);
+  S21Matrix b = FilledMatrix(2, 6, -2.0);
+  std::string path = testing::TempDir() + "s21_matrix_io.npz";
+  S21MatrixIO::WriteNpz({{"a", &a}, {"weights", &b}}, path);
+  std::vector<std::pair<std::string, S21Matrix>> arrays =
+      S21MatrixIO::ReadNpz(path);
+  ASSERT_EQ(arrays.size(), 2u);
+  EXPECT_EQ(arrays[0].first, "a");
+  EXPECT_EQ(arrays[1].first, "weights");
+  EXPECT_TRUE(arrays[0].second.EqMatrix(a));
+  EXPECT_TRUE(arrays[1].second.EqMatrix(b));
+  std::remove(path.c_str());
+}
+
+TEST(S21MatrixCowTest, CopySharesUntilWrite) {
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix a = FilledMatrix(4, 5, 1.0);
+  S21Matrix b(a);
+  EXPECT_TRUE(a.IsShared());
+  EXPECT_EQ(a.GetConstMatrixPointer()[0], b.GetConstMatrixPointer()[0]);
+  EXPECT_DOUBLE_EQ(static_cast<const S21Matrix&>(b)(1, 2), a(1, 2));
+
+  b.SetElement(1, 2, 100.0);
+  EXPECT_NE(a.GetConstMatrixPointer()[0], b.GetConstMatrixPointer()[0]);
+  EXPECT_FALSE(a.IsShared());
+  EXPECT_FALSE(b.IsShared());
+  EXPECT_DOUBLE_EQ(b(1, 2), 100.0);
+  EXPECT_TRUE(a.EqMatrix(FilledMatrix(4, 5, 1.0)));
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+TEST(S21MatrixCowTest, MutatorsDetach) {
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix a = FilledMatrix(3, 3, 2.0);
+  const S21Matrix expected = FilledMatrix(3, 3, 2.0);
+
+  S21Matrix sum(a);
+  sum.SumMatrix(a);
+  S21Matrix scaled(a);
+  scaled.MulNumber(3.0);
+  S21Matrix element(a);
+  element(0, 0) = -1.0;
+  S21Matrix hadamard(a);
+  hadamard.HadamardMul(a);
+  S21Matrix raw(a);
+  raw.GetMatrixPointer()[2][2] = 7.0;
+
+  EXPECT_TRUE(a.EqMatrix(expected));
+  EXPECT_DOUBLE_EQ(sum(1, 1), 2.0 * expected(1, 1));
+  EXPECT_DOUBLE_EQ(scaled(2, 0), 3.0 * expected(2, 0));
+  EXPECT_DOUBLE_EQ(element(0, 0), -1.0);
+  EXPECT_DOUBLE_EQ(hadamard(0, 1), expected(0, 1) * expected(0, 1));
+  EXPECT_DOUBLE_EQ(raw(2, 2), 7.0);
+  EXPECT_TRUE((a + a).EqMatrix(sum));
+  EXPECT_TRUE(a.EqMatrix(expected));
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+TEST(S21MatrixCowTest, HandedOutReferencesStopSharing) {
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix a = FilledMatrix(3, 3, 1.0);
+  const S21Matrix expected = FilledMatrix(3, 3, 1.0);
+  double& r = a(0, 0);
+  S21Matrix b(a);
+  EXPECT_FALSE(a.IsShared());
+  r = 5.0;
+  EXPECT_DOUBLE_EQ(b(0, 0), expected(0, 0));
+  EXPECT_DOUBLE_EQ(a(0, 0), 5.0);
+
+  S21Matrix source = FilledMatrix(3, 3, 1.0);
+  double** p = source.GetMatrixPointer();
+  S21Matrix c(source);
+  p[1][1] = 7.0;
+  EXPECT_DOUBLE_EQ(c(1, 1), expected(1, 1));
+  EXPECT_DOUBLE_EQ(source(1, 1), 7.0);
+
+  // Выданная до копирования ссылка на разделённый буфер тоже безопасна
+  S21Matrix shared = FilledMatrix(2, 2, 0.0);
+  S21Matrix copy(shared);
+  double& s = shared(1, 0);
+  S21Matrix late(shared);
+  s = -3.0;
+  EXPECT_DOUBLE_EQ(copy(1, 0), FilledMatrix(2, 2, 0.0)(1, 0));
+  EXPECT_DOUBLE_EQ(late(1, 0), FilledMatrix(2, 2, 0.0)(1, 0));
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+TEST(S21MatrixCowTest, CopyOutlivesOriginal) {
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix copy;
+  {
+    S21Matrix a = FilledMatrix(6, 2, -1.0);
+    copy = S21Matrix(a);
+    S21Matrix second(copy);
+    EXPECT_TRUE(second.IsShared());
+  }
+  EXPECT_FALSE(copy.IsShared());
+  EXPECT_TRUE(copy.EqMatrix(FilledMatrix(6, 2, -1.0)));
+  copy(5, 1) = 4.0;
+  EXPECT_DOUBLE_EQ(copy(5, 1), 4.0);
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+TEST(S21MatrixCowTest, DisabledModeCopiesEagerly) {
+  S21Matrix a = FilledMatrix(2, 2, 0.0);
+  S21Matrix b(a);
+  EXPECT_FALSE(a.IsShared());
+  EXPECT_NE(a.GetConstMatrixPointer()[0], b.GetConstMatrixPointer()[0]);
+  EXPECT_FALSE(S21Matrix::CopyOnWrite());
+}
+
+TEST(S21MatrixCowTest, ConcurrentCopiesDetachIndependently) {
+  S21Matrix::SetCopyOnWrite(true);
+  const S21Matrix source = FilledMatrix(32, 32, 0.5);
+  const S21Matrix expected = FilledMatrix(32, 32, 0.5);
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&source, &expected, &failures, t] {
+      for (int round = 0; round < 50; ++round) {
+        S21Matrix copy(source);
+        if (round % 2 == 0) copy.MulNumber(static_cast<double>(t + 2));
+        if (round % 2 == 0 &&
+            copy(3, 4) != expected(3, 4) * static_cast<double>(t + 2)) {
+          ++failures;
+        }
+        if (round % 2 == 1 && !copy.EqMatrix(expected)) ++failures;
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_TRUE(source.EqMatrix(expected));
+  EXPECT_FALSE(source.IsShared());
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+// Для подбора параметров
+
+TEST(S21TunerTest, BlockSizesDoNotChangeResults) {
+  S21Tuner& tuner = S21Tuner::Instance();
+  S21Matrix a = FilledMatrix(37, 29, 0.5);
+  S21Matrix b = FilledMatrix(29, 41, -1.5);
+  S21Matrix product = a * b;
+  S21Matrix transposed = a.Transpose();
+  S21Matrix system = FilledMatrix(41, 41, 2.0);
+  S21Matrix solution = system.Solve(b.Transpose());
+  const S21TuneParams saved = tuner.Params();
+
+  S21TuneParams params;
+  params.gemm_block_k = 3;
+  params.gemm_block_n = 5;
+  params.transpose_block = 7;
+  params.parallel_flops = 0;
+  params.lu_parallel_size = 1;
+  tuner.SetParams(params);
+  EXPECT_TRUE((a * b).EqMatrix(product));
+  EXPECT_TRUE(a.Transpose().EqMatrix(transposed));
+  EXPECT_TRUE(system.Solve(b.Transpose()).EqMatrix(solution, 1e-12));
+  tuner.SetParams(saved);
+}
+
+TEST(S21TunerTest, RejectsNonPositiveParams) {
+  S21TuneParams params;
+  params.transpose_block = 0;
+  EXPECT_THROW(S21Tuner::Instance().SetParams(params), std::invalid_argument);
+  S21TuneOptions options;
+  options.repeats = 0;
+  EXPECT_THROW(S21Tuner::Instance().Tune(options), std::invalid_argument);
+}
+
+TEST(S21TunerTest, SaveLoadRoundTrip) {
+  S21Tuner& tuner = S21Tuner::Instance();
+  std::string path = testing::TempDir() + "s21_matrix_tune.conf";
+  const S21TuneParams saved = tuner.Params();
+  S21TuneParams params;
+  params.gemm_block_k = 96;
+  params.transpose_block = 16;
+  params.parallel_flops = 12345;
+  tuner.SetParams(params);
+  tuner.Save(path);
+  tuner.SetParams(saved);
+  ASSERT_TRUE(tuner.Load(path));
+  EXPECT_EQ(tuner.Params().gemm_block_k, 96);
+  EXPECT_EQ(tuner.Params().transpose_block, 16);
+  EXPECT_EQ(tuner.Params().parallel_flops, 12345u);
+  tuner.SetParams(saved);
+  std::remove(path.c_str());
+  EXPECT_FALSE(tuner.Load(path));
+}
+
+TEST(S21TunerTest, IgnoresOtherHostsAndRejectsBadFiles) {
+  S21Tuner& tuner = S21Tuner::Instance();
+  std::string path = testing::TempDir() + "s21_matrix_tune_other.conf";
+  const int block_k = tuner.Params().gemm_block_k;
+  std::ofstream(path) << "host = другая машина\ngemm_block_k = 8\n";
+  EXPECT_FALSE(tuner.Load(path));
+  EXPECT_EQ(tuner.Params().gemm_block_k, block_k);
+
+  std::ofstream(path) << "host = " << S21Tuner::HostId()
+                      << "\ngemm_block_k = -8\n";
+  EXPECT_THROW(tuner.Load(path), std::invalid_argument);
+  std::ofstream(path) << "gemm_block_k\n";
+  EXPECT_THROW(tuner.Load(path), std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+TEST(S21TunerTest, TuneAppliesMeasuredCandidates) {
+  S21Tuner& tuner = S21Tuner::Instance();
+  S21TuneOptions options;
+  options.gemm_size = 48;
+  options.transpose_size = 64;
+  options.lu_size = 48;
+  options.repeats = 1;
+  const S21TuneParams saved = tuner.Params();
+  S21TuneParams tuned = tuner.Tune(options);
+  EXPECT_EQ(tuner.Params().gemm_block_k, tuned.gemm_block_k);
+  EXPECT_EQ(tuner.Params().transpose_block, tuned.transpose_block);
+  EXPECT_EQ(tuned.gemm_block_k % 64, 0);
+  EXPECT_EQ(tuned.transpose_block % 8, 0);
+  EXPECT_GT(tuned.parallel_flops, 0u);
+  tuner.SetParams(saved);
+}
+
+TEST(S21TunerTest, TuneRestoresParamsOnFailure) {
+  S21Tuner& tuner = S21Tuner::Instance();
+  const S21TuneParams saved = tuner.Params();
+  S21TuneParams params;
+  params.gemm_block_k = 7;
+  params.gemm_block_n = 11;
+  params.transpose_block = 13;
+  tuner.SetParams(params);
+  // Блоки умножения уже подобраны, матрица для Transpose не выделяется
+  S21TuneOptions options;
+  options.gemm_size = 16;
+  options.transpose_size = 1 << 28;
+  options.repeats = 1;
+  EXPECT_THROW(tuner.Tune(options), std::bad_alloc);
+  EXPECT_EQ(tuner.Params().gemm_block_k, 7);
+  EXPECT_EQ(tuner.Params().gemm_block_n, 11);
+  EXPECT_EQ(tuner.Params().transpose_block, 13);
+  tuner.SetParams(saved);
+}
+
+TEST(S21MatrixFuzzTest, RandomInputsMatchReference) {
+  S21MatrixFuzz fuzz;
+  std::string failure;
+  for (std::uint64_t seed = 0; seed < 300; ++seed) {
+    ASSERT_TRUE(fuzz.RunRandom(seed, &failure))
+        << "seed " << seed << ": " << failure;
+  }
+  // Каждое ядро реально сравнивалось с эталоном и уложилось в допуск
+  for (const char* kernel : {"MulMatrix", "Transpose", "Determinant",
+                             "InverseMatrix", "Pow", "Solve", "SolveRefined"}) {
+    ASSERT_TRUE(fuzz.Stats().count(kernel)) << kernel;
+    EXPECT_GT(fuzz.Stats().at(kernel).cases, 0u) << kernel;
+    EXPECT_LE(fuzz.Stats().at(kernel).worst_ratio, 1.0) << kernel;
+  }
+  EXPECT_NE(fuzz.Report().find("MulMatrix"), std::string::npos);
+}
+
+TEST(S21MatrixFuzzTest, HandlesDegenerateInputs) {
+  S21MatrixFuzz fuzz;
+  std::string failure;
+  const int block_k = S21Tuner::Instance().Params().gemm_block_k;
+  EXPECT_TRUE(fuzz.RunOne(nullptr, 0, &failure)) << failure;
+  // Все флаги: крайние значения, почти вырожденные строки, случайные
+  // параметры блочности
+  std::vector<std::uint8_t> bytes(4096);
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<std::uint8_t>(i * 37 + 7);
+  }
+  bytes[0] = 0xff;
+  EXPECT_TRUE(fuzz.RunOne(bytes.data(), bytes.size(), &failure)) << failure;
+  std::vector<std::uint8_t> ones(512, 0xff);
+  EXPECT_TRUE(fuzz.RunOne(ones.data(), ones.size(), &failure)) << failure;
+  EXPECT_EQ(S21Tuner::Instance().Params().gemm_block_k, block_k);
+}
+
+// Найдено фаззингом: обратная к матрице 1x1 была нулевой
+TEST(S21MatrixFuzzTest, InverseOfSingleElement) {
+  S21Matrix m(1, 1);
+  m(0, 0) = 4.0;
+  EXPECT_DOUBLE_EQ(m.InverseMatrix()(0, 0), 0.25);
+  EXPECT_DOUBLE_EQ(m.CalcComplements()(0, 0), 1.0);
+}
+
+// Найдено фаззингом: переполнение float в поправке принималось за
+// сошедшееся решение
+TEST(S21MatrixFuzzTest, SolveRefinedFallsBackOnFloatOverflow) {
+  S21Matrix a(2, 2), b(2, 1);
+  a(0, 0) = 2.0;
+  a(0, 1) = 1.0;
+  a(1, 0) = 1.0;
+  a(1, 1) = 3.0;
+  b(0, 0) = 1e300;
+  b(1, 0) = -2e300;
+  S21RefineReport report;
+  S21Matrix x = a.SolveRefined(b, &report);
+  EXPECT_TRUE(report.fell_back);
+  EXPECT_NEAR(x(0, 0) / 1e300, 1.0, 1e-12);
+  EXPECT_NEAR(x(1, 0) / 1e300, -1.0, 1e-12);
+}
+
+// Для малоранговых обновлений обратной и LU
+
+namespace {
+
+S21Matrix UpdateTestRow(int n, int step) {
+  S21Matrix row(1, n);
+  for (int j = 0; j < n; ++j) {
+    row(0, j) = std::sin(step * 1.3 + j) + (j == step % n ? n : 0.0);
+  }
+  return row;
+}
+
+}  // namespace
+
+TEST(S21MatrixUpdateTest, WoodburyMatchesFreshInverse) {
+  const int n = 12;
+  S21InverseUpdater updater(RandomMatrix(n, n, 1, n));
+  S21Matrix u(n, 2), v(2, n);
+  for (int i = 0; i < n; ++i) {
+    u(i, 0) = 0.1 * i;
+    u(i, 1) = 1.0 / (i + 1);
+    v(0, i) = std::cos(i);
+    v(1, i) = 0.5 - 0.05 * i;
+  }
+  updater.Update(u, v);
+  S21Matrix expected = RandomMatrix(n, n, 1, n);
+  expected.RankUpdate(u, v);
+  EXPECT_TRUE(updater.Matrix().EqMatrix(expected, 1e-15));
+  EXPECT_TRUE(updater.Inverse().EqMatrix(expected.InverseRefined(), 1e-12));
+  EXPECT_EQ(updater.Stats().updates, 1u);
+  EXPECT_EQ(updater.Stats().refactorizations, 0u);
+  EXPECT_LT(updater.Stats().drift, 1e-14);
+}
+
+TEST(S21MatrixUpdateTest, ReplaceRowsOverManySteps) {
+  const int n = 20;
+  S21InverseUpdater inverse(RandomMatrix(n, n, 1, n));
+  S21LuUpdater lu(RandomMatrix(n, n, 1, n));
+  S21Matrix b(n, 1);
+  for (int i = 0; i < n; ++i) b(i, 0) = i - 7.5;
+  for (int step = 0; step < 60; ++step) {
+    const int row = step * 7 % n;
+    inverse.ReplaceRows({row}, UpdateTestRow(n, step));
+    lu.ReplaceRows({row}, UpdateTestRow(n, step));
+  }
+  S21Matrix expected = inverse.Matrix().Solve(b);
+  EXPECT_TRUE(lu.Matrix().EqMatrix(inverse.Matrix()));
+  EXPECT_TRUE(inverse.Solve(b).EqMatrix(expected, 1e-10));
+  EXPECT_TRUE(lu.Solve(b).EqMatrix(expected, 1e-10));
+  EXPECT_NEAR(lu.Determinant() / S21LuUpdater(lu.Matrix()).Determinant(), 1.0,
+              1e-9);
+  EXPECT_EQ(lu.Stats().updates, 60u);
+  EXPECT_LE(lu.Stats().drift, S21UpdateOptions().drift_tolerance);
+  EXPECT_LE(inverse.Drift(), S21UpdateOptions().drift_tolerance);
+}
+
+TEST(S21MatrixUpdateTest, ReplaceSeveralRowsAtOnce) {
+  const int n = 9;
+  S21LuUpdater lu(RandomMatrix(n, n, 1, n));
+  S21Matrix values(2, n);
+  for (int j = 0; j < n; ++j) {
+    values(0, j) = UpdateTestRow(n, 3)(0, j);
+    values(1, j) = UpdateTestRow(n, 5)(0, j);
+  }
+  lu.ReplaceRows({5, 3}, values);
+  S21Matrix expected = RandomMatrix(n, n, 1, n);
+  for (int j = 0; j < n; ++j) {
+    expected(5, j) = values(0, j);
+    expected(3, j) = values(1, j);
+  }
+  EXPECT_TRUE(lu.Matrix().EqMatrix(expected, 1e-15));
+  EXPECT_TRUE(lu.Inverse().EqMatrix(expected.InverseRefined(), 1e-12));
+}
+
+TEST(S21MatrixUpdateTest, ZeroPivotTriggersRefactorisation) {
+  S21Matrix a(2, 2);
+  a(0, 0) = 1.0;
+  a(0, 1) = 2.0;
+  a(1, 0) = 3.0;
+  a(1, 1) = 4.0;
+  S21LuUpdater lu(a);
+  ASSERT_EQ(lu.Pivots()[0], 1);
+  // Ведущий элемент 3 исходного разложения обнуляется
+  S21Matrix row(1, 2);
+  row(0, 1) = 4.0;
+  lu.ReplaceRows({1}, row);
+  EXPECT_EQ(lu.Stats().refactorizations, 1u);
+  EXPECT_DOUBLE_EQ(lu.Determinant(), 4.0);
+  S21Matrix b(2, 1);
+  b(0, 0) = 5.0;
+  b(1, 0) = 8.0;
+  S21Matrix x = lu.Solve(b);
+  EXPECT_DOUBLE_EQ(x(0, 0), 1.0);
+  EXPECT_DOUBLE_EQ(x(1, 0), 2.0);
+}
+
+TEST(S21MatrixUpdateTest, DriftAndIntervalTriggerRefactorisation) {
+  const int n = 8;
+  S21UpdateOptions options;
+  options.refactor_interval = 2;
+  S21InverseUpdater scheduled(RandomMatrix(n, n, 1, n), options);
+  for (int step = 0; step < 4; ++step) {
+    scheduled.ReplaceRows({step}, UpdateTestRow(n, step));
+  }
+  EXPECT_EQ(scheduled.Stats().refactorizations, 2u);
+
+  // Недостижимый допуск: каждое обновление заканчивается пересчётом
+  options = S21UpdateOptions();
+  options.drift_tolerance = 1e-300;
+  S21LuUpdater strict(RandomMatrix(n, n, 1, n), options);
+  strict.ReplaceRows({2}, UpdateTestRow(n, 2));
+  strict.ReplaceRows({4}, UpdateTestRow(n, 4));
+  EXPECT_EQ(strict.Stats().refactorizations, 2u);
+
+  options.check_interval = 3;
+  options.drift_tolerance = 1e-300;
+  S21LuUpdater sparse(RandomMatrix(n, n, 1, n), options);
+  sparse.ReplaceRows({2}, UpdateTestRow(n, 2));
+  sparse.ReplaceRows({4}, UpdateTestRow(n, 4));
+  EXPECT_EQ(sparse.Stats().refactorizations, 0u);
+  sparse.ReplaceRows({6}, UpdateTestRow(n, 6));
+  EXPECT_EQ(sparse.Stats().refactorizations, 1u);
+  sparse.Refactor();
+  EXPECT_EQ(sparse.Stats().refactorizations, 2u);
+}
+
+TEST(S21MatrixUpdateTest, SingularUpdateKeepsState) {
+  S21Matrix a(3, 3);
+  for (int i = 0; i < 3; ++i) a(i, i) = 2.0;
+  S21InverseUpdater inverse(a);
+  S21LuUpdater lu(a);
+  S21Matrix copy(1, 3);
+  copy(0, 0) = 2.0;
+  EXPECT_THROW(inverse.ReplaceRows({2}, copy), std::invalid_argument);
+  EXPECT_THROW(lu.ReplaceRows({2}, copy), std::invalid_argument);
+  EXPECT_TRUE(inverse.Matrix().EqMatrix(a));
+  EXPECT_TRUE(lu.Matrix().EqMatrix(a));
+  EXPECT_DOUBLE_EQ(inverse.Inverse()(2, 2), 0.5);
+  EXPECT_DOUBLE_EQ(lu.Determinant(), 8.0);
+  EXPECT_EQ(inverse.Stats().updates, 0u);
+}
+
+TEST(S21MatrixUpdateTest, RejectsBadArguments) {
+  S21Matrix singular(2, 2);
+  EXPECT_THROW(S21InverseUpdater{singular}, std::invalid_argument);
+  EXPECT_THROW(S21LuUpdater(S21Matrix(2, 3)), std::invalid_argument);
+  S21UpdateOptions options;
+  options.check_interval = 0;
+  EXPECT_THROW(S21LuUpdater(RandomMatrix(3, 3, 1, 3), options),
+               std::invalid_argument);
+
+  S21LuUpdater lu(RandomMatrix(3, 3, 1, 3));
+  EXPECT_THROW(lu.Update(S21Matrix(3, 1), S21Matrix(2, 3)),
+               std::invalid_argument);
+  EXPECT_THROW(lu.ReplaceRows({1, 1}, S21Matrix(2, 3)), std::out_of_range);
+  EXPECT_THROW(lu.ReplaceRows({3}, S21Matrix(1, 3)), std::out_of_range);
+  EXPECT_THROW(lu.ReplaceRows({0}, S21Matrix(2, 3)), std::invalid_argument);
+  EXPECT_THROW(lu.Solve(S21Matrix(2, 1)), std::invalid_argument);
+
+  std::vector<int> pivots;
+  EXPECT_THROW(singular.LuDecompose(&pivots), std::invalid_argument);
+}
+
+// Для общей матрицы с конкурентным чтением
+
+namespace {
+
+// Версия v общей матрицы — v * I размером 4 x 4
+S21Matrix VersionMatrix(std::uint64_t version) {
+  S21Matrix m(4, 4);
+  for (int i = 0; i < 4; ++i) m(i, i) = static_cast<double>(version);
+  return m;
+}
+
+bool IsVersionMatrix(const S21Matrix& m, std::uint64_t version) {
+  return m.EqMatrix(VersionMatrix(version));
+}
+
+}  // namespace
+
+TEST(S21SharedMatrixTest, SnapshotOutlivesPublish) {
+  S21SharedMatrix shared(VersionMatrix(1));
+  EXPECT_EQ(shared.Version(), 1u);
+  {
+    S21SharedMatrix::Snapshot snapshot = shared.Read();
+    EXPECT_EQ(shared.Publish(VersionMatrix(2)), 2u);
+    EXPECT_EQ(shared.Publish(VersionMatrix(3)), 3u);
+    EXPECT_EQ(snapshot.Version(), 1u);
+    EXPECT_TRUE(IsVersionMatrix(*snapshot, 1));
+    EXPECT_EQ(snapshot->GetRows(), 4);
+    // Версии, заменённые во время чтения, ждут его окончания
+    EXPECT_EQ(shared.PendingReclaim(), 2u);
+
+    S21SharedMatrix::Snapshot nested = shared.Read();
+    EXPECT_TRUE(IsVersionMatrix(*nested, 3));
+    S21SharedMatrix::Snapshot moved = std::move(nested);
+    EXPECT_EQ(moved.Version(), 3u);
+    snapshot = std::move(moved);
+    EXPECT_EQ(snapshot.Version(), 3u);
+  }
+  shared.Reclaim();
+  EXPECT_EQ(shared.PendingReclaim(), 0u);
+  EXPECT_EQ(shared.Version(), 3u);
+}
+
+TEST(S21SharedMatrixTest, ReadersSeeConsistentVersions) {
+  S21SharedMatrix shared(VersionMatrix(1));
+  std::atomic<bool> done{false};
+  std::atomic<int> inconsistent{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&] {
+      std::uint64_t last = 0;
+      while (!done.load()) {
+        S21SharedMatrix::Snapshot snapshot = shared.Read();
+        const std::uint64_t version = snapshot.Version();
+        const double v = static_cast<double>(version);
+        S21Matrix copy = *snapshot;
+        bool ok = version >= last && IsVersionMatrix(copy, version) &&
+                  snapshot->Transpose().EqMatrix(copy) &&
+                  IsVersionMatrix(*snapshot, version) &&
+                  snapshot->Determinant() == v * v * v * v &&
+                  (*snapshot * *snapshot).EqMatrix(copy * v);
+        if (!ok) inconsistent.fetch_add(1);
+        last = version;
+      }
+    });
+  }
+  for (std::uint64_t version = 2; version <= 300; ++version) {
+    if (version % 2 == 0) {
+      shared.Publish(VersionMatrix(version));
+    } else {
+      shared.Update([](S21Matrix& m) {
+        for (int i = 0; i < 4; ++i) m(i, i) += 1.0;
+      });
+    }
+  }
+  done.store(true);
+  for (std::thread& reader : readers) reader.join();
+  EXPECT_EQ(inconsistent.load(), 0);
+  EXPECT_EQ(shared.Version(), 300u);
+  EXPECT_TRUE(IsVersionMatrix(*shared.Read(), 300));
+  shared.Reclaim();
+  EXPECT_EQ(shared.PendingReclaim(), 0u);
+}
+
+TEST(S21SharedMatrixTest, ConcurrentUpdatesAreSerialised) {
+  S21SharedMatrix shared(S21Matrix(2, 2));
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 4; ++w) {
+    writers.emplace_back([&shared] {
+      for (int k = 0; k < 100; ++k) {
+        shared.Update([](S21Matrix& m) { m(0, 0) += 1.0; });
+      }
+    });
+  }
+  for (std::thread& writer : writers) writer.join();
+  EXPECT_DOUBLE_EQ((*shared.Read())(0, 0), 400.0);
+  EXPECT_EQ(shared.Version(), 401u);
+}
+
+// Константные методы одной матрицы из многих потоков, в том числе с
+// копированием при записи
+TEST(S21SharedMatrixTest, ConstMethodsAreThreadSafe) {
+  for (bool copy_on_write : {false, true}) {
+    S21Matrix::SetCopyOnWrite(copy_on_write);
+    S21Matrix source(5, 5);
+    for (int i = 0; i < 5; ++i) {
+      for (int j = 0; j < 5; ++j) source(i, j) = (i * 3 + j) % 4 + (i == j);
+    }
+    const S21Matrix matrix = source;
+    const double determinant = matrix.Determinant();
+    const S21Matrix transposed = matrix.Transpose();
+    const S21Matrix squared = matrix * matrix;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&] {
+        for (int k = 0; k < 200; ++k) {
+          S21Matrix copy = matrix;
+          copy(0, 0) += 1.0;  // Отделяет копию, не трогая оригинал
+          S21Matrix product = matrix;
+          product.MulMatrix(matrix);
+          if (matrix.Determinant() != determinant ||
+              !matrix.Transpose().EqMatrix(transposed) ||
+              !product.EqMatrix(squared) || copy.EqMatrix(matrix)) {
+            mismatches.fetch_add(1);
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_TRUE(matrix.EqMatrix(source));
+  }
+  S21Matrix::SetCopyOnWrite(false);
+}
+
+// Для сжатого хранения
+
+TEST(S21CompressedMatrixTest, Int8RoundTrip) {
+  S21Matrix m = RandomMatrix(100, 70, 2);
+  S21CompressionReport report;
+  S21CompressedMatrix packed(m, S21CompressionOptions(), &report);
+  EXPECT_EQ(packed.Kind(), S21Compression::kInt8);
+  EXPECT_GT(report.ratio, 7.5);
+  EXPECT_EQ(report.compressed_bytes, packed.Bytes());
+  EXPECT_EQ(report.dense_bytes, 100u * 70u * sizeof(double));
+  // Ошибка не больше половины шага квантования самого грубого блока
+  EXPECT_LE(report.max_abs_error, 3.0 / 127 / 2 * (1 + 1e-12));
+  EXPECT_LT(report.relative_error, 1e-2);
+  S21Matrix restored = packed.Decompress();
+  EXPECT_TRUE(restored.EqMatrix(m, report.max_abs_error));
+  EXPECT_DOUBLE_EQ(packed.At(99, 69), restored(99, 69));
+  EXPECT_DOUBLE_EQ(packed.Compare(m).max_abs_error, report.max_abs_error);
+}
+
+TEST(S21CompressedMatrixTest, HalfPrecisionRounding) {
+  S21Matrix m(1, 8);
+  m(0, 0) = 1.0 + std::ldexp(1.0, -11);      // Ровно посередине: к чётному
+  m(0, 1) = 1.0 + 3 * std::ldexp(1.0, -11);  // Посередине: вверх к чётному
+  m(0, 2) = 65504.0;                          // Наибольшее конечное
+  m(0, 3) = 1e6;
+  m(0, 4) = -std::ldexp(1.0, -24);  // Наименьшее денормализованное
+  m(0, 5) = std::ldexp(1.0, -26);
+  m(0, 6) = std::numeric_limits<double>::quiet_NaN();
+  m(0, 7) = -0.1;
+  S21CompressionOptions options;
+  options.kind = S21Compression::kFloat16;
+  S21CompressedMatrix half(m, options);
+  EXPECT_EQ(half.At(0, 0), 1.0);
+  EXPECT_EQ(half.At(0, 1), 1.0 + std::ldexp(1.0, -9));
+  EXPECT_EQ(half.At(0, 2), 65504.0);
+  EXPECT_TRUE(std::isinf(half.At(0, 3)));
+  EXPECT_EQ(half.At(0, 4), -std::ldexp(1.0, -24));
+  EXPECT_EQ(half.At(0, 5), 0.0);
+  EXPECT_TRUE(std::isnan(half.At(0, 6)));
+  EXPECT_NEAR(half.At(0, 7), -0.1, 0.1 * std::ldexp(1.0, -11));
+
+  options.kind = S21Compression::kBFloat16;
+  S21CompressedMatrix bfloat(m, options);
+  EXPECT_EQ(bfloat.At(0, 0), 1.0);
+  EXPECT_NEAR(bfloat.At(0, 3), 1e6, 1e6 * std::ldexp(1.0, -8));
+  EXPECT_TRUE(std::isnan(bfloat.At(0, 6)));
+}
+
+TEST(S21CompressedMatrixTest, SixteenBitKindsHalveMemoryTwice) {
+  S21Matrix m = RandomMatrix(64, 96, 2);
+  S21CompressionOptions options;
+  options.kind = S21Compression::kFloat16;
+  S21CompressionReport report;
+  S21CompressedMatrix half(m, options, &report);
+  EXPECT_GT(report.ratio, 3.9);
+  EXPECT_LT(report.relative_error, std::ldexp(1.0, -11));
+  options.kind = S21Compression::kBFloat16;
+  S21CompressedMatrix bfloat(m, options, &report);
+  EXPECT_GT(report.ratio, 3.9);
+  EXPECT_LT(report.relative_error, std::ldexp(1.0, -8));
+}
+
+TEST(S21CompressedMatrixTest, BlockSparseSkipsZeroTiles) {
+  S21Matrix m(100, 100);
+  for (int i = 0; i < 100; ++i) m(i, i) = i + 1.0;
+  m(5, 90) = -2.5;
+  S21CompressionOptions options;
+  options.kind = S21Compression::kBlockSparse;
+  options.block_size = 10;
+  S21CompressionReport report;
+  S21CompressedMatrix sparse(m, options, &report);
+  EXPECT_EQ(sparse.StoredBlocks(), 11u);
+  EXPECT_EQ(report.max_abs_error, 0.0);
+  EXPECT_GT(report.ratio, 8.0);
+  EXPECT_TRUE(sparse.Decompress().EqMatrix(m));
+  EXPECT_EQ(sparse.At(5, 90), -2.5);
+  EXPECT_EQ(sparse.At(50, 0), 0.0);
+
+  // Блоки с элементами не больше порога опускаются с потерей точности
+  options.zero_tolerance = 1e-3;
+  m(50, 0) = 1e-4;
+  S21CompressedMatrix lossy(m, options, &report);
+  EXPECT_EQ(lossy.StoredBlocks(), 11u);
+  EXPECT_DOUBLE_EQ(report.max_abs_error, 1e-4);
+}
+
+TEST(S21CompressedMatrixTest, MultiplyMatchesDecompressed) {
+  for (S21Compression kind :
+       {S21Compression::kInt8, S21Compression::kFloat16,
+        S21Compression::kBFloat16, S21Compression::kBlockSparse}) {
+    S21CompressionOptions options;
+    options.kind = kind;
+    options.block_size = 24;
+    for (int n : {37, 600}) {
+      S21CompressedMatrix packed(RandomMatrix(n, n - 3, 2), options);
+      S21Matrix b = RandomMatrix(n - 3, 8, 2);
+      S21Matrix expected = packed.Decompress() * b;
+      EXPECT_TRUE(packed.Multiply(b).EqMatrix(expected, 1e-12, 1e-12));
+    }
+  }
+}
+
+TEST(S21CompressedMatrixTest, RejectsBadArguments) {
+  S21Matrix m = RandomMatrix(4, 4, 2);
+  S21CompressionOptions options;
+  options.block_size = 0;
+  EXPECT_THROW(S21CompressedMatrix(m, options), std::invalid_argument);
+  options = S21CompressionOptions();
+  options.zero_tolerance = -1.0;
+  EXPECT_THROW(S21CompressedMatrix(m, options), std::invalid_argument);
+  m(1, 1) = std::numeric_limits<double>::infinity();
+  EXPECT_THROW(S21CompressedMatrix{m}, std::invalid_argument);
+  S21CompressedMatrix packed(RandomMatrix(4, 4, 2));
+  EXPECT_THROW(packed.Multiply(S21Matrix(3, 1)), std::invalid_argument);
+  EXPECT_THROW(packed.Compare(S21Matrix(4, 3)), std::invalid_argument);
+  EXPECT_THROW(packed.At(4, 0), std::out_of_range);
+}
+
+// Для симметричных разложений
+
+namespace {
+
+// Симметричная часть (A + A^T) / 2
+S21Matrix Symmetrized(const S21Matrix& a) {
+  return (a + a.Transpose()) * 0.5;
+}
+
+// Положительно определённая B^T B + I
+S21Matrix SpdTestMatrix(int n) {
+  S21Matrix b = RandomMatrix(n, n, 3);
+  S21Matrix spd = b.Transpose() * b;
+  for (int i = 0; i < n; ++i) spd(i, i) += 1.0;
+  return spd;
+}
+
+S21Matrix Permuted(const S21Matrix& a, const std::vector<int>& perm) {
+  S21Matrix result(a.GetRows(), a.GetCols());
+  for (int i = 0; i < a.GetRows(); ++i) {
+    for (int j = 0; j < a.GetCols(); ++j) result(i, j) = a(perm[i], perm[j]);
+  }
+  return result;
+}
+
+double Norm1(const S21Matrix& a) {
+  double norm = 0.0;
+  for (int j = 0; j < a.GetCols(); ++j) {
+    double sum = 0.0;
+    for (int i = 0; i < a.GetRows(); ++i) sum += std::fabs(a(i, j));
+    norm = std::max(norm, sum);
+  }
+  return norm;
+}
+
+}  // namespace
+
+TEST(S21FactorTest, CholeskyReconstructsPivotedMatrix) {
+  S21Matrix a = SpdTestMatrix(7);
+  S21Cholesky cholesky(a);
+  ASSERT_TRUE(cholesky.IsPositiveDefinite());
+  const S21FactorReport& report = cholesky.Report();
+  EXPECT_EQ(report.rank, 7);
+  S21Matrix l = cholesky.Lower();
+  ExpectMatrixNear(l * l.Transpose(), Permuted(a, cholesky.Permutation()),
+                   1e-12);
+  // Ведущие элементы убывают
+  for (int i = 1; i < 7; ++i) EXPECT_LE(l(i, i), l(i - 1, i - 1));
+
+  S21Matrix b = FilledMatrix(7, 2, 1.0);
+  ExpectMatrixNear(a * cholesky.Solve(b), b, 1e-10);
+  EXPECT_EQ(report.det_sign, 1);
+  EXPECT_NEAR(report.log_abs_det, std::log(a.Determinant()), 1e-10);
+  // Оценка Хейгера не больше нормы обратной и близка к ней
+  const double exact = 1.0 / Norm1(a) / Norm1(a.InverseMatrix());
+  EXPECT_GE(report.rcond, exact * (1 - 1e-10));
+  EXPECT_LE(report.rcond, 3 * exact);
+  ExpectMatrixNear(cholesky.Inverse(), a.InverseMatrix(), 1e-10);
+}
+
+TEST(S21FactorTest, CholeskyDetectsRank) {
+  S21Matrix b(8, 3);
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 3; ++j) b(i, j) = std::sin((i + 1) * (j + 1) * 0.7);
+  }
+  S21Matrix a = b * b.Transpose();
+  S21Cholesky cholesky(a);
+  EXPECT_FALSE(cholesky.IsPositiveDefinite());
+  EXPECT_EQ(cholesky.Report().rank, 3);
+  EXPECT_EQ(cholesky.Report().rcond, 0.0);
+  EXPECT_EQ(cholesky.Report().det_sign, 0);
+  EXPECT_TRUE(std::isinf(cholesky.Report().log_abs_det));
+  EXPECT_THROW(cholesky.Solve(S21Matrix(8, 1)), std::invalid_argument);
+  // Разложение ранга 3 восстанавливает матрицу
+  S21Matrix l = cholesky.Lower();
+  EXPECT_EQ(l.GetCols(), 3);
+  ExpectMatrixNear(l * l.Transpose(), Permuted(a, cholesky.Permutation()),
+                   1e-10);
+
+  // Знаконеопределённая матрица останавливается на отрицательном элементе
+  S21Matrix indefinite(2, 2);
+  indefinite(0, 0) = 1.0;
+  indefinite(1, 1) = -1.0;
+  EXPECT_EQ(S21Cholesky(indefinite).Report().rank, 1);
+  EXPECT_THROW(S21Cholesky(S21Matrix(2, 3)), std::invalid_argument);
+}
+
+TEST(S21FactorTest, BlockedCholeskyAvoidsOverflow) {
+  const int n = 150;  // Больше ширины блока
+  S21Matrix a = SpdTestMatrix(n);
+  S21Cholesky cholesky(a);
+  ASSERT_TRUE(cholesky.IsPositiveDefinite());
+  S21Matrix b = FilledMatrix(n, 1, 0.5);
+  S21Matrix residual = a * cholesky.Solve(b) - b;
+  for (int i = 0; i < n; ++i) EXPECT_NEAR(residual(i, 0), 0.0, 1e-9);
+  EXPECT_NEAR(cholesky.Report().log_abs_det, a.LogDeterminant(), 1e-8);
+
+  // det(1e200 A) = 1e(200 n) det A не представим в double
+  S21Matrix scaled = a * 1e200;
+  S21Cholesky large(scaled);
+  EXPECT_NEAR(large.Report().log_abs_det,
+              cholesky.Report().log_abs_det + n * std::log(1e200), 1e-8);
+  EXPECT_NEAR(large.Report().rcond, cholesky.Report().rcond,
+              1e-6 * cholesky.Report().rcond);
+}
+
+TEST(S21FactorTest, LdltUsesTwoByTwoPivots) {
+  S21Matrix a(3, 3);
+  a(0, 1) = a(1, 0) = 1.0;
+  a(0, 2) = a(2, 0) = 2.0;
+  a(1, 2) = a(2, 1) = 3.0;
+  S21Ldlt ldlt(a);
+  const S21Matrix d = ldlt.Diagonal();
+  EXPECT_NE(d(1, 0) + d(2, 1), 0.0);  // Есть внедиагональный блок
+  S21Matrix l = ldlt.Lower();
+  ExpectMatrixNear(l * d * l.Transpose(), Permuted(a, ldlt.Permutation()),
+                   1e-12);
+  // Собственные значения: одно положительное и два отрицательных
+  EXPECT_EQ(ldlt.Inertia().positive, 1);
+  EXPECT_EQ(ldlt.Inertia().negative, 2);
+  EXPECT_EQ(ldlt.Inertia().zero, 0);
+  EXPECT_EQ(ldlt.Report().det_sign, 1);
+  EXPECT_NEAR(ldlt.Report().log_abs_det, std::log(a.Determinant()), 1e-12);
+  S21Matrix b = FilledMatrix(3, 2, 1.0);
+  ExpectMatrixNear(a * ldlt.Solve(b), b, 1e-12);
+  ExpectMatrixNear(ldlt.Inverse(), a.InverseMatrix(), 1e-12);
+  const double exact = 1.0 / Norm1(a) / Norm1(a.InverseMatrix());
+  EXPECT_GE(ldlt.Report().rcond, exact * (1 - 1e-10));
+  EXPECT_LE(ldlt.Report().rcond, 3 * exact);
+}
+
+TEST(S21FactorTest, LdltMatchesLuOnIndefiniteMatrix) {
+  const int n = 120;
+  S21Matrix a = Symmetrized(RandomMatrix(n, n, 3, 0.1));
+  S21Ldlt ldlt(a);
+  ASSERT_EQ(ldlt.Report().rank, n);
+  EXPECT_GT(ldlt.Inertia().positive, 0);
+  EXPECT_GT(ldlt.Inertia().negative, 0);
+  int sign = 0;
+  EXPECT_NEAR(ldlt.Report().log_abs_det, a.LogDeterminant(&sign), 1e-8);
+  EXPECT_EQ(ldlt.Report().det_sign, sign);
+  S21Matrix b = FilledMatrix(n, 3, 0.5);
+  S21Matrix x = ldlt.Solve(b);
+  ExpectMatrixNear(x, a.Solve(b), 1e-8 * Norm1(x));
+  EXPECT_NEAR(ldlt.Report().rcond, a.ConditionEstimate(),
+              0.5 * a.ConditionEstimate());
+  // Больше ширины панели: отложенные обновления дают то же разложение
+  S21Matrix l = ldlt.Lower();
+  ExpectMatrixNear(l * ldlt.Diagonal() * l.Transpose(),
+                   Permuted(a, ldlt.Permutation()), 1e-10);
+}
+
+TEST(S21FactorTest, EmptyMatrix) {
+  const S21Matrix empty(0, 0);
+  S21Cholesky cholesky(empty);
+  EXPECT_TRUE(cholesky.IsPositiveDefinite());
+  EXPECT_EQ(cholesky.Report().rank, 0);
+  EXPECT_EQ(cholesky.Report().rcond, 1.0);
+  EXPECT_EQ(cholesky.Solve(S21Matrix(0, 2)).GetCols(), 2);
+  S21Ldlt ldlt(empty);
+  EXPECT_EQ(ldlt.Report().rank, 0);
+  EXPECT_EQ(ldlt.Report().det_sign, 1);
+  EXPECT_EQ(ldlt.Report().rcond, 1.0);
+  EXPECT_EQ(ldlt.Inverse().GetRows(), 0);
+  EXPECT_EQ(S21InverseNorm1Estimate(0, [](double*, bool) {}), 0.0);
+}
+
+TEST(S21FactorTest, LdltDetectsSingularMatrix) {
+  // Ранг 1: после первого шага остаток точно нулевой
+  S21Matrix a(3, 3);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) a(i, j) = (i + 1.0) * (j + 1.0);
+  }
+  S21Ldlt ldlt(a);
+  EXPECT_EQ(ldlt.Report().rank, 1);
+  EXPECT_EQ(ldlt.Inertia().positive, 1);
+  EXPECT_EQ(ldlt.Inertia().zero, 2);
+  EXPECT_EQ(ldlt.Report().det_sign, 0);
+  EXPECT_EQ(ldlt.Report().rcond, 0.0);
+  EXPECT_THROW(ldlt.Solve(S21Matrix(3, 1)), std::invalid_argument);
+  S21Matrix l = ldlt.Lower();
+  ExpectMatrixNear(l * ldlt.Diagonal() * l.Transpose(),
+                   Permuted(a, ldlt.Permutation()), 1e-12);
+}
+
+TEST(S21FactorTest, InverseRejectsIllConditionedMatrix) {
+  S21Matrix nearly(2, 2);
+  nearly(0, 0) = nearly(0, 1) = nearly(1, 0) = 1.0;
+  nearly(1, 1) = 1.0 + std::ldexp(1.0, -52);
+  EXPECT_LT(nearly.ConditionEstimate(), 1e-15);
+  EXPECT_THROW(nearly.InverseMatrix(), std::invalid_argument);
+
+  // Плохой масштаб без плохой обусловленности не отклоняется
+  S21Matrix scaled(2, 2);
+  scaled(0, 0) = 1.0;
+  scaled(1, 1) = 1e-300;
+  scaled(1, 0) = 1e-301;
+  EXPECT_LT(scaled.ConditionEstimate(), 1e-299);
+  EXPECT_DOUBLE_EQ(scaled.InverseMatrix()(1, 1), 1e300);
+
+  S21Matrix identity(4, 4);
+  for (int i = 0; i < 4; ++i) identity(i, i) = 1.0;
+  EXPECT_DOUBLE_EQ(identity.ConditionEstimate(), 1.0);
+  EXPECT_THROW(S21Matrix(2, 3).ConditionEstimate(), std::invalid_argument);
+}
+
+TEST(S21FactorTest, LogDeterminantKeepsSignAndRange) {
+  S21Matrix swap(2, 2);
+  swap(0, 1) = swap(1, 0) = 1e200;
+  int sign = 0;
+  EXPECT_NEAR(swap.LogDeterminant(&sign), 2 * std::log(1e200), 1e-12);
+  EXPECT_EQ(sign, -1);
+  S21Matrix singular(2, 2);
+  singular(0, 0) = singular(0, 1) = 1.0;
+  EXPECT_TRUE(std::isinf(singular.LogDeterminant(&sign)));
+  EXPECT_EQ(sign, 0);
+  S21Matrix a = FilledMatrix(5, 5, 1.0);
+  EXPECT_NEAR(a.LogDeterminant(&sign), std::log(std::fabs(a.Determinant())),
+              1e-12);
+  EXPECT_EQ(sign, a.Determinant() > 0 ? 1 : -1);
+}
+
+// Для структурированных матриц и свёрток
+
+namespace {
+
+std::vector<double> ConvTestVector(int n, double phase) {
+  std::vector<double> values(n);
+  for (int i = 0; i < n; ++i) values[i] = std::cos(i * 1.3 + phase) + 0.25;
+  return values;
+}
+
+// Свёртка по определению: full(p, q) = sum image(p - a, q - b) k(a, b)
+S21Matrix NaiveFullConvolution(const S21Matrix& image,
+                               const S21Matrix& kernel) {
+  const int h = image.GetRows(), w = image.GetCols();
+  const int kh = kernel.GetRows(), kw = kernel.GetCols();
+  S21Matrix full(h + kh - 1, w + kw - 1);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      for (int a = 0; a < kh; ++a) {
+        for (int b = 0; b < kw; ++b) {
+          full(y + a, x + b) += image(y, x) * kernel(a, b);
+        }
+      }
+    }
+  }
+  return full;
+}
+
+S21Matrix Crop(const S21Matrix& m, int top, int left, int rows, int cols) {
+  S21Matrix part(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) part(i, j) = m(i + top, j + left);
+  }
+  return part;
+}
+
+}  // namespace
+
+TEST(S21ConvolutionTest, ToeplitzMatchesDense) {
+  // Малый размер идёт напрямую, большой — через БПФ
+  for (int n : {6, 300}) {
+    std::vector<double> column = ConvTestVector(n, 0.0);
+    std::vector<double> row = ConvTestVector(n / 2 + 1, 2.0);
+    row[0] = column[0];
+    S21Toeplitz toeplitz(column, row);
+    EXPECT_EQ(toeplitz.GetRows(), n);
+    EXPECT_EQ(toeplitz.GetCols(), n / 2 + 1);
+    S21Matrix dense = toeplitz.Dense();
+    EXPECT_DOUBLE_EQ(dense(n - 1, 0), column[n - 1]);
+    EXPECT_DOUBLE_EQ(dense(0, n / 2), row[n / 2]);
+    EXPECT_DOUBLE_EQ(toeplitz.At(2, 1), column[1]);
+    S21Matrix b = RandomMatrix(n / 2 + 1, 5, 2);  // Нечётное число столбцов
+    EXPECT_TRUE(toeplitz.Multiply(b).EqMatrix(dense * b, 1e-11, 1e-11));
+  }
+}
+
+TEST(S21ConvolutionTest, CirculantMatchesDense) {
+  for (int n : {5, 257}) {
+    S21Circulant circulant(ConvTestVector(n, 0.5));
+    S21Matrix dense = circulant.Dense();
+    EXPECT_EQ(circulant.GetSize(), n);
+    EXPECT_DOUBLE_EQ(dense(0, 1), dense(1, 2));
+    EXPECT_DOUBLE_EQ(dense(0, 1), dense(n - 1, 0));
+    EXPECT_DOUBLE_EQ(circulant.At(0, n - 1), dense(1, 0));
+    S21Matrix b = RandomMatrix(n, 4, 2);
+    EXPECT_TRUE(circulant.Multiply(b).EqMatrix(dense * b, 1e-11, 1e-11));
+  }
+}
+
+TEST(S21ConvolutionTest, ToeplitzConvolvesSignal) {
+  std::vector<double> kernel = {1.0, -2.0, 0.5};
+  S21Toeplitz conv = S21Toeplitz::Convolution(kernel, 4);
+  S21Matrix signal(4, 1);
+  for (int i = 0; i < 4; ++i) signal(i, 0) = i + 1.0;
+  S21Matrix result = conv.Multiply(signal);
+  ASSERT_EQ(result.GetRows(), 6);
+  const double expected[] = {1.0, 0.0, -0.5, -1.0, -6.5, 2.0};
+  for (int i = 0; i < 6; ++i) EXPECT_NEAR(result(i, 0), expected[i], 1e-15);
+}
+
+TEST(S21ConvolutionTest, Convolve2DMethodsAgree) {
+  S21Matrix image = RandomMatrix(23, 17, 2);
+  S21Matrix kernel = FilledMatrix(4, 5, -1.0);
+  S21Matrix full = NaiveFullConvolution(image, kernel);
+  for (S21ConvolutionMethod method :
+       {S21ConvolutionMethod::kIm2col, S21ConvolutionMethod::kFft,
+        S21ConvolutionMethod::kAuto}) {
+    S21ConvolutionOptions options;
+    options.method = method;
+    EXPECT_TRUE(S21Convolve2D(image, kernel, options)
+                    .EqMatrix(full, 1e-10, 1e-10));
+    options.mode = S21ConvolutionMode::kSame;
+    EXPECT_TRUE(S21Convolve2D(image, kernel, options)
+                    .EqMatrix(Crop(full, 1, 2, 23, 17), 1e-10, 1e-10));
+    options.mode = S21ConvolutionMode::kValid;
+    EXPECT_TRUE(S21Convolve2D(image, kernel, options)
+                    .EqMatrix(Crop(full, 3, 4, 20, 13), 1e-10, 1e-10));
+  }
+}
+
+TEST(S21ConvolutionTest, Convolve2DCorrelatesAndScales) {
+  S21Matrix image = RandomMatrix(40, 40, 2);
+  S21Matrix kernel(2, 2);
+  kernel(0, 0) = 1e-12;  // Масштаб ядра далёк от масштаба изображения
+  kernel(1, 1) = -2e-12;
+  S21ConvolutionOptions options;
+  options.correlate = true;
+  options.mode = S21ConvolutionMode::kValid;
+  for (S21ConvolutionMethod method :
+       {S21ConvolutionMethod::kIm2col, S21ConvolutionMethod::kFft}) {
+    options.method = method;
+    S21Matrix result = S21Convolve2D(image, kernel, options);
+    ASSERT_EQ(result.GetRows(), 39);
+    for (int i = 0; i < 39; ++i) {
+      for (int j = 0; j < 39; ++j) {
+        const double expected =
+            1e-12 * image(i, j) - 2e-12 * image(i + 1, j + 1);
+        EXPECT_NEAR(result(i, j), expected, 1e-22);
+      }
+    }
+  }
+  // Большое ядро выбирает БПФ и совпадает с развёрткой
+  S21Matrix big = RandomMatrix(31, 29, 2);
+  options = S21ConvolutionOptions();
+  S21Matrix automatic = S21Convolve2D(image, big, options);
+  options.method = S21ConvolutionMethod::kIm2col;
+  EXPECT_TRUE(automatic.EqMatrix(S21Convolve2D(image, big, options), 1e-9,
+                                 1e-9));
+}
+
+TEST(S21ConvolutionTest, RejectsBadArguments) {
+  EXPECT_THROW(S21Toeplitz({1.0}, {2.0}), std::invalid_argument);
+  EXPECT_THROW(S21Toeplitz({}, {1.0}), std::invalid_argument);
+  EXPECT_THROW(S21Circulant({}), std::invalid_argument);
+  S21Toeplitz toeplitz({1.0, 2.0}, {1.0, 3.0, 4.0});
+  EXPECT_THROW(toeplitz.Multiply(S21Matrix(2, 1)), std::invalid_argument);
+  EXPECT_THROW(toeplitz.At(2, 0), std::out_of_range);
+  S21ConvolutionOptions options;
+  options.mode = S21ConvolutionMode::kValid;
+  EXPECT_THROW(S21Convolve2D(S21Matrix(2, 2), S21Matrix(3, 1), options),
+               std::invalid_argument);
+  EXPECT_THROW(S21Convolve2D(S21Matrix(), S21Matrix(1, 1)),
+               std::invalid_argument);
+}
+
+TEST(S21IntoTest, MatchesAllocatingVersions) {
+  S21Matrix a = FilledMatrix(5, 5, 1.5), b = FilledMatrix(5, 5, -0.75);
+  S21Matrix rect = FilledMatrix(3, 5, 2.0);
+  S21Matrix out;
+  rect.TransposeInto(&out);
+  EXPECT_TRUE(out == rect.Transpose());
+  a.MinorInto(1, 3, &out);
+  EXPECT_TRUE(out == a.Minor(1, 3));
+  a.CalcComplementsInto(&out);
+  EXPECT_TRUE(out == a.CalcComplements());
+  a.InverseInto(&out);
+  EXPECT_TRUE(out == a.InverseMatrix());
+  S21Matrix::SumInto(a, b, &out);
+  EXPECT_TRUE(out == a + b);
+  S21Matrix::SubInto(a, b, &out);
+  EXPECT_TRUE(out == a - b);
+  S21Matrix::MulNumberInto(a, -3.0, &out);
+  EXPECT_TRUE(out == a * -3.0);
+  S21Matrix::MulInto(rect, a, &out);
+  EXPECT_TRUE(out == rect * a);
+}
+
+TEST(S21IntoTest, ReusesOutputBuffer) {
+  S21Matrix a = FilledMatrix(6, 6, 0.5), b = FilledMatrix(6, 6, 1.25);
+  S21Matrix out(6, 6);
+  const double* buffer = out.GetConstMatrixPointer()[0];
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    a.TransposeInto(&out);
+    a.InverseInto(&out);
+    a.CalcComplementsInto(&out);
+    S21Matrix::SumInto(a, b, &out);
+    S21Matrix::MulInto(a, b, &out);
+    S21Matrix::MulNumberInto(b, 2.0, &out);
+    EXPECT_EQ(out.GetConstMatrixPointer()[0], buffer);
+  }
+  // Меньший результат помещается в прежний буфер
+  a.MinorInto(0, 0, &out);
+  EXPECT_EQ(out.GetConstMatrixPointer()[0], buffer);
+  EXPECT_TRUE(out == a.Minor(0, 0));
+  // Общий буфер копии отделяется, а не портится
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix target(6, 6);
+  S21Matrix shared(target);
+  a.TransposeInto(&target);
+  S21Matrix::SetCopyOnWrite(false);
+  EXPECT_TRUE(target == a.Transpose());
+  EXPECT_TRUE(shared == S21Matrix(6, 6));
+}
+
+TEST(S21IntoTest, HandlesAliasing) {
+  S21Matrix a = FilledMatrix(4, 4, 0.5), rect = FilledMatrix(2, 4, 1.0);
+  S21Matrix expected = a.Transpose();
+  a.TransposeInto(&a);
+  EXPECT_TRUE(a == expected);
+  expected = rect.Transpose();
+  rect.TransposeInto(&rect);
+  EXPECT_TRUE(rect == expected);
+  expected = a.InverseMatrix();
+  a.InverseInto(&a);
+  EXPECT_TRUE(a == expected);
+  S21Matrix b = FilledMatrix(4, 4, 2.0);
+  expected = b * b;
+  S21Matrix::MulInto(b, b, &b);
+  EXPECT_TRUE(b == expected);
+  expected = b + b;
+  S21Matrix::SumInto(b, b, &b);
+  EXPECT_TRUE(b == expected);
+  expected = b.Minor(3, 0);
+  b.MinorInto(3, 0, &b);
+  EXPECT_TRUE(b == expected);
+}
+
+TEST(S21IntoTest, MulIntoScalesAndAccumulates) {
+  S21Matrix a = FilledMatrix(4, 3, 0.5), b = FilledMatrix(3, 5, -1.0);
+  S21Matrix c = FilledMatrix(4, 5, 2.0);
+  S21Matrix expected = a * b * 2.0 + c * -0.5;
+  S21Matrix::MulInto(a, b, &c, 2.0, -0.5);
+  ExpectMatrixNear(c, expected, 1e-12);
+  // При beta == 0 содержимое c не читается
+  c(0, 0) = std::numeric_limits<double>::quiet_NaN();
+  S21Matrix::MulInto(a, b, &c, 1.0, 0.0);
+  EXPECT_TRUE(c == a * b);
+  S21Matrix wrong(2, 2);
+  EXPECT_THROW(S21Matrix::MulInto(a, b, &wrong, 1.0, 1.0),
+               std::invalid_argument);
+  EXPECT_THROW(S21Matrix::MulInto(a, a, &c), std::invalid_argument);
+  EXPECT_THROW(S21Matrix::SumInto(a, b, &c), std::invalid_argument);
+  EXPECT_THROW(a.MinorInto(4, 0, &c), std::out_of_range);
+}
+
+TEST(S21ResizeTest, ResizeKeepsTopLeftBlock) {
+  S21Matrix a = FilledMatrix(4, 5, 1.0);
+  S21Matrix original(a);
+  // Сужение и расширение на месте, в пределах выделенной памяти
+  a.Resize(3, 3);
+  const double* buffer = a.GetConstMatrixPointer()[0];
+  a.Resize(4, 5);
+  EXPECT_EQ(a.GetConstMatrixPointer()[0], buffer);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      EXPECT_EQ(a(i, j), i < 3 && j < 3 ? original(i, j) : 0.0);
+    }
+  }
+  // Рост за пределы ёмкости выделяет новый буфер
+  a.Resize(6, 7);
+  EXPECT_EQ(a.GetRows(), 6);
+  EXPECT_EQ(a.GetCols(), 7);
+  EXPECT_EQ(a(1, 2), original(1, 2));
+  EXPECT_EQ(a(5, 6), 0.0);
+  S21Matrix empty;
+  empty.Resize(2, 3);
+  EXPECT_TRUE(empty == S21Matrix(2, 3));
+  EXPECT_THROW(a.Resize(-1, 2), std::invalid_argument);
+}
+
+TEST(S21ResizeTest, ReshapeDoesNotCopy) {
+  S21Matrix a = FilledMatrix(2, 6, 0.5);
+  S21Matrix original(a);
+  const double* buffer = a.GetConstMatrixPointer()[0];
+  a.Reshape(4, 3);
+  EXPECT_EQ(a.GetConstMatrixPointer()[0], buffer);
+  for (int k = 0; k < 12; ++k) {
+    EXPECT_EQ(a(k / 3, k % 3), original(k / 6, k % 6));
+  }
+  // Копия с общим буфером меняет форму без отделения
+  S21Matrix::SetCopyOnWrite(true);
+  S21Matrix shared = FilledMatrix(3, 4, 2.0);
+  S21Matrix copy(shared);
+  copy.Reshape(12, 1);
+  S21Matrix::SetCopyOnWrite(false);
+  EXPECT_TRUE(copy.IsShared());
+  EXPECT_EQ(copy(5, 0), shared(1, 1));
+  EXPECT_THROW(a.Reshape(5, 3), std::invalid_argument);
+}
+
+TEST(S21ResizeTest, AppendGrowsGeometrically) {
+  S21Matrix stream;
+  int reallocations = 0;
+  const double* buffer = nullptr;
+  for (int i = 0; i < 1000; ++i) {
+    stream.AppendRow({1.0 * i, -1.0 * i, 0.5});
+    if (stream.GetConstMatrixPointer()[0] != buffer) {
+      buffer = stream.GetConstMatrixPointer()[0];
+      ++reallocations;
+    }
+  }
+  EXPECT_LE(reallocations, 11);
+  EXPECT_GE(stream.GetRowCapacity(), 1000);
+  EXPECT_EQ(stream.GetRows(), 1000);
+  EXPECT_EQ(stream.GetCols(), 3);
+  EXPECT_EQ(stream(999, 1), -999.0);
+  EXPECT_EQ(stream(0, 2), 0.5);
+  EXPECT_THROW(stream.AppendRow({1.0}), std::invalid_argument);
+  // Reserve выделяет место заранее
+  S21Matrix reserved(0, 2);
+  reserved.Reserve(64);
+  S21Matrix block = FilledMatrix(8, 2, 1.0);
+  reserved.AppendRows(block);
+  buffer = reserved.GetConstMatrixPointer()[0];
+  for (int i = 1; i < 8; ++i) reserved.AppendRows(block);
+  EXPECT_EQ(reserved.GetConstMatrixPointer()[0], buffer);
+  EXPECT_EQ(reserved(63, 1), block(7, 1));
+  reserved.AppendRows(reserved);
+  EXPECT_EQ(reserved.GetRows(), 128);
+  EXPECT_EQ(reserved(127, 0), block(7, 0));
+}
+
+TEST(S21ResizeTest, StacksMatrices) {
+  S21Matrix a = FilledMatrix(2, 3, 1.0), b = FilledMatrix(4, 3, -2.0);
+  S21Matrix v = S21Matrix::VStack(a, b);
+  ASSERT_EQ(v.GetRows(), 6);
+  EXPECT_EQ(v(1, 2), a(1, 2));
+  EXPECT_EQ(v(5, 0), b(3, 0));
+  S21Matrix c = FilledMatrix(2, 4, 3.0);
+  S21Matrix h = S21Matrix::HStack(a, c);
+  ASSERT_EQ(h.GetCols(), 7);
+  EXPECT_EQ(h(1, 2), a(1, 2));
+  EXPECT_EQ(h(1, 6), c(1, 3));
+  // Добавление к самой себе использует запас ёмкости
+  S21Matrix grown(a);
+  grown.Reserve(6);
+  const double* buffer = grown.GetConstMatrixPointer()[0];
+  S21Matrix::VStackInto(grown, b, &grown);
+  EXPECT_EQ(grown.GetConstMatrixPointer()[0], buffer);
+  EXPECT_TRUE(grown == v);
+  S21Matrix::HStackInto(c, a, &a);
+  EXPECT_EQ(a(0, 0), c(0, 0));
+  EXPECT_THROW(S21Matrix::VStack(a, b), std::invalid_argument);
+  EXPECT_THROW(S21Matrix::HStack(a, b), std::invalid_argument);
+}
+
+namespace {
+
+// Ориентированный граф: примерно density рёбер с весами 1..9, иначе fill
+S21Matrix RandomGraph(int rows, int cols, double density, double fill,
+                      std::uint64_t seed) {
+  S21Matrix graph = RandomMatrix(rows, cols, seed);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      const double uniform = (graph(i, j) + 1.0) / 2;
+      graph(i, j) =
+          uniform < density ? 1 + static_cast<int>(uniform / density * 9)
+                            : fill;
+    }
+  }
+  return graph;
+}
+
+// Тройной цикл без блоков и пропусков
+template <typename Semiring>
+S21Matrix NaiveSemiringMultiply(const S21Matrix& a, const S21Matrix& b) {
+  S21Matrix c(a.GetRows(), b.GetCols());
+  for (int i = 0; i < a.GetRows(); ++i) {
+    for (int j = 0; j < b.GetCols(); ++j) {
+      double sum = Semiring::Zero();
+      for (int k = 0; k < a.GetCols(); ++k) {
+        sum = Semiring::Add(sum, Semiring::Mul(a(i, k), b(k, j)));
+      }
+      c(i, j) = sum;
+    }
+  }
+  return c;
+}
+
+// Узкое место пути: (max, min)
+struct BottleneckSemiring {
+  static double Zero() { return 0.0; }
+  static double One() { return std::numeric_limits<double>::infinity(); }
+  static double Add(double a, double b) { return std::max(a, b); }
+  static double Mul(double a, double b) { return std::min(a, b); }
+};
+
+}  // namespace
+
+TEST(S21SemiringTest, MatchesNaiveMultiply) {
+  const double inf = std::numeric_limits<double>::infinity();
+  S21Matrix a = RandomGraph(37, 53, 0.3, inf, 1);
+  S21Matrix b = RandomGraph(53, 29, 0.3, inf, 2);
+  EXPECT_TRUE(S21SemiringMultiply<S21MinPlus>(a, b) ==
+              NaiveSemiringMultiply<S21MinPlus>(a, b));
+  S21Matrix c = RandomGraph(37, 53, 0.3, -inf, 3);
+  S21Matrix d = RandomGraph(53, 29, 0.3, -inf, 4);
+  EXPECT_TRUE(S21SemiringMultiply<S21MaxPlus>(c, d) ==
+              NaiveSemiringMultiply<S21MaxPlus>(c, d));
+  S21Matrix e = RandomGraph(37, 53, 0.5, 0.0, 5);
+  S21Matrix f = RandomGraph(53, 29, 0.5, 0.0, 6);
+  EXPECT_TRUE(S21SemiringMultiply<BottleneckSemiring>(e, f) ==
+              NaiveSemiringMultiply<BottleneckSemiring>(e, f));
+  EXPECT_TRUE(S21SemiringMultiply<S21PlusTimes>(e, f) == e * f);
+  EXPECT_THROW(S21SemiringMultiply<S21MinPlus>(a, a), std::invalid_argument);
+}
+
+TEST(S21SemiringTest, PlusTimesKeepsZeroTimesNonFinite) {
+  const double inf = std::numeric_limits<double>::infinity();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  S21Matrix a(2, 2), b(2, 2);
+  a(0, 1) = 1.0;
+  a(1, 1) = 2.0;
+  b(0, 0) = inf;
+  b(0, 1) = nan;
+  b(1, 0) = 3.0;
+  b(1, 1) = 4.0;
+  // a(i, 0) == 0, поэтому 0 * inf и 0 * NaN дают NaN, как в MulMatrix
+  S21Matrix product = S21SemiringMultiply<S21PlusTimes>(a, b);
+  S21Matrix expected = a * b;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_TRUE(std::isnan(product(i, j)));
+      EXPECT_TRUE(std::isnan(expected(i, j)));
+    }
+  }
+  // В min-plus +inf поглощает: строка без рёбер остаётся +inf
+  S21Matrix none(1, 2);
+  none(0, 0) = none(0, 1) = inf;
+  S21Matrix paths = S21SemiringMultiply<S21MinPlus>(none, b);
+  EXPECT_EQ(paths(0, 0), inf);
+  EXPECT_EQ(paths(0, 1), inf);
+  static_assert(!S21ZeroAbsorbs<BottleneckSemiring>::value,
+                "без kZeroAbsorbs слагаемые не пропускаются");
+}
+
+TEST(S21SemiringTest, ResultIndependentOfBlockingAndThreads) {
+  const double inf = std::numeric_limits<double>::infinity();
+  S21Matrix a = RandomGraph(45, 70, 0.2, inf, 7);
+  S21Matrix b = RandomGraph(70, 33, 0.2, inf, 8);
+  S21Matrix expected = S21SemiringMultiply<S21MinPlus>(a, b);
+  S21BitMatrix x = S21BitMatrix::FromMatrix(RandomGraph(45, 200, 0.05, 0, 9));
+  S21BitMatrix y = S21BitMatrix::FromMatrix(RandomGraph(200, 130, 0.05, 0, 10));
+  S21BitMatrix bits = x.Multiply(y);
+  S21Tuner& tuner = S21Tuner::Instance();
+  const S21TuneParams saved = tuner.Params();
+  S21TuneParams params;
+  params.gemm_block_k = 3;
+  params.gemm_block_n = 2;
+  params.parallel_flops = 0;
+  tuner.SetParams(params);
+  EXPECT_TRUE(S21SemiringMultiply<S21MinPlus>(a, b) == expected);
+  EXPECT_TRUE(x.Multiply(y) == bits);
+  tuner.SetParams(saved);
+}
+
+TEST(S21SemiringTest, ShortestPathsMatchFloydWarshall) {
+  const double inf = std::numeric_limits<double>::infinity();
+  const int n = 60;
+  S21Matrix weights = RandomGraph(n, n, 0.05, inf, 11);
+  S21Matrix expected(weights);
+  for (int i = 0; i < n; ++i) expected(i, i) = std::min(expected(i, i), 0.0);
+  for (int k = 0; k < n; ++k) {
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        expected(i, j) =
+            std::min(expected(i, j), expected(i, k) + expected(k, j));
+      }
+    }
+  }
+  EXPECT_TRUE(S21ShortestPaths(weights) == expected);
+  // Цикл 0 -> 1 -> 2 -> 3 -> 0 суммарного веса -1
+  S21Matrix cycle(4, 4);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) cycle(i, j) = inf;
+    cycle(i, (i + 1) % 4) = i == 3 ? -4.0 : 1.0;
+  }
+  EXPECT_THROW(S21ShortestPaths(cycle), std::invalid_argument);
+  EXPECT_THROW(S21ShortestPaths(S21Matrix(2, 3)), std::invalid_argument);
+}
+
+TEST(S21SemiringTest, BitMatrixMatchesOrAnd) {
+  S21Matrix a = RandomGraph(70, 130, 0.1, 0.0, 12);
+  S21Matrix b = RandomGraph(130, 90, 0.1, 0.0, 13);
+  S21BitMatrix product =
+      S21BitMatrix::FromMatrix(a).Multiply(S21BitMatrix::FromMatrix(b));
+  EXPECT_TRUE(product.ToMatrix() == NaiveSemiringMultiply<S21OrAnd>(a, b));
+  EXPECT_TRUE(product.ToMatrix() == S21SemiringMultiply<S21OrAnd>(a, b));
+  S21BitMatrix bits(3, 70);
+  bits.Set(2, 69, true);
+  bits.Set(0, 0, true);
+  bits.Set(0, 0, false);
+  EXPECT_TRUE(bits.Get(2, 69));
+  EXPECT_FALSE(bits.Get(0, 0));
+  EXPECT_EQ(bits.Count(), 1);
+  EXPECT_THROW(bits.Get(3, 0), std::out_of_range);
+  EXPECT_THROW(bits.Multiply(bits), std::invalid_argument);
+  EXPECT_THROW(S21BitMatrix(-1, 2), std::invalid_argument);
+}
+
+TEST(S21SemiringTest, ClosureMatchesWarshall) {
+  const int n = 100;
+  S21BitMatrix graph = S21BitMatrix::FromMatrix(RandomGraph(n, n, 0.01, 0, 14));
+  S21BitMatrix expected(graph);
+  for (int i = 0; i < n; ++i) expected.Set(i, i, true);
+  for (int k = 0; k < n; ++k) {
+    for (int i = 0; i < n; ++i) {
+      if (!expected.Get(i, k)) continue;
+      for (int j = 0; j < n; ++j) {
+        if (expected.Get(k, j)) expected.Set(i, j, true);
+      }
+    }
+  }
+  EXPECT_TRUE(graph.Closure() == expected);
+  EXPECT_TRUE(S21BitMatrix::Identity(5).Closure() == S21BitMatrix::Identity(5));
+  EXPECT_THROW(S21BitMatrix(2, 3).Closure(), std::invalid_argument);
+}
+
+// Для NUMA-размещения
+
+TEST(S21MatrixMemoryTest, PolicyRoundTrip) {
+  S21MatrixMemory& memory = S21MatrixMemory::Instance();
+  memory.SetNumaPolicy(S21NumaPolicy::kInterleave);
+  EXPECT_EQ(memory.GetNumaPolicy(), S21NumaPolicy::kInterleave);
+  EXPECT_THROW(memory.SetNumaPolicy(S21NumaPolicy::kBind, -1),
+               std::invalid_argument);
+  EXPECT_THROW(memory.SetNumaPolicy(S21NumaPolicy::kBind,
+                                    S21MatrixMemory::NodeCount()),
+               std::invalid_argument);
+  EXPECT_EQ(memory.GetNumaPolicy(), S21NumaPolicy::kInterleave);
+  memory.SetNumaPolicy(S21NumaPolicy::kDefault);
+
+  // Чужой большой буфер не подменяет выданный
+  const std::size_t count = memory.LargeThreshold() / sizeof(double);
+  std::vector<double> foreign(count);
+  EXPECT_FALSE(memory.TryFree(foreign.data(), count));
+  EXPECT_DEATH(memory.Free(foreign.data(), count), "S21MatrixMemory::Free");
+  bool first_touch = false;
+  double* own = memory.Allocate(count, &first_touch);
+  EXPECT_TRUE(memory.TryFree(own, count));
+  EXPECT_FALSE(memory.TryFree(own, count));
+  EXPECT_GE(S21MatrixMemory::NodeCount(), 1);
+  EXPECT_EQ(S21MatrixMemory::NodeOfCpu(-1), 0);
+}
+
+TEST(S21MatrixMemoryTest, LargeMatricesUnderEveryPolicy) {
+  S21MatrixMemory& memory = S21MatrixMemory::Instance();
+  const int n = 200;  // 320 КиБ, выше порога mmap
+  ASSERT_GE(sizeof(double) * n * n, memory.LargeThreshold());
+  S21Matrix a = FilledMatrix(n, n, 0.5);
+  S21Matrix b = FilledMatrix(n, n, -1.0);
+  S21Matrix expected(n, n);
+  for (int i = 0; i < n; ++i) {
+    for (int k = 0; k < n; ++k) {
+      for (int j = 0; j < n; ++j) expected(i, j) += a(i, k) * b(k, j);
+    }
+  }
+
+  for (S21NumaPolicy policy :
+       {S21NumaPolicy::kDefault, S21NumaPolicy::kInterleave,
+        S21NumaPolicy::kFirstTouch, S21NumaPolicy::kBind}) {
+    memory.SetNumaPolicy(policy);
+    S21Matrix zeros(n, n);
+    EXPECT_EQ(zeros(n - 1, n - 1), 0.0);
+    EXPECT_EQ(zeros(n / 2, 0), 0.0);
+    S21Matrix product = a;
+    product.MulMatrix(b);
+    ExpectMatrixNear(product, expected, 1e-9);
+  }
+  memory.SetNumaPolicy(S21NumaPolicy::kDefault);
+}
+
+TEST(S21MatrixMemoryTest, RecyclesSameShapeTemporaries) {
+  S21MatrixMemory& memory = S21MatrixMemory::Instance();
+  memory.TrimCache();
+  const int n = 256;
+  S21MemoryStats before = memory.Stats();
+  {
+    S21Matrix temporary(n, n);
+    temporary(n - 1, n - 1) = 7.0;
+  }
+  EXPECT_GT(memory.Stats().cached_bytes, 0u);
+  S21Matrix reused(n, n);
+  S21MemoryStats after = memory.Stats();
+  EXPECT_EQ(after.reuses, before.reuses + 1);
+  EXPECT_EQ(after.maps, before.maps + 1);
+  EXPECT_EQ(reused(n - 1, n - 1), 0.0);
+
+  // Буфер другой формы из списка не берётся
+  S21Matrix other(n + 64, n);
+  EXPECT_EQ(memory.Stats().reuses, after.reuses);
+}
+
+TEST(S21MatrixMemoryTest, CacheLimitZeroUnmapsImmediately) {
+  S21MatrixMemory& memory = S21MatrixMemory::Instance();
+  std::size_t limit = memory.CacheLimit();
+  memory.SetCacheLimit(0);
+  EXPECT_EQ(memory.Stats().cached_bytes, 0u);
+  std::uint64_t unmaps = memory.Stats().unmaps;
+  { S21Matrix temporary(256, 256); }
+  EXPECT_EQ(memory.Stats().unmaps, unmaps + 1);
+  EXPECT_EQ(memory.Stats().cached_bytes, 0u);
+  memory.SetCacheLimit(limit);
+}
+
+TEST(S21MatrixMemoryTest, HugePageModesFallBackGracefully) {
+  S21MatrixMemory& memory = S21MatrixMemory::Instance();
+  const int n = 300;
+  S21Matrix a = FilledMatrix(n, n, 1.0);
+  for (S21HugePages mode :
+       {S21HugePages::kTransparent, S21HugePages::kExplicit}) {
+    memory.SetHugePages(mode);
+    EXPECT_EQ(memory.GetHugePages(), mode);
+    S21Matrix copy = a;
+    EXPECT_TRUE(copy.EqMatrix(a));
+    S21Matrix transposed = copy.Transpose().Transpose();
+    EXPECT_TRUE(transposed.EqMatrix(a));
+  }
+  memory.SetHugePages(S21HugePages::kOff);
+  memory.TrimCache();
+  EXPECT_EQ(memory.Stats().cached_bytes, 0u);
+}
+
+TEST(S21ThreadPoolTest, ParallelRowsCoversEveryRowOnce) {
+  S21ThreadPool pool(3);
+  std::vector<int> hits(10, 0);
+  pool.ParallelRows(10, sizeof(int), [&hits](int begin, int end) {
+    for (int i = begin; i < end; ++i) ++hits[i];
+  });
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 10);
+
+  // Меньше строк, чем потоков, и вложенный вызов из задачи пула
+  std::atomic<int> nested{0};
+  pool.ParallelRows(2, 0, [&pool, &nested](int begin, int end) {
+    pool.ParallelRows(end - begin, 0, [&nested](int from, int to) {
+      nested += to - from;
+    });
+  });
+  EXPECT_EQ(nested.load(), 2);
+  EXPECT_THROW(
+      pool.ParallelRows(4, 0, [](int, int) { throw std::runtime_error("x"); }),
+      std::runtime_error);
+}
+
+TEST(S21ThreadPoolTest, ParallelRowsDoesNotWaitForBusyWorker) {
+  S21ThreadPool pool(2);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  // Поток 0 занят, пока ParallelRows не вернётся: его диапазон должны
+  // забрать другой поток или вызывающий
+  pool.SubmitTo(0, [released] { released.wait(); });
+  std::vector<int> hits(8, 0);
+  pool.ParallelRows(8, 0, [&hits](int begin, int end) {
+    for (int i = begin; i < end; ++i) ++hits[i];
+  });
+  release.set_value();
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 8);
+}
+
+TEST(S21ThreadPoolTest, ParallelRowsIfWorthHonoursThreshold) {
+  S21ThreadPool pool(2);
+  std::vector<std::pair<int, int>> calls;
+  // Работы меньше порога: один вызов на все строки в текущем потоке
+  pool.ParallelRowsIfWorth(6, 0, 0, [&calls](int begin, int end) {
+    calls.emplace_back(begin, end);
+  });
+  ASSERT_EQ(calls.size(), 1u);
+  EXPECT_EQ(calls[0], std::make_pair(0, 6));
+
+  std::atomic<int> covered{0}, chunks{0};
+  pool.ParallelRowsIfWorth(
+      6, std::numeric_limits<std::uint64_t>::max(), 0,
+      [&covered, &chunks](int begin, int end) {
+        covered += end - begin;
+        ++chunks;
+      });
+  EXPECT_EQ(covered.load(), 6);
+  EXPECT_EQ(chunks.load(), 2);
+}
+
+TEST(S21ThreadPoolTest, PinWorkersReportsNodes) {
+  S21ThreadPool pool(2);
+  pool.PinWorkers();
+  for (int w = 0; w < pool.ThreadCount(); ++w) {
+    EXPECT_GE(pool.WorkerNode(w), 0);
+    EXPECT_LT(pool.WorkerNode(w), S21MatrixMemory::NodeCount());
+  }
+  EXPECT_EQ(pool.WorkerNode(5), 0);
+  EXPECT_THROW(pool.SubmitTo(2, [] {}), std::out_of_range);
+}
+
+#ifdef S21_MATRIX_PROFILE
+TEST(S21ProfilerTest, RecordsPerNodeBandwidth) {
+  S21Profiler& profiler = S21Profiler::Instance();
+  profiler.Reset();
+  S21ThreadPool pool(2);
+  pool.ParallelRows(4, 1024, [](int, int) {});
+  S21ProfileSnapshot snapshot = profiler.Snapshot();
+  std::uint64_t bytes = 0;
+  for (const S21NodeStats& node : snapshot.nodes) bytes += node.bytes;
+  EXPECT_EQ(bytes, 4u * 1024);
+  EXPECT_NE(profiler.ToJson().find("\"numa_nodes\":[{"), std::string::npos);
+}
+#endif
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();